@@ -0,0 +1,269 @@
+/*
+ * Copyright (C) 2005-2014 Christoph Rupp (chris@crupp.de).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * A block is a sequence of "sequences". Each sequence starts with a token;
+ * the high nibble is the number of literals, the low nibble the length of
+ * the match (minus MINMATCH). A nibble of 15 is continued with additional
+ * bytes, which are added to the length till a byte is not 255. The literals
+ * follow the token (and the length bytes), then the 16bit offset of the
+ * match (little endian) and the additional match length bytes. The last
+ * sequence only has literals.
+ *
+ * The compressor finds matches with a hash table of 4-byte sequences. If it
+ * does not find matches then it skips ahead in increasing steps, therefore
+ * incompressible data is processed quickly.
+ */
+
+#include <string.h>
+
+#include "lz4.h"
+
+typedef unsigned char  BYTE;
+typedef unsigned int   U32;
+
+#define MINMATCH        4
+#define LASTLITERALS    5   /* the last 5 bytes are always literals */
+#define MFLIMIT         12  /* the last match starts 12 bytes before the end */
+#define MAX_DISTANCE    65535
+#define HASH_LOG        12  /* the maximum size of the hash table */
+#define MIN_HASH_LOG    6
+#define ML_BITS         4
+#define ML_MASK         ((1U << ML_BITS) - 1)
+#define RUN_MASK        ((1U << (8 - ML_BITS)) - 1)
+#define SKIP_TRIGGER    6   /* increases the step after 2^6 failed searches */
+
+static U32
+read32(const BYTE *p)
+{
+  U32 v;
+  memcpy(&v, p, sizeof(v));
+  return (v);
+}
+
+static U32
+hash4(U32 sequence, unsigned hash_log)
+{
+  return ((sequence * 2654435761U) >> (32 - hash_log));
+}
+
+/* writes a length which exceeds the nibble of the token */
+static BYTE *
+write_length(BYTE *op, unsigned length)
+{
+  for (; length >= 255; length -= 255)
+    *op++ = 255;
+  *op++ = (BYTE)length;
+  return (op);
+}
+
+int
+LZ4_compressBound(int inputSize)
+{
+  return (LZ4_COMPRESSBOUND(inputSize));
+}
+
+int
+LZ4_compress_default(const char *src, char *dst, int srcSize,
+                int dstCapacity)
+{
+  const BYTE *base = (const BYTE *)src;
+  const BYTE *ip = base;
+  const BYTE *anchor = base;
+  const BYTE *iend = base + srcSize;
+  const BYTE *mflimit = iend - MFLIMIT;
+  const BYTE *matchlimit = iend - LASTLITERALS;
+  BYTE *op = (BYTE *)dst;
+  BYTE *oend = op + dstCapacity;
+  U32 table[1 << HASH_LOG];
+  unsigned hash_log = HASH_LOG;
+  unsigned literals;
+
+  if (srcSize < 0 || srcSize > LZ4_MAX_INPUT_SIZE || dstCapacity <= 0)
+    return (0);
+
+  if (srcSize > MFLIMIT) {
+    unsigned searches = 1 << SKIP_TRIGGER;
+
+    /* small inputs use a smaller table, which is faster to clear */
+    while (hash_log > MIN_HASH_LOG && (1 << (hash_log - 1)) >= srcSize)
+      hash_log--;
+
+    /* positions are relative to |base|; stale or wrong entries are
+     * detected when the candidate is compared */
+    memset(table, 0, sizeof(U32) << hash_log);
+    ip++;
+
+    while (ip < mflimit) {
+      U32 sequence = read32(ip);
+      U32 h = hash4(sequence, hash_log);
+      const BYTE *ref = base + table[h];
+      const BYTE *mp, *rp;
+      unsigned matchlen;
+      BYTE *token;
+
+      table[h] = (U32)(ip - base);
+      if (ref >= ip || ip - ref > MAX_DISTANCE || read32(ref) != sequence) {
+        ip += searches++ >> SKIP_TRIGGER;
+        continue;
+      }
+      searches = 1 << SKIP_TRIGGER;
+
+      /* extend the match backwards */
+      while (ip > anchor && ref > base && ip[-1] == ref[-1]) {
+        ip--;
+        ref--;
+      }
+
+      /* and forward */
+      mp = ip + MINMATCH;
+      rp = ref + MINMATCH;
+      while (mp < matchlimit && *mp == *rp) {
+        mp++;
+        rp++;
+      }
+
+      literals = (unsigned)(ip - anchor);
+      matchlen = (unsigned)(mp - ip) - MINMATCH;
+
+      /* token, literals, offset and length bytes; the last literals
+       * need at least one more byte */
+      if (op + 1 + literals + literals / 255 + 1 + 2 + matchlen / 255 + 1
+                + 1 + LASTLITERALS > oend)
+        return (0);
+
+      token = op++;
+      if (literals >= RUN_MASK) {
+        *token = (BYTE)(RUN_MASK << ML_BITS);
+        op = write_length(op, literals - RUN_MASK);
+      }
+      else
+        *token = (BYTE)(literals << ML_BITS);
+      memcpy(op, anchor, literals);
+      op += literals;
+
+      *op++ = (BYTE)(ip - ref);
+      *op++ = (BYTE)((ip - ref) >> 8);
+
+      if (matchlen >= ML_MASK) {
+        *token |= ML_MASK;
+        op = write_length(op, matchlen - ML_MASK);
+      }
+      else
+        *token |= (BYTE)matchlen;
+
+      ip = anchor = mp;
+
+      /* the position before the end of the match improves the ratio */
+      if (ip < mflimit)
+        table[hash4(read32(ip - 2), hash_log)] = (U32)(ip - 2 - base);
+    }
+  }
+
+  /* the remaining bytes are literals */
+  literals = (unsigned)(iend - anchor);
+  if (op + 1 + literals + (literals + 255 - RUN_MASK) / 255 > oend)
+    return (0);
+  if (literals >= RUN_MASK) {
+    *op++ = (BYTE)(RUN_MASK << ML_BITS);
+    op = write_length(op, literals - RUN_MASK);
+  }
+  else
+    *op++ = (BYTE)(literals << ML_BITS);
+  memcpy(op, anchor, literals);
+  op += literals;
+
+  return ((int)(op - (BYTE *)dst));
+}
+
+int
+LZ4_decompress_safe(const char *src, char *dst, int compressedSize,
+                int dstCapacity)
+{
+  const BYTE *ip = (const BYTE *)src;
+  const BYTE *iend = ip + compressedSize;
+  BYTE *op = (BYTE *)dst;
+  BYTE *oend = op + dstCapacity;
+
+  if (compressedSize <= 0 || dstCapacity < 0)
+    return (-1);
+
+  while (1) {
+    unsigned token;
+    size_t length, offset;
+    const BYTE *match;
+
+    if (ip >= iend)
+      return (-1);
+    token = *ip++;
+
+    /* the literals */
+    length = token >> ML_BITS;
+    if (length == RUN_MASK) {
+      unsigned s;
+      do {
+        if (ip >= iend)
+          return (-1);
+        s = *ip++;
+        length += s;
+      } while (s == 255);
+    }
+    if (length > (size_t)(iend - ip) || length > (size_t)(oend - op))
+      return (-1);
+    memcpy(op, ip, length);
+    op += length;
+    ip += length;
+
+    /* the last sequence has no match */
+    if (ip == iend)
+      break;
+
+    /* the match */
+    if (iend - ip < 2)
+      return (-1);
+    offset = ip[0] | (ip[1] << 8);
+    ip += 2;
+    if (offset == 0 || offset > (size_t)(op - (BYTE *)dst))
+      return (-1);
+
+    length = token & ML_MASK;
+    if (length == ML_MASK) {
+      unsigned s;
+      do {
+        if (ip >= iend)
+          return (-1);
+        s = *ip++;
+        length += s;
+      } while (s == 255);
+    }
+    length += MINMATCH;
+    if (length > (size_t)(oend - op))
+      return (-1);
+
+    /* the match can overlap with the output */
+    match = op - offset;
+    if (offset >= length) {
+      memcpy(op, match, length);
+      op += length;
+    }
+    else {
+      while (length--)
+        *op++ = *match++;
+    }
+  }
+
+  return ((int)(op - (BYTE *)dst));
+}
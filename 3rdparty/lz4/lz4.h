@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2005-2014 Christoph Rupp (chris@crupp.de).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * A compact implementation of the LZ4 block format
+ * (https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md).
+ *
+ * The compressed blocks are compatible with the reference implementation,
+ * and the functions have the same names and semantics as their counterparts
+ * in the reference library's lz4.h. Therefore the reference library can
+ * replace these files without changes to the callers.
+ */
+
+#ifndef LZ4_H_2983827168210
+#define LZ4_H_2983827168210
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* the maximum size of the input */
+#define LZ4_MAX_INPUT_SIZE        0x7E000000
+
+/* the maximum size of the compressed output of |isize| bytes */
+#define LZ4_COMPRESSBOUND(isize)  ((unsigned)(isize) > \
+                (unsigned)LZ4_MAX_INPUT_SIZE ? 0 : (isize) + ((isize) / 255) + 16)
+
+/*
+ * Returns the maximum size of the compressed output of |inputSize| bytes,
+ * or 0 if |inputSize| is too large
+ */
+int LZ4_compressBound(int inputSize);
+
+/*
+ * Compresses |srcSize| bytes from |src| into |dst|, which has a capacity
+ * of |dstCapacity| bytes. Returns the compressed size, or 0 if the output
+ * does not fit into |dst|.
+ */
+int LZ4_compress_default(const char *src, char *dst, int srcSize,
+                int dstCapacity);
+
+/*
+ * Decompresses |compressedSize| bytes from |src| into |dst|, which has a
+ * capacity of |dstCapacity| bytes. Returns the decompressed size, or a
+ * negative value if the input is malformed. Never reads or writes beyond
+ * the buffers.
+ */
+int LZ4_decompress_safe(const char *src, char *dst, int compressedSize,
+                int dstCapacity);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LZ4_H_2983827168210 */
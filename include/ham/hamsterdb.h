@@ -544,6 +544,11 @@ ham_get_license(const char **licensee, const char **product);
  *      Transactions and writes them to the Btree. Disabled by default. If
  *      disabled then hamsterdb buffers committed Transactions and only starts
  *      flushing when too many Transactions were committed.  
+ *     <li>@ref HAM_ENABLE_CONCURRENT_READS</li> Allows multiple threads
+ *      to run @ref ham_db_find, @ref ham_cursor_find and @ref ham_cursor_move
+ *      in parallel; all other operations are still serialized. Not allowed
+ *      in combination with @ref HAM_ENABLE_TRANSACTIONS,
+ *      @ref HAM_ENABLE_RECOVERY or remote Environments.
  *    </ul>
  *
  * @param mode File access rights for the new file. This is the @a mode
@@ -564,6 +569,36 @@ ham_get_license(const char **licensee, const char **product);
  *      file. Ignored for remote Environments.
  *    <li>@ref HAM_PARAM_NETWORK_TIMEOUT_SEC</li> Timeout (in seconds) when
  *      waiting for data from a remote server. By default, no timeout is set.
+ *    <li>@ref HAM_PARAM_CACHE_POLICY</li> The replacement policy of the
+ *      cache; either @ref HAM_CACHE_POLICY_LRU (the default) or
+ *      @ref HAM_CACHE_POLICY_2Q. Ignored for remote Environments.
+ *    <li>@ref HAM_PARAM_FLUSHER_HIGH_WATERMARK</li> Starts a background
+ *      thread which writes dirty pages to disk as soon as more than this
+ *      percentage of the cache is dirty. Disabled by default (0). Not
+ *      allowed for In-Memory Environments; ignored for remote Environments.
+ *    <li>@ref HAM_PARAM_FLUSHER_LOW_WATERMARK</li> The background thread
+ *      stops writing when the percentage of dirty pages dropped to this
+ *      value. Must be less than the high watermark; the default is half
+ *      of the high watermark.
+ *    <li>@ref HAM_PARAM_FILE_GROWTH_SIZE</li> The file grows in extents
+ *      of this size (in bytes) instead of page by page; the unused space
+ *      is released when the Environment is closed. Disabled by default
+ *      (0). Not allowed for In-Memory Environments; ignored for remote
+ *      Environments.
+ *    <li>@ref HAM_PARAM_JOURNAL_SIZE_LIMIT</li> The approximate maximum
+ *      size (in bytes) of the journal files; bounds the duration of the
+ *      recovery. If a journal file exceeds half of this size then all
+ *      committed Transactions are flushed, and the older file is cleared.
+ *      Only used with @ref HAM_ENABLE_TRANSACTIONS. Unlimited by default
+ *      (0), then the files are switched after a number of Transactions.
+ *      Not allowed for In-Memory Environments; ignored for remote
+ *      Environments.
+ *    <li>@ref HAM_PARAM_JOURNAL_COMPRESSION</li> Compresses the keys,
+ *      records and page images in the journal with this algorithm;
+ *      either @ref HAM_COMPRESSOR_LZ4 or (if hamsterdb was built with
+ *      zlib) @ref HAM_COMPRESSOR_ZLIB. Disabled by default
+ *      (@ref HAM_COMPRESSOR_NONE). Not allowed for In-Memory Environments;
+ *      ignored for remote Environments.
  *    </ul>
  *
  * @return @ref HAM_SUCCESS upon success
@@ -644,6 +679,11 @@ ham_env_create(ham_env_t **env, const char *filename,
  *      Transactions and writes them to the Btree. Disabled by default. If
  *      disabled then hamsterdb buffers committed Transactions and only starts
  *      flushing when too many Transactions were committed.  
+ *     <li>@ref HAM_ENABLE_CONCURRENT_READS</li> Allows multiple threads
+ *      to run @ref ham_db_find, @ref ham_cursor_find and @ref ham_cursor_move
+ *      in parallel; all other operations are still serialized. Not allowed
+ *      in combination with @ref HAM_ENABLE_TRANSACTIONS,
+ *      @ref HAM_ENABLE_RECOVERY or remote Environments.
  *    </ul>
  * @param param An array of ham_parameter_t structures. The following
  *      parameters are available:
@@ -656,6 +696,36 @@ ham_env_create(ham_env_t **env, const char *filename,
  *      file. Ignored for remote Environments.
  *    <li>@ref HAM_PARAM_NETWORK_TIMEOUT_SEC</li> Timeout (in seconds) when
  *      waiting for data from a remote server. By default, no timeout is set.
+ *    <li>@ref HAM_PARAM_CACHE_POLICY</li> The replacement policy of the
+ *      cache; either @ref HAM_CACHE_POLICY_LRU (the default) or
+ *      @ref HAM_CACHE_POLICY_2Q. Ignored for remote Environments.
+ *    <li>@ref HAM_PARAM_FLUSHER_HIGH_WATERMARK</li> Starts a background
+ *      thread which writes dirty pages to disk as soon as more than this
+ *      percentage of the cache is dirty. Disabled by default (0). Not
+ *      allowed for In-Memory Environments; ignored for remote Environments.
+ *    <li>@ref HAM_PARAM_FLUSHER_LOW_WATERMARK</li> The background thread
+ *      stops writing when the percentage of dirty pages dropped to this
+ *      value. Must be less than the high watermark; the default is half
+ *      of the high watermark.
+ *    <li>@ref HAM_PARAM_FILE_GROWTH_SIZE</li> The file grows in extents
+ *      of this size (in bytes) instead of page by page; the unused space
+ *      is released when the Environment is closed. Disabled by default
+ *      (0). Not allowed for In-Memory Environments; ignored for remote
+ *      Environments.
+ *    <li>@ref HAM_PARAM_JOURNAL_SIZE_LIMIT</li> The approximate maximum
+ *      size (in bytes) of the journal files; bounds the duration of the
+ *      recovery. If a journal file exceeds half of this size then all
+ *      committed Transactions are flushed, and the older file is cleared.
+ *      Only used with @ref HAM_ENABLE_TRANSACTIONS. Unlimited by default
+ *      (0), then the files are switched after a number of Transactions.
+ *      Not allowed for In-Memory Environments; ignored for remote
+ *      Environments.
+ *    <li>@ref HAM_PARAM_JOURNAL_COMPRESSION</li> Compresses the keys,
+ *      records and page images in the journal with this algorithm;
+ *      either @ref HAM_COMPRESSOR_LZ4 or (if hamsterdb was built with
+ *      zlib) @ref HAM_COMPRESSOR_ZLIB. Disabled by default
+ *      (@ref HAM_COMPRESSOR_NONE). Not allowed for In-Memory Environments;
+ *      ignored for remote Environments.
  *    </ul>
  *
  * @return @ref HAM_SUCCESS upon success.
@@ -699,6 +769,16 @@ ham_env_open(ham_env_t **env, const char *filename,
  *    <li>@ref HAM_PARAM_JOURNAL_COMPRESSION</li> Returns the
  *        selected algorithm for journal compression, or 0 if compression
  *        is disabled
+ *    <li>@ref HAM_PARAM_CACHE_POLICY</li> Returns the replacement policy
+ *        of the cache
+ *    <li>@ref HAM_PARAM_FLUSHER_HIGH_WATERMARK</li> Returns the high
+ *        watermark of the background flusher, or 0 if it is disabled
+ *    <li>@ref HAM_PARAM_FLUSHER_LOW_WATERMARK</li> Returns the low
+ *        watermark of the background flusher
+ *    <li>@ref HAM_PARAM_FILE_GROWTH_SIZE</li> Returns the size of the
+ *        extents in which the file grows, or 0 if it grows page by page
+ *    <li>@ref HAM_PARAM_JOURNAL_SIZE_LIMIT</li> Returns the size limit
+ *        of the journal, or 0 if it is unlimited
  *    </ul>
  *
  * @param env A valid Environment handle
@@ -812,6 +892,20 @@ ham_env_get_parameters(ham_env_t *env, ham_parameter_t *param);
  *    <li>@ref HAM_PARAM_RECORD_SIZE </li> The (fixed) size of the records;
  *      or @ref HAM_RECORD_SIZE_UNLIMITED if there was no fixed record size
  *      specified (this is the default).
+ *    <li>@ref HAM_PARAM_RECORD_COMPRESSION</li> Compresses the records
+ *      with this algorithm; either @ref HAM_COMPRESSOR_LZ4 or (if hamsterdb
+ *      was built with zlib) @ref HAM_COMPRESSOR_ZLIB. Records are only
+ *      stored compressed if this saves space; records which are stored
+ *      in the Btree leaf (i.e. with @ref HAM_FORCE_RECORDS_INLINE) are
+ *      never compressed. The setting is persistent. Disabled by default
+ *      (@ref HAM_COMPRESSOR_NONE). Not allowed for In-Memory Environments.
+ *    <li>@ref HAM_PARAM_KEY_COMPRESSION</li> Compresses the keys with
+ *      this algorithm; only @ref HAM_COMPRESSOR_PREFIX is supported, and
+ *      only for variable length keys of type @ref HAM_TYPE_BINARY. The
+ *      keys of a Btree leaf then share a common prefix, which is stored
+ *      only once per node. Useful for keys with long common prefixes
+ *      (i.e. URLs or file paths). The setting is persistent. Disabled by
+ *      default (@ref HAM_COMPRESSOR_NONE).
  *    </ul>
  *
  * @return @ref HAM_SUCCESS upon success
@@ -1191,6 +1285,10 @@ ham_txn_abort(ham_txn_t *txn, ham_u32_t flags);
  * This flag is non persistent. */
 #define HAM_FLUSH_WHEN_COMMITTED                    0x01000000
 
+/** Flag for @ref ham_env_open, @ref ham_env_create.
+ * This flag is non persistent. */
+#define HAM_ENABLE_CONCURRENT_READS                 0x02000000
+
 /**
  * Returns the last error code
  *
@@ -1519,6 +1617,99 @@ ham_db_insert(ham_db_t *db, ham_txn_t *txn, ham_key_t *key,
  */
 #define HAM_HINTS_MASK                  0x001F0000
 
+/**
+ * Inserts a batch of Database items
+ *
+ * This function inserts @a count key/record pairs. The items are sorted
+ * (unless @ref HAM_BULK_SORTED is specified) and then inserted in
+ * ascending order.
+ *
+ * If Transactions are disabled (or if @ref HAM_BULK_BYPASS_TRANSACTIONS
+ * is specified), and if the Database is empty or all keys are greater than
+ * the existing keys, then the Btree is built bottom-up: the leaf pages
+ * are filled one after another, and the internal nodes are created from
+ * the leafs. This is much faster than inserting the keys one by one, and
+ * the pages are packed as specified with @a fill_factor.
+ * Otherwise the keys are inserted one by one (in sorted order).
+ *
+ * If Transactions are enabled then all items are inserted in the
+ * Transaction @a txn, or in a new Transaction which is committed when all
+ * keys were inserted. @ref HAM_BULK_BYPASS_TRANSACTIONS writes the items
+ * directly to the Btree instead; this requires that @a txn is NULL and
+ * that there are no active Transactions which modified the Database.
+ * If the Environment was created with @ref HAM_ENABLE_RECOVERY then
+ * all modified pages are kept in memory until the whole batch is written
+ * to the journal.
+ *
+ * If the batch contains a key more than once then the items are inserted as
+ * duplicates (in the order of the input) if @ref HAM_DUPLICATE is
+ * specified; if @ref HAM_OVERWRITE is specified then only the last item
+ * is stored. Otherwise @ref HAM_DUPLICATE_KEY is returned and nothing
+ * is inserted.
+ *
+ * If an item cannot be inserted (i.e. because the key already exists)
+ * then the function returns an error. Without Transactions, the items
+ * which were inserted before are not removed.
+ *
+ * Record Number Databases assign the record numbers in the order of the
+ * input; the keys have to be initialized as described in
+ * @ref ham_db_insert. The record numbers are only returned in keys with
+ * flag @ref HAM_KEY_USER_ALLOC.
+ *
+ * @param db A valid Database handle
+ * @param txn A Transaction handle, or NULL
+ * @param keys An array with @a count keys
+ * @param records An array with @a count records
+ * @param count The number of items
+ * @param fill_factor The percentage of each new Btree node which is
+ *        filled (1 - 100); 0 selects the default, which is 100 (fully
+ *        packed nodes). Lower values leave space for subsequent inserts.
+ * @param flags Optional flags for inserting. Possible flags are:
+ *    <ul>
+ *    <li>@ref HAM_OVERWRITE. Existing keys are overwritten. Not allowed
+ *        in combination with @ref HAM_DUPLICATE.
+ *    <li>@ref HAM_DUPLICATE. Existing keys get a new duplicate. Not
+ *        allowed in combination with @ref HAM_OVERWRITE.
+ *    <li>@ref HAM_BULK_SORTED. The keys are already sorted and are not
+ *        sorted again.
+ *    <li>@ref HAM_BULK_BYPASS_TRANSACTIONS. The items are written
+ *        directly to the Btree, even if Transactions are enabled.
+ *    </ul>
+ *
+ * @return @ref HAM_SUCCESS upon success
+ * @return @ref HAM_INV_PARAMETER if @a db, @a keys or @a records is NULL
+ * @return @ref HAM_INV_PARAMETER if @a fill_factor is greater than 100
+ * @return @ref HAM_INV_PARAMETER if @ref HAM_BULK_SORTED was specified
+ *        but the keys are not sorted
+ * @return @ref HAM_INV_PARAMETER if @ref HAM_BULK_BYPASS_TRANSACTIONS was
+ *        specified together with a Transaction handle
+ * @return @ref HAM_INV_PARAMETER if the flags @ref HAM_OVERWRITE <b>and</b>
+ *        @ref HAM_DUPLICATE were specified, or if @ref HAM_DUPLICATE
+ *        was specified, but the Database was not created with
+ *        flag @ref HAM_ENABLE_DUPLICATE_KEYS, or if @ref HAM_PARTIAL
+ *        was specified
+ * @return @ref HAM_DUPLICATE_KEY if a key already exists, or if a key
+ *        occurs more than once in the batch
+ * @return @ref HAM_WRITE_PROTECTED if you tried to insert a key in a read-only
+ *        Database
+ * @return @ref HAM_TXN_STILL_OPEN if @ref HAM_BULK_BYPASS_TRANSACTIONS was
+ *        specified, but an active Transaction modified the Database
+ * @return @ref HAM_INV_KEY_SIZE if a key size is invalid (see
+ *        @ref ham_db_insert)
+ * @return @ref HAM_INV_RECORD_SIZE if a record size is different from
+ *        the one specified with @a HAM_PARAM_RECORD_SIZE
+ */
+HAM_EXPORT ham_status_t HAM_CALLCONV
+ham_db_bulk_insert(ham_db_t *db, ham_txn_t *txn, ham_key_t *keys,
+            ham_record_t *records, ham_u32_t count, ham_u32_t fill_factor,
+            ham_u32_t flags);
+
+/** Flag for @ref ham_db_bulk_insert: the keys are already sorted */
+#define HAM_BULK_SORTED                 0x0100
+
+/** Flag for @ref ham_db_bulk_insert: writes directly to the Btree */
+#define HAM_BULK_BYPASS_TRANSACTIONS    0x0200
+
 /**
  * Erases a Database item
  *
@@ -1552,8 +1743,11 @@ ham_db_erase(ham_db_t *db, ham_txn_t *txn, ham_key_t *key, ham_u32_t flags);
  * Returns the number of keys stored in the Database
  *
  * You can specify the @ref HAM_SKIP_DUPLICATES if you do now want
- * to include any duplicates in the count. This will also speed up the
- * counting.
+ * to include any duplicates in the count.
+ *
+ * The number of keys is maintained in persistent counters, therefore
+ * this function does not have to read the Database. Keys of Transactions
+ * which were not yet flushed are still counted individually.
  *
  * @param db A valid Database handle
  * @param txn A Transaction handle, or NULL
@@ -1561,6 +1755,9 @@ ham_db_erase(ham_db_t *db, ham_txn_t *txn, ham_key_t *key, ham_u32_t flags);
  *     <ul>
  *     <li>@ref HAM_SKIP_DUPLICATES. Excludes any duplicates from
  *       the count
+ *     <li>@ref HAM_KEY_COUNT_FULL_SCAN. Ignores the persistent counters
+ *       and counts the keys with a full scan of the Database; can be
+ *       used to verify the counters
  *     </ul>
  * @param keycount A reference to a variable which will receive
  *         the calculated key count per page
@@ -1573,6 +1770,9 @@ HAM_EXPORT ham_status_t HAM_CALLCONV
 ham_db_get_key_count(ham_db_t *db, ham_txn_t *txn, ham_u32_t flags,
             ham_u64_t *keycount);
 
+/** Flag for @ref ham_db_get_key_count */
+#define HAM_KEY_COUNT_FULL_SCAN                 0x0040
+
 /**
  * Retrieve the current value for a given Database setting
  *
@@ -1596,6 +1796,9 @@ ham_db_get_key_count(ham_db_t *db, ham_txn_t *txn, ham_u32_t flags,
  *    <li>@ref HAM_PARAM_RECORD_COMPRESSION</li> Returns the
  *        selected algorithm for record compression, or 0 if compression
  *        is disabled
+ *    <li>@ref HAM_PARAM_KEY_COMPRESSION</li> Returns the
+ *        selected algorithm for key compression, or 0 if compression
+ *        is disabled
  *    </ul>
  *
  * @param db A valid Database handle
@@ -1646,6 +1849,37 @@ ham_db_get_parameters(ham_db_t *db, ham_parameter_t *param);
 /** Parameter name for @ref ham_env_create_db; sets the key size */
 #define HAM_PARAM_RECORD_SIZE           0x00000108
 
+/** Parameter name for @ref ham_env_open, @ref ham_env_create;
+ * sets the replacement policy of the cache */
+#define HAM_PARAM_CACHE_POLICY          0x00000109
+
+/** Value for @ref HAM_PARAM_CACHE_POLICY: evicts the least recently used
+ * pages (this is the default) */
+#define HAM_CACHE_POLICY_LRU            0
+
+/** Value for @ref HAM_PARAM_CACHE_POLICY: scan-resistant "2Q" policy.
+ * Pages which are accessed only once (i.e. during a table scan) are evicted
+ * before frequently used pages and internal Btree nodes */
+#define HAM_CACHE_POLICY_2Q             1
+
+/** Parameter name for @ref ham_env_open, @ref ham_env_create;
+ * the percentage of dirty pages in the cache which starts the background
+ * flusher */
+#define HAM_PARAM_FLUSHER_HIGH_WATERMARK 0x0000010a
+
+/** Parameter name for @ref ham_env_open, @ref ham_env_create;
+ * the percentage of dirty pages in the cache which stops the background
+ * flusher */
+#define HAM_PARAM_FLUSHER_LOW_WATERMARK 0x0000010b
+
+/** Parameter name for @ref ham_env_open, @ref ham_env_create;
+ * the size of the extents (in bytes) in which the file grows */
+#define HAM_PARAM_FILE_GROWTH_SIZE      0x0000010c
+
+/** Parameter name for @ref ham_env_open, @ref ham_env_create;
+ * the approximate maximum size (in bytes) of the journal files */
+#define HAM_PARAM_JOURNAL_SIZE_LIMIT    0x0000010d
+
 /** Value for unlimited record sizes */
 #define HAM_RECORD_SIZE_UNLIMITED       ((ham_u32_t)-1)
 
@@ -1683,29 +1917,28 @@ ham_db_get_parameters(ham_db_t *db, ham_parameter_t *param);
 #define HAM_PARAM_MAX_KEYS_PER_PAGE     0x00000204
 
 /**
- * hamsterdb pro: Parameter name for @ref ham_env_create, @ref ham_env_open;
+ * Parameter name for @ref ham_env_create, @ref ham_env_open;
  * enables compression for the journal.
  */
 #define HAM_PARAM_JOURNAL_COMPRESSION   0x1000
 
 /**
- * hamsterdb pro: Parameter name for @ref ham_env_create_db,
- * @ref ham_env_open_db; enables compression for the records of
- * a Database.
+ * Parameter name for @ref ham_env_create_db; enables compression for
+ * the records of a Database.
  */
 #define HAM_PARAM_RECORD_COMPRESSION    0x1001
 
 /**
- * hamsterdb pro: Parameter name for @ref ham_env_create_db,
- * @ref ham_env_open_db; enables compression for the records of
- * a Database.
+ * Parameter name for @ref ham_env_create_db; enables compression for
+ * the keys of a Database.
  */
 #define HAM_PARAM_KEY_COMPRESSION       0x1002
 
-/** hamsterdb pro: helper macro for disabling compression */
+/** Helper macro for disabling compression */
 #define HAM_COMPRESSOR_NONE         0
 
-/** hamsterdb pro: selects zlib compression */
+/** Selects zlib compression; only available if hamsterdb was built
+ * with zlib */
 #define HAM_COMPRESSOR_ZLIB         1
 
 /**
@@ -1726,6 +1959,18 @@ ham_db_get_parameters(ham_db_t *db, ham_parameter_t *param);
  */
 #define HAM_COMPRESSOR_LZO          4
 
+/**
+ * Selects lz4 compression; the codec is bundled with hamsterdb
+ * http://code.google.com/p/lz4
+ */
+#define HAM_COMPRESSOR_LZ4          5
+
+/**
+ * Selects prefix compression for the keys (@ref HAM_PARAM_KEY_COMPRESSION);
+ * the keys of a Btree leaf are stored without their common prefix
+ */
+#define HAM_COMPRESSOR_PREFIX       6
+
 /**
  * Retrieves the Environment handle of a Database
  *
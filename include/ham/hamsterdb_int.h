@@ -127,7 +127,7 @@ ham_cursor_get_database(ham_cursor_t *cursor);
  * Metrics marked "global" are stored globally and shared between multiple
  * Environments.
  */
-#define HAM_METRICS_VERSION         7
+#define HAM_METRICS_VERSION         8
 
 typedef struct ham_env_metrics_t {
   // the version indicator - must be HAM_METRICS_VERSION
@@ -198,6 +198,65 @@ typedef struct ham_env_metrics_t {
   // number of flushed bytes in the log/journal
   ham_u64_t journal_bytes_flushed;
 
+  // number of times the background flusher wrote dirty pages
+  ham_u64_t flusher_runs;
+
+  // number of pages written by the background flusher
+  ham_u64_t flusher_pages_flushed;
+
+  // number of pages which were prefetched during sequential cursor scans
+  ham_u64_t page_count_prefetched;
+
+  // number of pages which were served from the memory mapped file
+  ham_u64_t page_count_mapped;
+
+  // number of pages which were read into malloc'ed buffers
+  ham_u64_t page_count_malloced;
+
+  // number of fsyncs which made committed Transactions durable (with
+  // HAM_ENABLE_FSYNC); each one can cover the commits of several threads
+  ham_u64_t journal_group_syncs;
+
+  // number of journal entries which were read during recovery
+  ham_u64_t journal_recovered_entries;
+
+  // number of journal bytes which were read during recovery
+  ham_u64_t journal_recovered_bytes;
+
+  // duration of the recovery, in microseconds
+  ham_u64_t journal_recovery_usec;
+
+  // number of times the committed Transactions were flushed because the
+  // journal exceeded HAM_PARAM_JOURNAL_SIZE_LIMIT
+  ham_u64_t journal_checkpoints;
+
+  // number of bytes which were not written to the journal because only
+  // the modified ranges of the changeset pages were logged
+  ham_u64_t journal_changeset_bytes_saved;
+
+  // number of bytes of keys, records and changeset pages which were
+  // passed to the journal compressor (HAM_PARAM_JOURNAL_COMPRESSION), and
+  // the number of bytes which were written instead
+  ham_u64_t journal_bytes_before_compression;
+  ham_u64_t journal_bytes_after_compression;
+
+  // number of bytes of records which were passed to the record compressor
+  // (HAM_PARAM_RECORD_COMPRESSION), and the number of bytes which were
+  // stored instead
+  ham_u64_t record_bytes_before_compression;
+  ham_u64_t record_bytes_after_compression;
+
+  // (global) number of TransactionOperations and TransactionNodes which
+  // were allocated without calling malloc, and the number of memory
+  // chunks which were malloc'ed for them
+  ham_u64_t txn_allocator_hits;
+  ham_u64_t txn_allocator_misses;
+
+  // (global) number of keys of ham_db_find_many and ham_db_insert_many
+  // which were found in (or inserted into) the leaf of the previous key,
+  // without traversing the Btree
+  ham_u64_t btree_batch_leaf_hits;
+
 } ham_env_metrics_t;
 
 /**
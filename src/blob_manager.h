@@ -41,6 +41,13 @@ class LocalEnvironment;
 HAM_PACK_0 class HAM_PACK_1 PBlobHeader
 {
   public:
+    enum {
+      // The payload is compressed with the Database's record compressor;
+      // the size is the uncompressed size, the compressed data fills the
+      // allocated space
+      kIsCompressed = 1
+    };
+
     PBlobHeader() {
       memset(this, 0, sizeof(PBlobHeader));
     }
@@ -92,8 +99,7 @@ HAM_PACK_0 class HAM_PACK_1 PBlobHeader
     }
 
   private:
-    // Flags; currently only used in hamsterdb-pro to store compression
-    // information
+    // Flags; currently only used to store compression information
     ham_u32_t m_flags;
 
     // The blob ID - which is the absolute address/offset of this
@@ -117,8 +123,17 @@ HAM_PACK_0 class HAM_PACK_1 PBlobHeader
 class BlobManager
 {
   public:
+    enum {
+      // Flag for allocate() and overwrite(): stores the blob uncompressed,
+      // even if the Database uses record compression (i.e. for extended
+      // keys and duplicate tables)
+      kDisableCompression = 0x08000000
+    };
+
     BlobManager(LocalEnvironment *env)
-      : m_env(env), m_blob_total_allocated(0), m_blob_total_read(0) {
+      : m_env(env), m_blob_total_allocated(0), m_blob_total_read(0),
+        m_record_bytes_before_compression(0),
+        m_record_bytes_after_compression(0) {
     }
 
     virtual ~BlobManager() { }
@@ -153,6 +168,10 @@ class BlobManager
     void get_metrics(ham_env_metrics_t *metrics) const {
       metrics->blob_total_allocated = m_blob_total_allocated;
       metrics->blob_total_read = m_blob_total_read;
+      metrics->record_bytes_before_compression
+              = m_record_bytes_before_compression;
+      metrics->record_bytes_after_compression
+              = m_record_bytes_after_compression;
     }
 
   protected:
@@ -192,6 +211,12 @@ class BlobManager
     // Usage tracking - number of blobs read
     ham_u64_t m_blob_total_read;
 
+    // Usage tracking - number of record bytes passed to the compressor
+    ham_u64_t m_record_bytes_before_compression;
+
+    // Usage tracking - number of record bytes stored after compression
+    ham_u64_t m_record_bytes_after_compression;
+
 };
 
 } // namespace hamsterdb
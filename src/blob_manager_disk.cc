@@ -22,6 +22,7 @@
 #include "device.h"
 #include "error.h"
 #include "page_manager.h"
+#include "db_local.h"
 
 #include "blob_manager_disk.h"
 
@@ -31,6 +32,19 @@ using namespace hamsterdb;
 ham_u64_t
 DiskBlobManager::do_allocate(LocalDatabase *db, ham_record_t *record,
                 ham_u32_t flags)
+{
+  ham_u8_t *data;
+  ham_u32_t size;
+  bool compressed = compress(db, record, flags, &data, &size);
+
+  return (allocate_blob(db, record, flags, data, size,
+                          compressed ? PBlobHeader::kIsCompressed : 0));
+}
+
+ham_u64_t
+DiskBlobManager::allocate_blob(LocalDatabase *db, ham_record_t *record,
+                ham_u32_t flags, ham_u8_t *data, ham_u32_t size,
+                ham_u32_t blob_flags)
 {
   ham_u8_t *chunk_data[2];
   ham_u32_t chunk_size[2];
@@ -39,7 +53,7 @@ DiskBlobManager::do_allocate(LocalDatabase *db, ham_record_t *record,
   m_blob_total_allocated++;
 
   PBlobHeader blob_header;
-  ham_u32_t alloc_size = sizeof(PBlobHeader) + record->size;
+  ham_u32_t alloc_size = sizeof(PBlobHeader) + size;
 
   // first check if we can add another blob to the last used page
   Page *page = m_env->get_page_manager()->get_last_blob_page(db);
@@ -99,6 +113,7 @@ DiskBlobManager::do_allocate(LocalDatabase *db, ham_record_t *record,
   blob_header.set_alloc_size(alloc_size);
   blob_header.set_size(record->size);
   blob_header.set_self(address);
+  blob_header.set_flags(blob_flags);
 
   // PARTIAL WRITE
   //
@@ -138,10 +153,10 @@ DiskBlobManager::do_allocate(LocalDatabase *db, ham_record_t *record,
     // not writing partially: write header and data, then we're done
     chunk_data[0] = (ham_u8_t *)&blob_header;
     chunk_size[0] = sizeof(blob_header);
-    chunk_data[1] = (ham_u8_t *)record->data;
+    chunk_data[1] = data;
     chunk_size[1] = (flags & HAM_PARTIAL)
                         ? record->partial_size
-                        : record->size;
+                        : size;
 
     write_chunks(db, page, address, chunk_data, chunk_size, 2);
     address += chunk_size[0] + chunk_size[1];
@@ -229,6 +244,12 @@ DiskBlobManager::do_read(LocalDatabase *db, ham_u64_t blobid,
     record->data = arena->get_ptr();
   }
 
+  // compressed blobs are always read completely, then decompressed
+  if (blob_header.get_flags() & PBlobHeader::kIsCompressed) {
+    read_compressed(db, page, &blob_header, record, flags, blobsize);
+    return;
+  }
+
   // third step: read the blob data
   read_chunk(page, 0,
                   blobid + sizeof(PBlobHeader) + (flags & HAM_PARTIAL
@@ -237,6 +258,44 @@ DiskBlobManager::do_read(LocalDatabase *db, ham_u64_t blobid,
                   db, (ham_u8_t *)record->data, blobsize, true);
 }
 
+void
+DiskBlobManager::read_compressed(LocalDatabase *db, Page *page,
+                PBlobHeader *blob_header, ham_record_t *record,
+                ham_u32_t flags, ham_u32_t blobsize)
+{
+  Compressor *compressor = db->get_record_compressor();
+  if (!compressor) {
+    ham_log(("blob %lld is compressed, but the database does not use "
+             "record compression", blob_header->get_self()));
+    throw Exception(HAM_INTEGRITY_VIOLATED);
+  }
+
+  // the compressed payload fills the allocated space. The buffers are
+  // local because readers can run concurrently
+  // (HAM_ENABLE_CONCURRENT_READS).
+  ham_u32_t size = (ham_u32_t)(blob_header->get_alloc_size()
+                        - sizeof(PBlobHeader));
+  ByteArray compressed(size);
+  read_chunk(page, 0, blob_header->get_self() + sizeof(PBlobHeader),
+                  db, (ham_u8_t *)compressed.get_ptr(), size, true);
+
+  if (!(flags & HAM_PARTIAL)) {
+    compressor->decompress((ham_u8_t *)compressed.get_ptr(), size,
+                    (ham_u8_t *)record->data, blobsize);
+    return;
+  }
+
+  // PARTIAL READ: decompress the full record, then copy the requested
+  // range
+  ham_u32_t full_size = (ham_u32_t)blob_header->get_size();
+  ByteArray uncompressed(full_size);
+  compressor->decompress((ham_u8_t *)compressed.get_ptr(), size,
+                  (ham_u8_t *)uncompressed.get_ptr(), full_size);
+  memcpy(record->data,
+                  (ham_u8_t *)uncompressed.get_ptr() + record->partial_offset,
+                  blobsize);
+}
+
 ham_u64_t
 DiskBlobManager::do_get_blob_size(LocalDatabase *db, ham_u64_t blobid)
 {
@@ -258,8 +317,6 @@ DiskBlobManager::do_overwrite(LocalDatabase *db, ham_u64_t old_blobid,
   PBlobHeader old_blob_header, new_blob_header;
   Page *page;
 
-  ham_u32_t alloc_size = sizeof(PBlobHeader) + record->size;
-
   // first, read the blob header; if the new blob fits into the
   // old blob, we overwrite the old blob (and add the remaining
   // space to the freelist, if there is any)
@@ -271,6 +328,35 @@ DiskBlobManager::do_overwrite(LocalDatabase *db, ham_u64_t old_blobid,
   if (old_blob_header.get_self() != old_blobid)
     throw Exception(HAM_BLOB_NOT_FOUND);
 
+  // PARTIAL WRITE
+  //
+  // a compressed blob cannot be patched in place; merge the partial data
+  // with the uncompressed record, then overwrite the full record
+  if ((flags & HAM_PARTIAL)
+      && (old_blob_header.get_flags() & PBlobHeader::kIsCompressed)) {
+    ByteArray arena;
+    ham_record_t old_record = {0};
+    do_read(db, old_blobid, &old_record, 0, &arena);
+
+    ByteArray merged(record->size, 0);
+    memcpy(merged.get_ptr(), old_record.data,
+                    std::min(old_record.size, record->size));
+    merged.overwrite(record->partial_offset, record->data,
+                    record->partial_size);
+
+    ham_record_t full_record = {0};
+    full_record.data = merged.get_ptr();
+    full_record.size = record->size;
+    return (do_overwrite(db, old_blobid, &full_record, flags & ~HAM_PARTIAL));
+  }
+
+  ham_u8_t *data;
+  ham_u32_t size;
+  bool compressed = compress(db, record, flags, &data, &size);
+  ham_u32_t blob_flags = compressed ? PBlobHeader::kIsCompressed : 0;
+
+  ham_u32_t alloc_size = sizeof(PBlobHeader) + size;
+
   // now compare the sizes; does the new data fit in the old allocated
   // space?
   if (alloc_size <= old_blob_header.get_alloc_size()) {
@@ -281,6 +367,7 @@ DiskBlobManager::do_overwrite(LocalDatabase *db, ham_u64_t old_blobid,
     new_blob_header.set_self(old_blob_header.get_self());
     new_blob_header.set_size(record->size);
     new_blob_header.set_alloc_size(alloc_size);
+    new_blob_header.set_flags(blob_flags);
 
     // PARTIAL WRITE
     //
@@ -302,10 +389,10 @@ DiskBlobManager::do_overwrite(LocalDatabase *db, ham_u64_t old_blobid,
     else {
       chunk_data[0] = (ham_u8_t *)&new_blob_header;
       chunk_size[0] = sizeof(new_blob_header);
-      chunk_data[1] = (ham_u8_t *)record->data;
+      chunk_data[1] = data;
       chunk_size[1] = (flags & HAM_PARTIAL)
                           ? record->partial_size
-                          : record->size;
+                          : size;
 
       write_chunks(db, page, new_blob_header.get_self(),
                       chunk_data, chunk_size, 2);
@@ -327,7 +414,8 @@ DiskBlobManager::do_overwrite(LocalDatabase *db, ham_u64_t old_blobid,
 
   // if the new data is larger: allocate a fresh space for it
   // and discard the old; 'overwrite' has become (delete + insert) now.
-  ham_u64_t new_blobid = allocate(db, record, flags);
+  ham_u64_t new_blobid = allocate_blob(db, record, flags, data, size,
+                  blob_flags);
   erase(db, old_blobid, 0, 0);
 
   return (new_blobid);
@@ -367,6 +455,34 @@ DiskBlobManager::do_erase(LocalDatabase *db, ham_u64_t blobid, Page *page,
                   (ham_u32_t)blob_header.get_alloc_size());
 }
 
+bool
+DiskBlobManager::compress(LocalDatabase *db, ham_record_t *record,
+                ham_u32_t flags, ham_u8_t **pdata, ham_u32_t *psize)
+{
+  *pdata = (ham_u8_t *)record->data;
+  *psize = record->size;
+
+  Compressor *compressor = db ? db->get_record_compressor() : 0;
+  if (!compressor || !record->size
+      || (flags & (HAM_PARTIAL | kDisableCompression)))
+    return (false);
+
+  ham_u32_t len = compressor->compress((ham_u8_t *)record->data,
+                  record->size);
+  m_record_bytes_before_compression += record->size;
+
+  // store the record uncompressed if compression does not save space
+  if (len >= record->size) {
+    m_record_bytes_after_compression += record->size;
+    return (false);
+  }
+
+  m_record_bytes_after_compression += len;
+  *pdata = (ham_u8_t *)compressor->get_output_data();
+  *psize = len;
+  return (true);
+}
+
 bool
 DiskBlobManager::alloc_from_freelist(PBlobPageHeader *header, ham_u32_t size,
                     ham_u64_t *poffset)
@@ -156,6 +156,26 @@ class DiskBlobManager : public BlobManager
     friend class DuplicateManager;
     friend struct BlobManagerFixture;
 
+    // Compresses |record| with the Database's record compressor, unless
+    // this is a partial write or |kDisableCompression| is set. Returns
+    // true if compression saves space; then |pdata| and |psize| point to
+    // the compressed data, otherwise to the record data.
+    bool compress(LocalDatabase *db, ham_record_t *record, ham_u32_t flags,
+                    ham_u8_t **pdata, ham_u32_t *psize);
+
+    // allocates the blob for |record|; |data| and |size| are the payload
+    // which is stored on disk, and |blob_flags| are stored in the
+    // PBlobHeader
+    ham_u64_t allocate_blob(LocalDatabase *db, ham_record_t *record,
+                    ham_u32_t flags, ham_u8_t *data, ham_u32_t size,
+                    ham_u32_t blob_flags);
+
+    // reads and decompresses a compressed blob into |record->data|;
+    // |blobsize| is the number of bytes that are returned
+    void read_compressed(LocalDatabase *db, Page *page,
+                    PBlobHeader *blob_header, ham_record_t *record,
+                    ham_u32_t flags, ham_u32_t blobsize);
+
     // write a series of data chunks to storage at file offset 'addr'.
     //
     // The chunks are assumed to be stored in sequential order, adjacent
@@ -0,0 +1,357 @@
+/*
+ * Copyright (C) 2005-2014 Christoph Rupp (chris@crupp.de).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "config.h"
+
+#include <vector>
+#include <algorithm>
+
+#include "db_local.h"
+#include "env_local.h"
+#include "page.h"
+#include "page_manager.h"
+#include "btree_index.h"
+#include "btree_node_proxy.h"
+#include "btree_cursor.h"
+
+namespace hamsterdb {
+
+/*
+ * Builds the btree bottom-up from sorted keys (ham_db_bulk_insert).
+ *
+ * The keys are appended to the right-most leaf. When a node is full, a
+ * new (empty) node is started on the same level, and its first key is
+ * appended to the parent level. If the top-most node gets a sibling then
+ * a new root is created. Therefore the btree is never traversed, and pages
+ * are never split (unless a fill factor is specified).
+ *
+ * The first node which is full on each level determines how many keys
+ * the following nodes of this level will store (= the fill factor applied
+ * to its capacity).
+ */
+class BtreeBulkLoadAction
+{
+  public:
+    BtreeBulkLoadAction(BtreeIndex *btree, ham_key_t *keys,
+            ham_record_t *records, const ham_u32_t *order, ham_u32_t count,
+            ham_u32_t fill_factor, ham_u32_t flags)
+      : m_btree(btree), m_db(btree->get_db()), m_keys(keys),
+        m_records(records), m_order(order), m_count(count),
+        m_fill_factor(fill_factor), m_flags(flags) {
+      m_page_manager = m_db->get_local_env()->get_page_manager();
+    }
+
+    // Unpins the pages of the right-most path
+    ~BtreeBulkLoadAction() {
+      for (std::vector<Page *>::iterator it = m_levels.begin();
+              it != m_levels.end(); it++)
+        m_page_manager->unpin_page(*it);
+    }
+
+    // This is the entry point for the bulk load; returns false if the
+    // keys cannot be appended
+    bool run() {
+      if (!fetch_rightmost_path(&m_keys[m_order[0]]))
+        return (false);
+
+      ham_u64_t old_root = m_btree->get_root_address();
+      ham_s64_t keys = 0;
+
+      for (ham_u32_t i = 0; i < m_count; i++) {
+        ham_key_t *key = &m_keys[m_order[i]];
+        ham_record_t *record = &m_records[m_order[i]];
+
+        if (i > 0 && (m_flags & HAM_DUPLICATE)
+            && m_btree->compare_keys(&m_keys[m_order[i - 1]], key) == 0)
+          append_duplicate(record);
+        else {
+          append_key(key, record);
+          keys++;
+        }
+      }
+
+      // the top-most node is the root
+      ham_u64_t new_root = m_levels.back()->get_address();
+      if (new_root != old_root)
+        m_btree->set_root_address(new_root);
+
+      m_btree->adjust_key_count(keys, m_count);
+      return (true);
+    }
+
+  private:
+    // Collects (and pins) the right-most node of each level, and checks
+    // if |key| (the smallest new key) is greater than all existing keys
+    bool fetch_rightmost_path(ham_key_t *key) {
+      std::vector<Page *> path;
+      Page *page = m_page_manager->fetch_page(m_db,
+                    m_btree->get_root_address(), PageManager::kPinPage);
+
+      while (true) {
+        path.push_back(page);
+        BtreeNodeProxy *node = m_btree->get_node_from_page(page);
+        ham_u32_t count = node->get_count();
+
+        // the keys of a leaf must be smaller, the separators of an
+        // internal node can be equal (but only if the leaf is empty)
+        bool ok;
+        if (node->is_leaf())
+          ok = count == 0 || node->compare(key, count - 1) > 0;
+        else
+          ok = count == 0 || node->compare(key, count - 1) >= 0;
+        if (!ok) {
+          for (std::vector<Page *>::iterator it = path.begin();
+                  it != path.end(); it++)
+            m_page_manager->unpin_page(*it);
+          return (false);
+        }
+
+        if (node->is_leaf())
+          break;
+
+        page = m_page_manager->fetch_page(m_db,
+                    count ? node->get_record_id(count - 1)
+                          : node->get_ptr_down(),
+                    PageManager::kPinPage);
+      }
+
+      // the leaf is at level 0
+      m_levels.assign(path.rbegin(), path.rend());
+      m_limits.assign(m_levels.size(), 0);
+
+      m_btree->get_statistics()->reset_page(m_levels[0]);
+      return (true);
+    }
+
+    // Appends a new key to the right-most leaf
+    void append_key(ham_key_t *key, ham_record_t *record) {
+      Page *page = m_levels[0];
+      BtreeNodeProxy *node = m_btree->get_node_from_page(page);
+      if (is_full(0, node)) {
+        if (!apply_fill_factor(0))
+          new_node(0, key, 0);
+        page = m_levels[0];
+        node = m_btree->get_node_from_page(page);
+      }
+
+      ham_u32_t slot = node->get_count();
+      node->insert(slot, key);
+      try {
+        node->set_record(slot, record, 0, 0, 0);
+      }
+      catch (Exception &ex) {
+        node->erase(slot);
+        throw ex;
+      }
+      page->set_dirty(true);
+    }
+
+    // Appends a duplicate to the last key of the right-most leaf
+    void append_duplicate(ham_record_t *record) {
+      Page *page = m_levels[0];
+      BtreeNodeProxy *node = m_btree->get_node_from_page(page);
+      ham_u32_t slot = node->get_count() - 1;
+
+      // move the key to a new leaf if the current one is full
+      if (slot > 0 && node->requires_split()) {
+        page = split_node(0, slot);
+        node = m_btree->get_node_from_page(page);
+        slot = 0;
+      }
+
+      node->set_record(slot, record, 0, HAM_DUPLICATE, 0);
+      page->set_dirty(true);
+    }
+
+    // Appends a child node to the right-most node of |level|; |key| is
+    // the smallest key of the child, |left| is the address of the child's
+    // left sibling
+    void add_child(ham_u32_t level, ham_key_t *key, ham_u64_t child,
+                    ham_u64_t left) {
+      // the current root got a sibling? then create a new root above both
+      if (level == m_levels.size()) {
+        Page *old_root = m_levels.back();
+        ham_assert(old_root->get_address() == left);
+
+        Page *page = allocate_node(level, Page::kTypeBroot);
+        m_btree->get_node_from_page(page)->set_ptr_down(left);
+        old_root->set_type(Page::kTypeBindex);
+        old_root->set_dirty(true);
+
+        m_levels.push_back(page);
+        m_limits.push_back(0);
+      }
+
+      Page *page = m_levels[level];
+      BtreeNodeProxy *node = m_btree->get_node_from_page(page);
+      if (is_full(level, node)) {
+        // a new internal node stores the child in its ptr_down
+        if (!apply_fill_factor(level)) {
+          new_node(level, key, child);
+          return;
+        }
+        page = m_levels[level];
+        node = m_btree->get_node_from_page(page);
+      }
+
+      ham_u32_t slot = node->get_count();
+      node->insert(slot, key);
+      node->set_record_id(slot, child);
+      page->set_dirty(true);
+    }
+
+    // Returns true if the right-most node of a level cannot store
+    // another key
+    bool is_full(ham_u32_t level, BtreeNodeProxy *node) {
+      return (node->requires_split()
+              || (m_limits[level] && node->get_count() >= m_limits[level]));
+    }
+
+    // Called when the right-most node of |level| is full. If the fill
+    // factor of this level was not yet determined then the node is reduced
+    // to its new capacity, and the remaining keys are moved to new nodes.
+    // Returns true if the (new) right-most node can store another key.
+    bool apply_fill_factor(ham_u32_t level) {
+      if (m_limits[level] != 0 || m_fill_factor == 100)
+        return (false);
+
+      BtreeNodeProxy *node = m_btree->get_node_from_page(m_levels[level]);
+      m_limits[level] = std::max(1u, node->get_count() * m_fill_factor / 100);
+
+      while (node->get_count() > m_limits[level]) {
+        split_node(level, m_limits[level]);
+        node = m_btree->get_node_from_page(m_levels[level]);
+      }
+      return (!is_full(level, node));
+    }
+
+    // Starts a new (empty) right-most node on |level|. |key| will be the
+    // first key of the new node; internal nodes store |child| in their
+    // ptr_down.
+    void new_node(ham_u32_t level, ham_key_t *key, ham_u64_t child) {
+      Page *old_page = m_levels[level];
+      Page *page = allocate_node(level, Page::kTypeBindex);
+      if (level > 0)
+        m_btree->get_node_from_page(page)->set_ptr_down(child);
+
+      append_sibling(level, old_page, page, key);
+    }
+
+    // Moves the keys starting at |pivot| from the right-most node of
+    // |level| to a new right-most node
+    Page *split_node(ham_u32_t level, ham_u32_t pivot) {
+      Page *old_page = m_levels[level];
+      BtreeNodeProxy *old_node = m_btree->get_node_from_page(old_page);
+      Page *page = allocate_node(level, Page::kTypeBindex);
+      BtreeNodeProxy *node = m_btree->get_node_from_page(page);
+
+      ByteArray pivot_arena;
+      ham_key_t pivot_key = {0};
+      old_node->get_key(pivot, &pivot_arena, &pivot_key);
+
+      // the pivot key of an internal node moves to the parent
+      if (old_node->is_leaf())
+        BtreeCursor::uncouple_all_cursors(old_page, pivot);
+      else
+        node->set_ptr_down(old_node->get_record_id(pivot));
+
+      old_node->split(node, pivot);
+
+      append_sibling(level, old_page, page, &pivot_key);
+      return (page);
+    }
+
+    // Links |page| as the right sibling of |old_page|, adds it to the
+    // parent and replaces |old_page| as the right-most node of |level|
+    void append_sibling(ham_u32_t level, Page *old_page, Page *page,
+                    ham_key_t *key) {
+      BtreeNodeProxy *old_node = m_btree->get_node_from_page(old_page);
+      BtreeNodeProxy *node = m_btree->get_node_from_page(page);
+      ham_assert(old_node->get_right() == 0);
+
+      node->set_left(old_page->get_address());
+      old_node->set_right(page->get_address());
+      old_page->set_dirty(true);
+      page->set_dirty(true);
+
+      add_child(level + 1, key, page->get_address(), old_page->get_address());
+
+      m_levels[level] = page;
+      m_page_manager->unpin_page(old_page);
+
+      // the completed nodes can be flushed if the cache is full; with
+      // recovery they have to stay in the Changeset
+      if (level == 0
+          && !(m_db->get_local_env()->get_flags() & HAM_ENABLE_RECOVERY))
+        m_page_manager->purge_cache();
+    }
+
+    // Allocates and pins a new node for |level|
+    Page *allocate_node(ham_u32_t level, ham_u32_t type) {
+      Page *page = m_page_manager->alloc_page(m_db, type);
+      PBtreeNode::from_page(page)->set_flags(level == 0
+                                    ? PBtreeNode::kLeafNode
+                                    : 0);
+      m_page_manager->fetch_page(m_db, page->get_address(),
+                    PageManager::kPinPage);
+      return (page);
+    }
+
+    // the current btree
+    BtreeIndex *m_btree;
+
+    // the current database
+    LocalDatabase *m_db;
+
+    // the PageManager of the Environment
+    PageManager *m_page_manager;
+
+    // the keys
+    ham_key_t *m_keys;
+
+    // the records
+    ham_record_t *m_records;
+
+    // the indices of the keys and records, in sorted order
+    const ham_u32_t *m_order;
+
+    // the number of items in |m_order|
+    ham_u32_t m_count;
+
+    // the fill factor of new nodes, in percent
+    ham_u32_t m_fill_factor;
+
+    // flags of ham_db_bulk_insert()
+    ham_u32_t m_flags;
+
+    // the (pinned) right-most node of each level; level 0 is the leaf level
+    std::vector<Page *> m_levels;
+
+    // the max. number of keys of a node, per level; 0 if not yet known
+    std::vector<ham_u32_t> m_limits;
+};
+
+bool
+BtreeIndex::bulk_load(ham_key_t *keys, ham_record_t *records,
+                const ham_u32_t *order, ham_u32_t count,
+                ham_u32_t fill_factor, ham_u32_t flags)
+{
+  BtreeBulkLoadAction bla(this, keys, records, order, count, fill_factor,
+                  flags);
+  return (bla.run());
+}
+
+} // namespace hamsterdb
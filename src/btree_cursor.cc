@@ -33,7 +33,8 @@ namespace hamsterdb {
 BtreeCursor::BtreeCursor(Cursor *parent)
   : m_parent(parent), m_state(0), m_duplicate_index(0),
     m_coupled_page(0), m_coupled_index(0), m_next_in_page(0),
-    m_previous_in_page(0)
+    m_previous_in_page(0), m_leaf_transitions(0), m_readahead_pages(0),
+    m_readahead_exhausted(false)
 {
   memset(&m_uncoupled_key, 0, sizeof(m_uncoupled_key));
   m_btree = parent->get_db()->get_btree_index();
@@ -51,6 +52,7 @@ BtreeCursor::set_to_nil()
 
   m_state = BtreeCursor::kStateNil;
   m_duplicate_index = 0;
+  reset_read_ahead();
 }
 
 void
@@ -121,6 +123,10 @@ BtreeCursor::move(ham_key_t *key, ham_record_t *record, ham_u32_t flags)
   LocalDatabase *db = m_parent->get_db();
   Transaction *txn = m_parent->get_txn();
 
+  // only consecutive HAM_CURSOR_NEXT moves are a sequential scan
+  if (!(flags & HAM_CURSOR_NEXT))
+    reset_read_ahead();
+
   if (flags & HAM_CURSOR_FIRST)
     st = move_first(flags);
   else if (flags & HAM_CURSOR_LAST)
@@ -367,9 +373,34 @@ BtreeCursor::move_next(ham_u32_t flags)
   // couple this cursor to the smallest key in this page
   couple_to_page(page, 0, 0);
 
+  if (!(env->get_flags() & HAM_IN_MEMORY))
+    read_ahead(page);
+
   return (0);
 }
 
+void
+BtreeCursor::read_ahead(Page *page)
+{
+  if (++m_leaf_transitions < kReadAheadThreshold)
+    return;
+
+  // |page| was one of the prefetched siblings
+  if (m_readahead_pages > 0)
+    m_readahead_pages--;
+
+  // prefetch the next batch before the previous one is used up; the
+  // siblings which were already prefetched are skipped
+  if (m_readahead_pages == 0
+      || (!m_readahead_exhausted && m_readahead_pages <= kReadAheadPages / 2)) {
+    ham_u32_t skip = m_readahead_pages;
+    ham_u32_t count = m_btree->prefetch_right_siblings(page, skip,
+                    kReadAheadPages);
+    m_readahead_exhausted = count < (ham_u32_t)kReadAheadPages;
+    m_readahead_pages = count;
+  }
+}
+
 ham_status_t
 BtreeCursor::move_previous(ham_u32_t flags)
 {
@@ -488,7 +519,9 @@ BtreeCursor::couple_to_page(Page *page, ham_u32_t index)
 
   m_coupled_page = page;
 
-  // add the cursor to the page
+  // add the cursor to the page; the list is shared with cursors of
+  // other threads
+  ScopedLock lock(m_btree->get_node_mutex());
   if (page->get_cursor_list()) {
     m_next_in_page = page->get_cursor_list();
     m_previous_in_page = 0;
@@ -502,6 +535,7 @@ BtreeCursor::remove_cursor_from_page(Page *page)
 {
   BtreeCursor *n, *p;
 
+  ScopedLock lock(m_btree->get_node_mutex());
   if (this == page->get_cursor_list()) {
     n = m_next_in_page;
     if (n)
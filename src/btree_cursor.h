@@ -65,6 +65,15 @@ class BtreeCursor
       kStateUncoupled = 2
     };
 
+    enum {
+      // read-ahead starts after this many consecutive moves to the
+      // right sibling (HAM_CURSOR_NEXT)
+      kReadAheadThreshold = 2,
+
+      // the number of sibling pages which are prefetched
+      kReadAheadPages = 16
+    };
+
     // Constructor
     BtreeCursor(Cursor *parent = 0);
 
@@ -197,6 +206,17 @@ class BtreeCursor
     // move cursor to the previous key
     ham_status_t move_previous(ham_u32_t flags);
 
+    // Called by move_next() after moving to the right sibling |page|;
+    // prefetches the next siblings if the cursor performs a sequential scan
+    void read_ahead(Page *page);
+
+    // Resets the read-ahead state
+    void reset_read_ahead() {
+      m_leaf_transitions = 0;
+      m_readahead_pages = 0;
+      m_readahead_exhausted = false;
+    }
+
     // the parent cursor
     Cursor *m_parent;
 
@@ -227,6 +247,15 @@ class BtreeCursor
 
     // Linked list of cursors which point to the same page
     BtreeCursor *m_next_in_page, *m_previous_in_page;
+
+    // number of consecutive moves to the right sibling
+    ham_u32_t m_leaf_transitions;
+
+    // number of prefetched siblings which were not yet visited
+    ham_u32_t m_readahead_pages;
+
+    // true if the parent node has no more siblings to prefetch
+    bool m_readahead_exhausted;
 };
 
 } // namespace hamsterdb
@@ -171,11 +171,18 @@ class BtreeEraseAction
       bool has_duplicates_left = false;
       if (node->is_leaf()) {
         // only delete a duplicate?
-        if (m_duplicate_index > 0)
+        if (m_duplicate_index > 0) {
           node->erase_record(slot, m_duplicate_index - 1, false,
                         &has_duplicates_left);
-        else
+          m_btree->adjust_key_count(has_duplicates_left ? 0 : -1, -1);
+        }
+        else {
+          ham_u32_t records = 1;
+          if (db->get_rt_flags() & HAM_ENABLE_DUPLICATE_KEYS)
+            records = node->get_record_count(slot);
           node->erase_record(slot, 0, true, 0);
+          m_btree->adjust_key_count(-1, -(ham_s64_t)records);
+        }
       }
 
       page->set_dirty(true);
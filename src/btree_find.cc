@@ -39,9 +39,10 @@ class BtreeFindAction
 {
   public:
     BtreeFindAction(BtreeIndex *btree, Transaction *txn, Cursor *cursor,
-        ham_key_t *key, ham_record_t *record, ham_u32_t flags)
+        ham_key_t *key, ham_record_t *record, ham_u32_t flags,
+        ham_u64_t *leaf_hint)
       : m_btree(btree), m_txn(txn), m_cursor(0), m_key(key),
-        m_record(record), m_flags(flags) {
+        m_record(record), m_flags(flags), m_leaf_hint(leaf_hint) {
       if (cursor && cursor->get_btree_cursor()->get_parent())
         m_cursor = cursor->get_btree_cursor();
     }
@@ -56,7 +57,28 @@ class BtreeFindAction
       BtreeStatistics *stats = m_btree->get_statistics();
       BtreeStatistics::FindHints hints = stats->get_find_hints(m_flags);
 
-      if (hints.try_fast_track) {
+      /*
+       * batch lookups with sorted keys (ham_db_find_many): if the key
+       * belongs to the leaf of the previous key then the tree is not
+       * traversed. Only exact matches are supported.
+       */
+      if (m_leaf_hint && *m_leaf_hint) {
+        ham_assert(!(m_flags & (HAM_FIND_LT_MATCH | HAM_FIND_GT_MATCH)));
+
+        page = m_btree->get_hinted_leaf(*m_leaf_hint, m_key,
+                        PageManager::kReadOnly);
+        if (page) {
+          BtreeIndex::ms_btree_batch_leaf_hits++;
+          slot = m_btree->find_leaf(page, m_key, hints.flags);
+          if (slot < 0) {
+            stats->find_failed();
+            return (HAM_KEY_NOT_FOUND);
+          }
+          node = m_btree->get_node_from_page(page);
+        }
+      }
+
+      if (slot == -1 && hints.try_fast_track) {
         /*
          * see if we get a sure hit within this btree leaf; if not, revert to
          * regular scan
@@ -123,6 +145,8 @@ class BtreeFindAction
 
         /* check the leaf page for the key */
         slot = m_btree->find_leaf(page, m_key, hints.flags);
+        if (m_leaf_hint)
+          *m_leaf_hint = page->get_address();
         if (slot < -1) {
           stats->find_failed();
           return (HAM_KEY_NOT_FOUND);
@@ -339,13 +363,16 @@ class BtreeFindAction
 
     // flags of ham_db_find()
     ham_u32_t m_flags;
+
+    // the leaf of the previous key of a batch; can be null
+    ham_u64_t *m_leaf_hint;
 };
 
 ham_status_t
 BtreeIndex::find(Transaction *txn, Cursor *cursor, ham_key_t *key,
-                ham_record_t *record, ham_u32_t flags)
+                ham_record_t *record, ham_u32_t flags, ham_u64_t *leaf_hint)
 {
-  BtreeFindAction bfa(this, txn, cursor, key, record, flags);
+  BtreeFindAction bfa(this, txn, cursor, key, record, flags, leaf_hint);
   return (bfa.run());
 }
 
@@ -39,7 +39,11 @@ struct BtreeKey
 
     // this key has no records attached (this flag is used if the key does
     // not have a separate "record counter" field
-    kHasNoRecords         = 0x08
+    kHasNoRecords         = 0x08,
+
+    // only the suffix of the key is stored; the prefix is shared by all
+    // keys of the node (HAM_COMPRESSOR_PREFIX)
+    kPrefixCompressed     = 0x80
   };
 
   // flags used with the ham_key_t::_flags (note the underscore - this
@@ -81,12 +81,26 @@
  *   Rec1|F1|Rec2|F2|...
  * where Recn is an 8 bytes record-ID (offset in the file) OR inline record,
  * and F1 is 1 byte for flags (kBlobSizeSmall etc).
+ *
+ * If the Database was created with prefix compression
+ * (HAM_PARAM_KEY_COMPRESSION = HAM_COMPRESSOR_PREFIX) then each leaf stores
+ * a key prefix at the end of the page:
+ *
+ * ...|Key1Rec1|Key2Rec2|...(space)...|Prefix|PrefixLength (2 bytes)|
+ *
+ * Keys starting with this prefix only store their suffix and have the
+ * flag |kPrefixCompressed|; all other keys are stored in full. The prefix
+ * is chosen whenever the keys of a node are rewritten, i.e. when a node is
+ * split or merged, or if a full node can avoid a split by choosing a
+ * better prefix. Keys are only moved to a blob if their suffix exceeds the
+ * threshold for extended keys.
  */
 
 #ifndef HAM_BTREE_IMPL_DEFAULT_H__
 #define HAM_BTREE_IMPL_DEFAULT_H__
 
 #include <algorithm>
+#include <functional>
 #include <vector>
 #include <map>
 
@@ -1073,7 +1087,13 @@ class DefaultNodeImpl
       kRearrangeThreshold = 5,
 
       // sizeof(ham_u64_t) + 1 (for flags)
-      kExtendedDuplicatesSize = 9
+      kExtendedDuplicatesSize = 9,
+
+      // for the length of the key prefix at the end of the page
+      kPrefixOverhead = 2,
+
+      // keys up to this size are decompressed on the stack
+      kKeyBufferSize = 512
     };
 
   public:
@@ -1084,7 +1104,9 @@ class DefaultNodeImpl
     DefaultNodeImpl(Page *page)
       : m_page(page), m_node(PBtreeNode::from_page(m_page)),
         m_records(this, m_page->get_db()->get_record_size()),
-        m_extkey_cache(0), m_duptable_cache(0), m_recalc_capacity(false) {
+        m_extkey_cache(0), m_duptable_cache(0), m_recalc_capacity(false),
+        m_use_prefix(m_node->is_leaf() && m_page->get_db()->get_key_compression()
+                        == HAM_COMPRESSOR_PREFIX) {
       initialize();
     }
 
@@ -1153,12 +1175,22 @@ class DefaultNodeImpl
           throw Exception(HAM_INTEGRITY_VIOLATED);
         }
 
-        if (it->get_key_size() > get_extended_threshold()
+        if (it->get_key_data_size() > get_extended_threshold()
             && !(it->get_key_flags() & BtreeKey::kExtendedKey)) {
           ham_log(("key size %d, but is not extended", it->get_key_size()));
           throw Exception(HAM_INTEGRITY_VIOLATED);
         }
 
+        if (it->get_key_flags() & BtreeKey::kPrefixCompressed) {
+          if (it->get_key_flags() & BtreeKey::kExtendedKey
+              || get_prefix_size() == 0
+              || it->get_key_size() <= get_prefix_size()) {
+            ham_log(("integrity check failed in page 0x%llx: item #%u "
+                    "has an invalid prefix", m_page->get_address(), i));
+            throw Exception(HAM_INTEGRITY_VIOLATED);
+          }
+        }
+
         if (it->get_key_flags() & BtreeKey::kInitialized) {
           ham_log(("integrity check failed in page 0x%llx: item #%u"
                   "is initialized (w/o record)", m_page->get_address(), i));
@@ -1206,6 +1238,16 @@ class DefaultNodeImpl
         get_extended_key(it->get_extended_blob_id(), &tmp);
         return (cmp(lhs->data, lhs->size, tmp.data, tmp.size));
       }
+      if (it->get_key_flags() & BtreeKey::kPrefixCompressed) {
+        ham_u8_t buffer[kKeyBufferSize];
+        ByteArray arena;
+        ham_u32_t size = it->get_key_size();
+        ham_u8_t *p = size <= sizeof(buffer)
+                        ? &buffer[0]
+                        : (ham_u8_t *)arena.resize(size);
+        copy_prefixed_key(it->get_slot(), p);
+        return (cmp(lhs->data, lhs->size, p, size));
+      }
       return (cmp(lhs->data, lhs->size, it->get_key_data(),
                               it->get_key_size()));
     }
@@ -1294,6 +1336,8 @@ class DefaultNodeImpl
         get_extended_key(it->get_extended_blob_id(), &tmp);
         memcpy(dest->data, tmp.data, tmp.size);
       }
+      else if (it->get_key_flags() & BtreeKey::kPrefixCompressed)
+        copy_prefixed_key(slot, (ham_u8_t *)dest->data);
       else
         memcpy(dest->data, it->get_key_data(), it->get_key_size());
 
@@ -1912,13 +1956,21 @@ class DefaultNodeImpl
       check_index_integrity(count);
 #endif
 
-      bool extended_key = key->size > get_extended_threshold();
+      // if the key starts with the node's prefix then only the suffix
+      // is stored
+      ham_u32_t prefix_size = get_prefix_size();
+      bool prefixed = prefix_size > 0
+                && key->size > prefix_size
+                && !memcmp(key->data, get_prefix_data(), prefix_size);
+      ham_u32_t data_size = prefixed ? key->size - prefix_size : key->size;
+
+      bool extended_key = data_size > get_extended_threshold();
 
       ham_u32_t offset = (ham_u32_t)-1;
 
       // search the freelist for free key space
       int idx = freelist_find(count,
-                      (extended_key ? sizeof(ham_u64_t) : key->size)
+                      (extended_key ? sizeof(ham_u64_t) : data_size)
                             + get_total_inline_record_size());
       // found: remove this freelist entry
       if (idx != -1) {
@@ -1928,7 +1980,7 @@ class DefaultNodeImpl
         // adjust the next key offset, if required
         if (get_next_offset() == offset + size)
           set_next_offset(offset
-                      + (extended_key ? sizeof(ham_u64_t) : key->size)
+                      + (extended_key ? sizeof(ham_u64_t) : data_size)
                       + get_total_inline_record_size());
       }
       // not found: append at the end
@@ -1943,7 +1995,7 @@ class DefaultNodeImpl
         // fit into the splitted page.
         if (!extended_key) {
           if (offset + m_layout.get_key_index_span() * get_capacity()
-              + key->size + get_total_inline_record_size()
+              + data_size + get_total_inline_record_size()
                   >= get_usable_page_size()) {
             extended_key = true;
             // check once more if the key fits
@@ -1955,14 +2007,14 @@ class DefaultNodeImpl
         }
 
         set_next_offset(offset
-                        + (extended_key ? sizeof(ham_u64_t) : key->size)
+                        + (extended_key ? sizeof(ham_u64_t) : data_size)
                         + get_total_inline_record_size());
       }
 
       // once more assert that the new key fits
       ham_assert(offset
               + m_layout.get_key_index_span() * get_capacity()
-              + (extended_key ? sizeof(ham_u64_t) : key->size)
+              + (extended_key ? sizeof(ham_u64_t) : data_size)
               + get_total_inline_record_size()
                   <= get_usable_page_size());
 
@@ -1988,6 +2040,11 @@ class DefaultNodeImpl
         it->set_key_flags(BtreeKey::kExtendedKey | BtreeKey::kInitialized);
         it->set_key_size(key->size);
       }
+      else if (prefixed) {
+        it->set_key_flags(BtreeKey::kInitialized | BtreeKey::kPrefixCompressed);
+        it->set_key_size(key->size);
+        it->set_key_data((ham_u8_t *)key->data + prefix_size, data_size);
+      }
       else {
         it->set_key_flags(BtreeKey::kInitialized);
         it->set_key_size(key->size);
@@ -2017,8 +2074,14 @@ class DefaultNodeImpl
         return (false);
 
       // shift data area to left or right to make more space
-      if (m_recalc_capacity)
-        return (resize(m_node->get_count() + 1, size));
+      if (m_recalc_capacity && !resize(m_node->get_count() + 1, size))
+        return (false);
+
+      // choose a better prefix for the keys of this node
+      if (m_use_prefix
+          && rewrite_prefix(m_node->get_count(), size)
+          && has_enough_space(size, true))
+        return (false);
 
       return (true);
     }
@@ -2054,6 +2117,30 @@ class DefaultNodeImpl
       if (other->get_capacity() <= (ham_u32_t)count)
         other->set_capacity(count + 1); // + 1 for the pivot key
 
+      // with prefix compression: the keys are re-encoded with a new prefix
+      // for each of both nodes
+      if (m_use_prefix) {
+        ByteArray keys;
+        ByteArray prefix;
+        export_keys(start, count, &keys);
+        choose_prefix(&keys, count,
+                        other->get_encoding_budget(other->get_capacity()), 0,
+                        &prefix);
+        other->set_prefix(prefix.get_ptr(), prefix.get_size());
+        other->import_keys(&keys, count, 0);
+
+        set_freelist_count(get_freelist_count() + count);
+        set_next_offset(calc_next_offset(pivot));
+        if (!rewrite_prefix(pivot, 0)
+            && get_freelist_count() > kRearrangeThreshold)
+          rearrange(pivot);
+#ifdef HAM_DEBUG
+        check_index_integrity(pivot);
+        other->check_index_integrity(count);
+#endif
+        return;
+      }
+
       // move |count| keys to the other node
       memcpy(other->m_layout.get_key_index_ptr(0),
                       m_layout.get_key_index_ptr(start),
@@ -2102,6 +2189,30 @@ class DefaultNodeImpl
 
       other->clear_caches();
 
+      // with prefix compression: rewrite this node with a prefix that fits
+      // the keys of both nodes
+      if (m_use_prefix) {
+        ByteArray keys;
+        ByteArray prefix;
+        export_keys(0, count, &keys);
+        other->export_keys(0, other_count, &keys);
+        choose_prefix(&keys, count + other_count,
+                        get_encoding_budget(get_capacity()), 0, &prefix);
+        clear_caches();
+        set_freelist_count(0);
+        set_next_offset(0);
+        set_prefix(prefix.get_ptr(), prefix.get_size());
+        ham_assert(count + other_count <= get_capacity());
+        import_keys(&keys, count + other_count, 0);
+
+        other->set_next_offset(0);
+        other->set_freelist_count(0);
+#ifdef HAM_DEBUG
+        check_index_integrity(count + other_count);
+#endif
+        return;
+      }
+
       // re-arrange the node: moves all keys sequentially to the beginning
       // of the key space, removes the whole freelist
       rearrange(m_node->get_count(), true);
@@ -2146,6 +2257,10 @@ class DefaultNodeImpl
       initialize();
     }
 
+    // Rebuilds the in-memory search index; this layout does not have one
+    void update_search_index() {
+    }
+
   private:
     friend class DefaultIterator<LayoutImpl, RecordList>;
     friend class FixedInlineRecordImpl<LayoutImpl>;
@@ -2161,6 +2276,10 @@ class DefaultNodeImpl
       m_layout.initialize(m_node->get_data() + kPayloadOffset, key_size);
 
       if (m_node->get_count() == 0 && !(db->get_rt_flags() & HAM_READ_ONLY)) {
+        // a new node does not yet have a key prefix
+        if (m_use_prefix)
+          set_prefix(0, 0);
+
         // ask the btree for the default capacity (it keeps track of the
         // average capacity of older pages).
         ham_u32_t capacity = db->get_btree_index()->get_statistics()->get_default_page_capacity();
@@ -2206,6 +2325,7 @@ class DefaultNodeImpl
     // Retrieves the extended key at |blobid| and stores it in |key|; will
     // use the cache.
     void get_extended_key(ham_u64_t blobid, ham_key_t *key) {
+      ScopedLock lock(m_cache_mutex);
       if (!m_extkey_cache)
         m_extkey_cache = new ExtKeyCache();
       else {
@@ -2231,6 +2351,7 @@ class DefaultNodeImpl
     // Retrieves the extended duplicate table at |tableid| and stores it the
     // cache; returns the ByteArray with the cached data
     ByteArray get_duplicate_table(ham_u64_t tableid) {
+      ScopedLock lock(m_cache_mutex);
       if (!m_duptable_cache)
         m_duptable_cache = new DupTableCache();
       else {
@@ -2263,7 +2384,7 @@ class DefaultNodeImpl
       rec.data = table->get_ptr();
       rec.size = table->get_size();
       ham_u64_t tableid = db->get_local_env()->get_blob_manager()->allocate(db,
-                                &rec, 0);
+                                &rec, BlobManager::kDisableCompression);
 
       (*m_duptable_cache)[tableid] = *table;
       table->disown();
@@ -2299,7 +2420,7 @@ class DefaultNodeImpl
       record.data = table->get_ptr();
       record.size = table->get_size();
       ham_u64_t newid = db->get_local_env()->get_blob_manager()->overwrite(db,
-                      tableid, &record, 0);
+                      tableid, &record, BlobManager::kDisableCompression);
       if (tableid != newid) {
         DupTableCache::iterator it = m_duptable_cache->find(tableid);
         ham_assert(it != m_duptable_cache->end());
@@ -2364,7 +2485,7 @@ class DefaultNodeImpl
 
       LocalDatabase *db = m_page->get_db();
       ham_u64_t blobid = db->get_local_env()->get_blob_manager()->allocate(db,
-                            &rec, 0);
+                            &rec, BlobManager::kDisableCompression);
       ham_assert(blobid != 0);
       ham_assert(m_extkey_cache->find(blobid) == m_extkey_cache->end());
 
@@ -2402,18 +2523,17 @@ class DefaultNodeImpl
 
     // Returns the size of the memory occupied by the key
     ham_u32_t get_key_data_size(ham_u32_t slot) const {
-      if (m_layout.get_key_flags(slot) & BtreeKey::kExtendedKey)
+      ham_u32_t flags = m_layout.get_key_flags(slot);
+      if (flags & BtreeKey::kExtendedKey)
         return (sizeof(ham_u64_t));
+      if (flags & BtreeKey::kPrefixCompressed)
+        return (m_layout.get_key_size(slot) - get_prefix_size());
       return (m_layout.get_key_size(slot));
     }
 
     // Returns the total size of the key  - key data + record(s)
     ham_u32_t get_total_key_data_size(ham_u32_t slot) const {
-      ham_u32_t size;
-      if (m_layout.get_key_flags(slot) & BtreeKey::kExtendedKey)
-        size = sizeof(ham_u64_t);
-      else
-        size = m_layout.get_key_size(slot);
+      ham_u32_t size = get_key_data_size(slot);
       if (m_layout.get_key_flags(slot) & BtreeKey::kExtendedDuplicates)
         return (size + kExtendedDuplicatesSize);
       else
@@ -2917,11 +3037,349 @@ class DefaultNodeImpl
     // Returns the usable page size that can be used for actually
     // storing the data
     ham_u32_t get_usable_page_size() const {
+      ham_u32_t size = get_total_page_size();
+      if (m_use_prefix)
+        size -= kPrefixOverhead + get_prefix_size();
+      return (size);
+    }
+
+    // Returns the page size available to this node, including the space
+    // for the key prefix
+    ham_u32_t get_total_page_size() const {
       return (m_page->get_db()->get_local_env()->get_usable_page_size()
                     - kPayloadOffset
                     - PBtreeNode::get_entry_offset());
     }
 
+    // Returns a pointer to the length of the key prefix at the end
+    // of the page
+    ham_u8_t *get_prefix_size_ptr() const {
+      return (m_node->get_data() + kPayloadOffset + get_total_page_size()
+                    - kPrefixOverhead);
+    }
+
+    // Returns the size of the key prefix, or 0 if there is none
+    ham_u32_t get_prefix_size() const {
+      if (!m_use_prefix)
+        return (0);
+      return (ham_db2h16(*(ham_u16_t *)get_prefix_size_ptr()));
+    }
+
+    // Returns a pointer to the key prefix
+    ham_u8_t *get_prefix_data() const {
+      return (get_prefix_size_ptr() - get_prefix_size());
+    }
+
+    // Stores a new key prefix. Only allowed if the key space is empty, or
+    // after the keys were exported.
+    void set_prefix(const void *data, ham_u32_t size) {
+      ham_assert(m_use_prefix);
+      ham_u8_t *p = get_prefix_size_ptr();
+      if (size)
+        memmove(p - size, data, size);
+      *(ham_u16_t *)p = ham_h2db16((ham_u16_t)size);
+    }
+
+    // Copies the (full) key at |slot| to |buffer|, which must be large
+    // enough. Only for keys with the flag kPrefixCompressed!
+    void copy_prefixed_key(ham_u32_t slot, ham_u8_t *buffer) const {
+      ham_u32_t prefix_size = get_prefix_size();
+      memcpy(buffer, get_prefix_data(), prefix_size);
+      memcpy(buffer + prefix_size, get_key_data(slot),
+                      m_layout.get_key_size(slot) - prefix_size);
+    }
+
+    // Copies |count| keys (starting at |start|) and their records to
+    // |arena|, in a format which does not depend on the key prefix of
+    // this node. Each key is serialized as
+    //   flags (1 byte)|index entry|key size (4 bytes)|blob id|key|
+    //        record size (4 bytes)|records
+    // where |key| is always the full key. The blob id (8 bytes) is only
+    // stored for extended keys.
+    void export_keys(ham_u32_t start, ham_u32_t count, ByteArray *arena) {
+      LocalDatabase *db = m_page->get_db();
+      ham_u32_t span = m_layout.get_key_index_span();
+      ByteArray tmp;
+      for (ham_u32_t slot = start; slot < start + count; slot++) {
+        ham_u8_t flags = m_layout.get_key_flags(slot);
+        ham_u32_t key_size = m_layout.get_key_size(slot);
+        ham_u32_t rec_size = get_record_data_size(slot);
+
+        arena->append(&flags, 1);
+        arena->append(m_layout.get_key_index_ptr(slot), span);
+        arena->append(&key_size, sizeof(key_size));
+        if (flags & BtreeKey::kExtendedKey) {
+          // do NOT use the cache - the key might be moved to a
+          // different page
+          ham_u64_t blobid = ham_db2h_offset(*(ham_u64_t *)get_key_data(slot));
+          ham_record_t record = {0};
+          db->get_local_env()->get_blob_manager()->read(db, blobid, &record,
+                          0, &tmp);
+          ham_assert(record.size == key_size);
+          arena->append(&blobid, sizeof(blobid));
+          arena->append(record.data, record.size);
+        }
+        else if (flags & BtreeKey::kPrefixCompressed) {
+          arena->append(get_prefix_data(), get_prefix_size());
+          arena->append(get_key_data(slot), get_key_data_size(slot));
+        }
+        else
+          arena->append(get_key_data(slot), key_size);
+        arena->append(&rec_size, sizeof(rec_size));
+        arena->append(get_key_data(slot) + get_key_data_size(slot), rec_size);
+      }
+    }
+
+    // Deserializes a key which was serialized by export_keys(); returns
+    // a pointer to the next key
+    const ham_u8_t *read_exported_key(const ham_u8_t *p, ham_u8_t *flags,
+                    const ham_u8_t **index, ham_u64_t *blobid,
+                    const ham_u8_t **key, ham_u32_t *key_size,
+                    const ham_u8_t **record, ham_u32_t *rec_size) const {
+      *flags = *p;
+      p += 1;
+      *index = p;
+      p += m_layout.get_key_index_span();
+      memcpy(key_size, p, sizeof(ham_u32_t));
+      p += sizeof(ham_u32_t);
+      *blobid = 0;
+      if (*flags & BtreeKey::kExtendedKey) {
+        memcpy(blobid, p, sizeof(ham_u64_t));
+        p += sizeof(ham_u64_t);
+      }
+      *key = p;
+      p += *key_size;
+      memcpy(rec_size, p, sizeof(ham_u32_t));
+      p += sizeof(ham_u32_t);
+      *record = p;
+      return (p + *rec_size);
+    }
+
+    // Returns the number of bytes required for storing the exported keys
+    // and their records with the given prefix, including the prefix itself.
+    // If |blob_size| is not null then it receives the size of those keys
+    // which are too long and have to be stored in a blob.
+    ham_u32_t get_encoded_size(ByteArray *arena, ham_u32_t count,
+                    const ham_u8_t *prefix, ham_u32_t prefix_size,
+                    ham_u32_t *blob_size = 0) const {
+      ham_u32_t total = prefix_size;
+      if (blob_size)
+        *blob_size = 0;
+      const ham_u8_t *p = (const ham_u8_t *)arena->get_ptr();
+      for (ham_u32_t i = 0; i < count; i++) {
+        ham_u8_t flags;
+        const ham_u8_t *index, *key, *record;
+        ham_u32_t key_size, rec_size;
+        ham_u64_t blobid;
+        p = read_exported_key(p, &flags, &index, &blobid, &key, &key_size,
+                        &record, &rec_size);
+        ham_u32_t data_size = key_size;
+        if (prefix_size > 0
+            && key_size > prefix_size
+            && !memcmp(key, prefix, prefix_size))
+          data_size -= prefix_size;
+        // keys which are too long are moved to a blob
+        if (data_size > get_extended_threshold()) {
+          data_size = sizeof(ham_u64_t);
+          if (blob_size)
+            *blob_size += key_size;
+        }
+        total += data_size + rec_size;
+      }
+      return (total);
+    }
+
+    // Returns the number of bytes which are available for the prefix, the
+    // keys and the records of a node with the given index |capacity|
+    ham_u32_t get_encoding_budget(ham_u32_t capacity) const {
+      ham_u32_t overhead = kPrefixOverhead
+                + m_layout.get_key_index_span() * capacity;
+      ham_u32_t total = get_total_page_size();
+      return (total > overhead ? total - overhead : 0);
+    }
+
+    // Chooses the prefix for the exported keys in |arena| which requires
+    // the least storage (in the node and in blobs for extended keys), but
+    // still leaves |reserve| bytes of the |budget|. Candidates are no
+    // prefix, the current prefix of this node, the common prefix of all
+    // keys and the prefix of the median key which is shared by most of the
+    // other keys. Falls back to the current prefix if no candidate fits;
+    // the current prefix reproduces the current encoding of the keys.
+    void choose_prefix(ByteArray *arena, ham_u32_t count, ham_u32_t budget,
+                    ham_u32_t reserve, ByteArray *prefix) {
+      typedef std::vector<std::pair<const ham_u8_t *, ham_u32_t> > KeyVec;
+      KeyVec keys;
+      keys.reserve(count);
+      const ham_u8_t *p = (const ham_u8_t *)arena->get_ptr();
+      for (ham_u32_t i = 0; i < count; i++) {
+        ham_u8_t flags;
+        const ham_u8_t *index, *key, *record;
+        ham_u32_t key_size, rec_size;
+        ham_u64_t blobid;
+        p = read_exported_key(p, &flags, &index, &blobid, &key, &key_size,
+                        &record, &rec_size);
+        keys.push_back(std::make_pair(key, key_size));
+      }
+
+      prefix->clear();
+      if (keys.size() < 2) {
+        prefix->append(get_prefix_data(), get_prefix_size());
+        return;
+      }
+
+      // the prefix length is limited; this makes sure that prefix and
+      // suffix of inline keys can be decompressed on the stack
+      ham_u32_t max_size = std::min(get_extended_threshold(),
+                      (ham_u32_t)kKeyBufferSize / 2);
+
+      // the length of the common prefix of each key and the median key
+      const ham_u8_t *median = keys[keys.size() / 2].first;
+      ham_u32_t median_size = std::min(keys[keys.size() / 2].second, max_size);
+      std::vector<ham_u32_t> lengths;
+      lengths.reserve(keys.size());
+      ham_u32_t common = median_size;
+      for (KeyVec::iterator it = keys.begin(); it != keys.end(); it++) {
+        ham_u32_t l = 0;
+        ham_u32_t max = std::min(median_size, it->second);
+        while (l < max && it->first[l] == median[l])
+          l++;
+        lengths.push_back(l);
+        common = std::min(common, l);
+      }
+
+      // if the prefix has length |lengths[i]| then at least |i + 1| keys
+      // share it; pick the length with the highest savings
+      std::sort(lengths.begin(), lengths.end(), std::greater<ham_u32_t>());
+      ham_u32_t best = 0;
+      ham_u64_t best_savings = 0;
+      for (ham_u32_t i = 0; i < lengths.size(); i++) {
+        ham_u64_t savings = (ham_u64_t)lengths[i] * i;
+        if (savings > best_savings) {
+          best_savings = savings;
+          best = lengths[i];
+        }
+      }
+
+      // now compare the exact costs of all candidates
+      ham_u32_t candidates[4] = {0, get_prefix_size(), best, common};
+      const ham_u8_t *candidate_data[4] = {0, get_prefix_data(),
+                      median, median};
+      int winner = 1;
+      ham_u64_t winner_cost = 0;
+      for (int i = 0; i < 4; i++) {
+        if (candidates[i] > max_size || (i > 1 && candidates[i] == 0))
+          continue;
+        ham_u32_t blob_size;
+        ham_u32_t size = get_encoded_size(arena, count, candidate_data[i],
+                                candidates[i], &blob_size);
+        if (size + reserve > budget)
+          continue;
+        ham_u64_t cost = (ham_u64_t)size + blob_size;
+        if (winner_cost == 0 || cost < winner_cost) {
+          winner = i;
+          winner_cost = cost;
+        }
+      }
+
+      prefix->append(candidate_data[winner], candidates[winner]);
+    }
+
+    // Appends the exported keys in |arena| to this node, starting at
+    // |slot|; the keys are compressed with the current prefix of this node.
+    // Extended keys which now fit into the node are moved out of their
+    // blob.
+    void import_keys(ByteArray *arena, ham_u32_t count, ham_u32_t slot) {
+      ham_u32_t prefix_size = get_prefix_size();
+      const ham_u8_t *prefix = get_prefix_data();
+      const ham_u8_t *p = (const ham_u8_t *)arena->get_ptr();
+
+      for (ham_u32_t i = 0; i < count; i++, slot++) {
+        ham_u8_t flags;
+        const ham_u8_t *index, *key, *record;
+        ham_u32_t key_size, rec_size;
+        ham_u64_t blobid;
+        p = read_exported_key(p, &flags, &index, &blobid, &key, &key_size,
+                        &record, &rec_size);
+
+        memcpy(m_layout.get_key_index_ptr(slot), index,
+                        m_layout.get_key_index_span());
+        flags &= ~(BtreeKey::kPrefixCompressed | BtreeKey::kExtendedKey);
+
+        const ham_u8_t *data = key;
+        ham_u32_t data_size = key_size;
+        if (prefix_size > 0
+            && key_size > prefix_size
+            && !memcmp(key, prefix, prefix_size)) {
+          data += prefix_size;
+          data_size -= prefix_size;
+          flags |= BtreeKey::kPrefixCompressed;
+        }
+
+        // the key is too long for an inline key: move it to a blob (or
+        // re-use the blob if it already was an extended key)
+        ham_u64_t stored_id;
+        if (data_size > get_extended_threshold()) {
+          if (!blobid) {
+            ham_key_t tmp = {0};
+            tmp.data = (void *)key;
+            tmp.size = (ham_u16_t)key_size;
+            blobid = add_extended_key(&tmp);
+          }
+          stored_id = ham_h2db_offset(blobid);
+          data = (const ham_u8_t *)&stored_id;
+          data_size = sizeof(ham_u64_t);
+          flags &= ~BtreeKey::kPrefixCompressed;
+          flags |= BtreeKey::kExtendedKey;
+        }
+        else if (blobid)
+          erase_extended_key(blobid);
+
+        ham_u32_t offset = allocate(slot, data_size + rec_size, false);
+        ham_assert(offset + data_size + rec_size
+                + m_layout.get_key_index_span() * get_capacity()
+                    <= get_usable_page_size());
+        m_layout.set_key_data_offset(slot, offset);
+        m_layout.set_key_flags(slot, flags);
+        ham_u8_t *dest = get_key_data(slot);
+        memcpy(dest, data, data_size);
+        memcpy(dest + data_size, record, rec_size);
+      }
+    }
+
+    // Rewrites the first |count| keys of this node with a new prefix, but
+    // only if this reduces the storage and leaves at least |min_gain| bytes
+    // for new keys. Also removes the freelist. Returns true if the node
+    // was rewritten.
+    bool rewrite_prefix(ham_u32_t count, ham_u32_t min_gain) {
+      if (count < 2)
+        return (false);
+
+      ByteArray keys;
+      ByteArray prefix;
+      export_keys(0, count, &keys);
+      choose_prefix(&keys, count, get_encoding_budget(get_capacity()),
+                      min_gain, &prefix);
+
+      ham_u32_t old_blob_size, new_blob_size;
+      ham_u32_t old_size = get_encoded_size(&keys, count, get_prefix_data(),
+                                get_prefix_size(), &old_blob_size);
+      ham_u32_t new_size = get_encoded_size(&keys, count,
+                                (const ham_u8_t *)prefix.get_ptr(),
+                                prefix.get_size(), &new_blob_size);
+      if ((ham_u64_t)new_size + new_blob_size
+              >= (ham_u64_t)old_size + old_blob_size)
+        return (false);
+
+      set_freelist_count(0);
+      set_next_offset(0);
+      set_prefix(prefix.get_ptr(), prefix.get_size());
+      import_keys(&keys, count, 0);
+#ifdef HAM_DEBUG
+      check_index_integrity(count);
+#endif
+      return (true);
+    }
+
     // The page that we're operating on
     Page *m_page;
 
@@ -2943,8 +3401,14 @@ class DefaultNodeImpl
     // Cache for external duplicate tables
     DupTableCache *m_duptable_cache;
 
+    // Protects both caches; they are filled by concurrent readers
+    Mutex m_cache_mutex;
+
     // Allow the capacity to be recalculated later on
     bool m_recalc_capacity;
+
+    // True if the keys of this node are prefix compressed
+    bool m_use_prefix;
 };
 
 } // namespace hamsterdb
@@ -61,6 +61,7 @@
 #include "util.h"
 #include "page.h"
 #include "btree_node.h"
+#include "btree_search.h"
 #include "blob_manager.h"
 #include "env_local.h"
 
@@ -69,6 +70,9 @@ namespace hamsterdb {
 template<typename KeyList, typename RecordList>
 class PaxNodeImpl;
 
+template<typename T>
+struct NumericCompare;
+
 //
 // An iterator for the PaxNodeImpl class. It offers simple access to a single
 // key ("slot") in the node, and can move forward to the next key.
@@ -241,6 +245,10 @@ struct PaxIterator
 template<typename T>
 class PodKeyList
 {
+  // internal nodes with less keys are searched without the
+  // EytzingerIndex
+  enum { kMinIndexedKeys = 128 };
+
   public:
     // Constructor
     PodKeyList(LocalDatabase *db, ham_u8_t *data)
@@ -269,9 +277,47 @@ class PodKeyList
       m_data[slot] = *(T *)ptr;
     }
 
+    // Searches the sorted list of |count| keys for |key|; the keys are
+    // compared with SIMD instructions or with the EytzingerIndex, see
+    // btree_search.h. Stores the slot in |*pslot| and the result of the
+    // last comparison in |*pcmp|.
+    // This overload is only picked for the default numeric comparator.
+    bool find(ham_u32_t count, const ham_key_t *key, NumericCompare<T> &,
+                    int *pslot, int *pcmp) {
+      ham_assert(key->size == sizeof(T));
+      if (m_index.get_count() > 0) {
+        ham_assert(m_index.get_count() == (int)count);
+        *pslot = m_index.find(m_data, *(T *)key->data, pcmp);
+      }
+      else
+        *pslot = find_numeric_key<T>(m_data, (int)count, *(T *)key->data,
+                        pcmp);
+      return (true);
+    }
+
+    // Rebuilds the search index for |count| keys; only internal nodes are
+    // indexed (|count| is 0 for leaf nodes)
+    void update_search_index(ham_u32_t count) {
+      if (count >= kMinIndexedKeys)
+        m_index.build(m_data, (int)count);
+      else if (m_index.get_count() > 0)
+        m_index.clear();
+    }
+
+    // All other comparators (i.e. for record numbers or user-defined
+    // callbacks) use the generic binary search in the PaxNodeImpl
+    template<typename Cmp>
+    bool find(ham_u32_t count, const ham_key_t *key, Cmp &, int *pslot,
+                    int *pcmp) {
+      return (false);
+    }
+
   private:
     // The actual array of T's
     T *m_data;
+
+    // The in-memory search index for internal nodes
+    EytzingerIndex<T> m_index;
 };
 
 //
@@ -309,6 +355,17 @@ class BinaryKeyList
       memcpy(&m_data[slot * m_key_size], ptr, size);
     }
 
+    // Binary keys are always searched with the generic binary search
+    template<typename Cmp>
+    bool find(ham_u32_t count, const ham_key_t *key, Cmp &, int *pslot,
+                    int *pcmp) {
+      return (false);
+    }
+
+    // Binary keys do not have a search index
+    void update_search_index(ham_u32_t count) {
+    }
+
   private:
     // The size of a single key
     ham_u32_t m_key_size;
@@ -638,6 +695,8 @@ class PaxNodeImpl
         m_flags = &p[m_capacity * get_key_size()];
         m_records.set_data_pointer(&p[m_capacity * (1 + get_key_size())]);
       }
+
+      update_search_index();
     }
 
     // Returns the actual key size (including overhead, without record)
@@ -684,6 +743,13 @@ class PaxNodeImpl
 
       ham_assert(count > 0);
 
+      /* numeric keys are searched with a vectorized search */
+      if (m_keys.find(count, key, comparator, &ret, &cmp)) {
+        if (pcmp)
+          *pcmp = cmp;
+        return (ret);
+      }
+
       /* only one element in this node? */
       if (r == 0) {
         cmp = compare(key, at(0), comparator);
@@ -993,6 +1059,16 @@ class PaxNodeImpl
       return (it->get_record_count());
     }
 
+    // Rebuilds the in-memory search index of an internal node; called
+    // whenever the keys were modified
+    void update_search_index() {
+      ham_u32_t count = m_node->get_count();
+      // a freshly allocated page is not yet initialized
+      if (m_node->is_leaf() || count > m_capacity)
+        count = 0;
+      m_keys.update_search_index(count);
+    }
+
     // Clears the page with zeroes and reinitializes it
     void test_clear_page() {
       // this is not yet in use
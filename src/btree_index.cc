@@ -35,6 +35,7 @@ namespace hamsterdb {
 ham_u64_t BtreeIndex::ms_btree_smo_split = 0;
 ham_u64_t BtreeIndex::ms_btree_smo_merge = 0;
 ham_u64_t BtreeIndex::ms_btree_smo_shift = 0;
+ham_u64_t BtreeIndex::ms_btree_batch_leaf_hits = 0;
 ham_u32_t g_extended_threshold = 0;
 ham_u32_t g_duplicate_threshold = 0;
 ham_u64_t g_extended_keys = 0;
@@ -43,7 +44,8 @@ ham_u64_t g_extended_duptables = 0;
 BtreeIndex::BtreeIndex(LocalDatabase *db, ham_u32_t descriptor, ham_u32_t flags,
                 ham_u32_t key_type, ham_u32_t key_size)
   : m_db(db), m_key_size(0), m_key_type(key_type), m_rec_size(0),
-    m_descriptor_index(descriptor), m_flags(flags), m_root_address(0)
+    m_descriptor_index(descriptor), m_flags(flags), m_root_address(0),
+    m_key_count(0), m_record_count(0)
 {
   m_leaf_traits = BtreeIndexFactory::create(db, flags, key_type,
                   key_size, true);
@@ -96,6 +98,8 @@ BtreeIndex::open()
   m_key_type = key_type;
   m_flags = flags;
   m_rec_size = rec_size;
+  m_key_count = desc->get_key_count();
+  m_record_count = desc->get_record_count();
 }
 
 void
@@ -114,10 +118,31 @@ BtreeIndex::flush_descriptor()
   desc->set_key_type(get_key_type());
   desc->set_root_address(get_root_address());
   desc->set_flags(get_flags());
+  desc->set_key_count(m_key_count);
+  desc->set_record_count(m_record_count);
 
   env->mark_header_page_dirty();
 }
 
+void
+BtreeIndex::adjust_key_count(ham_s64_t keys, ham_s64_t records)
+{
+  m_key_count += keys;
+  m_record_count += records;
+
+  LocalEnvironment *env = m_db->get_local_env();
+  PBtreeHeader *desc = env->get_btree_descriptor(m_descriptor_index);
+  desc->set_key_count(m_key_count);
+  desc->set_record_count(m_record_count);
+
+  // The header page is NOT added to the Changeset; otherwise each
+  // operation would modify (at least) two index pages, and the Changeset
+  // would always have to be logged. The header page is written when the
+  // Environment is flushed or closed, and the counters are rebuilt
+  // after a recovery.
+  env->get_header()->get_header_page()->set_dirty(true);
+}
+
 Page *
 BtreeIndex::find_internal(Page *page, ham_key_t *key, ham_s32_t *idxptr)
 {
@@ -381,6 +406,29 @@ BtreeIndex::find_leaf(Page *page, ham_key_t *key, ham_u32_t flags)
   return (slot);
 }
 
+Page *
+BtreeIndex::get_hinted_leaf(ham_u64_t address, ham_key_t *key,
+                ham_u32_t fetch_flags)
+{
+  Page *page = m_db->get_local_env()->get_page_manager()->fetch_page(m_db,
+                  address, fetch_flags | PageManager::kOnlyFromCache);
+  if (!page || page->get_db() != m_db
+      || (page->get_type() != Page::kTypeBindex
+          && page->get_type() != Page::kTypeBroot))
+    return (0);
+
+  BtreeNodeProxy *node = get_node_from_page(page);
+  if (!node->is_leaf() || node->get_count() == 0)
+    return (0);
+
+  if (node->get_left() && node->compare(key, 0) < 0)
+    return (0);
+  if (node->get_right() && node->compare(key, node->get_count() - 1) > 0)
+    return (0);
+
+  return (page);
+}
+
 ham_u32_t
 BtreeIndex::get_max_keys_per_page() const
 {
@@ -411,41 +459,107 @@ BtreeIndex::get_max_keys_per_page() const
 class CalcKeysVisitor : public BtreeVisitor {
   public:
     CalcKeysVisitor(LocalDatabase *db, ham_u32_t flags)
-      : m_db(db), m_flags(flags), m_count(0) {
+      : m_db(db), m_flags(flags), m_count(0), m_record_count(0) {
     }
 
     virtual bool operator()(BtreeNodeProxy *node, const void *key_data,
                   ham_u8_t key_flags, ham_u32_t key_size, 
                   ham_u64_t record_id) {
       ham_u32_t count = node->get_count();
+      m_count += count;
 
       if (m_flags & HAM_SKIP_DUPLICATES
           || (m_db->get_rt_flags() & HAM_ENABLE_DUPLICATE_KEYS) == 0) {
-        m_count += count;
+        m_record_count += count;
         return (false);
       }
 
       for (ham_u32_t i = 0; i < count; i++)
-        m_count += node->get_record_count(i);
+        m_record_count += node->get_record_count(i);
       return (false);
     }
 
+    // Returns the number of keys (without duplicates)
     ham_u64_t get_key_count() const {
       return (m_count);
     }
 
+    // Returns the number of records (= keys including their duplicates);
+    // only valid if HAM_SKIP_DUPLICATES was not specified
+    ham_u64_t get_record_count() const {
+      return (m_record_count);
+    }
+
   private:
     LocalDatabase *m_db;
     ham_u32_t m_flags;
     ham_u64_t m_count;
+    ham_u64_t m_record_count;
 };
 
 ham_u64_t
 BtreeIndex::get_key_count(ham_u32_t flags)
 {
-  CalcKeysVisitor visitor(m_db, flags);
+  if (flags & HAM_KEY_COUNT_FULL_SCAN) {
+    CalcKeysVisitor visitor(m_db, flags);
+    enumerate(visitor);
+    return (flags & HAM_SKIP_DUPLICATES
+              ? visitor.get_key_count()
+              : visitor.get_record_count());
+  }
+
+  if (flags & HAM_SKIP_DUPLICATES)
+    return (m_key_count);
+  return (m_record_count);
+}
+
+void
+BtreeIndex::recount_keys()
+{
+  CalcKeysVisitor visitor(m_db, 0);
   enumerate(visitor);
-  return (visitor.get_key_count());
+
+  m_key_count = visitor.get_key_count();
+  m_record_count = visitor.get_record_count();
+  flush_descriptor();
+}
+
+ham_u32_t
+BtreeIndex::prefetch_right_siblings(Page *page, ham_u32_t skip,
+                ham_u32_t count)
+{
+  BtreeNodeProxy *node = get_node_from_page(page);
+  ham_assert(node->is_leaf());
+  if (node->get_count() == 0 || page->get_address() == m_root_address)
+    return (0);
+
+  // the leaf has no link to its parent; descend with the leaf's first key
+  ByteArray arena;
+  ham_key_t key = {0};
+  node->get_key(0, &arena, &key);
+
+  Page *parent = m_db->get_local_env()->get_page_manager()->fetch_page(m_db,
+                  m_root_address);
+  ham_s32_t slot = -1;
+  while (true) {
+    Page *child = find_internal(parent, &key, &slot);
+    if (child == page)
+      break;
+    if (get_node_from_page(child)->is_leaf())
+      return (0);
+    parent = child;
+  }
+
+  BtreeNodeProxy *pnode = get_node_from_page(parent);
+  ham_u32_t available = pnode->get_count() - (slot + 1);
+  if (count > available)
+    count = available;
+
+  // slot -1 is the ptr_down child; its right sibling is in slot 0
+  PageManager *pm = m_db->get_local_env()->get_page_manager();
+  for (ham_u32_t i = skip; i < count; i++)
+    pm->prefetch_page(pnode->get_record_id(slot + 1 + i));
+  return (count);
 }
 
 //
@@ -122,6 +122,36 @@ HAM_PACK_0 class HAM_PACK_1 PBtreeHeader
       m_record_compression = (algorithm << 4) | level;
     }
 
+    // Returns the key compression
+    ham_u8_t get_key_compression() const {
+      return (m_key_compression);
+    }
+
+    // Sets the key compression
+    void set_key_compression(int algorithm) {
+      m_key_compression = (ham_u8_t)algorithm;
+    }
+
+    // Returns the number of keys (without duplicates)
+    ham_u64_t get_key_count() const {
+      return (ham_db2h64(m_key_count));
+    }
+
+    // Sets the number of keys (without duplicates)
+    void set_key_count(ham_u64_t count) {
+      m_key_count = ham_h2db64(count);
+    }
+
+    // Returns the number of records (= keys including their duplicates)
+    ham_u64_t get_record_count() const {
+      return (ham_db2h64(m_record_count));
+    }
+
+    // Sets the number of records
+    void set_record_count(ham_u64_t count) {
+      m_record_count = ham_h2db64(count);
+    }
+
   private:
     // address of the root-page
     ham_u64_t m_root_address;
@@ -141,12 +171,19 @@ HAM_PACK_0 class HAM_PACK_1 PBtreeHeader
     // PRO: for storing record compression algorithm and level */
     ham_u8_t m_record_compression;
 
-    // reserved for padding
-    ham_u8_t m_padding1;
+    // the key compression algorithm (HAM_COMPRESSOR_PREFIX); older files
+    // stored a zero padding byte here
+    ham_u8_t m_key_compression;
 
     // the record size
     ham_u32_t m_rec_size;
 
+    // the number of keys (without duplicates)
+    ham_u64_t m_key_count;
+
+    // the number of records (= keys including their duplicates)
+    ham_u64_t m_record_count;
+
 } HAM_PACK_2;
 
 #include "packstop.h"
@@ -263,13 +300,19 @@ class BtreeIndex
     // and the file was opened
     void open();
 
-    // Lookup a key in the index (ham_db_find)
+    // Lookup a key in the index (ham_db_find).
+    // |leaf_hint| is used by batches with sorted keys (ham_db_find_many):
+    // if it points to the address of a leaf which covers |key| then the
+    // tree is not traversed. Afterwards it stores the leaf of |key|.
     ham_status_t find(Transaction *txn, Cursor *cursor,
-            ham_key_t *key, ham_record_t *record, ham_u32_t flags);
+            ham_key_t *key, ham_record_t *record, ham_u32_t flags,
+            ham_u64_t *leaf_hint = 0);
 
-    // Inserts (or updates) a key/record in the index (ham_db_insert)
+    // Inserts (or updates) a key/record in the index (ham_db_insert);
+    // |leaf_hint| is used like in find() (ham_db_insert_many)
     ham_status_t insert(Transaction *txn, Cursor *cursor, ham_key_t *key,
-            ham_record_t *record, ham_u32_t flags);
+            ham_record_t *record, ham_u32_t flags,
+            ham_u64_t *leaf_hint = 0);
 
     // Erases a key/record from the index (ham_db_erase).
     // If |duplicate| is 0 then all duplicates are erased, otherwise only
@@ -277,6 +320,15 @@ class BtreeIndex
     ham_status_t erase(Transaction *txn, Cursor *cursor, ham_key_t *key,
             ham_u32_t duplicate, ham_u32_t flags);
 
+    // Appends the sorted items |keys[order[0]]| ... |keys[order[count - 1]]|
+    // (ham_db_bulk_insert); the nodes are created bottom-up, and filled
+    // with |fill_factor| percent of their capacity. Returns false (without
+    // modifying the btree) if the keys are not greater than the existing
+    // keys.
+    bool bulk_load(ham_key_t *keys, ham_record_t *records,
+            const ham_u32_t *order, ham_u32_t count, ham_u32_t fill_factor,
+            ham_u32_t flags);
+
     // Iterates over the whole index and enumerate every item
     void enumerate(BtreeVisitor &visitor,
                     bool visit_internal_nodes = false);
@@ -284,9 +336,24 @@ class BtreeIndex
     // Checks the integrity of the btree (ham_db_check_integrity)
     void check_integrity(ham_u32_t flags);
 
-    // Counts the keys in the btree (ham_db_get_key_count)
+    // Returns the number of keys in the btree (ham_db_get_key_count);
+    // the persistent counters are returned unless |flags| contains
+    // HAM_KEY_COUNT_FULL_SCAN, which counts the keys with a full scan
     ham_u64_t get_key_count(ham_u32_t flags);
 
+    // Counts the keys with a full scan and stores the result in the
+    // persistent counters; used after recovery
+    void recount_keys();
+
+    // Read-ahead for sequential scans: prefetches up to |count| right
+    // siblings of the leaf |page|, skipping the first |skip| of them. The
+    // addresses are taken from the parent node, therefore only siblings
+    // with the same parent are prefetched. Returns the number of siblings
+    // which are available in the parent (including the skipped ones),
+    // but not more than |count|.
+    ham_u32_t prefetch_right_siblings(Page *page, ham_u32_t skip,
+                    ham_u32_t count);
+
     // Erases all records, overflow areas, extended keys etc from the index;
     // used to avoid memory leaks when closing in-memory Databases and to
     // clean up when deleting on-disk Databases.
@@ -305,6 +372,11 @@ class BtreeIndex
       if (page->get_node_proxy())
         return (page->get_node_proxy());
 
+      // concurrent readers can race to create the proxy for the same page
+      ScopedLock lock(m_node_mutex);
+      if (page->get_node_proxy())
+        return (page->get_node_proxy());
+
       BtreeNodeProxy *proxy;
       PBtreeNode *node = PBtreeNode::from_page(page);
       if (node->is_leaf())
@@ -320,6 +392,7 @@ class BtreeIndex
     static void get_metrics(ham_env_metrics_t *metrics) {
       metrics->btree_smo_split = ms_btree_smo_split;
       metrics->btree_smo_merge = ms_btree_smo_merge;
+      metrics->btree_batch_leaf_hits = ms_btree_batch_leaf_hits;
       metrics->extended_keys = g_extended_keys;
       metrics->extended_duptables = g_extended_duptables;
     }
@@ -329,12 +402,19 @@ class BtreeIndex
       return (&m_statistics);
     }
 
+    // Returns the mutex which protects the lazily created node proxies and
+    // the lists of coupled cursors if multiple threads read concurrently
+    Mutex &get_node_mutex() {
+      return (m_node_mutex);
+    }
+
     // Returns the class name (for testing)
     std::string test_get_classname() const {
       return (m_leaf_traits->test_get_classname());
     }
 
   private:
+    friend class BtreeBulkLoadAction;
     friend class BtreeCheckAction;
     friend class BtreeEnumAction;
     friend class BtreeEraseAction;
@@ -367,6 +447,10 @@ class BtreeIndex
     // Flushes the PBtreeHeader to the Environment's header page
     void flush_descriptor();
 
+    // Adjusts the persistent key counters after a key (or a duplicate)
+    // was inserted or erased
+    void adjust_key_count(ham_s64_t keys, ham_s64_t records);
+
     // Searches |parent| page for key |key| and returns the child
     // page in |child|.
     //
@@ -383,6 +467,13 @@ class BtreeIndex
     // another negative status code value when an unexpected error occurred.
     ham_s32_t find_leaf(Page *page, ham_key_t *key, ham_u32_t flags);
 
+    // Returns the leaf at |address| if it is still cached and if |key|
+    // belongs to this leaf (because it is in the range of the leaf's keys,
+    // or beyond the first or last leaf of the tree); otherwise returns
+    // null. |fetch_flags| are passed to PageManager::fetch_page.
+    Page *get_hinted_leaf(ham_u64_t address, ham_key_t *key,
+                    ham_u32_t fetch_flags);
+
     // pointer to the database object
     LocalDatabase *m_db;
 
@@ -412,9 +503,18 @@ class BtreeIndex
     // address of the root-page
     ham_u64_t m_root_address;
 
+    // the number of keys (without duplicates)
+    ham_u64_t m_key_count;
+
+    // the number of records (= keys including their duplicates)
+    ham_u64_t m_record_count;
+
     // the btree statistics
     BtreeStatistics m_statistics;
 
+    // protects the node proxies and the cursor lists of the pages
+    Mutex m_node_mutex;
+
     // usage metrics - number of page splits
     static ham_u64_t ms_btree_smo_split;
 
@@ -423,6 +523,10 @@ class BtreeIndex
 
     // usage metrics - number of page shifts
     static ham_u64_t ms_btree_smo_shift;
+
+    // usage metrics - number of batch operations which reused the leaf
+    // of the previous key
+    static ham_u64_t ms_btree_batch_leaf_hits;
 };
 
 } // namespace hamsterdb
@@ -52,9 +52,10 @@ class BtreeInsertAction
 
   public:
     BtreeInsertAction(BtreeIndex *btree, Transaction *txn, Cursor *cursor,
-        ham_key_t *key, ham_record_t *record, ham_u32_t flags)
+        ham_key_t *key, ham_record_t *record, ham_u32_t flags,
+        ham_u64_t *leaf_hint)
       : m_btree(btree), m_txn(txn), m_cursor(0), m_key(key),
-        m_record(record), m_flags(flags) {
+        m_record(record), m_flags(flags), m_leaf_hint(leaf_hint) {
       if (cursor) {
         m_cursor = cursor->get_btree_cursor();
         ham_assert(m_btree->get_db() == m_cursor->get_parent()->get_db());
@@ -82,7 +83,9 @@ class BtreeInsertAction
        * flag and call insert()
        */
       ham_status_t st;
-      if (m_hints.leaf_page_addr
+      if (m_leaf_hint && *m_leaf_hint)
+        st = insert_in_hinted_leaf();
+      else if (m_hints.leaf_page_addr
           && (m_hints.flags & HAM_HINT_APPEND
               || m_hints.flags & HAM_HINT_PREPEND))
         st = append_or_prepend_key();
@@ -92,15 +95,30 @@ class BtreeInsertAction
       if (st)
         stats->insert_failed();
       else {
-        if (m_hints.processed_leaf_page)
+        if (m_hints.processed_leaf_page) {
           stats->insert_succeeded(m_hints.processed_leaf_page,
                   m_hints.processed_slot);
+          if (m_leaf_hint)
+            *m_leaf_hint = m_hints.processed_leaf_page->get_address();
+        }
       }
 
       return (st);
     }
 
   private:
+    // Inserts the key in the leaf of the previous key of a batch with
+    // sorted keys (ham_db_insert_many), if the key belongs to this leaf
+    // and the leaf is not full; otherwise the tree is traversed
+    ham_status_t insert_in_hinted_leaf() {
+      Page *page = m_btree->get_hinted_leaf(*m_leaf_hint, m_key, 0);
+      if (!page || split_required(m_btree->get_node_from_page(page)))
+        return (insert());
+
+      BtreeIndex::ms_btree_batch_leaf_hits++;
+      return (insert_in_leaf(page, m_key, 0));
+    }
+
     // Appends a key at the "end" of the btree, or prepends it at the
     // "beginning"
     ham_status_t append_or_prepend_key() {
@@ -444,6 +462,15 @@ class BtreeInsertAction
         }
       }
 
+      // update the key counters; an existing key either was overwritten,
+      // or it got a new duplicate
+      if (node->is_leaf()) {
+        if (!exists)
+          m_btree->adjust_key_count(1, 1);
+        else if (!(m_hints.flags & HAM_OVERWRITE))
+          m_btree->adjust_key_count(0, 1);
+      }
+
       page->set_dirty(true);
 
       /* if we have a cursor (and this is a leaf node): couple it to the
@@ -476,15 +503,18 @@ class BtreeInsertAction
     // flags of ham_db_insert()
     ham_u32_t m_flags;
 
+    // the leaf of the previous key of a batch; can be null
+    ham_u64_t *m_leaf_hint;
+
     // statistical hints for this operation
     BtreeStatistics::InsertHints m_hints;
 };
 
 ham_status_t
 BtreeIndex::insert(Transaction *txn, Cursor *cursor, ham_key_t *key,
-                ham_record_t *record, ham_u32_t flags)
+                ham_record_t *record, ham_u32_t flags, ham_u64_t *leaf_hint)
 {
-  BtreeInsertAction bia(this, txn, cursor, key, record, flags);
+  BtreeInsertAction bia(this, txn, cursor, key, record, flags, leaf_hint);
   return (bia.run());
 }
 
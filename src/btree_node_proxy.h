@@ -478,6 +478,7 @@ class BtreeNodeProxyImpl : public BtreeNodeProxy
       ham_assert(slot < get_count());
       m_impl.erase(slot);
       set_count(get_count() - 1);
+      m_impl.update_search_index();
     }
 
     // Removes the record (or the duplicate of it, if |duplicate_index| is > 0).
@@ -513,6 +514,7 @@ class BtreeNodeProxyImpl : public BtreeNodeProxy
     virtual void insert(ham_u32_t slot, const ham_key_t *key) {
       m_impl.insert(slot, key);
       set_count(get_count() + 1);
+      m_impl.update_search_index();
     }
 
     // Returns true if a node requires a split to insert |key|
@@ -539,6 +541,9 @@ class BtreeNodeProxyImpl : public BtreeNodeProxy
         other->set_count(count - pivot);
       else
         other->set_count(count - pivot - 1);
+
+      m_impl.update_search_index();
+      other->m_impl.update_search_index();
     }
 
     // Merges all keys from the |other| node into this node
@@ -550,6 +555,9 @@ class BtreeNodeProxyImpl : public BtreeNodeProxy
 
       set_count(get_count() + other->get_count());
       other->set_count(0);
+
+      m_impl.update_search_index();
+      other->m_impl.update_search_index();
     }
 
     // Prints the node to stdout (for debugging)
@@ -571,6 +579,15 @@ class BtreeNodeProxyImpl : public BtreeNodeProxy
           printf("%03u: EX %s (%d) -> %08llx\n", i, (const char *)key.data,
                           key.size, (unsigned long long)it->get_record_id());
         }
+        else if (it->get_key_flags() & BtreeKey::kPrefixCompressed) {
+          ham_key_t key = {0};
+          get_key(i, &arena, &key);
+          printf("%03u: PX ", i);
+          for (ham_u32_t j = 0; j < key.size; j++)
+            printf("%c", ((const char *)key.data)[j]);
+          printf(" (%d) -> %08llx\n", key.size,
+                          (unsigned long long)it->get_record_id());
+        }
         else {
          printf("%03u:    ", i);
          //printf("    %08d -> %08llx\n", *(int *)it->get_key_data(),
@@ -597,11 +614,13 @@ class BtreeNodeProxyImpl : public BtreeNodeProxy
       it->set_key_flags(flags);
       it->set_key_size((ham_u16_t)data_size);
       it->set_key_data(data, (ham_u32_t)data_size);
+      m_impl.update_search_index();
     }
 
     // Clears the page with zeroes and reinitializes it; only for testing
     virtual void test_clear_page() {
       m_impl.test_clear_page();
+      m_impl.update_search_index();
     }
 
     // Returns the class name. Only for testing! Uses the functions exported
@@ -0,0 +1,274 @@
+/*
+ * Copyright (C) 2005-2014 Christoph Rupp (chris@crupp.de).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Search functions for sorted arrays of numeric keys
+ *
+ * The PAX layout stores numeric keys as a dense array. Such an array is
+ * searched with a binary search till the remaining range fits into a
+ * cache line; then the keys in this window are compared with SIMD
+ * instructions (if available). Since the keys are sorted, the number of
+ * keys which are greater than the search key is sufficient to calculate
+ * the slot, and the loop has no branches which depend on the keys.
+ *
+ * Internal nodes are read on every lookup, but rarely modified. For them,
+ * an EytzingerIndex keeps an in-memory copy of the keys in Eytzinger order
+ * (the layout of a binary heap). The first levels of the search then share
+ * very few cache lines, and the following levels are prefetched.
+ */
+
+#ifndef HAM_BTREE_SEARCH_H__
+#define HAM_BTREE_SEARCH_H__
+
+#include <vector>
+
+#include <ham/types.h>
+
+#if defined(__SSE2__) || defined(_M_X64) \
+    || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define HAM_SIMD_SSE2 1
+#  include <emmintrin.h>
+#endif
+#if defined(__SSE4_2__)
+#  define HAM_SIMD_SSE42 1
+#  include <nmmintrin.h>
+#endif
+#if defined(__AVX2__)
+#  define HAM_SIMD_AVX2 1
+#  include <immintrin.h>
+#endif
+
+namespace hamsterdb {
+
+// Returns the number of keys in |data[0..count[| which are greater than
+// |key|; the generic (scalar) version
+template<typename T>
+inline int
+count_greater_keys(const T *data, int count, T key)
+{
+  int c = 0;
+  for (int i = 0; i < count; i++)
+    c += (data[i] > key);
+  return (c);
+}
+
+#if HAM_SIMD_SSE2
+// SSE2/AVX2 version for 32bit keys. SSE2 only has a signed comparison,
+// therefore the sign bits are flipped.
+template<>
+inline int
+count_greater_keys<ham_u32_t>(const ham_u32_t *data, int count, ham_u32_t key)
+{
+  int i = 0;
+  int c = 0;
+#  if HAM_SIMD_AVX2
+  {
+    const __m256i bias = _mm256_set1_epi32((int)0x80000000);
+    const __m256i k = _mm256_xor_si256(_mm256_set1_epi32((int)key), bias);
+    __m256i acc = _mm256_setzero_si256();
+    for (; i + 8 <= count; i += 8) {
+      __m256i v = _mm256_xor_si256(
+                  _mm256_loadu_si256((const __m256i *)&data[i]), bias);
+      // every matching lane is -1
+      acc = _mm256_sub_epi32(acc, _mm256_cmpgt_epi32(v, k));
+    }
+    ham_u32_t lanes[8];
+    _mm256_storeu_si256((__m256i *)&lanes[0], acc);
+    for (int j = 0; j < 8; j++)
+      c += lanes[j];
+  }
+#  endif
+  const __m128i bias = _mm_set1_epi32((int)0x80000000);
+  const __m128i k = _mm_xor_si128(_mm_set1_epi32((int)key), bias);
+  __m128i acc = _mm_setzero_si128();
+  for (; i + 4 <= count; i += 4) {
+    __m128i v = _mm_xor_si128(_mm_loadu_si128((const __m128i *)&data[i]),
+                    bias);
+    acc = _mm_sub_epi32(acc, _mm_cmpgt_epi32(v, k));
+  }
+  ham_u32_t lanes[4];
+  _mm_storeu_si128((__m128i *)&lanes[0], acc);
+  c += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+
+  for (; i < count; i++)
+    c += (data[i] > key);
+  return (c);
+}
+#endif // HAM_SIMD_SSE2
+
+#if HAM_SIMD_SSE42 || HAM_SIMD_AVX2
+// SSE4.2/AVX2 version for 64bit keys; SSE2 cannot compare 64bit integers
+template<>
+inline int
+count_greater_keys<ham_u64_t>(const ham_u64_t *data, int count, ham_u64_t key)
+{
+  int i = 0;
+  int c = 0;
+#  if HAM_SIMD_AVX2
+  const __m256i bias = _mm256_set1_epi64x((long long)0x8000000000000000ull);
+  const __m256i k = _mm256_xor_si256(_mm256_set1_epi64x((long long)key),
+                  bias);
+  __m256i acc = _mm256_setzero_si256();
+  for (; i + 4 <= count; i += 4) {
+    __m256i v = _mm256_xor_si256(
+                _mm256_loadu_si256((const __m256i *)&data[i]), bias);
+    acc = _mm256_sub_epi64(acc, _mm256_cmpgt_epi64(v, k));
+  }
+  ham_u64_t lanes[4];
+  _mm256_storeu_si256((__m256i *)&lanes[0], acc);
+  c += (int)(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+#  else
+  const __m128i bias = _mm_set1_epi64x((long long)0x8000000000000000ull);
+  const __m128i k = _mm_xor_si128(_mm_set1_epi64x((long long)key), bias);
+  __m128i acc = _mm_setzero_si128();
+  for (; i + 2 <= count; i += 2) {
+    __m128i v = _mm_xor_si128(_mm_loadu_si128((const __m128i *)&data[i]),
+                    bias);
+    acc = _mm_sub_epi64(acc, _mm_cmpgt_epi64(v, k));
+  }
+  ham_u64_t lanes[2];
+  _mm_storeu_si128((__m128i *)&lanes[0], acc);
+  c += (int)(lanes[0] + lanes[1]);
+#  endif
+
+  for (; i < count; i++)
+    c += (data[i] > key);
+  return (c);
+}
+#endif // HAM_SIMD_SSE42 || HAM_SIMD_AVX2
+
+// Searches the sorted array |data[0..count[| for |key|. Returns the slot
+// of the largest key which is <= |key|, or -1 if all keys are greater.
+// |*pcmp| is 0 if the key was found, +1 if the key at the returned slot is
+// smaller than |key|, and -1 if the slot is -1.
+// This is the same contract as the binary search in PaxNodeImpl::find().
+template<typename T>
+inline int
+find_numeric_key(const T *data, int count, T key, int *pcmp)
+{
+  // the size of the window which is searched linearly
+  enum { kWindow = 64 / sizeof(T) };
+
+  // all keys left of |l| are <= |key|, all keys at or right of |r| are
+  // greater
+  int l = 0;
+  int r = count;
+  while (r - l > kWindow) {
+    int m = (l + r) / 2;
+    if (data[m] <= key)
+      l = m + 1;
+    else
+      r = m;
+  }
+
+  int slot = r - 1 - count_greater_keys<T>(&data[l], r - l, key);
+  if (slot < 0)
+    *pcmp = -1;
+  else
+    *pcmp = (data[slot] == key) ? 0 : +1;
+  return (slot);
+}
+
+//
+// A search accelerator for a sorted array of numeric keys. Stores a copy of
+// the keys in Eytzinger order, and the slot of each key in the original
+// array. Has to be rebuilt whenever the original array is modified.
+//
+template<typename T>
+class EytzingerIndex
+{
+  // the number of keys in a cache line; the search prefetches the keys
+  // which are visited four levels further down
+  enum { kKeysPerCacheLine = 64 / sizeof(T) };
+
+  public:
+    // Constructor
+    EytzingerIndex()
+      : m_count(0) {
+    }
+
+    // Returns the number of indexed keys; 0 if the index is empty
+    int get_count() const {
+      return (m_count);
+    }
+
+    // Builds the index for the sorted array |data[0..count[|
+    void build(const T *data, int count) {
+      m_count = count;
+      m_keys.resize(count + 1);
+      m_slots.resize(count + 1);
+      int slot = 0;
+      build(data, &slot, 1);
+    }
+
+    // Clears the index and releases the memory
+    void clear() {
+      m_count = 0;
+      std::vector<T>().swap(m_keys);
+      std::vector<ham_u32_t>().swap(m_slots);
+    }
+
+    // Same as find_numeric_key(); |data| is the original array which was
+    // used to build the index
+    int find(const T *data, T key, int *pcmp) const {
+      const T *keys = &m_keys[0];
+      int k = 1;
+      while (k <= m_count) {
+#if defined(__GNUC__)
+        __builtin_prefetch(keys + k * kKeysPerCacheLine);
+#endif
+        k = 2 * k + (keys[k] <= key);
+      }
+
+      // the path to the first key which is greater than |key| ends with
+      // the last "left" turn; strip all "right" turns after it
+      while (k & 1)
+        k >>= 1;
+      k >>= 1;
+
+      int slot = k ? (int)m_slots[k] - 1 : m_count - 1;
+      if (slot < 0)
+        *pcmp = -1;
+      else
+        *pcmp = (data[slot] == key) ? 0 : +1;
+      return (slot);
+    }
+
+  private:
+    // Copies the keys (in-order) to the subtree of node |k|
+    void build(const T *data, int *slot, int k) {
+      if (k > m_count)
+        return;
+      build(data, slot, 2 * k);
+      m_keys[k] = data[*slot];
+      m_slots[k] = (ham_u32_t)*slot;
+      (*slot)++;
+      build(data, slot, 2 * k + 1);
+    }
+
+    // The number of indexed keys
+    int m_count;
+
+    // The keys in Eytzinger order; the first element is unused
+    std::vector<T> m_keys;
+
+    // The slots of the keys in the original array
+    std::vector<ham_u32_t> m_slots;
+};
+
+} // namespace hamsterdb
+
+#endif /* HAM_BTREE_SEARCH_H__ */
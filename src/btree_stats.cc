@@ -50,8 +50,11 @@ BtreeStatistics::find_succeeded(Page *page)
 void
 BtreeStatistics::find_failed()
 {
-  m_last_leaf_pages[kOperationFind] = 0;
-  m_last_leaf_count[kOperationFind] = 0;
+  // only write if necessary; this is called by concurrent readers
+  if (m_last_leaf_pages[kOperationFind] || m_last_leaf_count[kOperationFind]) {
+    m_last_leaf_pages[kOperationFind] = 0;
+    m_last_leaf_count[kOperationFind] = 0;
+  }
 }
 
 void
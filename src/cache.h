@@ -17,21 +17,47 @@
 /*
  * The Cache Manager
  *
- * Stores pages in a non-intrusive hash table (each Page instance keeps
- * next/previous pointers for the overflow bucket). Can efficiently purge
+ * Stores pages in an open addressing hash table with linear probing. Each
+ * slot stores the address of the page next to the Page pointer, therefore
+ * a lookup usually touches only one or two cache lines and does not have
+ * to dereference any Page which is not the one we're looking for. The
+ * table grows whenever it is half full. Can efficiently purge
  * unused pages, because all pages are also stored in a (non-intrusive)
  * linked list, and whenever a page is accessed it is removed and re-inserted
  * at the head. The tail therefore points to the page which was not used
  * in a long time, and is the primary candidate for purging.
+ *
+ * If the 2Q policy (HAM_CACHE_POLICY_2Q) is enabled then the cached pages
+ * are split into two lists. New pages are added to the "cold" list, which
+ * is a FIFO and not reordered when pages are accessed. Pages which are
+ * purged from the cold list leave a "ghost" (their address) behind. If a
+ * page is fetched again while its ghost still exists, or if the page is an
+ * internal Btree node and accessed a second time, then it is moved to the
+ * "hot" list, which is managed as a LRU. Purges first shrink the cold list.
+ * A table scan therefore only flushes the cold list, but not the frequently
+ * used pages.
+ *
+ * Large caches are partitioned into several shards. A page is assigned to a
+ * shard by its address; each shard has its own hash table, lists and mutex,
+ * therefore threads accessing different shards do not block each other.
+ * Each shard manages its share of the capacity with the selected policy.
+ *
+ * Pages can be pinned while they are used by a thread; pinned pages are
+ * never purged.
  */
 
 #ifndef HAM_CACHE_H__
 #define HAM_CACHE_H__
 
+#include <map>
+#include <deque>
 #include <vector>
+#include <algorithm>
 
 #include "config.h"
+#include "mutex.h"
 #include "env_local.h"
+#include "btree_node.h"
 
 namespace hamsterdb {
 
@@ -39,41 +65,78 @@ class LocalEnvironment;
 class PageManager;
 
 /*
- * The Cache Manager
+ * A single shard of the Cache; not thread-safe, the caller has to lock
+ * the shard's mutex
  */
-class Cache
+class CacheShard
 {
     enum {
-      // The number of buckets should be a prime number or similar, as it
-      // is used in a MODULO hash scheme
-      kBucketSize = 10317
+      // The minimum number of slots in the hash table; must be a power of 2
+      kMinTableSize = 1024,
+
+      // The initial size of the hash table is limited; it will grow
+      // later if required
+      kMaxInitialTableSize = 16 * 1024,
+
+      // 2Q: the cold list can grow up to 1/kColdRatio of the capacity
+      kColdRatio = 4,
+
+      // 2Q: remembers ghosts of up to 1/kGhostRatio of the capacity
+      kGhostRatio = 2
     };
 
+    // A slot in the hash table; empty if |page| is null
+    struct Slot {
+      ham_u64_t address;
+      Page *page;
+    };
+
+    // 2Q: maps the address of a purged page to a sequence number
+    typedef std::map<ham_u64_t, ham_u64_t> GhostMap;
+
+    // 2Q: the ghosts in chronological order (address, sequence number)
+    typedef std::deque<std::pair<ham_u64_t, ham_u64_t> > GhostQueue;
+
   public:
     // the default constructor
     // |capacity_size| is in bytes!
-    Cache(LocalEnvironment *env,
-            ham_u64_t capacity_bytes = HAM_DEFAULT_CACHESIZE)
-      : m_env(env), m_capacity(capacity_bytes), m_cur_elements(0),
-        m_alloc_elements(0), m_totallist(0), m_totallist_tail(0),
+    CacheShard(LocalEnvironment *env, ham_u64_t capacity_bytes,
+            ham_u32_t policy)
+      : m_env(env), m_capacity(capacity_bytes), m_policy(policy),
+        m_cur_elements(0), m_alloc_elements(0), m_hot_elements(0),
+        m_totallist(0), m_totallist_tail(0), m_hotlist(0), m_hotlist_tail(0),
+        m_ghost_seqnum(0), m_table_used(0), m_table_shift(0),
         m_cache_hits(0), m_cache_misses(0) {
       if (m_capacity == 0)
         m_capacity = HAM_DEFAULT_CACHESIZE;
 
-      for (ham_u32_t i = 0; i < kBucketSize; i++)
-        m_buckets.push_back(0);
+      // reserve enough slots for the whole capacity (at 50% load)
+      ham_u64_t size = kMinTableSize;
+      while (size < kMaxInitialTableSize && size < 2 * get_capacity_pages())
+        size *= 2;
+      resize_table(size);
+    }
+
+    // Returns the mutex which protects this shard
+    Mutex &get_mutex() {
+      return (m_mutex);
+    }
+
+    // Returns a cached page without updating the statistics or the lists;
+    // returns null if the page was not cached
+    Page *lookup(ham_u64_t address) {
+      for (ham_u64_t i = calc_hash(address); m_table[i].page;
+              i = (i + 1) & (m_table.size() - 1)) {
+        if (m_table[i].address == address)
+          return (m_table[i].page);
+      }
+      return (0);
     }
 
     // Retrieves a page from the cache, also removes the page from the cache
     // and re-inserts it at the front. Returns null if the page was not cached.
-    Page *get_page(ham_u64_t address, ham_u32_t flags = 0) {
-      ham_u64_t hash = calc_hash(address);
-      Page *page = m_buckets[hash];
-      while (page) {
-        if (page->get_address() == address)
-          break;
-        page = page->get_next(Page::kListBucket);
-      }
+    Page *get_page(ham_u64_t address) {
+      Page *page = lookup(address);
 
       /* not found? then return */
       if (!page) {
@@ -81,21 +144,32 @@ class Cache
         return (0);
       }
 
+      m_cache_hits++;
+
+      // 2Q: pages in the cold list are not reordered, unless they are
+      // internal btree nodes; these are promoted to the hot list. Pages in
+      // the hot list are moved to its head.
+      if (m_policy == HAM_CACHE_POLICY_2Q) {
+        if (page->is_cache_hot()
+            || is_internal_node(page)) {
+          unlink_page(page);
+          insert_hot(page);
+        }
+        return (page);
+      }
+
       // Now re-insert the page at the head of the "totallist", and
       // thus move far away from the tail. The pages at the tail are highest
-      // candidates to be deleted when the cache is purged.
-      remove_page(page);
-      put_page(page);
-
-      m_cache_hits++;
+      // candidates to be deleted when the cache is purged. The hash table
+      // is not modified.
+      unlink_page(page);
+      insert_cold(page);
 
       return (page);
     }
 
     // Stores a page in the cache
     void put_page(Page *page) {
-      ham_u64_t hash = calc_hash(page->get_address());
-
       ham_assert(page->get_data());
 
       /* first remove the page from the cache, if it's already cached
@@ -104,57 +178,224 @@ class Cache
        * cache->_totallist_tail pointer is updated and that the page
        * is inserted at the HEAD of the list
        */
-      if (page->is_in_list(m_totallist, Page::kListCache))
+      bool was_hot = page->is_cache_hot();
+      if (is_cached(page))
         remove_page(page);
 
       /* now (re-)insert into the list of all cached pages, and increment
-       * the counter */
-      ham_assert(!page->is_in_list(m_totallist, Page::kListCache));
-      m_totallist = page->list_insert(m_totallist, Page::kListCache);
+       * the counter; with 2Q, pages which were hot (or which have a ghost)
+       * are inserted in the hot list */
+      if (m_policy == HAM_CACHE_POLICY_2Q
+          && (was_hot || remove_ghost(page->get_address())))
+        insert_hot(page);
+      else
+        insert_cold(page);
+
+      /* insert it in the hash table (or overwrite the existing slot) */
+      table_insert(page);
+    }
 
-      m_cur_elements++;
-      if (page->get_flags() & Page::kNpersMalloc)
-        m_alloc_elements++;
+    // Removes a page from the cache
+    void remove_page(Page *page) {
+      /* remove the page from the hash table */
+      if (page->get_address())
+        table_erase(page);
 
-      /*
-       * insert it in the cache buckets
-       * !!!
-       * to avoid inserting the page twice, we first remove it from the
-       * bucket
-       */
-      if (page->is_in_list(m_buckets[hash], Page::kListBucket))
-        m_buckets[hash] = page->list_remove(m_buckets[hash], Page::kListBucket);
-      ham_assert(!page->is_in_list(m_buckets[hash], Page::kListBucket));
-      m_buckets[hash] = page->list_insert(m_buckets[hash], Page::kListBucket);
+      unlink_page(page);
+    }
 
-      /* is this the chronologically oldest page? then set the pointer */
-      if (!m_totallist_tail)
-        m_totallist_tail = page;
+    // Removes up to |limit| pages from the shard and appends them to
+    // |victims|; the caller then flushes and deletes them. Dirty pages
+    // are skipped if |skip_dirty| is true.
+    void purge(unsigned limit, bool skip_dirty, std::vector<Page *> &victims) {
+      if (m_policy != HAM_CACHE_POLICY_2Q) {
+        purge_list(m_totallist_tail, limit, false, skip_dirty, victims);
+        return;
+      }
+
+      // 2Q: shrink the cold list till it reaches its limit, then purge the
+      // hot list. If this is not sufficient then continue with the cold list.
+      unsigned cold_limit = get_capacity_pages() / kColdRatio;
+      ham_u64_t cold = m_cur_elements - m_hot_elements;
+      unsigned i = 0;
+      if (cold > cold_limit)
+        i += purge_list(m_totallist_tail,
+                    std::min((ham_u64_t)limit, cold - cold_limit), true,
+                    skip_dirty, victims);
+      if (i < limit)
+        i += purge_list(m_hotlist_tail, limit - i, false, skip_dirty, victims);
+      if (i < limit)
+        i += purge_list(m_totallist_tail, limit - i, true, skip_dirty,
+                    victims);
     }
 
-    // Removes a page from the cache
-    void remove_page(Page *page) {
-      bool removed = false;
+    // Appends all dirty pages which could be purged to |pages|, the least
+    // recently used pages first
+    void get_dirty_pages(std::vector<Page *> &pages) {
+      collect_dirty_pages(m_totallist_tail, pages);
+      collect_dirty_pages(m_hotlist_tail, pages);
+    }
+
+    // the visitor callback returns true if the page should be removed from
+    // the cache and deleted
+    typedef bool (*VisitCallback)(Page *page, Database *db, ham_u32_t flags);
+
+    // Visits all pages in the "totallist"; this is used by the Environment
+    // to flush (and delete) pages
+    void visit(VisitCallback cb, Database *db, ham_u32_t flags) {
+      visit_list(m_totallist, cb, db, flags);
+      visit_list(m_hotlist, cb, db, flags);
+    }
 
-      /* are we removing the chronologically oldest page? then
-       * update the pointer with the next oldest page */
-      if (m_totallist_tail == page)
-        m_totallist_tail = page->get_previous(Page::kListCache);
-
-      /* remove the page from the cache buckets */
-      if (page->get_address()) {
-        ham_u64_t hash = calc_hash(page->get_address());
-        if (page->is_in_list(m_buckets[hash], Page::kListBucket)) {
-          m_buckets[hash] = page->list_remove(m_buckets[hash],
-                        Page::kListBucket);
+    // Returns the number of currently cached elements
+    ham_u64_t get_current_elements() const {
+      return (m_cur_elements);
+    }
+
+    // Returns the number of currently cached elements that were allocated
+    // (and not mapped)
+    ham_u64_t get_alloc_elements() const {
+      return (m_alloc_elements);
+    }
+
+    // Returns the number of cache hits
+    ham_u64_t get_cache_hits() const {
+      return (m_cache_hits);
+    }
+
+    // Returns the number of cache misses
+    ham_u64_t get_cache_misses() const {
+      return (m_cache_misses);
+    }
+
+  private:
+    // Calculates the hash of a page address; this is the index of the
+    // preferred slot in the hash table. Page addresses are aligned, therefore
+    // the lower bits are useless; a multiplicative (fibonacci) hash uses
+    // the upper bits of the product instead.
+    ham_u64_t calc_hash(ham_u64_t o) const {
+      return ((o * 0x9e3779b97f4a7c15ull) >> m_table_shift);
+    }
+
+    // Inserts a page into the hash table; if the address already exists
+    // then the slot is overwritten
+    void table_insert(Page *page) {
+      ham_u64_t address = page->get_address();
+      ham_u64_t mask = m_table.size() - 1;
+      ham_u64_t i = calc_hash(address);
+      for (; m_table[i].page; i = (i + 1) & mask) {
+        if (m_table[i].address == address) {
+          m_table[i].page = page;
+          return;
+        }
+      }
+
+      m_table[i].address = address;
+      m_table[i].page = page;
+
+      // grow the table if it is half full
+      if (++m_table_used * 2 > m_table.size())
+        resize_table(m_table.size() * 2);
+    }
+
+    // Removes a page from the hash table. Uses backward shift deletion: the
+    // following slots of the same cluster are moved up, if required, so
+    // there is no need for "deleted" markers.
+    void table_erase(Page *page) {
+      ham_u64_t mask = m_table.size() - 1;
+      ham_u64_t i = calc_hash(page->get_address());
+      for (; m_table[i].page != page; i = (i + 1) & mask) {
+        if (!m_table[i].page)
+          return;
+      }
+
+      for (ham_u64_t j = (i + 1) & mask; m_table[j].page; j = (j + 1) & mask) {
+        ham_u64_t home = calc_hash(m_table[j].address);
+        // move slot |j| to |i| if its home slot is not in (i, j]
+        if (((j - home) & mask) >= ((j - i) & mask)) {
+          m_table[i] = m_table[j];
+          i = j;
         }
       }
 
-      /* remove it from the list of all cached pages */
-      if (page->is_in_list(m_totallist, Page::kListCache)) {
-        m_totallist = page->list_remove(m_totallist, Page::kListCache);
-        removed = true;
+      m_table[i].page = 0;
+      m_table_used--;
+    }
+
+    // Resizes the hash table and re-inserts all pages; |size| must be a
+    // power of 2
+    void resize_table(ham_u64_t size) {
+      std::vector<Slot> old;
+      old.swap(m_table);
+
+      Slot empty = {0, 0};
+      m_table.resize(size, empty);
+      m_table_shift = 64;
+      for (ham_u64_t s = size; s > 1; s >>= 1)
+        m_table_shift--;
+
+      ham_u64_t mask = size - 1;
+      for (std::vector<Slot>::iterator it = old.begin(); it != old.end(); it++) {
+        if (!it->page)
+          continue;
+        ham_u64_t i = calc_hash(it->address);
+        while (m_table[i].page)
+          i = (i + 1) & mask;
+        m_table[i] = *it;
+      }
+    }
+
+    // Returns the capacity (in number of pages)
+    unsigned get_capacity_pages() const {
+      ham_u64_t pages = m_capacity / m_env->get_page_size();
+      if (pages > 0xffffffffu)
+        return (0xffffffffu);
+      return (pages ? (unsigned)pages : 1);
+    }
+
+    // Returns true if the page is stored in one of the lists
+    bool is_cached(Page *page) {
+      if (page->is_cache_hot())
+        return (page->is_in_list(m_hotlist, Page::kListCache));
+      return (page->is_in_list(m_totallist, Page::kListCache));
+    }
+
+    // Returns true if the page is an internal (non-leaf) btree node
+    bool is_internal_node(Page *page) {
+      if (page->get_flags() & Page::kNpersNoHeader || page->get_address() == 0)
+        return (false);
+      ham_u32_t type = page->get_type();
+      if (type != Page::kTypeBroot && type != Page::kTypeBindex)
+        return (false);
+      return (!PBtreeNode::from_page(page)->is_leaf());
+    }
+
+    // Removes a page from the list of all cached pages (or from the hot
+    // list), but not from the buckets
+    void unlink_page(Page *page) {
+      bool removed = false;
+
+      /* are we removing the chronologically oldest page? then update
+       * the pointer with the next oldest page */
+      if (page->is_cache_hot()) {
+        if (m_hotlist_tail == page)
+          m_hotlist_tail = page->get_previous(Page::kListCache);
+        if (page->is_in_list(m_hotlist, Page::kListCache)) {
+          m_hotlist = page->list_remove(m_hotlist, Page::kListCache);
+          m_hot_elements--;
+          removed = true;
+        }
+        page->set_cache_hot(false);
+      }
+      else {
+        if (m_totallist_tail == page)
+          m_totallist_tail = page->get_previous(Page::kListCache);
+        if (page->is_in_list(m_totallist, Page::kListCache)) {
+          m_totallist = page->list_remove(m_totallist, Page::kListCache);
+          removed = true;
+        }
       }
+
       /* decrease the number of cached elements */
       if (removed) {
         m_cur_elements--;
@@ -163,48 +404,75 @@ class Cache
       }
     }
 
-    typedef void (*PurgeCallback)(Page *page, PageManager *pm);
+    // Inserts a page at the head of the cold list (or of the LRU list,
+    // if the 2Q policy is disabled)
+    void insert_cold(Page *page) {
+      ham_assert(!page->is_in_list(m_totallist, Page::kListCache));
+      m_totallist = page->list_insert(m_totallist, Page::kListCache);
+      if (!m_totallist_tail)
+        m_totallist_tail = page;
 
-    // Purges the cache; the callback is called for every page that needs
-    // to be purged
-    void purge(PurgeCallback cb, PageManager *pm, unsigned limit) {
-      ham_assert(is_full() && limit > 0);
+      m_cur_elements++;
+      if (page->get_flags() & Page::kNpersMalloc)
+        m_alloc_elements++;
+    }
 
-      unsigned i = 0;
+    // Inserts a page at the head of the hot list
+    void insert_hot(Page *page) {
+      ham_assert(!page->is_in_list(m_hotlist, Page::kListCache));
+      page->set_cache_hot(true);
+      m_hotlist = page->list_insert(m_hotlist, Page::kListCache);
+      if (!m_hotlist_tail)
+        m_hotlist_tail = page;
 
-      /* get the chronologically oldest page */
-      Page *oldest = m_totallist_tail;
-      if (!oldest)
-        return;
+      m_hot_elements++;
+      m_cur_elements++;
+      if (page->get_flags() & Page::kNpersMalloc)
+        m_alloc_elements++;
+    }
 
-      /* now iterate through all pages, starting from the oldest
-       * (which is the tail of the "totallist", the list of ALL cached
-       * pages) */
-      Page *page = oldest;
-      do {
-        /* pick the first unused page (not in a changeset) that is NOT mapped */
-        if (page->get_flags() & Page::kNpersMalloc
-            && !m_env->get_changeset().contains(page)) {
-          Page *prev = page->get_previous(Page::kListCache);
+    // Returns true if a page can be purged: it is not pinned, not in a
+    // changeset and NOT mapped
+    bool is_purgeable(Page *page) {
+      return (page->get_flags() & Page::kNpersMalloc
+            && !page->is_pinned()
+            && !m_env->get_changeset().contains(page));
+    }
+
+    // Purges up to |limit| pages from a list, starting at its |tail|, and
+    // appends them to |victims|. If |remember| is true then ghosts of the
+    // purged pages are stored. Returns the number of purged pages.
+    unsigned purge_list(Page *tail, ham_u64_t limit, bool remember,
+                    bool skip_dirty, std::vector<Page *> &victims) {
+      unsigned i = 0;
+      Page *page = tail;
+      while (i < limit && page) {
+        Page *prev = page->get_previous(Page::kListCache);
+        /* pick the first unused page */
+        if (is_purgeable(page) && !(skip_dirty && page->is_dirty())) {
+          if (remember)
+            add_ghost(page->get_address());
           remove_page(page);
-          cb(page, pm);
+          victims.push_back(page);
           i++;
-          page = prev;
         }
-        else
-          page = page->get_previous(Page::kListCache);
-        ham_assert(page != oldest);
-      } while (i < limit && page && page != oldest);
+        page = prev;
+      }
+      return (i);
     }
 
-    // the visitor callback returns true if the page should be removed from
-    // the cache and deleted
-    typedef bool (*VisitCallback)(Page *page, Database *db, ham_u32_t flags);
+    // Appends the dirty pages of a list to |pages|, starting at its |tail|
+    void collect_dirty_pages(Page *tail, std::vector<Page *> &pages) {
+      for (Page *page = tail; page;
+              page = page->get_previous(Page::kListCache)) {
+        if (page->is_dirty() && is_purgeable(page))
+          pages.push_back(page);
+      }
+    }
 
-    // Visits all pages in the "totallist"; this is used by the Environment
-    // to flush (and delete) pages
-    void visit(VisitCallback cb, Database *db, ham_u32_t flags) {
-      Page *head = m_totallist;
+    // Visits all pages of a list
+    void visit_list(Page *head, VisitCallback cb, Database *db,
+                    ham_u32_t flags) {
       while (head) {
         Page *next = head->get_next(Page::kListCache);
 
@@ -216,9 +484,273 @@ class Cache
       }
     }
 
+    // 2Q: stores the ghost of a purged page; forgets the oldest ghost if
+    // there are too many
+    void add_ghost(ham_u64_t address) {
+      m_ghost_seqnum++;
+      m_ghosts[address] = m_ghost_seqnum;
+      m_ghost_queue.push_back(std::make_pair(address, m_ghost_seqnum));
+
+      unsigned ghost_limit = get_capacity_pages() / kGhostRatio;
+      while (m_ghost_queue.size() > ghost_limit) {
+        std::pair<ham_u64_t, ham_u64_t> &oldest = m_ghost_queue.front();
+        GhostMap::iterator it = m_ghosts.find(oldest.first);
+        // skip stale entries; the ghost was removed (or re-added) later
+        if (it != m_ghosts.end() && it->second == oldest.second)
+          m_ghosts.erase(it);
+        m_ghost_queue.pop_front();
+      }
+    }
+
+    // 2Q: removes the ghost of a page; returns true if the ghost existed
+    bool remove_ghost(ham_u64_t address) {
+      GhostMap::iterator it = m_ghosts.find(address);
+      if (it == m_ghosts.end())
+        return (false);
+      m_ghosts.erase(it);
+      return (true);
+    }
+
+    // the mutex which protects this shard
+    Mutex m_mutex;
+
+    // the current Environment
+    LocalEnvironment *m_env;
+
+    // the capacity of this shard (in bytes)
+    ham_u64_t m_capacity;
+
+    // the replacement policy (HAM_CACHE_POLICY_*)
+    ham_u32_t m_policy;
+
+    // the current number of cached elements
+    ham_u64_t m_cur_elements;
+
+    // the current number of cached elements that were allocated (and not
+    // mapped)
+    ham_u64_t m_alloc_elements;
+
+    // 2Q: the current number of elements in the hot list
+    ham_u64_t m_hot_elements;
+
+    // linked list of ALL cached pages; with 2Q this is the cold list
+    Page *m_totallist;
+
+    // the tail of the linked "totallist" - this is the oldest element,
+    // and therefore the highest candidate for a flush
+    Page *m_totallist_tail;
+
+    // 2Q: linked list of the hot pages
+    Page *m_hotlist;
+
+    // 2Q: the tail of the hot list (the least recently used hot page)
+    Page *m_hotlist_tail;
+
+    // 2Q: the ghosts of pages that were purged from the cold list
+    GhostMap m_ghosts;
+
+    // 2Q: the ghosts in chronological order, oldest first
+    GhostQueue m_ghost_queue;
+
+    // 2Q: the sequence number of the newest ghost
+    ham_u64_t m_ghost_seqnum;
+
+    // the hash table; the number of slots is a power of 2
+    std::vector<Slot> m_table;
+
+    // the number of used slots in the hash table
+    ham_u64_t m_table_used;
+
+    // the hash is shifted by this amount to get a slot index
+    int m_table_shift;
+
+    // counts the cache hits
+    ham_u64_t m_cache_hits;
+
+    // counts the cache misses
+    ham_u64_t m_cache_misses;
+};
+
+/*
+ * The Cache Manager
+ */
+class Cache
+{
+    enum {
+      // The maximum number of shards; must be a power of 2
+      kMaxShards = 16,
+
+      // Each shard manages at least this many pages
+      kMinShardPages = 64
+    };
+
+  public:
+    // Flags for get_page() and put_page_if_absent()
+    enum {
+      // pins the page; it is not purged till unpin_page() is called
+      kPin = 1
+    };
+
+    // Flags for purge()
+    enum {
+      // dirty pages are not purged
+      kSkipDirty = 1
+    };
+
+    typedef CacheShard::VisitCallback VisitCallback;
+
+    typedef void (*PurgeCallback)(Page *page, PageManager *pm);
+
+    // the default constructor
+    // |capacity_size| is in bytes!
+    Cache(LocalEnvironment *env,
+            ham_u64_t capacity_bytes = HAM_DEFAULT_CACHESIZE,
+            ham_u32_t policy = HAM_CACHE_POLICY_LRU)
+      : m_env(env), m_capacity(capacity_bytes), m_policy(policy),
+        m_purge_shard(0) {
+      if (m_capacity == 0)
+        m_capacity = HAM_DEFAULT_CACHESIZE;
+
+      ham_u64_t pages = m_capacity / m_env->get_page_size();
+      size_t num_shards = 1;
+      while (num_shards < kMaxShards
+              && pages / (num_shards * 2) >= kMinShardPages) {
+        num_shards *= 2;
+      }
+
+      for (size_t i = 0; i < num_shards; i++)
+        m_shards.push_back(new CacheShard(env, m_capacity / num_shards,
+                                m_policy));
+    }
+
+    // the destructor
+    ~Cache() {
+      for (size_t i = 0; i < m_shards.size(); i++)
+        delete m_shards[i];
+    }
+
+    // Retrieves a page from the cache and updates the lists of the
+    // replacement policy. Returns null if the page was not cached.
+    // |flags|: kPin
+    Page *get_page(ham_u64_t address, ham_u32_t flags = 0) {
+      CacheShard *shard = get_shard(address);
+      ScopedLock lock(shard->get_mutex());
+      Page *page = shard->get_page(address);
+      if (page && flags & kPin)
+        page->pin();
+      return (page);
+    }
+
+    // Returns true if a page is cached; does not update the lists of the
+    // replacement policy
+    bool has_page(ham_u64_t address) {
+      CacheShard *shard = get_shard(address);
+      ScopedLock lock(shard->get_mutex());
+      return (shard->lookup(address) != 0);
+    }
+
+    // Stores a page in the cache
+    void put_page(Page *page) {
+      CacheShard *shard = get_shard(page->get_address());
+      ScopedLock lock(shard->get_mutex());
+      shard->put_page(page);
+    }
+
+    // Stores a page which was just fetched from disk, unless another
+    // thread was faster and already cached a page with the same address.
+    // Returns the cached page; if this is not |page| then the caller has to
+    // delete |page|.
+    // |flags|: kPin
+    Page *put_page_if_absent(Page *page, ham_u32_t flags = 0) {
+      CacheShard *shard = get_shard(page->get_address());
+      ScopedLock lock(shard->get_mutex());
+      Page *other = shard->lookup(page->get_address());
+      if (other)
+        page = other;
+      else
+        shard->put_page(page);
+      if (flags & kPin)
+        page->pin();
+      return (page);
+    }
+
+    // Removes a page from the cache
+    void remove_page(Page *page) {
+      CacheShard *shard = get_shard(page->get_address());
+      ScopedLock lock(shard->get_mutex());
+      shard->remove_page(page);
+    }
+
+    // Pins a cached page
+    void pin_page(Page *page) {
+      CacheShard *shard = get_shard(page->get_address());
+      ScopedLock lock(shard->get_mutex());
+      page->pin();
+    }
+
+    // Releases a page which was pinned by get_page(), put_page_if_absent()
+    // or pin_page()
+    void unpin_page(Page *page) {
+      CacheShard *shard = get_shard(page->get_address());
+      ScopedLock lock(shard->get_mutex());
+      page->unpin();
+    }
+
+    // Purges the cache; the callback is called for every page that needs
+    // to be purged. The shards are purged in a round-robin fashion, and
+    // the callbacks are invoked after the shards were unlocked.
+    // |flags|: kSkipDirty
+    void purge(PurgeCallback cb, PageManager *pm, unsigned limit,
+                    ham_u32_t flags = 0) {
+      ham_assert(limit > 0);
+
+      std::vector<Page *> victims;
+      {
+        ScopedLock lock(m_purge_mutex);
+        size_t num_shards = m_shards.size();
+        for (size_t i = 0; i < num_shards && victims.size() < limit; i++) {
+          CacheShard *shard = m_shards[m_purge_shard];
+          m_purge_shard = (m_purge_shard + 1) % num_shards;
+
+          // every remaining shard purges its share of the remaining pages
+          unsigned quota = (unsigned)((limit - victims.size()
+                                  + (num_shards - i) - 1) / (num_shards - i));
+          ScopedLock shard_lock(shard->get_mutex());
+          shard->purge(quota, (flags & kSkipDirty) != 0, victims);
+        }
+      }
+
+      for (std::vector<Page *>::iterator it = victims.begin();
+              it != victims.end(); it++)
+        cb(*it, pm);
+    }
+
+    // Visits all cached pages; this is used by the Environment to flush
+    // (and delete) pages
+    void visit(VisitCallback cb, Database *db, ham_u32_t flags) {
+      for (size_t i = 0; i < m_shards.size(); i++) {
+        ScopedLock lock(m_shards[i]->get_mutex());
+        m_shards[i]->visit(cb, db, flags);
+      }
+    }
+
+    // Appends all dirty pages which could be purged to |pages|; the
+    // least recently used pages of each shard come first
+    void get_dirty_pages(std::vector<Page *> &pages) {
+      for (size_t i = 0; i < m_shards.size(); i++) {
+        ScopedLock lock(m_shards[i]->get_mutex());
+        m_shards[i]->get_dirty_pages(pages);
+      }
+    }
+
     // Returns true if the caller should purge the cache
     bool is_full() const {
-      return (m_alloc_elements * m_env->get_page_size() > m_capacity);
+      ham_u64_t alloc_elements = 0;
+      for (size_t i = 0; i < m_shards.size(); i++) {
+        ScopedLock lock(m_shards[i]->get_mutex());
+        alloc_elements += m_shards[i]->get_alloc_elements();
+      }
+      return (alloc_elements * m_env->get_page_size() > m_capacity);
     }
 
     // Returns the capacity (in bytes)
@@ -226,9 +758,24 @@ class Cache
       return (m_capacity);
     }
 
+    // Returns the replacement policy (HAM_CACHE_POLICY_*)
+    ham_u32_t get_policy() const {
+      return (m_policy);
+    }
+
+    // Returns the number of shards
+    size_t get_num_shards() const {
+      return (m_shards.size());
+    }
+
     // Returns the number of currently cached elements
     ham_u64_t get_current_elements() const {
-      return (m_cur_elements);
+      ham_u64_t elements = 0;
+      for (size_t i = 0; i < m_shards.size(); i++) {
+        ScopedLock lock(m_shards[i]->get_mutex());
+        elements += m_shards[i]->get_current_elements();
+      }
+      return (elements);
     }
 
     // Checks the cache integrity; throws an exception if the integrity
@@ -237,19 +784,23 @@ class Cache
 
     // Fills in the current metrics
     void get_metrics(ham_env_metrics_t *metrics) const {
-      metrics->cache_hits = m_cache_hits;
-      metrics->cache_misses = m_cache_misses;
+      metrics->cache_hits = 0;
+      metrics->cache_misses = 0;
+      for (size_t i = 0; i < m_shards.size(); i++) {
+        ScopedLock lock(m_shards[i]->get_mutex());
+        metrics->cache_hits += m_shards[i]->get_cache_hits();
+        metrics->cache_misses += m_shards[i]->get_cache_misses();
+      }
     }
 
   private:
-    // Calculates the hash of a page address
-    ham_u64_t calc_hash(ham_u64_t o) const {
-      return (o % kBucketSize);
-    }
-
-    // Sets the HEAD of the global page list
-    void set_totallist(Page *l) {
-      m_totallist = l;
+    // Returns the shard of a page address. Uses other bits of the hash
+    // than the hash tables of the shards.
+    CacheShard *get_shard(ham_u64_t address) const {
+      if (m_shards.size() == 1)
+        return (m_shards[0]);
+      return (m_shards[((address * 0x9e3779b97f4a7c15ull) >> 32)
+                    & (m_shards.size() - 1)]);
     }
 
     // the current Environment
@@ -258,28 +809,17 @@ class Cache
     // the capacity (in bytes)
     ham_u64_t m_capacity;
 
-    // the current number of cached elements
-    ham_u64_t m_cur_elements;
-
-    // the current number of cached elements that were allocated (and not
-    // mapped)
-    ham_u64_t m_alloc_elements;
-
-    // linked list of ALL cached pages
-    Page *m_totallist;
+    // the replacement policy (HAM_CACHE_POLICY_*)
+    ham_u32_t m_policy;
 
-    // the tail of the linked "totallist" - this is the oldest element,
-    // and therefore the highest candidate for a flush
-    Page *m_totallist_tail;
-
-    // the buckets - a linked list of Page pointers
-    std::vector<Page *> m_buckets;
+    // the shards
+    std::vector<CacheShard *> m_shards;
 
-    // counts the cache hits
-    ham_u64_t m_cache_hits;
+    // the shard which is purged next
+    size_t m_purge_shard;
 
-    // counts the cache misses
-    ham_u64_t m_cache_misses;
+    // serializes calls to purge()
+    Mutex m_purge_mutex;
 };
 
 } // namespace hamsterdb
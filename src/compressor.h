@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2005-2014 Christoph Rupp (chris@crupp.de).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * The Compressor interface
+ *
+ * A Compressor compresses data into an internal buffer (the "arena"),
+ * which stays valid till the next call. The implementations (one per
+ * HAM_COMPRESSOR_* algorithm) are created by the CompressorFactory.
+ */
+
+#ifndef HAM_COMPRESSOR_H__
+#define HAM_COMPRESSOR_H__
+
+#include "ham/types.h"
+
+#include "error.h"
+#include "util.h"
+
+namespace hamsterdb {
+
+class Compressor
+{
+  public:
+    virtual ~Compressor() {
+    }
+
+    // Compresses |inlength| bytes of |inp|; returns the compressed length.
+    // The compressed data is returned by get_output_data(). The compressed
+    // data can be larger than the input!
+    ham_u32_t compress(const ham_u8_t *inp, ham_u32_t inlength) {
+      m_arena.resize(get_compressed_length(inlength));
+      return (do_compress(inp, inlength, (ham_u8_t *)m_arena.get_ptr(),
+                              m_arena.get_size()));
+    }
+
+    // Decompresses |inlength| bytes of |inp| into |outp|; |outlength| is
+    // the size of the uncompressed data. Throws HAM_INTEGRITY_VIOLATED if
+    // the data is corrupt.
+    void decompress(const ham_u8_t *inp, ham_u32_t inlength, ham_u8_t *outp,
+                    ham_u32_t outlength) {
+      do_decompress(inp, inlength, outp, outlength);
+    }
+
+    // Decompresses |inlength| bytes of |inp| into the arena; |outlength| is
+    // the size of the uncompressed data
+    void decompress(const ham_u8_t *inp, ham_u32_t inlength,
+                    ham_u32_t outlength) {
+      m_arena.resize(outlength);
+      do_decompress(inp, inlength, (ham_u8_t *)m_arena.get_ptr(), outlength);
+    }
+
+    // Returns the (de-)compressed data of the previous call
+    const ham_u8_t *get_output_data() const {
+      return ((const ham_u8_t *)m_arena.get_ptr());
+    }
+
+  protected:
+    // Returns the maximum size of the compressed data of |length| bytes
+    virtual ham_u32_t get_compressed_length(ham_u32_t length) = 0;
+
+    // Compresses |inlength| bytes of |inp| into |outp|, which has a capacity
+    // of |outlength| bytes; returns the compressed length
+    virtual ham_u32_t do_compress(const ham_u8_t *inp, ham_u32_t inlength,
+                    ham_u8_t *outp, ham_u32_t outlength) = 0;
+
+    // Decompresses |inlength| bytes of |inp| into |outp|; exactly |outlength|
+    // bytes are expected
+    virtual void do_decompress(const ham_u8_t *inp, ham_u32_t inlength,
+                    ham_u8_t *outp, ham_u32_t outlength) = 0;
+
+  private:
+    // the buffer for the (de-)compressed data
+    ByteArray m_arena;
+};
+
+} // namespace hamsterdb
+
+#endif /* HAM_COMPRESSOR_H__ */
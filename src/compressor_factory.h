@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2005-2014 Christoph Rupp (chris@crupp.de).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HAM_COMPRESSOR_FACTORY_H__
+#define HAM_COMPRESSOR_FACTORY_H__
+
+#include "config.h"
+
+#include <ham/types.h>
+#include "compressor_lz4.h"
+#if defined(HAVE_ZLIB_H) && defined(HAVE_LIBZ)
+#  include "compressor_zlib.h"
+#endif
+
+namespace hamsterdb {
+
+class CompressorFactory {
+  public:
+    // returns true if the algorithm |type| (HAM_COMPRESSOR_*) is available
+    static bool is_available(int type) {
+      switch (type) {
+        case HAM_COMPRESSOR_LZ4:
+          return (true);
+#if defined(HAVE_ZLIB_H) && defined(HAVE_LIBZ)
+        case HAM_COMPRESSOR_ZLIB:
+          return (true);
+#endif
+        default:
+          return (false);
+      }
+    }
+
+    // creates a new Compressor instance for the algorithm |type|
+    // (HAM_COMPRESSOR_*); throws HAM_NOT_IMPLEMENTED if it is not available
+    static Compressor *create(int type) {
+      switch (type) {
+        case HAM_COMPRESSOR_LZ4:
+          return (new Lz4Compressor());
+#if defined(HAVE_ZLIB_H) && defined(HAVE_LIBZ)
+        case HAM_COMPRESSOR_ZLIB:
+          return (new ZlibCompressor());
+#endif
+        default:
+          ham_trace(("compressor %d is not available", type));
+          throw Exception(HAM_NOT_IMPLEMENTED);
+      }
+    }
+};
+
+} // namespace hamsterdb
+
+#endif /* HAM_COMPRESSOR_FACTORY_H__ */
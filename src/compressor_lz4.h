@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2005-2014 Christoph Rupp (chris@crupp.de).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * A Compressor for the LZ4 block format (HAM_COMPRESSOR_LZ4); the codec
+ * is bundled in 3rdparty/lz4
+ */
+
+#ifndef HAM_COMPRESSOR_LZ4_H__
+#define HAM_COMPRESSOR_LZ4_H__
+
+#include "../3rdparty/lz4/lz4.h"
+
+#include "compressor.h"
+
+namespace hamsterdb {
+
+class Lz4Compressor : public Compressor
+{
+  protected:
+    virtual ham_u32_t get_compressed_length(ham_u32_t length) {
+      return (LZ4_compressBound(length));
+    }
+
+    virtual ham_u32_t do_compress(const ham_u8_t *inp, ham_u32_t inlength,
+                    ham_u8_t *outp, ham_u32_t outlength) {
+      int len = LZ4_compress_default((const char *)inp, (char *)outp,
+                      inlength, outlength);
+      if (len <= 0) {
+        ham_log(("LZ4_compress_default failed"));
+        throw Exception(HAM_INTERNAL_ERROR);
+      }
+      return ((ham_u32_t)len);
+    }
+
+    virtual void do_decompress(const ham_u8_t *inp, ham_u32_t inlength,
+                    ham_u8_t *outp, ham_u32_t outlength) {
+      int len = LZ4_decompress_safe((const char *)inp, (char *)outp,
+                      inlength, outlength);
+      if (len != (int)outlength) {
+        ham_log(("LZ4_decompress_safe failed"));
+        throw Exception(HAM_INTEGRITY_VIOLATED);
+      }
+    }
+};
+
+} // namespace hamsterdb
+
+#endif /* HAM_COMPRESSOR_LZ4_H__ */
@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2005-2014 Christoph Rupp (chris@crupp.de).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * A Compressor for zlib (HAM_COMPRESSOR_ZLIB); only available if zlib
+ * was found by configure
+ */
+
+#ifndef HAM_COMPRESSOR_ZLIB_H__
+#define HAM_COMPRESSOR_ZLIB_H__
+
+#include <zlib.h>
+
+#include "compressor.h"
+
+namespace hamsterdb {
+
+class ZlibCompressor : public Compressor
+{
+  public:
+    ZlibCompressor(int level = Z_DEFAULT_COMPRESSION)
+      : m_level(level) {
+    }
+
+  protected:
+    virtual ham_u32_t get_compressed_length(ham_u32_t length) {
+      return ((ham_u32_t)::compressBound(length));
+    }
+
+    virtual ham_u32_t do_compress(const ham_u8_t *inp, ham_u32_t inlength,
+                    ham_u8_t *outp, ham_u32_t outlength) {
+      uLongf len = outlength;
+      int zret = ::compress2((Bytef *)outp, &len, (const Bytef *)inp,
+                      inlength, m_level);
+      if (zret != Z_OK) {
+        ham_log(("compress2 failed with error %d", zret));
+        throw Exception(HAM_INTERNAL_ERROR);
+      }
+      return ((ham_u32_t)len);
+    }
+
+    virtual void do_decompress(const ham_u8_t *inp, ham_u32_t inlength,
+                    ham_u8_t *outp, ham_u32_t outlength) {
+      uLongf len = outlength;
+      int zret = ::uncompress((Bytef *)outp, &len, (const Bytef *)inp,
+                      inlength);
+      if (zret != Z_OK || len != outlength) {
+        ham_log(("uncompress failed with error %d", zret));
+        throw Exception(HAM_INTEGRITY_VIOLATED);
+      }
+    }
+
+  private:
+    // the compression level
+    int m_level;
+};
+
+} // namespace hamsterdb
+
+#endif /* HAM_COMPRESSOR_ZLIB_H__ */
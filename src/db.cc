@@ -27,6 +27,30 @@ Database::Database(Environment *env, ham_u16_t name, ham_u32_t flags)
 {
 }
 
+ham_status_t
+Database::bulk_insert(Transaction *txn, ham_key_t *keys,
+                ham_record_t *records, ham_u32_t count,
+                ham_u32_t fill_factor, ham_u32_t flags)
+{
+  flags &= ~(HAM_BULK_SORTED | HAM_BULK_BYPASS_TRANSACTIONS);
+
+  for (ham_u32_t i = 0; i < count; i++) {
+    ham_status_t st = insert(txn, &keys[i], &records[i], flags);
+    if (st)
+      return (st);
+
+    // the record number of a key without HAM_KEY_USER_ALLOC is returned
+    // in a temporary buffer, which is overwritten by the next insert
+    if ((get_rt_flags() & HAM_RECORD_NUMBER)
+        && !(flags & HAM_OVERWRITE)
+        && !(keys[i].flags & HAM_KEY_USER_ALLOC)) {
+      keys[i].data = 0;
+      keys[i].size = 0;
+    }
+  }
+  return (0);
+}
+
 Cursor *
 Database::cursor_create(Transaction *txn, ham_u32_t flags)
 {
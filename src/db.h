@@ -99,6 +99,12 @@ class Database
     virtual ham_status_t insert(Transaction *txn, ham_key_t *key,
                     ham_record_t *record, ham_u32_t flags) = 0;
 
+    // Inserts a batch of key/value pairs (ham_db_bulk_insert); the default
+    // implementation inserts the pairs one by one
+    virtual ham_status_t bulk_insert(Transaction *txn, ham_key_t *keys,
+                    ham_record_t *records, ham_u32_t count,
+                    ham_u32_t fill_factor, ham_u32_t flags);
+
     // Erase a key/value pair (ham_db_erase)
     virtual ham_status_t erase(Transaction *txn, ham_key_t *key,
                     ham_u32_t flags) = 0;
@@ -171,17 +177,31 @@ class Database
       return (m_cursor_list);
     }
 
-    // Returns the memory buffer for the key data
+    // Returns the memory buffer for the key data; if concurrent reads
+    // are enabled then each thread has its own buffer
     ByteArray &get_key_arena() {
+      if (m_env->get_flags() & HAM_ENABLE_CONCURRENT_READS)
+        return (get_thread_arena(m_thread_key_arena));
       return (m_key_arena);
     }
 
-    // Returns the memory buffer for the record data
+    // Returns the memory buffer for the record data; if concurrent reads
+    // are enabled then each thread has its own buffer
     ByteArray &get_record_arena() {
+      if (m_env->get_flags() & HAM_ENABLE_CONCURRENT_READS)
+        return (get_thread_arena(m_thread_record_arena));
       return (m_record_arena);
     }
 
   protected:
+    // Returns the calling thread's arena; allocates it if necessary
+    static ByteArray &get_thread_arena(
+                    boost::thread_specific_ptr<ByteArray> &arena) {
+      if (!arena.get())
+        arena.reset(new ByteArray());
+      return (*arena);
+    }
+
     // Creates a cursor; this is the actual implementation
     virtual Cursor *cursor_create_impl(Transaction *txn, ham_u32_t flags) = 0;
 
@@ -220,6 +240,13 @@ class Database
     // This is where record->data points to when returning a
     // record to the user; used if Transactions are disabled
     ByteArray m_record_arena;
+
+    // The per-thread arenas for keys and records; used instead of
+    // |m_key_arena| and |m_record_arena| if HAM_ENABLE_CONCURRENT_READS
+    // is set. The arenas of other threads are released when those
+    // threads terminate.
+    boost::thread_specific_ptr<ByteArray> m_thread_key_arena;
+    boost::thread_specific_ptr<ByteArray> m_thread_record_arena;
 };
 
 } // namespace hamsterdb
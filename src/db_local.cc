@@ -16,11 +16,15 @@
 
 #include "config.h"
 
+#include <vector>
+#include <algorithm>
+
 #include "blob_manager.h"
 #include "btree_index.h"
 #include "btree_index_factory.h"
 #include "btree_cursor.h"
 #include "btree_stats.h"
+#include "compressor_factory.h"
 #include "cursor.h"
 #include "db_local.h"
 #include "device.h"
@@ -181,7 +185,7 @@ LocalDatabase::insert_txn(LocalTransaction *txn, ham_key_t *key,
   /* get (or create) the node for this key */
   TransactionNode *node = get_txn_index()->get(key, 0);
   if (!node) {
-    node = new TransactionNode(this, key);
+    node = new (get_txn_index()) TransactionNode(this, key);
     node_created = true;
     // TODO only store when the operation is successful?
     get_txn_index()->store(node);
@@ -440,7 +444,7 @@ LocalDatabase::erase_txn(LocalTransaction *txn, ham_key_t *key, ham_u32_t flags,
   /* get (or create) the node for this key */
   TransactionNode *node = get_txn_index()->get(key, 0);
   if (!node) {
-    node = new TransactionNode(this, key);
+    node = new (get_txn_index()) TransactionNode(this, key);
     node_created = true;
     // TODO only store when the operation is successful?
     get_txn_index()->store(node);
@@ -521,9 +525,30 @@ LocalDatabase::open(ham_u16_t descriptor)
   ham_assert(!(m_btree_index->get_flags() & HAM_AUTO_RECOVERY));
   ham_assert(!(m_btree_index->get_flags() & HAM_ENABLE_TRANSACTIONS));
 
+  /* the key compression is persisted in the btree descriptor, and is
+   * required before the first node is loaded */
+  m_key_compression = desc->get_key_compression();
+  if (m_key_compression && m_key_compression != HAM_COMPRESSOR_PREFIX) {
+    ham_trace(("database was created with key compression %d, which "
+               "is not available", m_key_compression));
+    return (HAM_NOT_IMPLEMENTED);
+  }
+
   /* initialize the btree */
   m_btree_index->open();
 
+  /* the record compression is persisted in the btree descriptor */
+  int level;
+  m_record_compression = desc->get_record_compression(&level);
+  if (m_record_compression) {
+    if (!CompressorFactory::is_available(m_record_compression)) {
+      ham_trace(("database was created with record compression %d, which "
+                 "is not available", m_record_compression));
+      return (HAM_NOT_IMPLEMENTED);
+    }
+    m_record_compressor.reset(CompressorFactory::create(m_record_compression));
+  }
+
   /* create the TransactionIndex - TODO only if txn's are enabled? */
   m_txn_index = new TransactionIndex(this);
 
@@ -602,6 +627,15 @@ LocalDatabase::create(ham_u16_t descriptor, ham_u16_t key_type,
     }
   }
 
+  // store the record compression in the btree descriptor
+  PBtreeHeader *desc = get_local_env()->get_btree_descriptor(descriptor);
+  desc->set_record_compression(m_record_compression, 0);
+  if (m_record_compression)
+    m_record_compressor.reset(CompressorFactory::create(m_record_compression));
+
+  // same for the key compression
+  desc->set_key_compression(m_key_compression);
+
   // create the btree
   m_btree_index = new BtreeIndex(this, descriptor, persistent_flags,
                         key_type, key_size);
@@ -644,7 +678,10 @@ LocalDatabase::get_parameters(ham_parameter_t *param)
         p->value = get_btree_index()->get_max_keys_per_page();
         break;
       case HAM_PARAM_RECORD_COMPRESSION:
-        p->value = 0;
+        p->value = (ham_u64_t)get_record_compression();
+        break;
+      case HAM_PARAM_KEY_COMPRESSION:
+        p->value = (ham_u64_t)get_key_compression();
         break;
       default:
         ham_trace(("unknown parameter %d", (int)p->name));
@@ -676,14 +713,15 @@ LocalDatabase::get_key_count(Transaction *htxn, ham_u32_t flags,
   ham_status_t st = 0;
   LocalTransaction *txn = dynamic_cast<LocalTransaction *>(htxn);
 
-  if (flags & ~(HAM_SKIP_DUPLICATES)) {
+  if (flags & ~(HAM_SKIP_DUPLICATES | HAM_KEY_COUNT_FULL_SCAN)) {
     ham_trace(("parameter 'flag' contains unsupported flag bits: %08x",
-          flags & ~(HAM_SKIP_DUPLICATES)));
+          flags & ~(HAM_SKIP_DUPLICATES | HAM_KEY_COUNT_FULL_SCAN)));
     return (HAM_INV_PARAMETER);
   }
 
-  /* purge cache if necessary */
-  get_local_env()->get_page_manager()->purge_cache();
+  /* purge cache if necessary; only the full scan fetches pages */
+  if (flags & HAM_KEY_COUNT_FULL_SCAN)
+    get_local_env()->get_page_manager()->purge_cache();
 
   /*
    * call the btree function - this will retrieve the number of keys
@@ -824,6 +862,164 @@ LocalDatabase::insert(Transaction *htxn, ham_key_t *key,
   return (0);
 }
 
+// Sorts the items of ham_db_bulk_insert by their keys
+struct BulkKeyComparator
+{
+  BulkKeyComparator(BtreeIndex *btree, ham_key_t *keys)
+    : m_btree(btree), m_keys(keys) {
+  }
+
+  bool operator()(ham_u32_t lhs, ham_u32_t rhs) const {
+    return (m_btree->compare_keys(&m_keys[lhs], &m_keys[rhs]) < 0);
+  }
+
+  BtreeIndex *m_btree;
+  ham_key_t *m_keys;
+};
+
+ham_status_t
+LocalDatabase::bulk_insert(Transaction *htxn, ham_key_t *keys,
+            ham_record_t *records, ham_u32_t count, ham_u32_t fill_factor,
+            ham_u32_t flags)
+{
+  LocalTransaction *local_txn = 0;
+  LocalTransaction *txn = dynamic_cast<LocalTransaction *>(htxn);
+
+  /* record numbers are assigned in the order of the input */
+  if (get_rt_flags() & HAM_RECORD_NUMBER)
+    return (Database::bulk_insert(htxn, keys, records, count, fill_factor,
+                            flags));
+
+  for (ham_u32_t i = 0; i < count; i++) {
+    if (get_key_size() != HAM_KEY_SIZE_UNLIMITED
+        && keys[i].size != get_key_size()) {
+      ham_trace(("invalid key size (%u instead of %u)",
+            keys[i].size, get_key_size()));
+      return (HAM_INV_KEY_SIZE);
+    }
+    if (get_record_size() != HAM_RECORD_SIZE_UNLIMITED
+        && records[i].size != get_record_size()) {
+      ham_trace(("invalid record size (%u instead of %u)",
+            records[i].size, get_record_size()));
+      return (HAM_INV_RECORD_SIZE);
+    }
+  }
+
+  /* sort the items; duplicate keys keep the order of the input */
+  BulkKeyComparator cmp(m_btree_index, keys);
+  std::vector<ham_u32_t> order(count);
+  for (ham_u32_t i = 0; i < count; i++)
+    order[i] = i;
+  if (flags & HAM_BULK_SORTED) {
+    for (ham_u32_t i = 1; i < count; i++) {
+      if (cmp(order[i], order[i - 1])) {
+        ham_trace(("HAM_BULK_SORTED was specified, but the keys are "
+              "not sorted"));
+        return (HAM_INV_PARAMETER);
+      }
+    }
+  }
+  else
+    std::stable_sort(order.begin(), order.end(), cmp);
+
+  /* a key which occurs multiple times is rejected unless it is inserted
+   * as a duplicate; if it's overwritten then only the last item is
+   * required */
+  if (!(flags & HAM_DUPLICATE)) {
+    std::vector<ham_u32_t> unique;
+    unique.reserve(count);
+    for (ham_u32_t i = 0; i < count; i++) {
+      if (i + 1 < count && !cmp(order[i], order[i + 1])) {
+        if (!(flags & HAM_OVERWRITE))
+          return (HAM_DUPLICATE_KEY);
+        continue;
+      }
+      unique.push_back(order[i]);
+    }
+    order.swap(unique);
+  }
+
+  bool bypass = (flags & HAM_BULK_BYPASS_TRANSACTIONS)
+            || !(get_rt_flags() & HAM_ENABLE_TRANSACTIONS);
+  flags &= ~(HAM_BULK_SORTED | HAM_BULK_BYPASS_TRANSACTIONS);
+
+  /*
+   * if transactions are enabled: insert all items in the same Transaction
+   */
+  if (!bypass) {
+    if (!txn) {
+      local_txn = (LocalTransaction *)get_local_env()->get_txn_manager()->begin(
+                        0, 0);
+      txn = local_txn;
+    }
+
+    for (std::vector<ham_u32_t>::iterator it = order.begin();
+            it != order.end(); it++) {
+      ham_status_t st = insert(txn, &keys[*it], &records[*it], flags);
+      if (st) {
+        if (local_txn)
+          get_local_env()->get_txn_manager()->abort(local_txn);
+        return (st);
+      }
+    }
+
+    if (local_txn)
+      get_local_env()->get_txn_manager()->commit(local_txn);
+    return (0);
+  }
+
+  /* otherwise write directly to the btree. Pending Transactions would be
+   * applied on top of the new items; therefore the committed Transactions
+   * are flushed, and active Transactions are not allowed */
+  if (get_rt_flags() & HAM_ENABLE_TRANSACTIONS) {
+    if (get_txn_index()->get_first())
+      get_local_env()->get_txn_manager()->flush_committed_txns();
+    if (get_txn_index()->get_first()) {
+      ham_trace(("cannot bypass Transactions while a Transaction modifies "
+            "the Database"));
+      return (HAM_TXN_STILL_OPEN);
+    }
+  }
+
+  /* if the btree is empty, or if all keys are appended: build the
+   * btree nodes bottom-up */
+  get_local_env()->get_page_manager()->purge_cache();
+  if (!m_btree_index->bulk_load(keys, records, &order[0], order.size(),
+                          fill_factor, flags)) {
+    /* otherwise insert the keys one by one */
+    get_local_env()->get_changeset().clear();
+    for (std::vector<ham_u32_t>::iterator it = order.begin();
+            it != order.end(); it++) {
+      get_local_env()->get_page_manager()->purge_cache();
+
+      ham_status_t st = m_btree_index->insert(0, 0, &keys[*it],
+                            &records[*it], flags);
+      if (st) {
+        get_local_env()->get_changeset().clear();
+        return (st);
+      }
+      flush_bulk_changeset();
+    }
+    return (0);
+  }
+
+  flush_bulk_changeset();
+  return (0);
+}
+
+void
+LocalDatabase::flush_bulk_changeset()
+{
+  if (!(m_env->get_flags() & HAM_ENABLE_RECOVERY))
+    return;
+
+  if (m_env->get_flags() & HAM_ENABLE_TRANSACTIONS)
+    get_local_env()->get_changeset().flush(
+                    get_local_env()->get_incremented_lsn());
+  else
+    get_local_env()->get_changeset().flush();
+}
+
 ham_status_t
 LocalDatabase::erase(Transaction *htxn, ham_key_t *key, ham_u32_t flags)
 {
@@ -902,8 +1098,10 @@ LocalDatabase::find(Transaction *htxn, ham_key_t *key,
     return (HAM_INV_KEY_SIZE);
   }
 
-  /* purge cache if necessary */
-  get_local_env()->get_page_manager()->purge_cache();
+  /* purge cache if necessary; concurrent readers do not purge, the
+   * cache was already purged when the Environment was locked */
+  if (!(m_env->get_flags() & HAM_ENABLE_CONCURRENT_READS))
+    get_local_env()->get_page_manager()->purge_cache();
 
   /* if this database has duplicates, then we use ham_cursor_find
    * because we have to build a duplicate list, and this is currently
@@ -1203,8 +1401,10 @@ LocalDatabase::cursor_find(Cursor *cursor, ham_key_t *key,
     *(ham_u64_t *)key->data = recno;
   }
 
-  /* purge cache if necessary */
-  get_local_env()->get_page_manager()->purge_cache();
+  /* purge cache if necessary; concurrent readers do not purge, the
+   * cache was already purged when the Environment was locked */
+  if (!(m_env->get_flags() & HAM_ENABLE_CONCURRENT_READS))
+    get_local_env()->get_page_manager()->purge_cache();
 
   /* reset the dupecache */
   cursor->clear_dupecache();
@@ -1428,8 +1628,10 @@ ham_status_t
 LocalDatabase::cursor_move(Cursor *cursor, ham_key_t *key,
         ham_record_t *record, ham_u32_t flags)
 {
-  /* purge cache if necessary */
-  get_local_env()->get_page_manager()->purge_cache();
+  /* purge cache if necessary; concurrent readers do not purge, the
+   * cache was already purged when the Environment was locked */
+  if (!(m_env->get_flags() & HAM_ENABLE_CONCURRENT_READS))
+    get_local_env()->get_page_manager()->purge_cache();
 
   /*
    * if the cursor was never used before and the user requests a NEXT then
@@ -17,7 +17,10 @@
 #ifndef HAM_DB_LOCAL_H__
 #define HAM_DB_LOCAL_H__
 
+#include <memory>
+
 #include "db.h"
+#include "compressor.h"
 
 namespace hamsterdb {
 
@@ -42,7 +45,8 @@ class LocalDatabase : public Database {
     // Constructor
     LocalDatabase(Environment *env, ham_u16_t name, ham_u32_t flags)
       : Database(env, name, flags), m_recno(0), m_btree_index(0),
-        m_txn_index(0), m_cmp_func(0) {
+        m_txn_index(0), m_cmp_func(0), m_record_compression(0),
+        m_key_compression(0) {
     }
 
     // Returns the btree index
@@ -84,6 +88,11 @@ class LocalDatabase : public Database {
     virtual ham_status_t insert(Transaction *txn, ham_key_t *key,
                     ham_record_t *record, ham_u32_t flags);
 
+    // Inserts a batch of key/value pairs (ham_db_bulk_insert)
+    virtual ham_status_t bulk_insert(Transaction *txn, ham_key_t *keys,
+                    ham_record_t *records, ham_u32_t count,
+                    ham_u32_t fill_factor, ham_u32_t flags);
+
     // Erase a key/value pair (ham_db_erase)
     virtual ham_status_t erase(Transaction *txn, ham_key_t *key,
                     ham_u32_t flags);
@@ -158,6 +167,36 @@ class LocalDatabase : public Database {
     // HAM_RECORD_SIZE_UNLIMITED if none was specified)
     ham_u32_t get_record_size();
 
+    // Sets the record compression algorithm (HAM_COMPRESSOR_*); only
+    // valid before the Database is created (HAM_PARAM_RECORD_COMPRESSION)
+    void set_record_compression(int algorithm) {
+      m_record_compression = algorithm;
+    }
+
+    // Returns the record compression algorithm, or 0 if records are
+    // not compressed
+    int get_record_compression() const {
+      return (m_record_compression);
+    }
+
+    // Returns the Compressor for the records, or NULL if records are
+    // not compressed
+    Compressor *get_record_compressor() {
+      return (m_record_compressor.get());
+    }
+
+    // Sets the key compression algorithm (HAM_COMPRESSOR_PREFIX); only
+    // valid before the Database is created (HAM_PARAM_KEY_COMPRESSION)
+    void set_key_compression(int algorithm) {
+      m_key_compression = algorithm;
+    }
+
+    // Returns the key compression algorithm, or 0 if keys are
+    // not compressed
+    int get_key_compression() const {
+      return (m_key_compression);
+    }
+
     // Flushes a TransactionOperation to the btree
     ham_status_t flush_txn_operation(LocalTransaction *txn,
                     TransactionOperation *op);
@@ -211,6 +250,10 @@ class LocalDatabase : public Database {
     // Sets all cursors to nil if they point to |key| in the btree index
     void nil_all_cursors_in_btree(Cursor *current, ham_key_t *key);
 
+    // Flushes the Changeset after ham_db_bulk_insert modified the btree
+    // directly (if recovery is enabled)
+    void flush_bulk_changeset();
+
     // Lookup of a key/record pair in the Transaction index and in the btree,
     // if transactions are disabled/not successful; copies the
     // record into |record|. Also performs approx. matching.
@@ -228,6 +271,16 @@ class LocalDatabase : public Database {
 
     // the comparison function
     ham_compare_func_t m_cmp_func;
+
+    // the record compression algorithm (HAM_PARAM_RECORD_COMPRESSION)
+    int m_record_compression;
+
+    // the Compressor for the records; created if m_record_compression
+    // is set
+    std::auto_ptr<Compressor> m_record_compressor;
+
+    // the key compression algorithm (HAM_PARAM_KEY_COMPRESSION)
+    int m_key_compression;
 };
 
 } // namespace hamsterdb
@@ -23,7 +23,7 @@
 #ifndef HAM_DEVICE_H__
 #define HAM_DEVICE_H__
 
-#include <ham/hamsterdb.h>
+#include <ham/hamsterdb_int.h>
 
 #include "config.h"
 
@@ -79,6 +79,10 @@ class Device {
     virtual void write(ham_u64_t offset, void *buffer,
                 ham_u64_t size) = 0;
 
+    // advises the device that a range will be read soon; the data is
+    // loaded in the background
+    virtual void prefetch(ham_u64_t offset, ham_u64_t size) = 0;
+
     // reads a page from the device; this function CAN use mmap
     virtual void read_page(Page *page, ham_u32_t page_size) = 0;
 
@@ -99,6 +103,9 @@ class Device {
     // function will assert that the page is not dirty.
     virtual void free_page(Page *page) = 0;
 
+    // Fills in the current metrics
+    virtual void get_metrics(ham_env_metrics_t *metrics) const = 0;
+
     // get the Environment
     //
     // TODO get rid of this function. It's only used in the PageManager.
@@ -17,6 +17,9 @@
 #ifndef HAM_DEVICE_DISK_H__
 #define HAM_DEVICE_DISK_H__
 
+#include <vector>
+#include <algorithm>
+
 #include "os.h"
 #include "mem.h"
 #include "db.h"
@@ -27,18 +30,64 @@ namespace hamsterdb {
 
 /*
  * a File-based device
+ *
+ * The file is memory mapped in chunks. The first chunk covers the file
+ * when it is opened; whenever the file grew by at least |kMinMapChunk|
+ * bytes (or 1/8th of the mapped size, whatever is larger) then the new
+ * range is mapped as well. Already mapped chunks are never moved, because
+ * the Pages point into them.
+ *
+ * If HAM_PARAM_FILE_GROWTH_SIZE is set then the file grows in extents of
+ * this size, and new pages are handed out from the reserved extent. The
+ * unused space is released when the device is closed.
  */
 class DiskDevice : public Device {
+    // a mapped range of the file
+    struct MappedChunk {
+      MappedChunk(ham_u64_t offset_, ham_u64_t size_)
+        : offset(offset_), size(size_), win32mmap(HAM_INVALID_FD), ptr(0) {
+      }
+
+      // compares the file offsets; required for std::upper_bound
+      bool operator<(const MappedChunk &other) const {
+        return (offset < other.offset);
+      }
+
+      // the file offset of the chunk
+      ham_u64_t offset;
+
+      // the size of the chunk
+      ham_u64_t size;
+
+      // the win32 mmap handle
+      ham_fd_t win32mmap;
+
+      // pointer to the mapped data
+      ham_u8_t *ptr;
+    };
+
   public:
+    enum {
+      // the minimum size of a chunk which is mapped when the file grows
+      kMinMapChunk = 1024 * 1024,
+
+      // the size of a chunk is limited, otherwise too many newly allocated
+      // pages are malloc'ed till the file grew sufficiently
+      kMaxMapChunk = 256 * 1024 * 1024
+    };
+
     DiskDevice(LocalEnvironment *env, ham_u32_t flags)
-      : Device(env, flags), m_fd(HAM_INVALID_FD), m_win32mmap(HAM_INVALID_FD),
-        m_mmapptr(0), m_mapped_size(0) {
+      : Device(env, flags), m_fd(HAM_INVALID_FD), m_file_size(0),
+        m_reserved_size(0), m_growth_size(0), m_mapped_size(0),
+        m_page_count_mapped(0), m_page_count_malloced(0) {
     }
 
     // Create a new device
     virtual void create(const char *filename, ham_u32_t flags, ham_u32_t mode) {
       m_flags = flags;
       m_fd = os_create(filename, flags, mode);
+      m_file_size = m_reserved_size = 0;
+      m_growth_size = m_env->get_file_growth_size();
     }
 
     // opens an existing device
@@ -47,29 +96,27 @@ class DiskDevice : public Device {
     virtual void open(const char *filename, ham_u32_t flags) {
       m_flags = flags;
       m_fd = os_open(filename, flags);
+      m_file_size = m_reserved_size = os_get_file_size(m_fd);
+      m_growth_size = m_env->get_file_growth_size();
 
       if (m_flags & HAM_DISABLE_MMAP)
         return;
 
-      // the file size which backs the mapped ptr
-      ham_u64_t open_filesize = get_file_size();
-
-      // make sure we do not exceed the "real" size of the file, otherwise
-      // we run into issues when accessing that memory (at least on windows)
-      ham_u32_t granularity = os_get_granularity();
-      if (open_filesize == 0 || open_filesize % granularity)
-        return;
-
-      m_mapped_size = open_filesize;
-
-      os_mmap(m_fd, &m_win32mmap, 0, m_mapped_size,
-                    (flags & HAM_READ_ONLY) != 0, &m_mmapptr);
+      map_file(m_file_size);
     }
 
-    // closes the device
+    // closes the device; releases the unused space of the reserved extent
     virtual void close() {
-      if (m_mmapptr)
-        os_munmap(&m_win32mmap, m_mmapptr, m_mapped_size);
+      for (std::vector<MappedChunk>::iterator it = m_chunks.begin();
+              it != m_chunks.end(); ++it)
+        os_munmap(&it->win32mmap, it->ptr, it->size);
+      m_chunks.clear();
+      m_mapped_size = 0;
+
+      // Win32: the file can only be truncated if it is no longer mapped
+      if (m_reserved_size > m_file_size)
+        os_truncate(m_fd, m_file_size);
+      m_reserved_size = m_file_size;
 
       os_close(m_fd);
       m_fd = HAM_INVALID_FD;
@@ -80,9 +127,10 @@ class DiskDevice : public Device {
       os_flush(m_fd);
     }
 
-    // truncate/resize the device
+    // truncate/resize the device; also releases the reserved space
     virtual void truncate(ham_u64_t newsize) {
       os_truncate(m_fd, newsize);
+      m_file_size = m_reserved_size = newsize;
     }
 
     // returns true if the device is open
@@ -90,9 +138,10 @@ class DiskDevice : public Device {
       return (HAM_INVALID_FD != m_fd);
     }
 
-    // get the current file/storage size
+    // get the current file/storage size; does not include the reserved
+    // space
     virtual ham_u64_t get_file_size() {
-      return (os_get_file_size(m_fd));
+      return (m_file_size);
     }
 
     // seek to a position in a file
@@ -110,6 +159,12 @@ class DiskDevice : public Device {
       os_pread(m_fd, offset, buffer, size);
     }
 
+    // advises the device that a range will be read soon; the kernel then
+    // reads the data in the background. Also works for the mapped area.
+    virtual void prefetch(ham_u64_t offset, ham_u64_t size) {
+      os_readahead(m_fd, offset, size);
+    }
+
     // writes to the device; this function does not use mmap,
     // and is responsible for writing the data is run through the file
     // filters
@@ -122,13 +177,17 @@ class DiskDevice : public Device {
     virtual void read_page(Page *page, ham_u32_t page_size) {
       // if this page is in the mapped area: return a pointer into that area.
       // otherwise fall back to read/write.
-      if (page->get_address() < m_mapped_size && m_mmapptr != 0) {
+      ham_u8_t *mapped = get_mapped_ptr(page->get_address(), page_size);
+      if (mapped) {
         // ok, this page is mapped. If the Page object has a memory buffer:
         // free it
         ham_assert(m_env->is_encryption_enabled() == false);
-        Memory::release(page->get_data());
-        page->set_flags(page->get_flags() & ~Page::kNpersMalloc);
-        page->set_data((PPageData *)&m_mmapptr[page->get_address()]);
+        if (page->get_flags() & Page::kNpersMalloc) {
+          Memory::release(page->get_data());
+          page->set_flags(page->get_flags() & ~Page::kNpersMalloc);
+        }
+        page->set_data((PPageData *)mapped);
+        m_page_count_mapped++;
         return;
       }
 
@@ -140,6 +199,7 @@ class DiskDevice : public Device {
       }
 
       os_pread(m_fd, page->get_address(), page->get_data(), page_size);
+      m_page_count_malloced++;
     }
 
     // writes a page to the device
@@ -150,17 +210,21 @@ class DiskDevice : public Device {
     // allocate storage from this device; this function
     // will *NOT* return mmapped memory
     virtual ham_u64_t alloc(ham_u32_t size) {
-      ham_u64_t address = os_get_file_size(m_fd);
-      os_truncate(m_fd, address + size);
+      ham_u64_t address = m_file_size;
+      reserve(address + size);
+      m_file_size += size;
       return (address);
     }
 
-    // Allocates storage for a page from this device; this function
-    // will *NOT* return mmapped memory
+    // Allocates storage for a page from this device; the page is mapped
+    // if the file grew sufficiently, otherwise a buffer is allocated
     virtual void alloc_page(Page *page, ham_u32_t page_size) {
-      ham_u64_t pos = os_get_file_size(m_fd);
+      ham_u64_t pos = m_file_size;
 
-      os_truncate(m_fd, pos + page_size);
+      reserve(pos + page_size);
+      m_file_size += page_size;
+      if (!(m_flags & HAM_DISABLE_MMAP))
+        grow_mapping(m_reserved_size, page_size);
       page->set_address(pos);
       read_page(page, page_size);
     }
@@ -174,19 +238,115 @@ class DiskDevice : public Device {
       page->set_data(0);
     }
 
+    // Fills in the current metrics
+    virtual void get_metrics(ham_env_metrics_t *metrics) const {
+      metrics->page_count_mapped = m_page_count_mapped;
+      metrics->page_count_malloced = m_page_count_malloced;
+    }
+
   private:
+    // Grows the file to at least |size| bytes. If a growth size was
+    // configured then the file grows by at least a full extent.
+    void reserve(ham_u64_t size) {
+      if (size <= m_reserved_size)
+        return;
+
+      if (m_growth_size) {
+        size = std::max(size, m_reserved_size + m_growth_size);
+        os_allocate(m_fd, m_reserved_size, size - m_reserved_size);
+      }
+      else
+        os_truncate(m_fd, size);
+      m_reserved_size = size;
+    }
+
+    // Maps the range of the file between |m_mapped_size| and |file_size|
+    void map_file(ham_u64_t file_size) {
+      // make sure we do not exceed the "real" size of the file, otherwise
+      // we run into issues when accessing that memory (at least on windows)
+      file_size -= file_size % os_get_granularity();
+      if (file_size <= m_mapped_size)
+        return;
+
+      MappedChunk chunk(m_mapped_size, file_size - m_mapped_size);
+      os_mmap(m_fd, &chunk.win32mmap, chunk.offset, chunk.size,
+                    (m_flags & HAM_READ_ONLY) != 0, &chunk.ptr);
+      m_chunks.push_back(chunk);
+      m_mapped_size = file_size;
+    }
+
+    // Maps the newly allocated range of the file if it is large enough
+    // to avoid excessive numbers of mappings
+    void grow_mapping(ham_u64_t file_size, ham_u32_t page_size) {
+      // Pages which were read before their range was mapped stay in
+      // malloc'ed buffers and are written with pwrite. This is only safe
+      // if they do not share an OS page with a mapped (and therefore
+      // possibly copied-on-write) Page.
+      if (page_size % os_get_granularity())
+        return;
+
+      ham_u64_t min_size = std::min(std::max(m_mapped_size / 8,
+                              (ham_u64_t)kMinMapChunk),
+                      (ham_u64_t)kMaxMapChunk);
+      if (file_size < m_mapped_size + min_size)
+        return;
+
+      try {
+        map_file(file_size);
+      }
+      catch (Exception &) {
+        // continue with read/write, i.e. if the address space is exhausted
+        m_flags |= HAM_DISABLE_MMAP;
+      }
+    }
+
+    // Returns a pointer to the mapped memory of a range, or null if the
+    // range is not mapped
+    ham_u8_t *get_mapped_ptr(ham_u64_t address, ham_u32_t size) const {
+      if (address + size > m_mapped_size)
+        return (0);
+
+      // the chunks are sorted by their offsets; find the last chunk which
+      // starts at or before |address|
+      std::vector<MappedChunk>::const_iterator it;
+      it = std::upper_bound(m_chunks.begin(), m_chunks.end(),
+                      MappedChunk(address, 0));
+      ham_assert(it != m_chunks.begin());
+      --it;
+
+      // a range must not span two chunks
+      if (address + size > it->offset + it->size)
+        return (0);
+      return (it->ptr + (address - it->offset));
+    }
+
     // the file handle
     ham_fd_t m_fd;
 
-    // the win32 mmap handle
-    ham_fd_t m_win32mmap;
+    // the size of the file which is in use
+    ham_u64_t m_file_size;
+
+    // the physical size of the file; larger than |m_file_size| if
+    // space was reserved
+    ham_u64_t m_reserved_size;
 
-    // pointer to the the mmapped data
-    ham_u8_t *m_mmapptr;
+    // the size of the extents which are reserved; 0 if the file grows
+    // page by page
+    ham_u64_t m_growth_size;
 
-    // the size of m_mmapptr as used in os_mmap
+    // the mapped chunks, sorted by their file offsets
+    std::vector<MappedChunk> m_chunks;
+
+    // the size of the mapped range; the chunks are contiguous, starting
+    // at offset 0
     ham_u64_t m_mapped_size;
 
+    // number of pages which were served from the mapped range
+    ham_u64_t m_page_count_mapped;
+
+    // number of pages which were read into malloc'ed buffers
+    ham_u64_t m_page_count_malloced;
+
     // dynamic byte array providing temporary space for encryption
     ByteArray m_encryption_buffer;
 };
@@ -89,6 +89,14 @@ class InMemoryDevice : public Device {
       throw Exception(HAM_NOT_IMPLEMENTED);
     }
 
+    // advises the device that a range will be read soon; nothing to do
+    virtual void prefetch(ham_u64_t offset, ham_u64_t size) {
+    }
+
+    // Fills in the current metrics; in-memory pages are never mapped
+    virtual void get_metrics(ham_env_metrics_t *metrics) const {
+    }
+
     // writes to the device 
     virtual void write(ham_u64_t offset, void *buffer, ham_u64_t size) {
       ham_assert(!"operation is not possible for in-memory-databases");
@@ -93,8 +93,9 @@ class Environment
       m_context = ctxt;
     }
 
-    // Returns this Environment's mutex
-    Mutex &get_mutex() {
+    // Returns this Environment's mutex; read-only operations acquire a
+    // shared lock if HAM_ENABLE_CONCURRENT_READS is set
+    RwMutex &get_mutex() {
       return (m_mutex);
     }
 
@@ -153,7 +154,7 @@ class Environment
 
   protected:
     // A mutex to serialize access to this Environment
-    Mutex m_mutex;
+    RwMutex m_mutex;
 
     // The filename/url of this environment
     std::string m_filename;
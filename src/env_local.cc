@@ -21,6 +21,7 @@
 #include "db.h"
 #include "btree_index.h"
 #include "btree_stats.h"
+#include "compressor_factory.h"
 #include "device_factory.h"
 #include "blob_manager_factory.h"
 #include "page_manager.h"
@@ -47,7 +48,10 @@ LocalEnvironment::get_btree_descriptor(int i)
 LocalEnvironment::LocalEnvironment()
   : Environment(), m_header(0), m_device(0), m_changeset(this),
     m_blob_manager(0), m_page_manager(0), m_journal(0), 
-    m_encryption_enabled(false), m_page_size(0)
+    m_encryption_enabled(false), m_page_size(0),
+    m_cache_policy(HAM_CACHE_POLICY_LRU), m_flusher_high_watermark(0),
+    m_flusher_low_watermark(0), m_file_growth_size(0),
+    m_journal_size_limit(0), m_journal_compression(HAM_COMPRESSOR_NONE)
 {
 }
 
@@ -118,6 +122,11 @@ LocalEnvironment::create(const char *filename, ham_u32_t flags,
   if (get_flags() & HAM_ENABLE_RECOVERY)
     m_page_manager->flush_page(m_header->get_header_page());
 
+  /* start the background flusher */
+  if (m_flusher_high_watermark && !(get_flags() & HAM_IN_MEMORY))
+    m_page_manager->start_flusher(m_flusher_high_watermark,
+                    m_flusher_low_watermark);
+
   return (0);
 }
 
@@ -242,6 +251,11 @@ fail_with_fake_cleansing:
       get_changeset().clear();
   }
 
+  /* start the background flusher; nothing to do in read-only mode */
+  if (m_flusher_high_watermark && !(get_flags() & HAM_READ_ONLY))
+    m_page_manager->start_flusher(m_flusher_high_watermark,
+                    m_flusher_low_watermark);
+
   return (0);
 }
 
@@ -385,6 +399,10 @@ LocalEnvironment::close(ham_u32_t flags)
   ham_status_t st;
   Device *device = get_device();
 
+  /* stop the background flusher; all pages are flushed below */
+  if (m_page_manager)
+    m_page_manager->stop_flusher();
+
   /* flush all committed transactions */
   if (get_txn_manager())
     get_txn_manager()->flush_committed_txns();
@@ -525,7 +543,22 @@ LocalEnvironment::get_parameters(ham_parameter_t *param)
           p->value = 0;
         break;
       case HAM_PARAM_JOURNAL_COMPRESSION:
-        p->value = 0;
+        p->value = m_journal_compression;
+        break;
+      case HAM_PARAM_CACHE_POLICY:
+        p->value = m_cache_policy;
+        break;
+      case HAM_PARAM_FLUSHER_HIGH_WATERMARK:
+        p->value = m_flusher_high_watermark;
+        break;
+      case HAM_PARAM_FLUSHER_LOW_WATERMARK:
+        p->value = m_flusher_low_watermark;
+        break;
+      case HAM_PARAM_FILE_GROWTH_SIZE:
+        p->value = m_file_growth_size;
+        break;
+      case HAM_PARAM_JOURNAL_SIZE_LIMIT:
+        p->value = m_journal_size_limit;
         break;
       default:
         ham_trace(("unknown parameter %d", (int)p->name));
@@ -570,6 +603,8 @@ LocalEnvironment::create_db(Database **pdb, ham_u16_t dbname,
   ham_u16_t key_type = HAM_TYPE_BINARY;
   ham_u32_t key_size = HAM_KEY_SIZE_UNLIMITED;
   ham_u32_t rec_size = HAM_RECORD_SIZE_UNLIMITED;
+  int record_compression = 0;
+  int key_compression = 0;
   ham_u16_t dbi;
   std::string logdir;
 
@@ -584,8 +619,27 @@ LocalEnvironment::create_db(Database **pdb, ham_u16_t dbname,
     for (; param->name; param++) {
       switch (param->name) {
         case HAM_PARAM_RECORD_COMPRESSION:
-          ham_trace(("Record compression is only available in hamsterdb pro"));
-          return (HAM_NOT_IMPLEMENTED);
+          if (get_flags() & HAM_IN_MEMORY) {
+            ham_trace(("Record compression is not allowed for In-Memory "
+                       "Environments"));
+            return (HAM_INV_PARAMETER);
+          }
+          if (param->value
+              && !CompressorFactory::is_available((int)param->value)) {
+            ham_trace(("unknown or unavailable record compression %d",
+                       (int)param->value));
+            return (HAM_NOT_IMPLEMENTED);
+          }
+          record_compression = (int)param->value;
+          break;
+        case HAM_PARAM_KEY_COMPRESSION:
+          if (param->value && param->value != HAM_COMPRESSOR_PREFIX) {
+            ham_trace(("unknown or unavailable key compression %d",
+                       (int)param->value));
+            return (HAM_NOT_IMPLEMENTED);
+          }
+          key_compression = (int)param->value;
+          break;
         case HAM_PARAM_KEY_TYPE:
           key_type = (ham_u16_t)param->value;
           break;
@@ -631,6 +685,16 @@ LocalEnvironment::create_db(Database **pdb, ham_u16_t dbname,
   if (flags & HAM_RECORD_NUMBER)
     key_type = HAM_TYPE_UINT64;
 
+  /* prefix compression is only implemented for variable length
+   * binary keys */
+  if (key_compression
+        && (key_type != HAM_TYPE_BINARY
+            || key_size != HAM_KEY_SIZE_UNLIMITED)) {
+    ham_trace(("HAM_COMPRESSOR_PREFIX requires variable length keys of "
+                    "type HAM_TYPE_BINARY"));
+    return (HAM_INV_PARAMETER);
+  }
+
   ham_u32_t mask = HAM_FORCE_RECORDS_INLINE
                     | HAM_FLUSH_WHEN_COMMITTED
                     | HAM_ENABLE_DUPLICATE_KEYS
@@ -676,6 +740,8 @@ LocalEnvironment::create_db(Database **pdb, ham_u16_t dbname,
 #endif
 
   /* initialize the Database */
+  db->set_record_compression(record_compression);
+  db->set_key_compression(key_compression);
   ham_status_t st = db->create(dbi, key_type, key_size, rec_size);
   if (st) {
     delete db;
@@ -719,8 +785,13 @@ LocalEnvironment::open_db(Database **pdb, ham_u16_t dbname,
     for (; param->name; param++) {
       switch (param->name) {
         case HAM_PARAM_RECORD_COMPRESSION:
-          ham_trace(("Record compression is only available in hamsterdb pro"));
-          return (HAM_NOT_IMPLEMENTED);
+          ham_trace(("Record compression is persistent and can only be "
+                     "specified when the Database is created"));
+          return (HAM_INV_PARAMETER);
+        case HAM_PARAM_KEY_COMPRESSION:
+          ham_trace(("Key compression is persistent and can only be "
+                     "specified when the Database is created"));
+          return (HAM_INV_PARAMETER);
         default:
           ham_trace(("invalid parameter 0x%x (%d)", param->name, param->name));
           return (HAM_INV_PARAMETER);
@@ -814,12 +885,9 @@ bail:
     throw Exception(st);
   }
 
-  /* done with recovering - if there's no log and/or no journal then
-   * create them and store them in the environment */
-  if (!(get_flags() & HAM_ENABLE_TRANSACTIONS)) {
-    delete m_journal;
-    m_journal = 0;
-  }
+  /* done with recovering - the journal is kept even if Transactions are
+   * disabled (like in create()), because the Changeset is logged to the
+   * journal */
 
   /* reset the page manager */
   m_page_manager->close();
@@ -830,6 +898,8 @@ LocalEnvironment::get_metrics(ham_env_metrics_t *metrics) const
 {
   // PageManager metrics (incl. cache and freelist)
   m_page_manager->get_metrics(metrics);
+  // the Device (mapped vs. malloc'ed pages)
+  m_device->get_metrics(metrics);
   // the BlobManagers
   m_blob_manager->get_metrics(metrics);
   // the Journal (if available)
@@ -837,6 +907,8 @@ LocalEnvironment::get_metrics(ham_env_metrics_t *metrics) const
     m_journal->get_metrics(metrics);
   // and of the btrees
   BtreeIndex::get_metrics(metrics);
+  // and of the Transaction allocators
+  TransactionArena::get_metrics(metrics);
 }
 
 ham_u64_t
@@ -117,6 +117,70 @@ class LocalEnvironment : public Environment
       m_log_directory = dir;
     }
 
+    // Returns the replacement policy of the cache (HAM_CACHE_POLICY_*)
+    ham_u32_t get_cache_policy() const {
+      return (m_cache_policy);
+    }
+
+    // Sets the replacement policy of the cache; must be called before the
+    // Environment is created or opened
+    void set_cache_policy(ham_u32_t policy) {
+      m_cache_policy = policy;
+    }
+
+    // Returns the high watermark of the background flusher (in percent
+    // of the cache capacity); 0 if the flusher is disabled
+    ham_u32_t get_flusher_high_watermark() const {
+      return (m_flusher_high_watermark);
+    }
+
+    // Returns the low watermark of the background flusher
+    ham_u32_t get_flusher_low_watermark() const {
+      return (m_flusher_low_watermark);
+    }
+
+    // Sets the watermarks of the background flusher; must be called before
+    // the Environment is created or opened
+    void set_flusher_watermarks(ham_u32_t high, ham_u32_t low) {
+      m_flusher_high_watermark = high;
+      m_flusher_low_watermark = low;
+    }
+
+    // Returns the size of the extents in which the file grows; 0 if the
+    // file grows page by page
+    ham_u64_t get_file_growth_size() const {
+      return (m_file_growth_size);
+    }
+
+    // Sets the size of the extents in which the file grows; must be called
+    // before the Environment is created or opened
+    void set_file_growth_size(ham_u64_t size) {
+      m_file_growth_size = size;
+    }
+
+    // Returns the approximate maximum size of the journal files; 0 if
+    // the size is unlimited
+    ham_u64_t get_journal_size_limit() const {
+      return (m_journal_size_limit);
+    }
+
+    // Sets the approximate maximum size of the journal files; must be
+    // called before the Environment is created or opened
+    void set_journal_size_limit(ham_u64_t size) {
+      m_journal_size_limit = size;
+    }
+
+    // Returns the compression algorithm of the journal (HAM_COMPRESSOR_*)
+    int get_journal_compression() const {
+      return (m_journal_compression);
+    }
+
+    // Sets the compression algorithm of the journal; must be called before
+    // the Environment is created or opened
+    void set_journal_compression(int algorithm) {
+      m_journal_compression = algorithm;
+    }
+
     // Enables AES encryption
     void enable_encryption(const ham_u8_t *key) {
       m_encryption_enabled = true;
@@ -210,6 +274,22 @@ class LocalEnvironment : public Environment
 
     // The page_size which was specified when the env was created
     ham_u32_t m_page_size;
+
+    // The replacement policy of the cache (HAM_CACHE_POLICY_*)
+    ham_u32_t m_cache_policy;
+
+    // The watermarks of the background flusher
+    ham_u32_t m_flusher_high_watermark;
+    ham_u32_t m_flusher_low_watermark;
+
+    // The size of the extents in which the file grows
+    ham_u64_t m_file_growth_size;
+
+    // The approximate maximum size of the journal files
+    ham_u64_t m_journal_size_limit;
+
+    // The compression algorithm of the journal
+    int m_journal_compression;
 };
 
 } // namespace hamsterdb
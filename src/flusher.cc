@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) 2005-2014 Christoph Rupp (chris@crupp.de).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+#include <algorithm>
+#include <boost/bind.hpp>
+
+#include "page.h"
+#include "cache.h"
+#include "device.h"
+#include "env_local.h"
+#include "flusher.h"
+
+namespace hamsterdb {
+
+Flusher::Flusher(LocalEnvironment *env, Cache *cache,
+                ham_u32_t high_watermark, ham_u32_t low_watermark)
+  : m_env(env), m_cache(cache), m_high_watermark(high_watermark),
+    m_low_watermark(low_watermark), m_stop(false), m_wakeup(false),
+    m_runs(0), m_pages_flushed(0),
+    m_thread(boost::bind(&Flusher::run, this))
+{
+  ham_assert(low_watermark < high_watermark);
+}
+
+Flusher::~Flusher()
+{
+  {
+    ScopedLock lock(m_mutex);
+    m_stop = true;
+  }
+  m_cond.notify_one();
+  m_thread.join();
+}
+
+void
+Flusher::wakeup()
+{
+  {
+    ScopedLock lock(m_mutex);
+    m_wakeup = true;
+  }
+  m_cond.notify_one();
+}
+
+void
+Flusher::run()
+{
+  while (true) {
+    {
+      ScopedLock lock(m_mutex);
+      if (!m_stop && !m_wakeup)
+        m_cond.timed_wait(lock,
+                boost::posix_time::milliseconds((long)kIntervalMsec));
+      if (m_stop)
+        return;
+      m_wakeup = false;
+    }
+
+    try {
+      (void)run_once();
+    }
+    catch (Exception &ex) {
+      ham_log(("background flusher failed with error %d", ex.code));
+    }
+  }
+}
+
+ham_u32_t
+Flusher::run_once()
+{
+  ham_u32_t total = 0;
+
+  // once the high watermark was crossed: continue till the number of
+  // dirty pages dropped to the low watermark
+  while (!is_stopped()) {
+    ham_u32_t count = flush_batch(total ? m_low_watermark : m_high_watermark);
+    if (count == 0)
+      break;
+    total += count;
+  }
+
+  if (total) {
+    ScopedLock lock(m_mutex);
+    m_runs++;
+  }
+  return (total);
+}
+
+ham_u32_t
+Flusher::flush_batch(ham_u32_t watermark)
+{
+  // do not block forever; the Environment may wait for this thread while
+  // it is being closed
+  ExclusiveLock env_lock(m_env->get_mutex(), boost::defer_lock);
+  while (!env_lock.timed_lock(
+                boost::posix_time::milliseconds((long)kLockTimeoutMsec))) {
+    if (is_stopped())
+      return (0);
+  }
+
+  // |m_io_mutex| protects the buffer and the pinned pages till they were
+  // written. It stays locked after the Environment was unlocked, otherwise
+  // another thread could delete the pinned pages
+  ScopedLock io_lock(m_io_mutex);
+
+  ham_u32_t page_size = m_env->get_page_size();
+  ham_u64_t capacity = m_cache->get_capacity() / page_size;
+  if (capacity == 0)
+    capacity = 1;
+
+  m_pages.clear();
+  m_cache->get_dirty_pages(m_pages);
+  ham_u64_t dirty = m_pages.size();
+  ham_u64_t target = capacity * m_low_watermark / 100;
+  if (dirty * 100 < capacity * watermark || dirty <= target)
+    return (0);
+
+  ham_u32_t count = (ham_u32_t)std::min(dirty - target,
+                        (ham_u64_t)kMaxBatchPages);
+  m_pages.resize(count);
+
+  // copy and pin the pages; they are clean as soon as the copy exists
+  m_buffer.resize(count * page_size);
+  ham_u8_t *p = (ham_u8_t *)m_buffer.get_ptr();
+  for (ham_u32_t i = 0; i < count; i++) {
+    ::memcpy(p + i * page_size, m_pages[i]->get_data(), page_size);
+    m_cache->pin_page(m_pages[i]);
+    m_pages[i]->set_dirty(false);
+  }
+
+  env_lock.unlock();
+
+  ham_u32_t i = 0;
+  try {
+    for (; i < count; i++)
+      m_env->get_device()->write(m_pages[i]->get_address(),
+                      p + i * page_size, page_size);
+  }
+  catch (Exception &) {
+    // the remaining pages were not written. Nobody else resets the dirty
+    // flag while |m_io_mutex| is locked (see PageManager::flush_page())
+    for (; i < count; i++)
+      m_pages[i]->set_dirty(true);
+    for (i = 0; i < count; i++)
+      m_cache->unpin_page(m_pages[i]);
+    throw;
+  }
+
+  for (i = 0; i < count; i++)
+    m_cache->unpin_page(m_pages[i]);
+
+  ScopedLock lock(m_mutex);
+  m_pages_flushed += count;
+  return (count);
+}
+
+void
+Flusher::get_metrics(ham_env_metrics_t *metrics) const
+{
+  ScopedLock lock(m_mutex);
+  metrics->flusher_runs = m_runs;
+  metrics->flusher_pages_flushed = m_pages_flushed;
+}
+
+} // namespace hamsterdb
@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2005-2014 Christoph Rupp (chris@crupp.de).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * The background flusher
+ *
+ * A thread which writes dirty pages to disk, therefore the foreground
+ * threads can purge clean pages from the cache without blocking on write
+ * I/O. The flusher wakes up periodically, or when PageManager::purge_cache()
+ * skipped dirty pages. If the number of dirty pages exceeds the high
+ * watermark (in percent of the cache capacity) then the least recently
+ * used dirty pages are written till their number drops to the low
+ * watermark.
+ *
+ * The pages are copied while the Environment is locked, and the copies
+ * are written after the lock was released. The pages stay pinned till
+ * the write completed, therefore they cannot be purged in the meantime.
+ * Everything which writes or deletes cached pages has to call wait_for_io()
+ * before.
+ */
+
+#ifndef HAM_FLUSHER_H__
+#define HAM_FLUSHER_H__
+
+#include <vector>
+
+#include "ham/hamsterdb_int.h"
+
+#include "mutex.h"
+#include "util.h"
+
+namespace hamsterdb {
+
+class Page;
+class Cache;
+class LocalEnvironment;
+
+class Flusher
+{
+  public:
+    enum {
+      // the watermarks are checked at least every |kIntervalMsec| msec
+      kIntervalMsec = 100,
+
+      // timeout when waiting for the Environment lock; afterwards the
+      // thread checks if it was stopped
+      kLockTimeoutMsec = 10,
+
+      // the maximum number of pages which are written while the
+      // Environment is unlocked
+      kMaxBatchPages = 64
+    };
+
+    // Constructor; starts the thread. The watermarks are in percent of
+    // the cache capacity
+    Flusher(LocalEnvironment *env, Cache *cache, ham_u32_t high_watermark,
+                    ham_u32_t low_watermark);
+
+    // Destructor; stops the thread and waits till it terminated
+    ~Flusher();
+
+    // Wakes up the thread, i.e. if the cache is full
+    void wakeup();
+
+    // Blocks till the pages of the current run were written; the caller
+    // has to hold the Environment lock
+    void wait_for_io() {
+      ScopedLock lock(m_io_mutex);
+    }
+
+    // Writes dirty pages if the high watermark is exceeded, till the low
+    // watermark is reached; returns the number of written pages. The caller
+    // must not hold the Environment lock. Used by the thread, but also by
+    // the unittests.
+    ham_u32_t run_once();
+
+    // Fills in the current metrics
+    void get_metrics(ham_env_metrics_t *metrics) const;
+
+  private:
+    // The thread's main function
+    void run();
+
+    // Writes up to |kMaxBatchPages| of the least recently used dirty
+    // pages if the number of dirty pages exceeds |watermark| percent of
+    // the cache capacity; returns the number of written pages
+    ham_u32_t flush_batch(ham_u32_t watermark);
+
+    // Returns true if the thread should terminate
+    bool is_stopped() {
+      ScopedLock lock(m_mutex);
+      return (m_stop);
+    }
+
+    // the current Environment
+    LocalEnvironment *m_env;
+
+    // the Cache of the PageManager
+    Cache *m_cache;
+
+    // the high watermark, in percent of the cache capacity
+    ham_u32_t m_high_watermark;
+
+    // the low watermark, in percent of the cache capacity
+    ham_u32_t m_low_watermark;
+
+    // protects |m_stop|, |m_wakeup| and the metrics
+    mutable Mutex m_mutex;
+
+    // signals the thread
+    Condition m_cond;
+
+    // true if the thread should terminate
+    bool m_stop;
+
+    // true if the thread was woken up
+    bool m_wakeup;
+
+    // locked while the copied pages are written
+    Mutex m_io_mutex;
+
+    // the copies of the pages
+    ByteArray m_buffer;
+
+    // the pinned pages of the current run
+    std::vector<Page *> m_pages;
+
+    // number of runs which wrote pages
+    ham_u64_t m_runs;
+
+    // number of pages written by the flusher
+    ham_u64_t m_pages_flushed;
+
+    // the thread; must be initialized last
+    Thread m_thread;
+};
+
+} // namespace hamsterdb
+
+#endif /* HAM_FLUSHER_H__ */
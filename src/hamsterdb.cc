@@ -30,6 +30,7 @@
 #include "blob_manager.h"
 #include "btree_index.h"
 #include "btree_cursor.h"
+#include "compressor_factory.h"
 #include "cursor.h"
 #include "db.h"
 #include "device.h"
@@ -41,6 +42,7 @@
 #include "mem.h"
 #include "os.h"
 #include "page.h"
+#include "page_manager.h"
 #include "serial.h"
 #include "btree_stats.h"
 #include "txn.h"
@@ -78,9 +80,9 @@ ham_txn_begin(ham_txn_t **htxn, ham_env_t *henv, const char *name,
   Environment *env = (Environment *)henv;
 
   try {
-    ScopedLock lock;
+    ExclusiveLock lock;
     if (!(flags & HAM_DONT_LOCK))
-      lock = ScopedLock(env->get_mutex());
+      lock = ExclusiveLock(env->get_mutex());
 
     if (!(env->get_flags() & HAM_ENABLE_TRANSACTIONS)) {
       ham_trace(("transactions are disabled (see HAM_ENABLE_TRANSACTIONS)"));
@@ -104,7 +106,7 @@ ham_txn_get_name(ham_txn_t *htxn)
     return (0);
 
   try {
-    ScopedLock lock(txn->get_env()->get_mutex());
+    ExclusiveLock lock(txn->get_env()->get_mutex());
     const std::string &name = txn->get_name();
     if (name.empty())
       return 0;
@@ -128,11 +130,17 @@ ham_txn_commit(ham_txn_t *htxn, ham_u32_t flags)
   Environment *env = txn->get_env();
 
   try {
-    ScopedLock lock;
-    if (!(flags & HAM_DONT_LOCK))
-      lock = ScopedLock(env->get_mutex());
+    {
+      ExclusiveLock lock;
+      if (!(flags & HAM_DONT_LOCK))
+        lock = ExclusiveLock(env->get_mutex());
+
+      env->get_txn_manager()->commit(txn, flags);
+    }
 
-    env->get_txn_manager()->commit(txn, flags);
+    // the journal is synced without holding the lock, therefore the
+    // commits of concurrent threads can share a single fsync
+    env->get_txn_manager()->sync_journal();
     return (0);
   }
   catch (Exception &ex) {
@@ -152,9 +160,9 @@ ham_txn_abort(ham_txn_t *htxn, ham_u32_t flags)
   Environment *env = txn->get_env();
 
   try {
-    ScopedLock lock;
+    ExclusiveLock lock;
     if (!(flags & HAM_DONT_LOCK))
-      lock = ScopedLock(env->get_mutex());
+      lock = ExclusiveLock(env->get_mutex());
 
     env->get_txn_manager()->abort(txn, flags);
     return (0);
@@ -299,6 +307,61 @@ __prepare_record(ham_record_t *record)
   return (true);
 }
 
+/**
+ * Checks whether a key of a Record Number Database is initialized
+ * correctly for an insert operation.
+ */
+static bool
+__prepare_recno_key(ham_key_t *key, ham_u32_t flags)
+{
+  if (flags & HAM_OVERWRITE) {
+    if (key->size != sizeof(ham_u64_t) || !key->data) {
+      ham_trace(("key->size must be 8, key->data must not be NULL"));
+      return (false);
+    }
+  }
+  else {
+    if (key->flags & HAM_KEY_USER_ALLOC) {
+      if (!key->data || key->size != sizeof(ham_u64_t)) {
+        ham_trace(("key->size must be 8, key->data must not "
+              "be NULL"));
+        return (false);
+      }
+    }
+    else {
+      if (key->data || key->size) {
+        ham_trace(("key->size must be 0, key->data must be NULL"));
+        return (false);
+      }
+    }
+  }
+  return (true);
+}
+
+/*
+ * Locks the Environment for a read-only operation (ham_db_find,
+ * ham_cursor_find, ham_cursor_move).
+ *
+ * If HAM_ENABLE_CONCURRENT_READS is set then the lock is shared with
+ * other readers. Readers must not purge the cache, therefore the cache
+ * is purged (with an exclusive lock) before the shared lock is acquired.
+ */
+static void
+__lock_for_reading(Environment *env, ExclusiveLock &xlock, SharedLock &slock)
+{
+  if (!(env->get_flags() & HAM_ENABLE_CONCURRENT_READS)) {
+    xlock = ExclusiveLock(env->get_mutex());
+    return;
+  }
+
+  PageManager *pm = ((LocalEnvironment *)env)->get_page_manager();
+  if (!(env->get_flags() & HAM_IN_MEMORY) && pm->cache_is_full()) {
+    ExclusiveLock lock(env->get_mutex());
+    pm->purge_cache();
+  }
+  slock = SharedLock(env->get_mutex());
+}
+
 void HAM_CALLCONV
 ham_get_version(ham_u32_t *major, ham_u32_t *minor,
         ham_u32_t *revision)
@@ -328,6 +391,12 @@ ham_env_create(ham_env_t **henv, const char *filename,
   ham_u64_t cache_size = 0;
   ham_u16_t max_databases = 0;
   ham_u32_t timeout = 0;
+  ham_u32_t cache_policy = HAM_CACHE_POLICY_LRU;
+  ham_u32_t flusher_high = 0;
+  ham_u32_t flusher_low = 0;
+  ham_u64_t file_growth_size = 0;
+  ham_u64_t journal_size_limit = 0;
+  int journal_compression = HAM_COMPRESSOR_NONE;
   std::string logdir;
   ham_u8_t *encryption_key = 0;
 
@@ -364,12 +433,27 @@ ham_env_create(ham_env_t **henv, const char *filename,
   if (flags & HAM_IN_MEMORY)
     flags &= ~HAM_ENABLE_RECOVERY;
 
+  /* concurrent reads are not supported in combination with Transactions
+   * or recovery */
+  if ((flags & HAM_ENABLE_CONCURRENT_READS)
+      && (flags & (HAM_ENABLE_TRANSACTIONS | HAM_ENABLE_RECOVERY))) {
+    ham_trace(("combination of HAM_ENABLE_CONCURRENT_READS and "
+            "Transactions/recovery not allowed"));
+    return (HAM_INV_PARAMETER);
+  }
+
   if (param) {
     for (; param->name; param++) {
       switch (param->name) {
       case HAM_PARAM_JOURNAL_COMPRESSION:
-        ham_trace(("Journal compression is only available in hamsterdb pro"));
-        return (HAM_NOT_IMPLEMENTED);
+        if (param->value != HAM_COMPRESSOR_NONE
+            && !CompressorFactory::is_available((int)param->value)) {
+          ham_trace(("unknown or unavailable compressor %d",
+                  (int)param->value));
+          return (HAM_NOT_IMPLEMENTED);
+        }
+        journal_compression = (int)param->value;
+        break;
       case HAM_PARAM_CACHESIZE:
         cache_size = param->value;
         if (flags & HAM_IN_MEMORY && cache_size != 0) {
@@ -391,6 +475,32 @@ ham_env_create(ham_env_t **henv, const char *filename,
       case HAM_PARAM_NETWORK_TIMEOUT_SEC:
         timeout = (ham_u32_t)param->value;
         break;
+      case HAM_PARAM_CACHE_POLICY:
+        if (param->value != HAM_CACHE_POLICY_LRU
+            && param->value != HAM_CACHE_POLICY_2Q) {
+          ham_trace(("invalid cache policy %u", (unsigned)param->value));
+          return (HAM_INV_PARAMETER);
+        }
+        cache_policy = (ham_u32_t)param->value;
+        break;
+      case HAM_PARAM_FLUSHER_HIGH_WATERMARK:
+      case HAM_PARAM_FLUSHER_LOW_WATERMARK:
+        if (param->value > 100) {
+          ham_trace(("invalid flusher watermark %u (must be a percentage)",
+                (unsigned)param->value));
+          return (HAM_INV_PARAMETER);
+        }
+        if (param->name == HAM_PARAM_FLUSHER_HIGH_WATERMARK)
+          flusher_high = (ham_u32_t)param->value;
+        else
+          flusher_low = (ham_u32_t)param->value;
+        break;
+      case HAM_PARAM_FILE_GROWTH_SIZE:
+        file_growth_size = param->value;
+        break;
+      case HAM_PARAM_JOURNAL_SIZE_LIMIT:
+        journal_size_limit = param->value;
+        break;
       case HAM_PARAM_ENCRYPTION_KEY:
         ham_trace(("Encryption is only available in hamsterdb pro"));
         return (HAM_NOT_IMPLEMENTED);
@@ -408,6 +518,45 @@ ham_env_create(ham_env_t **henv, const char *filename,
     return (HAM_INV_PARAMETER);
   }
 
+  /* the background flusher writes to disk; the low watermark defaults
+   * to half of the high watermark */
+  if (flusher_high) {
+    if (flags & HAM_IN_MEMORY) {
+      ham_trace(("combination of HAM_IN_MEMORY and the background flusher "
+            "not allowed"));
+      return (HAM_INV_PARAMETER);
+    }
+    if (flusher_low == 0)
+      flusher_low = flusher_high / 2;
+    if (flusher_low >= flusher_high) {
+      ham_trace(("flusher low watermark must be less than the high "
+            "watermark"));
+      return (HAM_INV_PARAMETER);
+    }
+  }
+  else if (flusher_low) {
+    ham_trace(("flusher low watermark requires a high watermark"));
+    return (HAM_INV_PARAMETER);
+  }
+
+  if (file_growth_size && (flags & HAM_IN_MEMORY)) {
+    ham_trace(("combination of HAM_IN_MEMORY and HAM_PARAM_FILE_GROWTH_SIZE "
+          "not allowed"));
+    return (HAM_INV_PARAMETER);
+  }
+
+  if (journal_size_limit && (flags & HAM_IN_MEMORY)) {
+    ham_trace(("combination of HAM_IN_MEMORY and HAM_PARAM_JOURNAL_SIZE_LIMIT "
+          "not allowed"));
+    return (HAM_INV_PARAMETER);
+  }
+
+  if (journal_compression && (flags & HAM_IN_MEMORY)) {
+    ham_trace(("combination of HAM_IN_MEMORY and HAM_PARAM_JOURNAL_COMPRESSION "
+          "not allowed"));
+    return (HAM_INV_PARAMETER);
+  }
+
   if (cache_size == 0)
     cache_size = HAM_DEFAULT_CACHESIZE;
   if (page_size == 0)
@@ -434,6 +583,11 @@ ham_env_create(ham_env_t **henv, const char *filename,
       env = lenv;
       if (logdir.size())
         lenv->set_log_directory(logdir);
+      lenv->set_cache_policy(cache_policy);
+      lenv->set_flusher_watermarks(flusher_high, flusher_low);
+      lenv->set_file_growth_size(file_growth_size);
+      lenv->set_journal_size_limit(journal_size_limit);
+      lenv->set_journal_compression(journal_compression);
       if (encryption_key)
         lenv->enable_encryption(encryption_key);
     }
@@ -441,6 +595,11 @@ ham_env_create(ham_env_t **henv, const char *filename,
 #ifndef HAM_ENABLE_REMOTE
       return (HAM_NOT_IMPLEMENTED);
 #else // HAM_ENABLE_REMOTE
+      if (flags & HAM_ENABLE_CONCURRENT_READS) {
+        ham_trace(("flag HAM_ENABLE_CONCURRENT_READS is not allowed for "
+                "remote Environments"));
+        return (HAM_INV_PARAMETER);
+      }
       RemoteEnvironment *renv = new RemoteEnvironment();
       if (timeout)
         renv->set_timeout(timeout);
@@ -498,7 +657,7 @@ ham_env_create_db(ham_env_t *henv, ham_db_t **hdb, ham_u16_t dbname,
   }
 
   try {
-    ScopedLock lock(env->get_mutex());
+    ExclusiveLock lock(env->get_mutex());
 
     /* the function handler will do the rest */
     st = env->create_db((Database **)hdb, dbname, flags, param);
@@ -554,9 +713,9 @@ ham_env_open_db(ham_env_t *henv, ham_db_t **hdb, ham_u16_t dbname,
   }
 
   try {
-    ScopedLock lock;
+    ExclusiveLock lock;
     if (!(flags & HAM_DONT_LOCK))
-      lock = ScopedLock(env->get_mutex());
+      lock = ExclusiveLock(env->get_mutex());
 
     /* the function handler will do the rest */
     st = env->open_db((Database **)hdb, dbname, flags, param);
@@ -582,6 +741,12 @@ ham_env_open(ham_env_t **henv, const char *filename, ham_u32_t flags,
 {
   ham_u64_t cache_size = 0;
   ham_u32_t timeout = 0;
+  ham_u32_t cache_policy = HAM_CACHE_POLICY_LRU;
+  ham_u32_t flusher_high = 0;
+  ham_u32_t flusher_low = 0;
+  ham_u64_t file_growth_size = 0;
+  ham_u64_t journal_size_limit = 0;
+  int journal_compression = HAM_COMPRESSOR_NONE;
   std::string logdir;
   ham_u8_t *encryption_key = 0;
 
@@ -615,6 +780,15 @@ ham_env_open(ham_env_t **henv, const char *filename, ham_u32_t flags,
   if (flags & HAM_AUTO_RECOVERY)
     flags |= HAM_ENABLE_RECOVERY;
 
+  /* concurrent reads are not supported in combination with Transactions
+   * or recovery */
+  if ((flags & HAM_ENABLE_CONCURRENT_READS)
+      && (flags & (HAM_ENABLE_TRANSACTIONS | HAM_ENABLE_RECOVERY))) {
+    ham_trace(("combination of HAM_ENABLE_CONCURRENT_READS and "
+            "Transactions/recovery not allowed"));
+    return (HAM_INV_PARAMETER);
+  }
+
   if (!filename && !(flags & HAM_IN_MEMORY)) {
     ham_trace(("filename is missing"));
     return (HAM_INV_PARAMETER);
@@ -624,8 +798,14 @@ ham_env_open(ham_env_t **henv, const char *filename, ham_u32_t flags,
     for (; param->name; param++) {
       switch (param->name) {
       case HAM_PARAM_JOURNAL_COMPRESSION:
-        ham_trace(("Journal compression is only available in hamsterdb pro"));
-        return (HAM_NOT_IMPLEMENTED);
+        if (param->value != HAM_COMPRESSOR_NONE
+            && !CompressorFactory::is_available((int)param->value)) {
+          ham_trace(("unknown or unavailable compressor %d",
+                  (int)param->value));
+          return (HAM_NOT_IMPLEMENTED);
+        }
+        journal_compression = (int)param->value;
+        break;
       case HAM_PARAM_CACHESIZE:
         cache_size = param->value;
         break;
@@ -635,6 +815,32 @@ ham_env_open(ham_env_t **henv, const char *filename, ham_u32_t flags,
       case HAM_PARAM_NETWORK_TIMEOUT_SEC:
         timeout = (ham_u32_t)param->value;
         break;
+      case HAM_PARAM_CACHE_POLICY:
+        if (param->value != HAM_CACHE_POLICY_LRU
+            && param->value != HAM_CACHE_POLICY_2Q) {
+          ham_trace(("invalid cache policy %u", (unsigned)param->value));
+          return (HAM_INV_PARAMETER);
+        }
+        cache_policy = (ham_u32_t)param->value;
+        break;
+      case HAM_PARAM_FLUSHER_HIGH_WATERMARK:
+      case HAM_PARAM_FLUSHER_LOW_WATERMARK:
+        if (param->value > 100) {
+          ham_trace(("invalid flusher watermark %u (must be a percentage)",
+                (unsigned)param->value));
+          return (HAM_INV_PARAMETER);
+        }
+        if (param->name == HAM_PARAM_FLUSHER_HIGH_WATERMARK)
+          flusher_high = (ham_u32_t)param->value;
+        else
+          flusher_low = (ham_u32_t)param->value;
+        break;
+      case HAM_PARAM_FILE_GROWTH_SIZE:
+        file_growth_size = param->value;
+        break;
+      case HAM_PARAM_JOURNAL_SIZE_LIMIT:
+        journal_size_limit = param->value;
+        break;
       case HAM_PARAM_ENCRYPTION_KEY:
         ham_trace(("Encryption is only available in hamsterdb pro"));
         return (HAM_NOT_IMPLEMENTED);
@@ -652,6 +858,45 @@ ham_env_open(ham_env_t **henv, const char *filename, ham_u32_t flags,
     return (HAM_INV_PARAMETER);
   }
 
+  /* the background flusher writes to disk; the low watermark defaults
+   * to half of the high watermark */
+  if (flusher_high) {
+    if (flags & HAM_IN_MEMORY) {
+      ham_trace(("combination of HAM_IN_MEMORY and the background flusher "
+            "not allowed"));
+      return (HAM_INV_PARAMETER);
+    }
+    if (flusher_low == 0)
+      flusher_low = flusher_high / 2;
+    if (flusher_low >= flusher_high) {
+      ham_trace(("flusher low watermark must be less than the high "
+            "watermark"));
+      return (HAM_INV_PARAMETER);
+    }
+  }
+  else if (flusher_low) {
+    ham_trace(("flusher low watermark requires a high watermark"));
+    return (HAM_INV_PARAMETER);
+  }
+
+  if (file_growth_size && (flags & HAM_IN_MEMORY)) {
+    ham_trace(("combination of HAM_IN_MEMORY and HAM_PARAM_FILE_GROWTH_SIZE "
+          "not allowed"));
+    return (HAM_INV_PARAMETER);
+  }
+
+  if (journal_size_limit && (flags & HAM_IN_MEMORY)) {
+    ham_trace(("combination of HAM_IN_MEMORY and HAM_PARAM_JOURNAL_SIZE_LIMIT "
+          "not allowed"));
+    return (HAM_INV_PARAMETER);
+  }
+
+  if (journal_compression && (flags & HAM_IN_MEMORY)) {
+    ham_trace(("combination of HAM_IN_MEMORY and HAM_PARAM_JOURNAL_COMPRESSION "
+          "not allowed"));
+    return (HAM_INV_PARAMETER);
+  }
+
   if (cache_size == 0)
     cache_size = HAM_DEFAULT_CACHESIZE;
 
@@ -664,6 +909,11 @@ ham_env_open(ham_env_t **henv, const char *filename, ham_u32_t flags,
       env = lenv;
       if (logdir.size())
         lenv->set_log_directory(logdir);
+      lenv->set_cache_policy(cache_policy);
+      lenv->set_flusher_watermarks(flusher_high, flusher_low);
+      lenv->set_file_growth_size(file_growth_size);
+      lenv->set_journal_size_limit(journal_size_limit);
+      lenv->set_journal_compression(journal_compression);
       if (encryption_key)
         lenv->enable_encryption(encryption_key);
     }
@@ -671,6 +921,11 @@ ham_env_open(ham_env_t **henv, const char *filename, ham_u32_t flags,
 #ifndef HAM_ENABLE_REMOTE
       return (HAM_NOT_IMPLEMENTED);
 #else // HAM_ENABLE_REMOTE
+      if (flags & HAM_ENABLE_CONCURRENT_READS) {
+        ham_trace(("flag HAM_ENABLE_CONCURRENT_READS is not allowed for "
+                "remote Environments"));
+        return (HAM_INV_PARAMETER);
+      }
       RemoteEnvironment *renv = new RemoteEnvironment();
       if (timeout)
         renv->set_timeout(timeout);
@@ -726,7 +981,7 @@ ham_env_rename_db(ham_env_t *henv, ham_u16_t oldname, ham_u16_t newname,
     return (0);
 
   try {
-    ScopedLock lock(env->get_mutex());
+    ExclusiveLock lock(env->get_mutex());
 
     /* rename the database */
     return (env->rename_db(oldname, newname, flags));
@@ -751,7 +1006,7 @@ ham_env_erase_db(ham_env_t *henv, ham_u16_t name, ham_u32_t flags)
   }
 
   try {
-    ScopedLock lock(env->get_mutex());
+    ExclusiveLock lock(env->get_mutex());
 
     /* erase the database */
     return (env->erase_db(name, flags));
@@ -780,7 +1035,7 @@ ham_env_get_database_names(ham_env_t *henv, ham_u16_t *names, ham_u32_t *count)
   }
 
   try {
-    ScopedLock lock(env->get_mutex());
+    ExclusiveLock lock(env->get_mutex());
 
     /* get all database names */
     return (env->get_database_names(names, count));
@@ -805,7 +1060,7 @@ ham_env_get_parameters(ham_env_t *henv, ham_parameter_t *param)
   }
 
   try {
-    ScopedLock lock(env->get_mutex());
+    ExclusiveLock lock(env->get_mutex());
 
     /* get the parameters */
     return (env->get_parameters(param));
@@ -830,7 +1085,7 @@ ham_env_flush(ham_env_t *henv, ham_u32_t flags)
   }
 
   try {
-    ScopedLock lock = ScopedLock(env->get_mutex());
+    ExclusiveLock lock = ExclusiveLock(env->get_mutex());
 
     /* flush the Environment */
     return (env->flush(flags));
@@ -852,7 +1107,7 @@ ham_env_close(ham_env_t *henv, ham_u32_t flags)
   }
 
   try {
-    ScopedLock lock = ScopedLock(env->get_mutex());
+    ExclusiveLock lock = ExclusiveLock(env->get_mutex());
 
 #ifdef HAM_DEBUG
     /* make sure that the changeset is empty */
@@ -906,7 +1161,7 @@ ham_db_get_parameters(ham_db_t *hdb, ham_parameter_t *param)
   }
 
   try {
-    ScopedLock lock(db->get_env()->get_mutex());
+    ExclusiveLock lock(db->get_env()->get_mutex());
 
     /* get the parameters */
     return (db->get_parameters(param));
@@ -926,9 +1181,9 @@ ham_db_get_error(ham_db_t *hdb)
   }
 
   try {
-    ScopedLock lock;
+    ExclusiveLock lock;
     if (db->get_env())
-      lock = ScopedLock(db->get_env()->get_mutex());
+      lock = ExclusiveLock(db->get_env()->get_mutex());
 
     return (db->get_error());
   }
@@ -957,9 +1212,9 @@ ham_db_set_compare_func(ham_db_t *hdb, ham_compare_func_t foo)
   }
 
   try {
-    ScopedLock lock;
+    ExclusiveLock lock;
     if (ldb->get_env())
-      lock = ScopedLock(ldb->get_env()->get_mutex());
+      lock = ExclusiveLock(ldb->get_env()->get_mutex());
 
     /* set the compare functions */
     return (ldb->set_error(ldb->set_compare_func(foo)));
@@ -989,7 +1244,9 @@ ham_db_find(ham_db_t *hdb, ham_txn_t *htxn, ham_key_t *key,
   }
 
   try {
-    ScopedLock lock(env->get_mutex());
+    ExclusiveLock xlock;
+    SharedLock slock;
+    __lock_for_reading(env, xlock, slock);
 
     if (!key) {
       ham_trace(("parameter 'key' must not be NULL"));
@@ -1076,9 +1333,9 @@ ham_db_insert(ham_db_t *hdb, ham_txn_t *htxn, ham_key_t *key,
   }
 
   try {
-    ScopedLock lock;
+    ExclusiveLock lock;
     if (!(flags & HAM_DONT_LOCK))
-      lock = ScopedLock(env->get_mutex());
+      lock = ExclusiveLock(env->get_mutex());
 
     if (!key) {
       ham_trace(("parameter 'key' must not be NULL"));
@@ -1141,30 +1398,9 @@ ham_db_insert(ham_db_t *hdb, ham_txn_t *htxn, ham_key_t *key,
     if (!__prepare_key(key) || !__prepare_record(record))
       return (db->set_error(HAM_INV_PARAMETER));
 
-    /* allocate temp. storage for a recno key */
-    if (db->get_rt_flags() & HAM_RECORD_NUMBER) {
-      if (flags & HAM_OVERWRITE) {
-        if (key->size != sizeof(ham_u64_t) || !key->data) {
-          ham_trace(("key->size must be 8, key->data must not be NULL"));
-          return (db->set_error(HAM_INV_PARAMETER));
-        }
-      }
-      else {
-        if (key->flags & HAM_KEY_USER_ALLOC) {
-          if (!key->data || key->size != sizeof(ham_u64_t)) {
-            ham_trace(("key->size must be 8, key->data must not "
-                  "be NULL"));
-            return (db->set_error(HAM_INV_PARAMETER));
-          }
-        }
-        else {
-          if (key->data || key->size) {
-            ham_trace(("key->size must be 0, key->data must be NULL"));
-            return (db->set_error(HAM_INV_PARAMETER));
-          }
-        }
-      }
-    }
+    if ((db->get_rt_flags() & HAM_RECORD_NUMBER)
+        && !__prepare_recno_key(key, flags))
+      return (db->set_error(HAM_INV_PARAMETER));
 
     return (db->set_error(db->insert(txn, key, record, flags)));
   }
@@ -1173,6 +1409,89 @@ ham_db_insert(ham_db_t *hdb, ham_txn_t *htxn, ham_key_t *key,
   }
 }
 
+ham_status_t HAM_CALLCONV
+ham_db_bulk_insert(ham_db_t *hdb, ham_txn_t *htxn, ham_key_t *keys,
+            ham_record_t *records, ham_u32_t count, ham_u32_t fill_factor,
+            ham_u32_t flags)
+{
+  Database *db = (Database *)hdb;
+  Transaction *txn = (Transaction *)htxn;
+  Environment *env;
+
+  if (!db) {
+    ham_trace(("parameter 'db' must not be NULL"));
+    return HAM_INV_PARAMETER;
+  }
+  env = db->get_env();
+  if (!env) {
+    ham_trace(("parameter 'db' must be linked to a valid (implicit or "
+           "explicit) environment"));
+    return (db->set_error(HAM_INV_PARAMETER));
+  }
+
+  try {
+    ExclusiveLock lock;
+    if (!(flags & HAM_DONT_LOCK))
+      lock = ExclusiveLock(env->get_mutex());
+
+    if (count && !keys) {
+      ham_trace(("parameter 'keys' must not be NULL"));
+      return (db->set_error(HAM_INV_PARAMETER));
+    }
+    if (count && !records) {
+      ham_trace(("parameter 'records' must not be NULL"));
+      return (db->set_error(HAM_INV_PARAMETER));
+    }
+    if (fill_factor > 100) {
+      ham_trace(("parameter 'fill_factor' must not be greater than 100"));
+      return (db->set_error(HAM_INV_PARAMETER));
+    }
+    if (db->get_rt_flags() & HAM_READ_ONLY) {
+      ham_trace(("cannot insert in a read-only database"));
+      return (db->set_error(HAM_WRITE_PROTECTED));
+    }
+    if ((flags & HAM_OVERWRITE) && (flags & HAM_DUPLICATE)) {
+      ham_trace(("cannot combine HAM_OVERWRITE and HAM_DUPLICATE"));
+      return (db->set_error(HAM_INV_PARAMETER));
+    }
+    if ((flags & HAM_DUPLICATE)
+        && !(db->get_rt_flags() & HAM_ENABLE_DUPLICATE_KEYS)) {
+      ham_trace(("database does not support duplicate keys "
+            "(see HAM_ENABLE_DUPLICATE_KEYS)"));
+      return (db->set_error(HAM_INV_PARAMETER));
+    }
+    if (flags & (HAM_PARTIAL | HAM_HINT_APPEND | HAM_HINT_PREPEND
+                | HAM_DUPLICATE_INSERT_AFTER | HAM_DUPLICATE_INSERT_BEFORE
+                | HAM_DUPLICATE_INSERT_LAST | HAM_DUPLICATE_INSERT_FIRST)) {
+      ham_trace(("function does not support flags HAM_PARTIAL, HAM_HINT_* "
+            "or HAM_DUPLICATE_INSERT_*"));
+      return (db->set_error(HAM_INV_PARAMETER));
+    }
+    if (txn && (flags & HAM_BULK_BYPASS_TRANSACTIONS)) {
+      ham_trace(("flag HAM_BULK_BYPASS_TRANSACTIONS is not allowed in "
+            "combination with a Transaction"));
+      return (db->set_error(HAM_INV_PARAMETER));
+    }
+
+    for (ham_u32_t i = 0; i < count; i++) {
+      if (!__prepare_key(&keys[i]) || !__prepare_record(&records[i]))
+        return (db->set_error(HAM_INV_PARAMETER));
+      if ((db->get_rt_flags() & HAM_RECORD_NUMBER)
+          && !__prepare_recno_key(&keys[i], flags))
+        return (db->set_error(HAM_INV_PARAMETER));
+    }
+
+    if (count == 0)
+      return (db->set_error(0));
+
+    return (db->set_error(db->bulk_insert(txn, keys, records, count,
+                            fill_factor ? fill_factor : 100, flags)));
+  }
+  catch (Exception &ex) {
+    return (ex.code);
+  }
+}
+
 ham_status_t HAM_CALLCONV
 ham_db_erase(ham_db_t *hdb, ham_txn_t *htxn, ham_key_t *key, ham_u32_t flags)
 {
@@ -1192,9 +1511,9 @@ ham_db_erase(ham_db_t *hdb, ham_txn_t *htxn, ham_key_t *key, ham_u32_t flags)
   }
 
   try {
-    ScopedLock lock;
+    ExclusiveLock lock;
     if (!(flags & HAM_DONT_LOCK))
-      lock = ScopedLock(env->get_mutex());
+      lock = ExclusiveLock(env->get_mutex());
 
     if (!key) {
       ham_trace(("parameter 'key' must not be NULL"));
@@ -1241,7 +1560,7 @@ ham_db_check_integrity(ham_db_t *hdb, ham_u32_t flags)
   }
 
   try {
-    ScopedLock lock(db->get_env()->get_mutex());
+    ExclusiveLock lock(db->get_env()->get_mutex());
 
     return (db->set_error(db->check_integrity(flags)));
   }
@@ -1280,9 +1599,9 @@ ham_db_close(ham_db_t *hdb, ham_u32_t flags)
   }
 
   try {
-    ScopedLock lock;
+    ExclusiveLock lock;
     if (!(flags & HAM_DONT_LOCK))
-      lock = ScopedLock(env->get_mutex());
+      lock = ExclusiveLock(env->get_mutex());
 
     /* the function pointer will do the actual implementation */
     st = db->close(flags);
@@ -1331,9 +1650,9 @@ ham_cursor_create(ham_cursor_t **hcursor, ham_db_t *hdb, ham_txn_t *htxn,
   }
 
   try {
-    ScopedLock lock;
+    ExclusiveLock lock;
     if (!(flags & HAM_DONT_LOCK))
-      lock = ScopedLock(env->get_mutex());
+      lock = ExclusiveLock(env->get_mutex());
 
     *cursor = db->cursor_create(txn, flags);
     return (0);
@@ -1364,7 +1683,7 @@ ham_cursor_clone(ham_cursor_t *hsrc, ham_cursor_t **hdest)
   db = src->get_db();
 
   try {
-    ScopedLock lock(db->get_env()->get_mutex());
+    ExclusiveLock lock(db->get_env()->get_mutex());
 
     *dest = db->cursor_clone(src);
 
@@ -1391,7 +1710,7 @@ ham_cursor_overwrite(ham_cursor_t *hcursor, ham_record_t *record,
   db = cursor->get_db();
 
   try {
-    ScopedLock lock(db->get_env()->get_mutex());
+    ExclusiveLock lock(db->get_env()->get_mutex());
 
     if (flags) {
       ham_trace(("function does not support a non-zero flags value; "
@@ -1433,7 +1752,9 @@ ham_cursor_move(ham_cursor_t *hcursor, ham_key_t *key,
   db = cursor->get_db();
 
   try {
-    ScopedLock lock(db->get_env()->get_mutex());
+    ExclusiveLock xlock;
+    SharedLock slock;
+    __lock_for_reading(db->get_env(), xlock, slock);
 
     if ((flags & HAM_ONLY_DUPLICATES) && (flags & HAM_SKIP_DUPLICATES)) {
       ham_trace(("combination of HAM_ONLY_DUPLICATES and "
@@ -1492,9 +1813,10 @@ ham_cursor_find(ham_cursor_t *hcursor, ham_key_t *key, ham_record_t *record,
   env = db->get_env();
 
   try {
-    ScopedLock lock;
+    ExclusiveLock xlock;
+    SharedLock slock;
     if (!(flags & HAM_DONT_LOCK))
-      lock = ScopedLock(env->get_mutex());
+      __lock_for_reading(env, xlock, slock);
 
     if (!key) {
       ham_trace(("parameter 'key' must not be NULL"));
@@ -1557,7 +1879,7 @@ ham_cursor_insert(ham_cursor_t *hcursor, ham_key_t *key, ham_record_t *record,
   db = cursor->get_db();
 
   try {
-    ScopedLock lock(db->get_env()->get_mutex());
+    ExclusiveLock lock(db->get_env()->get_mutex());
 
     if (!key) {
       ham_trace(("parameter 'key' must not be NULL"));
@@ -1664,7 +1986,7 @@ ham_cursor_erase(ham_cursor_t *hcursor, ham_u32_t flags)
   db = cursor->get_db();
 
   try {
-    ScopedLock lock(db->get_env()->get_mutex());
+    ExclusiveLock lock(db->get_env()->get_mutex());
 
     if (db->get_rt_flags() & HAM_READ_ONLY) {
       ham_trace(("cannot erase from a read-only database"));
@@ -1702,7 +2024,7 @@ ham_cursor_get_duplicate_count(ham_cursor_t *hcursor, ham_u32_t *count,
   db = cursor->get_db();
 
   try {
-    ScopedLock lock(db->get_env()->get_mutex());
+    ExclusiveLock lock(db->get_env()->get_mutex());
 
     if (!count) {
       ham_trace(("parameter 'count' must not be NULL"));
@@ -1734,7 +2056,7 @@ ham_cursor_get_record_size(ham_cursor_t *hcursor, ham_u64_t *size)
   db = cursor->get_db();
 
   try {
-    ScopedLock lock(db->get_env()->get_mutex());
+    ExclusiveLock lock(db->get_env()->get_mutex());
 
     if (!size) {
       ham_trace(("parameter 'size' must not be NULL"));
@@ -1765,7 +2087,7 @@ ham_cursor_close(ham_cursor_t *hcursor)
   db = cursor->get_db();
 
   try {
-    ScopedLock lock(db->get_env()->get_mutex());
+    ExclusiveLock lock(db->get_env()->get_mutex());
 
     db->cursor_close(cursor);
     return (0);
@@ -1783,7 +2105,7 @@ ham_set_context_data(ham_db_t *hdb, void *data)
   if (!db)
     return;
 
-  ScopedLock lock(db->get_env()->get_mutex());
+  ExclusiveLock lock(db->get_env()->get_mutex());
   db->set_context_data(data);
 }
 
@@ -1797,7 +2119,7 @@ ham_get_context_data(ham_db_t *hdb, ham_bool_t dont_lock)
   if (dont_lock)
     return (db->get_context_data());
 
-  ScopedLock lock(db->get_env()->get_mutex());
+  ExclusiveLock lock(db->get_env()->get_mutex());
   return (db->get_context_data());
 }
 
@@ -1808,7 +2130,7 @@ ham_env_set_context_data(ham_env_t *henv, void *data)
   if (!env)
     return;
 
-  ScopedLock lock(env->get_mutex());
+  ExclusiveLock lock(env->get_mutex());
   env->set_context_data(data);
 }
 
@@ -1819,7 +2141,7 @@ ham_env_get_context_data(ham_env_t *henv)
   if (!env)
     return (0);
 
-  ScopedLock lock(env->get_mutex());
+  ExclusiveLock lock(env->get_mutex());
   return (env->get_context_data());
 }
 
@@ -1864,7 +2186,7 @@ ham_db_get_key_count(ham_db_t *hdb, ham_txn_t *htxn, ham_u32_t flags,
   *keycount = 0;
 
   try {
-    ScopedLock lock(db->get_env()->get_mutex());
+    ExclusiveLock lock(db->get_env()->get_mutex());
 
     return (db->set_error(db->get_key_count(txn, flags, keycount)));
   }
@@ -1898,7 +2220,7 @@ ham_env_get_metrics(ham_env_t *henv, ham_env_metrics_t *metrics)
   memset(metrics, 0, sizeof(ham_env_metrics_t));
   metrics->version = HAM_METRICS_VERSION;
 
-  ScopedLock lock(env->get_mutex());
+  ExclusiveLock lock(env->get_mutex());
   // fill in memory metrics
   Memory::get_global_metrics(metrics);
   // ... and everything else
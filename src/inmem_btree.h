@@ -0,0 +1,461 @@
+/*
+ * Copyright (C) 2005-2014 Christoph Rupp (chris@crupp.de).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * An in-memory B+tree which stores pointers to (unique) elements in sorted
+ * order; used by the TransactionIndex.
+ *
+ * Each node stores up to kFanout pointers in a sorted array, which is
+ * searched with a binary search. Internal nodes store the smallest element
+ * of each child. The leaves are linked for fast iteration. Compared to a
+ * red-black tree with one heap node per element, far less (and denser)
+ * memory is touched when descending the tree.
+ *
+ * Nodes are not rebalanced when elements are deleted; underfull nodes are
+ * merged with a neighbour if both fit into a single node, and empty nodes
+ * are removed.
+ *
+ * |Compare| is a functor with an "int operator()(T *lhs, T *rhs)" which
+ * returns -1, 0 or +1.
+ */
+
+#ifndef HAM_INMEM_BTREE_H__
+#define HAM_INMEM_BTREE_H__
+
+#include <string.h>
+
+#include <ham/types.h>
+
+#include "error.h"
+
+namespace hamsterdb {
+
+template<typename T, typename Compare>
+class InMemoryBtree
+{
+    enum {
+      // number of elements per node
+      kFanout = 32
+    };
+
+    // the common header of leaf and internal nodes
+    struct Node {
+      Node(bool _is_leaf)
+        : is_leaf(_is_leaf), count(0) {
+      }
+
+      bool is_leaf;
+
+      // the number of elements (or children)
+      ham_u32_t count;
+
+      // leaf nodes: the elements; internal nodes: the smallest element
+      // of each child
+      T *keys[kFanout];
+    };
+
+    struct Leaf : public Node {
+      Leaf()
+        : Node(true), previous(0), next(0) {
+      }
+
+      // the linked list of leaves
+      Leaf *previous;
+      Leaf *next;
+    };
+
+    struct Internal : public Node {
+      Internal()
+        : Node(false) {
+      }
+
+      Node *children[kFanout];
+    };
+
+  public:
+    // Constructor
+    InMemoryBtree(Compare compare = Compare())
+      : m_compare(compare), m_root(0), m_size(0) {
+    }
+
+    // Destructor; the elements are not deleted
+    ~InMemoryBtree() {
+      clear();
+    }
+
+    // Returns the number of elements
+    size_t size() const {
+      return (m_size);
+    }
+
+    // Inserts |t|; an element with the same key must not yet exist
+    void insert(T *t) {
+      if (!m_root) {
+        Leaf *leaf = new Leaf();
+        leaf->keys[0] = t;
+        leaf->count = 1;
+        m_root = leaf;
+      }
+      else {
+        Node *sibling = insert_recursive(m_root, t);
+        if (sibling) {
+          Internal *root = new Internal();
+          root->keys[0] = m_root->keys[0];
+          root->children[0] = m_root;
+          root->keys[1] = sibling->keys[0];
+          root->children[1] = sibling;
+          root->count = 2;
+          m_root = root;
+        }
+      }
+      m_size++;
+    }
+
+    // Removes the element which is equal to |t|; returns false if it
+    // does not exist
+    bool remove(T *t) {
+      if (!m_root || !remove_recursive(m_root, t))
+        return (false);
+      m_size--;
+
+      // collapse the root
+      if (m_root->count == 0) {
+        delete_node(m_root);
+        m_root = 0;
+      }
+      else if (!m_root->is_leaf && m_root->count == 1) {
+        Internal *root = (Internal *)m_root;
+        m_root = root->children[0];
+        delete root;
+      }
+      return (true);
+    }
+
+    // Returns the element which is equal to |key|, or null
+    T *search(T *key) const {
+      if (!m_root)
+        return (0);
+      Leaf *leaf = find_leaf(key);
+      ham_u32_t i = lower_bound(leaf, key);
+      if (i < leaf->count && m_compare(leaf->keys[i], key) == 0)
+        return (leaf->keys[i]);
+      return (0);
+    }
+
+    // Returns the smallest element which is >= |key|, or null
+    T *nsearch(T *key) const {
+      if (!m_root)
+        return (0);
+      Leaf *leaf = find_leaf(key);
+      ham_u32_t i = lower_bound(leaf, key);
+      if (i < leaf->count)
+        return (leaf->keys[i]);
+      return (leaf->next ? leaf->next->keys[0] : 0);
+    }
+
+    // Returns the largest element which is <= |key|, or null
+    T *psearch(T *key) const {
+      if (!m_root)
+        return (0);
+      Leaf *leaf = find_leaf(key);
+      ham_u32_t i = upper_bound(leaf, key);
+      if (i > 0)
+        return (leaf->keys[i - 1]);
+      return (leaf->previous
+                ? leaf->previous->keys[leaf->previous->count - 1]
+                : 0);
+    }
+
+    // Returns the smallest element which is > |key|, or null
+    T *next(T *key) const {
+      if (!m_root)
+        return (0);
+      Leaf *leaf = find_leaf(key);
+      ham_u32_t i = upper_bound(leaf, key);
+      if (i < leaf->count)
+        return (leaf->keys[i]);
+      return (leaf->next ? leaf->next->keys[0] : 0);
+    }
+
+    // Returns the largest element which is < |key|, or null
+    T *previous(T *key) const {
+      if (!m_root)
+        return (0);
+      Leaf *leaf = find_leaf(key);
+      ham_u32_t i = lower_bound(leaf, key);
+      if (i > 0)
+        return (leaf->keys[i - 1]);
+      return (leaf->previous
+                ? leaf->previous->keys[leaf->previous->count - 1]
+                : 0);
+    }
+
+    // Returns the smallest element, or null
+    T *first() const {
+      if (!m_root)
+        return (0);
+      Node *node = m_root;
+      while (!node->is_leaf)
+        node = ((Internal *)node)->children[0];
+      return (node->keys[0]);
+    }
+
+    // Returns the largest element, or null
+    T *last() const {
+      if (!m_root)
+        return (0);
+      Node *node = m_root;
+      while (!node->is_leaf)
+        node = ((Internal *)node)->children[node->count - 1];
+      return (node->keys[node->count - 1]);
+    }
+
+    // Calls |visitor->visit(t)| for each element, in sorted order
+    template<typename Visitor>
+    void enumerate(Visitor *visitor) const {
+      if (!m_root)
+        return;
+      Node *node = m_root;
+      while (!node->is_leaf)
+        node = ((Internal *)node)->children[0];
+      for (Leaf *leaf = (Leaf *)node; leaf; leaf = leaf->next) {
+        for (ham_u32_t i = 0; i < leaf->count; i++)
+          visitor->visit(leaf->keys[i]);
+      }
+    }
+
+    // Removes all elements; the elements are not deleted
+    void clear() {
+      if (m_root)
+        delete_node(m_root);
+      m_root = 0;
+      m_size = 0;
+    }
+
+  private:
+    // Returns the index of the first element in |node| which is >= |key|
+    ham_u32_t lower_bound(const Node *node, T *key) const {
+      ham_u32_t l = 0, r = node->count;
+      while (l < r) {
+        ham_u32_t m = (l + r) / 2;
+        if (m_compare(node->keys[m], key) < 0)
+          l = m + 1;
+        else
+          r = m;
+      }
+      return (l);
+    }
+
+    // Returns the index of the first element in |node| which is > |key|
+    ham_u32_t upper_bound(const Node *node, T *key) const {
+      ham_u32_t l = 0, r = node->count;
+      while (l < r) {
+        ham_u32_t m = (l + r) / 2;
+        if (m_compare(node->keys[m], key) <= 0)
+          l = m + 1;
+        else
+          r = m;
+      }
+      return (l);
+    }
+
+    // Returns the index of the child of |node| which covers |key|
+    ham_u32_t find_child(const Internal *node, T *key) const {
+      ham_u32_t i = upper_bound(node, key);
+      return (i > 0 ? i - 1 : 0);
+    }
+
+    // Returns the leaf which covers |key|
+    Leaf *find_leaf(T *key) const {
+      Node *node = m_root;
+      while (!node->is_leaf) {
+        Internal *in = (Internal *)node;
+        node = in->children[find_child(in, key)];
+      }
+      return ((Leaf *)node);
+    }
+
+    // Inserts |t| in the subtree of |node|; returns the new right sibling
+    // of |node| if it was split
+    Node *insert_recursive(Node *node, T *t) {
+      if (node->is_leaf) {
+        Leaf *leaf = (Leaf *)node;
+        ham_u32_t i = lower_bound(leaf, t);
+        ham_assert(i == leaf->count || m_compare(leaf->keys[i], t) != 0);
+        if (leaf->count < kFanout) {
+          insert_at(leaf, i, t, 0);
+          return (0);
+        }
+
+        // split the leaf and link the new sibling
+        Leaf *sibling = new Leaf();
+        split(leaf, sibling);
+        sibling->previous = leaf;
+        sibling->next = leaf->next;
+        if (leaf->next)
+          leaf->next->previous = sibling;
+        leaf->next = sibling;
+
+        if (i <= leaf->count)
+          insert_at(leaf, i, t, 0);
+        else
+          insert_at(sibling, i - leaf->count, t, 0);
+        return (sibling);
+      }
+
+      Internal *in = (Internal *)node;
+      ham_u32_t ci = find_child(in, t);
+      Node *child = in->children[ci];
+      Node *new_child = insert_recursive(child, t);
+      in->keys[ci] = child->keys[0];
+      if (!new_child)
+        return (0);
+
+      if (in->count < kFanout) {
+        insert_at(in, ci + 1, new_child->keys[0], new_child);
+        return (0);
+      }
+
+      Internal *sibling = new Internal();
+      split(in, sibling);
+      if (ci + 1 <= in->count)
+        insert_at(in, ci + 1, new_child->keys[0], new_child);
+      else
+        insert_at(sibling, ci + 1 - in->count, new_child->keys[0], new_child);
+      return (sibling);
+    }
+
+    // Removes |t| from the subtree of |node|; returns false if it
+    // was not found
+    bool remove_recursive(Node *node, T *t) {
+      if (node->is_leaf) {
+        ham_u32_t i = lower_bound(node, t);
+        if (i == node->count || m_compare(node->keys[i], t) != 0)
+          return (false);
+        remove_at(node, i);
+        return (true);
+      }
+
+      Internal *in = (Internal *)node;
+      ham_u32_t ci = find_child(in, t);
+      Node *child = in->children[ci];
+      if (!remove_recursive(child, t))
+        return (false);
+
+      // remove empty children, merge underfull children with a neighbour
+      if (child->count == 0) {
+        remove_at(in, ci);
+        delete_node(child);
+      }
+      else {
+        in->keys[ci] = child->keys[0];
+        if (child->count < kFanout / 4 && in->count > 1) {
+          ham_u32_t left = ci > 0 ? ci - 1 : ci;
+          Node *l = in->children[left];
+          Node *r = in->children[left + 1];
+          if (l->count + r->count <= kFanout) {
+            merge(l, r);
+            remove_at(in, left + 1);
+            delete_node(r);
+          }
+        }
+      }
+      return (true);
+    }
+
+    // Inserts |t| (and |child|, for internal nodes) at position |i|
+    void insert_at(Node *node, ham_u32_t i, T *t, Node *child) {
+      ham_assert(node->count < kFanout);
+      ham_u32_t move = node->count - i;
+      memmove(&node->keys[i + 1], &node->keys[i], move * sizeof(T *));
+      node->keys[i] = t;
+      if (!node->is_leaf) {
+        Internal *in = (Internal *)node;
+        memmove(&in->children[i + 1], &in->children[i],
+                        move * sizeof(Node *));
+        in->children[i] = child;
+      }
+      node->count++;
+    }
+
+    // Removes the element (and child) at position |i|
+    void remove_at(Node *node, ham_u32_t i) {
+      ham_u32_t move = node->count - i - 1;
+      memmove(&node->keys[i], &node->keys[i + 1], move * sizeof(T *));
+      if (!node->is_leaf) {
+        Internal *in = (Internal *)node;
+        memmove(&in->children[i], &in->children[i + 1],
+                        move * sizeof(Node *));
+      }
+      node->count--;
+    }
+
+    // Moves the upper half of |node| to the (empty) |sibling|
+    void split(Node *node, Node *sibling) {
+      ham_u32_t half = node->count / 2;
+      sibling->count = node->count - half;
+      memcpy(&sibling->keys[0], &node->keys[half],
+                      sibling->count * sizeof(T *));
+      if (!node->is_leaf)
+        memcpy(&((Internal *)sibling)->children[0],
+                      &((Internal *)node)->children[half],
+                      sibling->count * sizeof(Node *));
+      node->count = half;
+    }
+
+    // Appends all elements of |right| to |left|; |right| becomes empty
+    void merge(Node *left, Node *right) {
+      memcpy(&left->keys[left->count], &right->keys[0],
+                      right->count * sizeof(T *));
+      if (!left->is_leaf)
+        memcpy(&((Internal *)left)->children[left->count],
+                      &((Internal *)right)->children[0],
+                      right->count * sizeof(Node *));
+      left->count += right->count;
+      right->count = 0;
+    }
+
+    // Deletes a node (and its children); leaves are unlinked
+    void delete_node(Node *node) {
+      if (node->is_leaf) {
+        Leaf *leaf = (Leaf *)node;
+        if (leaf->previous)
+          leaf->previous->next = leaf->next;
+        if (leaf->next)
+          leaf->next->previous = leaf->previous;
+        delete leaf;
+      }
+      else {
+        Internal *in = (Internal *)node;
+        for (ham_u32_t i = 0; i < in->count; i++)
+          delete_node(in->children[i]);
+        delete in;
+      }
+    }
+
+    // the compare function
+    Compare m_compare;
+
+    // the root node
+    Node *m_root;
+
+    // the number of elements
+    size_t m_size;
+};
+
+} // namespace hamsterdb
+
+#endif /* HAM_INMEM_BTREE_H__ */
@@ -22,37 +22,54 @@
 #else
 #  undef max // avoid clashes with std::max
 #endif
+#include <boost/date_time/posix_time/posix_time_types.hpp>
 
-#include "db.h"
+#include "db_local.h"
 #include "device.h"
 #include "error.h"
 #include "os.h"
 #include "util.h"
+#include "compressor_factory.h"
 #include "journal.h"
+#include "journal_reader.h"
 #include "txn_local.h"
 #include "env_local.h"
 #include "page_manager.h"
+#include "btree_index.h"
 
 namespace hamsterdb {
 
 Journal::Journal(LocalEnvironment *env)
   : m_env(env), m_current_fd(0), m_lsn(1), m_last_cp_lsn(0),
-    m_threshold(kSwitchTxnThreshold), m_disable_logging(false),
-    m_count_bytes_flushed(0)
+    m_threshold(kSwitchTxnThreshold),
+    m_size_limit(env->get_journal_size_limit()), m_disable_logging(false),
+    m_count_bytes_flushed(0), m_count_recovered_entries(0),
+    m_count_recovered_bytes(0), m_recovery_usec(0), m_count_checkpoints(0),
+    m_count_bytes_saved(0), m_count_bytes_before_compression(0),
+    m_count_bytes_after_compression(0), m_write_seq(0),
+    m_sync_seq(0), m_sync_in_progress(false), m_count_group_syncs(0)
 {
+  int algorithm = env->get_journal_compression();
+  if (algorithm)
+    m_compressor.reset(CompressorFactory::create(algorithm));
+
+  m_file_compressor[0] = algorithm;
+  m_file_compressor[1] = algorithm;
   m_fd[0] = HAM_INVALID_FD;
   m_fd[1] = HAM_INVALID_FD;
   m_open_txn[0] = 0;
   m_open_txn[1] = 0;
   m_closed_txn[0] = 0;
   m_closed_txn[1] = 0;
+  m_file_size[0] = 0;
+  m_file_size[1] = 0;
 }
 
 void
 Journal::create()
 {
   int i;
-  PJournalHeader header;
+  PJournalHeader header(m_env->get_journal_compression());
 
   // create the two files
   for (i = 0; i < 2; i++) {
@@ -61,6 +78,7 @@ Journal::create()
 
     // and write the magic
     os_write(m_fd[i], &header, sizeof(header));
+    m_file_size[i] = sizeof(header);
   }
 }
 
@@ -68,7 +86,7 @@ void
 Journal::open()
 {
   int i;
-  PJournalHeader header;
+  PJournalHeader header[2];
   PJournalEntry entry;
   PJournalTrailer trailer;
   ham_u64_t lsn[2];
@@ -104,16 +122,17 @@ Journal::open()
   // lsn is "newer"
   for (i = 0; i < 2; i++) {
     // check the magic
-    os_pread(m_fd[i], 0, &header, sizeof(header));
+    os_pread(m_fd[i], 0, &header[i], sizeof(header[i]));
 
-    if (header.magic != kHeaderMagic) {
+    if (header[i].magic != kHeaderMagic) {
       ham_trace(("journal has unknown magic or is corrupt"));
       (void)close();
       throw Exception(HAM_LOG_INV_FILE_HEADER);
     }
 
-    // read the lsn from the header structure
-    lsn[i] = header.lsn;
+    // read the lsn and the compression algorithm from the header structure
+    lsn[i] = header[i].lsn;
+    m_file_compressor[i] = header[i].compressor;
   }
 
   // the larger lsn will become the active file
@@ -126,6 +145,16 @@ Journal::open()
   for (int i = 0; i < 2; i++) {
     // but make sure that the file is large enough!
     ham_u64_t size = os_get_file_size(m_fd[i]);
+    m_file_size[i] = size;
+
+    // an empty file adopts the compression algorithm of the Environment;
+    // files with entries are recovered and cleared
+    if (size == sizeof(PJournalHeader)
+        && header[i].compressor != (ham_u32_t)m_env->get_journal_compression()) {
+      header[i].compressor = m_env->get_journal_compression();
+      os_pwrite(m_fd[i], 0, &header[i], sizeof(header[i]));
+      m_file_compressor[i] = header[i].compressor;
+    }
 
     if (size >= sizeof(entry)) {
       os_pread(m_fd[i], size - sizeof(PJournalTrailer),
@@ -163,7 +192,7 @@ Journal::switch_files_maybe(LocalTransaction *txn)
 
   // determine the journal file which is used for this transaction 
   // if the "current" file is not yet full, continue to write to this file
-  if (m_open_txn[cur] + m_closed_txn[cur] < m_threshold) {
+  if (!is_file_full(cur)) {
     txn->set_log_desc(cur);
   }
   else if (m_open_txn[other] == 0) {
@@ -270,8 +299,70 @@ Journal::append_txn_commit(LocalTransaction *txn, ham_u64_t lsn)
 
   append_entry(idx, &entry, sizeof(entry), &trailer, sizeof(trailer));
 
-  // and flush the file
-  flush_buffer(idx, m_env->get_flags() & HAM_ENABLE_FSYNC);
+  // and hand the buffer to the writer thread; the write and the fsync
+  // are awaited in sync(), after the Environment lock was released
+  ham_u64_t seq = write_buffer(idx);
+
+  ScopedLock lock(m_sync_mutex);
+  m_write_seq = seq;
+}
+
+void
+Journal::sync()
+{
+  ScopedLock lock(m_sync_mutex);
+
+  // all entries up to |target| have to be written (and durable, with
+  // HAM_ENABLE_FSYNC) when returning
+  ham_u64_t target = m_write_seq;
+
+  lock.unlock();
+  m_writer.wait(target);
+  if (!(m_env->get_flags() & HAM_ENABLE_FSYNC))
+    return;
+  lock.lock();
+
+  while (m_sync_seq < target) {
+    // another thread is the leader; wait till it's finished, then check
+    // if its fsync included our entries
+    if (m_sync_in_progress) {
+      m_sync_cond.wait(lock);
+      continue;
+    }
+
+    // otherwise become the leader and sync everything that was queued
+    // so far
+    ham_u64_t seq = m_write_seq;
+    m_sync_in_progress = true;
+    lock.unlock();
+
+    try {
+      m_writer.wait(seq);
+      sync_files();
+    }
+    catch (Exception &) {
+      lock.lock();
+      m_sync_in_progress = false;
+      m_sync_cond.notify_all();
+      throw;
+    }
+
+    lock.lock();
+    if (seq > m_sync_seq)
+      m_sync_seq = seq;
+    m_sync_in_progress = false;
+    m_count_group_syncs++;
+    m_sync_cond.notify_all();
+  }
+}
+
+void
+Journal::sync_files()
+{
+  for (int i = 0; i < 2; i++) {
+    if (m_fd[i] != HAM_INVALID_FD)
+      os_flush(m_fd[i]);
+  }
 }
 
 void
@@ -284,12 +375,29 @@ Journal::append_insert(Database *db, LocalTransaction *txn,
 
   PJournalEntry entry;
   PJournalEntryInsert insert;
-  ham_u32_t size = sizeof(PJournalEntryInsert)
-                        + key->size
-                        + (flags & HAM_PARTIAL
+  const void *key_data = key->data;
+  ham_u32_t key_size = key->size;
+  const void *record_data = record->data;
+  ham_u32_t record_size = flags & HAM_PARTIAL
                             ? record->partial_size
-                            : record->size)
-                        - 1;
+                            : record->size;
+
+  // compress the key and the record; the compressed key is copied because
+  // the Compressor overwrites its output when compressing the record
+  insert.compressed_key_size = (ham_u16_t)compress(key->data, key->size);
+  if (insert.compressed_key_size) {
+    m_compressed_key.copy(m_compressor->get_output_data(),
+                    insert.compressed_key_size);
+    key_data = m_compressed_key.get_ptr();
+    key_size = insert.compressed_key_size;
+  }
+  insert.compressed_record_size = compress(record->data, record_size);
+  if (insert.compressed_record_size) {
+    record_data = m_compressor->get_output_data();
+    record_size = insert.compressed_record_size;
+  }
+
+  ham_u32_t size = sizeof(PJournalEntryInsert) + key_size + record_size - 1;
 
   entry.lsn = lsn;
   entry.dbname = db->get_name();
@@ -319,10 +427,8 @@ Journal::append_insert(Database *db, LocalTransaction *txn,
   // append the entry to the logfile
   append_entry(idx, &entry, sizeof(entry),
                 &insert, sizeof(PJournalEntryInsert) - 1,
-                key->data, key->size,
-                record->data, (flags & HAM_PARTIAL
-                                ? record->partial_size
-                                : record->size),
+                key_data, key_size,
+                record_data, record_size,
                 &trailer, sizeof(trailer));
   maybe_flush_buffer(idx);
 }
@@ -336,7 +442,16 @@ Journal::append_erase(Database *db, LocalTransaction *txn, ham_key_t *key,
 
   PJournalEntry entry;
   PJournalEntryErase erase;
-  ham_u32_t size = sizeof(PJournalEntryErase) + key->size - 1;
+  const void *key_data = key->data;
+  ham_u32_t key_size = key->size;
+
+  erase.compressed_key_size = (ham_u16_t)compress(key->data, key->size);
+  if (erase.compressed_key_size) {
+    key_data = m_compressor->get_output_data();
+    key_size = erase.compressed_key_size;
+  }
+
+  ham_u32_t size = sizeof(PJournalEntryErase) + key_size - 1;
 
   entry.lsn = lsn;
   entry.dbname = db->get_name();
@@ -358,13 +473,12 @@ Journal::append_erase(Database *db, LocalTransaction *txn, ham_key_t *key,
 
   PJournalTrailer trailer;
   trailer.type = entry.type;
-  trailer.full_size = sizeof(entry) + sizeof(PJournalEntryErase) - 1
-                + key->size;
+  trailer.full_size = sizeof(entry) + size;
 
   // append the entry to the logfile
   append_entry(idx, &entry, sizeof(entry),
                 (PJournalEntry *)&erase, sizeof(PJournalEntryErase) - 1,
-                key->data, key->size,
+                key_data, key_size,
                 &trailer, sizeof(trailer));
   maybe_flush_buffer(idx);
 }
@@ -386,7 +500,7 @@ Journal::append_changeset(Page **bucket1, ham_u32_t bucket1_size,
   entry.lsn = lsn;
   entry.dbname = 0;
   entry.txn_id = 0;
-  entry.type = kEntryTypeChangeset;
+  entry.type = kEntryTypeChangesetDelta;
   // followup_size is incomplete - the actual page sizes are added later
   entry.followup_size = sizeof(PJournalEntryChangeset);
   changeset.num_pages = bucket1_size + bucket2_size
@@ -421,17 +535,221 @@ Journal::append_changeset(Page **bucket1, ham_u32_t bucket1_size,
   m_buffer[m_current_fd].overwrite(entry_position, &entry, sizeof(entry));
 
   // and flush the file
-  flush_buffer(m_current_fd, m_env->get_flags() & HAM_ENABLE_FSYNC);
+  flush_buffer(m_current_fd);
+
+  // The changeset must not become durable before the commit entries of
+  // its Transactions, which might not yet be synced (and might be stored
+  // in the other file). Therefore both files are synced; pending group
+  // commits are then finished as well.
+  if (m_env->get_flags() & HAM_ENABLE_FSYNC) {
+    ham_u64_t seq;
+    {
+      ScopedLock lock(m_sync_mutex);
+      seq = m_write_seq;
+    }
+
+    sync_files();
+
+    ScopedLock lock(m_sync_mutex);
+    if (seq > m_sync_seq) {
+      m_sync_seq = seq;
+      m_sync_cond.notify_all();
+    }
+  }
 }
 
 ham_u32_t
 Journal::append_changeset_page(Page *page, ham_u32_t page_size)
 {
   PJournalEntryPageHeader header(page->get_address());
+  const ham_u8_t *data = page->get_raw_payload();
+  Device *device = m_env->get_device();
+
+  // compare the page with the old version in the file; the page is not
+  // written before the changeset was appended. New pages are logged in full.
+  m_ranges.clear();
+  ham_u32_t size = page_size;
+  if (page->get_address() + page_size <= device->get_file_size()) {
+    m_before_image.resize(page_size);
+    device->read(page->get_address(), m_before_image.get_ptr(), page_size);
+    size = diff_page((ham_u8_t *)m_before_image.get_ptr(), data, page_size,
+                    &m_ranges);
+  }
+
+  if (size < page_size)
+    m_count_bytes_saved += page_size - size;
+  else {
+    m_ranges.clear();
+    m_ranges.push_back(PJournalEntryPageRange(0, page_size));
+    size = page_size + sizeof(PJournalEntryPageRange);
+  }
+
+  PJournalEntryPageDelta delta((ham_u32_t)m_ranges.size(), size);
+
+  if (!m_compressor.get()) {
+    append_entry(m_current_fd, &header, sizeof(header),
+                    &delta, sizeof(delta));
+    for (std::vector<PJournalEntryPageRange>::iterator it = m_ranges.begin();
+            it != m_ranges.end(); ++it)
+      append_entry(m_current_fd, &*it, sizeof(*it),
+                      data + it->offset, it->length);
+    return (sizeof(header) + sizeof(delta) + size);
+  }
 
-  append_entry(m_current_fd, &header, sizeof(header),
-                page->get_raw_payload(), page_size);
-  return (page_size + sizeof(header));
+  // with compression, the ranges are collected and compressed as a whole
+  ham_u8_t *p = (ham_u8_t *)m_page_ranges.resize(size);
+  for (std::vector<PJournalEntryPageRange>::iterator it = m_ranges.begin();
+          it != m_ranges.end(); ++it) {
+    memcpy(p, &*it, sizeof(*it));
+    memcpy(p + sizeof(*it), data + it->offset, it->length);
+    p += sizeof(*it) + it->length;
+  }
+
+  header.compressed_size = compress(m_page_ranges.get_ptr(), size);
+  append_entry(m_current_fd, &header, sizeof(header), &delta, sizeof(delta),
+                  header.compressed_size
+                      ? m_compressor->get_output_data()
+                      : m_page_ranges.get_ptr(),
+                  header.compressed_size ? header.compressed_size : size);
+  return (sizeof(header) + sizeof(delta)
+                  + (header.compressed_size ? header.compressed_size : size));
+}
+
+ham_u32_t
+Journal::diff_page(const ham_u8_t *before, const ham_u8_t *after,
+                ham_u32_t page_size,
+                std::vector<PJournalEntryPageRange> *ranges)
+{
+  // the pages are compared word by word; a gap of less than |kMaxGap|
+  // words does not start a new range, because each range has a header
+  const ham_u32_t kMaxGap = 2;
+  const ham_u64_t *b = (const ham_u64_t *)before;
+  const ham_u64_t *a = (const ham_u64_t *)after;
+  ham_u32_t words = page_size / sizeof(ham_u64_t);
+  ham_u32_t size = 0;
+
+  ham_u32_t i = 0;
+  while (true) {
+    while (i < words && a[i] == b[i])
+      i++;
+    if (i == words)
+      break;
+
+    // |end| is the word after the last modified word of this range
+    ham_u32_t start = i;
+    ham_u32_t end = ++i;
+    for (; i < words && i - end < kMaxGap; i++) {
+      if (a[i] != b[i])
+        end = i + 1;
+    }
+    i = end;
+
+    PJournalEntryPageRange range(start * sizeof(ham_u64_t),
+                    (end - start) * sizeof(ham_u64_t));
+    ranges->push_back(range);
+    size += sizeof(range) + range.length;
+  }
+
+  return (size);
+}
+
+ham_u32_t
+Journal::compress(const void *data, ham_u32_t size)
+{
+  if (!m_compressor.get() || size == 0)
+    return (0);
+
+  ham_u32_t compressed_size = m_compressor->compress((const ham_u8_t *)data,
+                  size);
+  m_count_bytes_before_compression += size;
+
+  // store the data uncompressed if it did not become smaller
+  if (compressed_size >= size) {
+    m_count_bytes_after_compression += size;
+    return (0);
+  }
+  m_count_bytes_after_compression += compressed_size;
+  return (compressed_size);
+}
+
+Compressor *
+Journal::get_decompressor(int idx)
+{
+  if (!m_decompressor[idx].get())
+    m_decompressor[idx].reset(CompressorFactory::create(
+                            m_file_compressor[idx]));
+  return (m_decompressor[idx].get());
+}
+
+void
+Journal::decompress_entry(int idx, PJournalEntry *entry, ByteArray *auxbuffer)
+{
+  ByteArray buffer;
+
+  if (entry->type == kEntryTypeInsert) {
+    PJournalEntryInsert *ins = (PJournalEntryInsert *)auxbuffer->get_ptr();
+    if (!ins->compressed_key_size && !ins->compressed_record_size)
+      return;
+
+    ham_u32_t key_size = ins->compressed_key_size
+                            ? ins->compressed_key_size
+                            : ins->key_size;
+    ham_u32_t record_size = ins->insert_flags & HAM_PARTIAL
+                            ? ins->record_partial_size
+                            : ins->record_size;
+    ham_u32_t stored_record_size = ins->compressed_record_size
+                            ? ins->compressed_record_size
+                            : record_size;
+    if (sizeof(PJournalEntryInsert) - 1 + key_size + stored_record_size
+            > auxbuffer->get_size()) {
+      ham_log(("journal entry is corrupt"));
+      throw Exception(HAM_INTEGRITY_VIOLATED);
+    }
+
+    buffer.append(ins, sizeof(PJournalEntryInsert) - 1);
+    if (ins->compressed_key_size) {
+      Compressor *decompressor = get_decompressor(idx);
+      decompressor->decompress(ins->get_key_data(), key_size, ins->key_size);
+      buffer.append(decompressor->get_output_data(), ins->key_size);
+    }
+    else
+      buffer.append(ins->get_key_data(), key_size);
+    if (ins->compressed_record_size) {
+      Compressor *decompressor = get_decompressor(idx);
+      decompressor->decompress(ins->get_record_data(), stored_record_size,
+                      record_size);
+      buffer.append(decompressor->get_output_data(), record_size);
+    }
+    else
+      buffer.append(ins->get_record_data(), record_size);
+
+    ins = (PJournalEntryInsert *)buffer.get_ptr();
+    ins->compressed_key_size = 0;
+    ins->compressed_record_size = 0;
+  }
+  else if (entry->type == kEntryTypeErase) {
+    PJournalEntryErase *e = (PJournalEntryErase *)auxbuffer->get_ptr();
+    if (!e->compressed_key_size)
+      return;
+    if (sizeof(PJournalEntryErase) - 1 + e->compressed_key_size
+            > auxbuffer->get_size()) {
+      ham_log(("journal entry is corrupt"));
+      throw Exception(HAM_INTEGRITY_VIOLATED);
+    }
+
+    Compressor *decompressor = get_decompressor(idx);
+    decompressor->decompress(e->get_key_data(), e->compressed_key_size,
+                    e->key_size);
+    buffer.append(e, sizeof(PJournalEntryErase) - 1);
+    buffer.append(decompressor->get_output_data(), e->key_size);
+
+    e = (PJournalEntryErase *)buffer.get_ptr();
+    e->compressed_key_size = 0;
+  }
+  else
+    return;
+
+  auxbuffer->swap(buffer);
 }
 
 void
@@ -501,6 +819,10 @@ Journal::get_entry(Iterator *iter, PJournalEntry *entry, ByteArray *auxbuffer)
     os_pread(m_fd[iter->fdidx], iter->offset, auxbuffer->get_ptr(),
                     entry->followup_size);
     iter->offset += entry->followup_size;
+
+    // the compressed keys and records are returned uncompressed
+    if (m_file_compressor[iter->fdidx])
+      decompress_entry(iter->fdidx, entry, auxbuffer);
   }
 
   // skip the trailer
@@ -512,6 +834,13 @@ Journal::close(bool noclear)
 {
   int i;
 
+  // wait till a pending group commit is finished
+  {
+    ScopedLock lock(m_sync_mutex);
+    while (m_sync_in_progress)
+      m_sync_cond.wait(lock);
+  }
+
   // the noclear flag is set during testing, for checking whether the files
   // contain the correct data. Flush the buffers, otherwise the tests will
   // fail because data is missing
@@ -521,7 +850,7 @@ Journal::close(bool noclear)
   }
 
   if (!noclear) {
-    PJournalHeader header;
+    PJournalHeader header(m_env->get_journal_compression());
 
     clear();
 
@@ -604,6 +933,9 @@ __abort_uncommitted_txns(Environment *env)
 void
 Journal::recover()
 {
+  boost::posix_time::ptime start
+          = boost::posix_time::microsec_clock::universal_time();
+
   // first re-apply the last changeset
   ham_u64_t start_lsn = recover_changeset();
   if (start_lsn > m_lsn)
@@ -623,6 +955,12 @@ Journal::recover()
   // then start the normal recovery
   if (m_env->get_flags() & HAM_ENABLE_TRANSACTIONS)
     recover_journal(start_lsn);
+
+  // finally rebuild the key counters
+  recover_key_counters();
+
+  m_recovery_usec = (ham_u64_t)(boost::posix_time::microsec_clock
+                        ::universal_time() - start).total_microseconds();
 }
 
 ham_u64_t 
@@ -653,7 +991,8 @@ Journal::recover_changeset()
 
   // only continue if it was a changeset; otherwise return, and the journal
   // will be applied
-  if (entry.type != kEntryTypeChangeset)
+  if (entry.type != kEntryTypeChangeset
+      && entry.type != kEntryTypeChangesetDelta)
     return (0);
 
   // Read the Changeset header
@@ -669,11 +1008,45 @@ Journal::recover_changeset()
     PJournalEntryPageHeader page_header;
     os_pread(m_fd[m_current_fd], position, &page_header, sizeof(page_header));
     position += sizeof(page_header);
-    os_pread(m_fd[m_current_fd], position, arena.get_ptr(), page_size);
-    position += page_size;
+
+    // older journals store the full page image; otherwise the modified
+    // ranges follow, and are read (and decompressed) in a single piece
+    PJournalEntryPageDelta delta;
+    const ham_u8_t *ranges = 0;
+    if (entry.type == kEntryTypeChangeset) {
+      os_pread(m_fd[m_current_fd], position, arena.get_ptr(), page_size);
+      position += page_size;
+    }
+    else {
+      os_pread(m_fd[m_current_fd], position, &delta, sizeof(delta));
+      position += sizeof(delta);
+
+      ham_u32_t size = page_header.compressed_size
+                          ? page_header.compressed_size
+                          : delta.size;
+      if (size > page_size + sizeof(PJournalEntryPageRange)
+          || delta.size > page_size + sizeof(PJournalEntryPageRange)) {
+        ham_log(("Changeset page is invalid"));
+        throw Exception(HAM_INTEGRITY_VIOLATED);
+      }
+      arena.resize(size);
+      os_pread(m_fd[m_current_fd], position, arena.get_ptr(), size);
+      position += size;
+
+      ranges = (const ham_u8_t *)arena.get_ptr();
+      if (page_header.compressed_size) {
+        Compressor *decompressor = get_decompressor(m_current_fd);
+        decompressor->decompress(ranges, size, delta.size);
+        ranges = decompressor->get_output_data();
+      }
+    }
 
     Page *page;
 
+    // the ranges are applied to a zeroed page if the page is not yet
+    // in the file
+    bool is_new = page_header.address >= file_size;
+
     // now write the page to disk
     if (page_header.address == file_size) {
       file_size += page_size;
@@ -703,10 +1076,41 @@ Journal::recover_changeset()
       }
     }
 
-    if (!skip) {
+    if (entry.type == kEntryTypeChangeset) {
       // overwrite the page data
-      memcpy(page->get_data(), arena.get_ptr(), page_size);
+      if (!skip)
+        memcpy(page->get_data(), arena.get_ptr(), page_size);
+    }
+    else {
+      if (!skip && is_new)
+        memset(page->get_data(), 0, page_size);
+
+      // apply the modified ranges
+      const ham_u8_t *end = ranges + delta.size;
+      for (ham_u32_t r = 0; r < delta.num_ranges; r++) {
+        PJournalEntryPageRange range;
+        if (ranges + sizeof(range) > end) {
+          ham_log(("Changeset page range is invalid"));
+          delete page;
+          throw Exception(HAM_INTEGRITY_VIOLATED);
+        }
+        memcpy(&range, ranges, sizeof(range));
+        ranges += sizeof(range);
+        if (range.offset > page_size
+            || range.length > page_size - range.offset
+            || range.length > (ham_u32_t)(end - ranges)) {
+          ham_log(("Changeset page range is invalid"));
+          delete page;
+          throw Exception(HAM_INTEGRITY_VIOLATED);
+        }
+        if (!skip)
+          memcpy((ham_u8_t *)page->get_data() + range.offset, ranges,
+                  range.length);
+        ranges += range.length;
+      }
+    }
 
+    if (!skip) {
       ham_assert(page->get_address() == page_header.address);
 
       // flush the modified page to disk
@@ -724,8 +1128,6 @@ void
 Journal::recover_journal(ham_u64_t start_lsn)
 {
   ham_status_t st = 0;
-  Iterator it;
-  ByteArray buffer;
 
   /* recovering the journal is rather simple - we iterate over the
    * files and re-apply EVERY operation (incl. txn_begin and txn_abort).
@@ -758,16 +1160,24 @@ Journal::recover_journal(ham_u64_t start_lsn)
   // do not append to the journal during recovery
   m_disable_logging = true;
 
-  do {
-    PJournalEntry entry;
+  // reads the entries in the background; the thread terminates after the
+  // last entry, therefore the files can be cleared afterwards
+  JournalReader reader(this);
 
-    // get the next entry
-    get_entry(&it, &entry, &buffer);
+  do {
+    // get the next entry; the reader has already read it in the background
+    JournalReader::Slot *slot = reader.get_next();
+    PJournalEntry &entry = slot->entry;
+    ByteArray &buffer = slot->buffer;
 
     // reached end of logfile?
     if (!entry.lsn)
       break;
 
+    m_count_recovered_entries++;
+    m_count_recovered_bytes += sizeof(PJournalEntry) + entry.followup_size
+            + sizeof(PJournalTrailer);
+
     // re-apply this operation
     switch (entry.type) {
       case kEntryTypeTxnBegin: {
@@ -848,7 +1258,8 @@ Journal::recover_journal(ham_u64_t start_lsn)
           st = 0;
         break;
       }
-      case kEntryTypeChangeset: {
+      case kEntryTypeChangeset:
+      case kEntryTypeChangesetDelta: {
         // skip this; the changeset was already applied
         break;
       }
@@ -882,9 +1293,30 @@ bail:
   clear();
 }
 
+void
+Journal::recover_key_counters()
+{
+  ham_u16_t max = m_env->get_header()->get_max_databases();
+  for (ham_u16_t dbi = 0; dbi < max; dbi++) {
+    ham_u16_t dbname = m_env->get_btree_descriptor(dbi)->get_dbname();
+    if (dbname == 0)
+      continue;
+    LocalDatabase *db = (LocalDatabase *)recover_get_db(m_env, dbname);
+    db->get_btree_index()->recount_keys();
+  }
+
+  // write the modified header page
+  m_env->get_changeset().flush(m_env->get_incremented_lsn());
+
+  (void)__close_all_databases(m_env);
+}
+
 void
 Journal::clear_file(int idx)
 {
+  // the writer thread must not write to the file after it was truncated
+  m_writer.flush();
+
   if (m_fd[idx] != HAM_INVALID_FD) {
     os_truncate(m_fd[idx], 0);
 
@@ -893,11 +1325,14 @@ Journal::clear_file(int idx)
     // the original size
     os_seek(m_fd[idx], 0, HAM_OS_SEEK_SET);
 
-    // now write the header with the up-to-date lsn
-    PJournalHeader header;
+    // now write the header with the up-to-date lsn; the file is now
+    // written with the compression algorithm of the Environment
+    PJournalHeader header(m_env->get_journal_compression());
     header.lsn = m_lsn;
     os_write(m_fd[idx], &header, sizeof(header));
   }
+  m_file_size[idx] = sizeof(PJournalHeader);
+  m_file_compressor[idx] = m_env->get_journal_compression();
 
   // clear the transaction counters
   m_open_txn[idx] = 0;
@@ -30,11 +30,36 @@
  * ("Log file switching"). When all Transactions from file #0 are committed,
  * and file #1 exceeds a limit, then the files are switched back again.
  *
+ * The limit is a number of Transactions, or (with HAM_PARAM_JOURNAL_SIZE_LIMIT)
+ * half of the configured size. A file can only be cleared when all its
+ * Transactions were flushed to the Btree. Therefore, if the current file
+ * exceeds the size limit but the other file still has Transactions, the
+ * TransactionManager performs a "checkpoint": it flushes all committed
+ * Transactions (and writes the modified pages), and the other file is
+ * cleared when the next Transaction begins. The header of the cleared file
+ * stores the lsn from which the recovery has to start. This bounds the size
+ * of the journal, and therefore the duration of the recovery, unless
+ * a single Transaction stays open for a long time.
+ *
  * For writing, files are buffered. The buffers are flushed when they
  * exceed a certain threshold, when a Transaction is committed or a Changeset
  * was written. In case of a commit or a changeset there will also be an
  * fsync, if HAM_ENABLE_FSYNC is enabled.
  *
+ * The buffers are written by a JournalWriter thread (see journal_writer.h).
+ * Full buffers and commits do not wait for the write; ham_txn_commit waits
+ * for it in sync(), after the Environment lock was released. A Changeset
+ * has to be written before the modified pages, therefore its write is
+ * awaited immediately.
+ *
+ * The fsync of a commit is not performed while the Environment is locked
+ * ("group commit"): ham_txn_commit writes the commit entry, releases the
+ * lock and then calls sync(). The first thread in sync() becomes the
+ * "leader" and performs the fsync; all other committers wait for the leader.
+ * If their entries were written before the fsync started then they are now
+ * durable; otherwise the next thread becomes the leader. This way a single
+ * fsync makes the commits of many concurrent threads durable.
+ *
  * The physical information is a collection of pages which are modified in
  * a single database operation (i.e. ham_db_erase). This collection is
  * called a "changeset" and implemented in changeset.h/.cc. As soon as the
@@ -43,6 +68,22 @@
  * Otherwise the whole changeset is appended to the journal, and afterwards
  * the database file is modified.
  *
+ * A changeset does not store the full page images, but only the ranges of
+ * bytes which differ from the pages in the database file
+ * (kEntryTypeChangesetDelta). This is possible because the pages are not
+ * written before their changeset is in the journal. If the write of a page
+ * is interrupted then the page is a mix of the old and the new version, but
+ * both are identical outside of the logged ranges. A page is logged in full
+ * if it is not yet in the file, or if its delta would not be smaller.
+ * Journals with full page images (kEntryTypeChangeset) are still recovered.
+ *
+ * With HAM_PARAM_JOURNAL_COMPRESSION, the keys and records of the insert and
+ * erase entries and the modified ranges of the changeset pages are
+ * compressed (see compressor.h), unless the compressed data would not be
+ * smaller. The header of each file stores the algorithm; an empty file
+ * adopts the algorithm of the Environment when it is opened, and a file
+ * with entries is recovered (and then cleared) with its own algorithm.
+ *
  * For recovery to work, each page stores the lsn of its last modification.
  * In addition, the journal also stores the last lsn - in the header structure
  * of each file, but also in each entry. 
@@ -63,19 +104,27 @@
  * In this phase all changesets are skipped because the newest changeset was
  * already applied, and we know that all older changesets
  * have already been written successfully to the database file.
+ *
+ * The entries are read by a JournalReader thread (see journal_reader.h)
+ * while the previous entries are re-applied.
  */
 
 #ifndef HAM_JOURNAL_H__
 #define HAM_JOURNAL_H__
 
 #include <cstdio>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include <ham/hamsterdb_int.h> // for metrics
 
 #include "os.h"
 #include "util.h"
+#include "mutex.h"
+#include "compressor.h"
 #include "journal_entries.h"
+#include "journal_writer.h"
 
 namespace hamsterdb {
 
@@ -123,22 +172,26 @@ class Journal
       kEntryTypeErase      = 5,
 
       // marks a whole changeset operation (writes modified pages)
-      kEntryTypeChangeset  = 6
+      kEntryTypeChangeset  = 6,
+
+      // marks a changeset operation which only writes the modified ranges
+      // of the pages
+      kEntryTypeChangesetDelta = 7
     };
 
     //
     // The header structure of a journal file
     //
     HAM_PACK_0 struct HAM_PACK_1 PJournalHeader {
-      PJournalHeader()
-        : magic(kHeaderMagic), _reserved(0), lsn(0) {
+      PJournalHeader(ham_u32_t _compressor = 0)
+        : magic(kHeaderMagic), compressor(_compressor), lsn(0) {
       }
 
       // the magic
       ham_u32_t magic;
 
-      // reserved, for padding
-      ham_u32_t _reserved;
+      // the compression algorithm of the entries (HAM_COMPRESSOR_*)
+      ham_u32_t compressor;
 
       // the last used lsn
       ham_u64_t lsn;
@@ -213,9 +266,16 @@ class Journal
     // Appends a journal entry for ham_txn_abort/kEntryTypeTxnAbort
     void append_txn_abort(LocalTransaction *txn, ham_u64_t lsn);
 
-    // Appends a journal entry for ham_txn_commit/kEntryTypeTxnCommit
+    // Appends a journal entry for ham_txn_commit/kEntryTypeTxnCommit.
+    // The entry is written to the file, but not yet synced; the caller
+    // has to call sync() (after releasing the Environment lock).
     void append_txn_commit(LocalTransaction *txn, ham_u64_t lsn);
 
+    // Makes all commit entries which were written so far durable, if
+    // HAM_ENABLE_FSYNC is enabled. Must not be called while the
+    // Environment is locked. Concurrent callers share a single fsync.
+    void sync();
+
     // Appends a journal entry for ham_insert/kEntryTypeInsert
     void append_insert(Database *db, LocalTransaction *txn,
                 ham_key_t *key, ham_record_t *record, ham_u32_t flags,
@@ -225,7 +285,7 @@ class Journal
     void append_erase(Database *db, LocalTransaction *txn,
                 ham_key_t *key, ham_u32_t dupe, ham_u32_t flags, ham_u64_t lsn);
 
-    // Appends a journal entry for a whole changeset/kEntryTypeChangeset
+    // Appends a journal entry for a whole changeset/kEntryTypeChangesetDelta
     void append_changeset(Page **bucket1, ham_u32_t bucket1_size,
                     Page **bucket2, ham_u32_t bucket2_size,
                     Page **bucket3, ham_u32_t bucket3_size,
@@ -248,6 +308,19 @@ class Journal
     // all others are automatically aborted
     void recover();
 
+    // Returns true if the current file exceeds the size limit, but the
+    // other file cannot be cleared because it still has Transactions
+    // which were not flushed
+    bool is_checkpoint_required() const {
+      int other = m_current_fd ? 0 : 1;
+      return (is_file_too_large(m_current_fd) && m_open_txn[other] > 0);
+    }
+
+    // Counts a checkpoint (for ham_env_get_metrics)
+    void checkpoint_performed() {
+      m_count_checkpoints++;
+    }
+
     // Returns the next lsn
     ham_u64_t get_incremented_lsn() {
       return (m_lsn++);
@@ -256,6 +329,19 @@ class Journal
     // Fills the metrics
     void get_metrics(ham_env_metrics_t *metrics) {
       metrics->journal_bytes_flushed = m_count_bytes_flushed;
+
+      metrics->journal_recovered_entries = m_count_recovered_entries;
+      metrics->journal_recovered_bytes = m_count_recovered_bytes;
+      metrics->journal_recovery_usec = m_recovery_usec;
+      metrics->journal_checkpoints = m_count_checkpoints;
+      metrics->journal_changeset_bytes_saved = m_count_bytes_saved;
+      metrics->journal_bytes_before_compression
+              = m_count_bytes_before_compression;
+      metrics->journal_bytes_after_compression
+              = m_count_bytes_after_compression;
+
+      ScopedLock lock(m_sync_mutex);
+      metrics->journal_group_syncs = m_count_group_syncs;
     }
 
     // Returns the previous lsn; only for testing!
@@ -266,12 +352,36 @@ class Journal
 
   private:
     friend struct JournalFixture;
+    friend class JournalReader;
 
-    // Helper function which adds a single page from the changeset to
-    // the Journal; returns the page size (or compressed size, if compression
-    // was enabled)
+    // Helper function which adds the modified ranges of a single page from
+    // the changeset to the Journal; returns the number of appended bytes
     ham_u32_t append_changeset_page(Page *page, ham_u32_t page_size);
 
+    // Compares the old (|before|) and the new version (|after|) of a page
+    // and stores the modified ranges in |ranges|. Ranges which are separated
+    // by only a few unmodified bytes are merged. Returns the size of the
+    // ranges (incl. the PJournalEntryPageRange headers) in the journal.
+    static ham_u32_t diff_page(const ham_u8_t *before, const ham_u8_t *after,
+                    ham_u32_t page_size,
+                    std::vector<PJournalEntryPageRange> *ranges);
+
+    // Compresses |size| bytes of |data| if compression is enabled; returns
+    // the compressed size, or 0 if the data is stored uncompressed (because
+    // it would not become smaller). The compressed data is returned by
+    // m_compressor->get_output_data().
+    ham_u32_t compress(const void *data, ham_u32_t size);
+
+    // Returns the Compressor for decompressing the entries of file |idx|
+    Compressor *get_decompressor(int idx);
+
+    // Decompresses the key and record of an insert or erase entry which
+    // was read from file |idx|; |auxbuffer| is replaced by the
+    // uncompressed entry. |entry->followup_size| still is the size in
+    // the file.
+    void decompress_entry(int idx, PJournalEntry *entry,
+                    ByteArray *auxbuffer);
+
     // Recovers (re-applies) the physical changelog; returns the lsn of the
     // Changelog
     ham_u64_t recover_changeset();
@@ -279,10 +389,28 @@ class Journal
     // Recovers the logical journal
     void recover_journal(ham_u64_t start_lsn);
 
+    // Rebuilds the key counters of all Databases; they are not logged,
+    // and therefore are not up-to-date after a crash
+    void recover_key_counters();
+
     // Switches the log file if necessary; sets the new log descriptor in the
     // transaction
     void switch_files_maybe(LocalTransaction *txn);
 
+    // Returns true if no new Transactions should be added to a file,
+    // because it has too many Transactions or exceeds the size limit
+    bool is_file_full(int idx) const {
+      return (m_open_txn[idx] + m_closed_txn[idx] >= m_threshold
+              || is_file_too_large(idx));
+    }
+
+    // Returns true if a file exceeds half of the size limit
+    bool is_file_too_large(int idx) const {
+      return (m_size_limit
+              && m_file_size[idx] + m_buffer[idx].get_size()
+                    >= m_size_limit / 2);
+    }
+
     // returns the path of the journal file
     std::string get_path(int i);
 
@@ -316,27 +444,36 @@ class Journal
         m_buffer[idx].append(ptr5, ptr5_size);
     }
 
-    // flush buffer if size limit is exceeded
+    // Hands the buffer to the writer thread if the size limit is exceeded
     void maybe_flush_buffer(int idx) {
       if (m_buffer[idx].get_size() >= kBufferLimit)
-        flush_buffer(idx);
+        write_buffer(idx);
     }
 
-    // Flushes a buffer to disk
-    void flush_buffer(int idx, bool fsync = false) {
-      if (m_buffer[idx].get_size() > 0) {
-        os_write(m_fd[idx], m_buffer[idx].get_ptr(), m_buffer[idx].get_size());
-        m_count_bytes_flushed += m_buffer[idx].get_size();
+    // Hands the buffer to the writer thread, without waiting for the
+    // write; returns the sequence number of the write
+    ham_u64_t write_buffer(int idx) {
+      m_count_bytes_flushed += m_buffer[idx].get_size();
+      m_file_size[idx] += m_buffer[idx].get_size();
+      return (m_writer.write(m_fd[idx], &m_buffer[idx]));
+    }
 
-        m_buffer[idx].clear();
-        if (fsync)
-          os_flush(m_fd[idx]);
-      }
+    // Flushes a buffer to disk; blocks till this and all previously
+    // queued buffers were written
+    void flush_buffer(int idx, bool fsync = false) {
+      if (m_buffer[idx].get_size() > 0)
+        write_buffer(idx);
+      m_writer.flush();
+      if (fsync)
+        os_flush(m_fd[idx]);
     }
 
     // Clears a single file
     void clear_file(int idx);
 
+    // Calls fsync on both files
+    void sync_files();
+
     // References the Environment this journal file is for
     LocalEnvironment *m_env;
 
@@ -349,6 +486,9 @@ class Journal
     // Buffers for writing data to the files
     ByteArray m_buffer[2];
 
+    // The sizes of the files, without the buffered data
+    ham_u64_t m_file_size[2];
+
     // For counting all open transactions in the files
     ham_u32_t m_open_txn[2];
 
@@ -365,11 +505,75 @@ class Journal
     // swap the files
     ham_u32_t m_threshold;
 
+    // The maximum size of both files (HAM_PARAM_JOURNAL_SIZE_LIMIT);
+    // 0 if the size is not limited
+    ham_u64_t m_size_limit;
+
     // Set to false to disable logging; used during recovery
     bool m_disable_logging;
 
     // Counting the flushed bytes (for ham_env_get_metrics)
     ham_u64_t m_count_bytes_flushed;
+
+    // Counting the entries and bytes which were read during recovery
+    // (for ham_env_get_metrics)
+    ham_u64_t m_count_recovered_entries;
+    ham_u64_t m_count_recovered_bytes;
+
+    // The duration of the recovery, in microseconds
+    ham_u64_t m_recovery_usec;
+
+    // Counting the checkpoints (for ham_env_get_metrics)
+    ham_u64_t m_count_checkpoints;
+
+    // Counting the bytes which were not logged because only the modified
+    // ranges of the changeset pages were written (for ham_env_get_metrics)
+    ham_u64_t m_count_bytes_saved;
+
+    // The old version of a changeset page, read from the database file
+    ByteArray m_before_image;
+
+    // The modified ranges of a changeset page
+    std::vector<PJournalEntryPageRange> m_ranges;
+
+    // Compresses the entries; null if compression is disabled
+    std::auto_ptr<Compressor> m_compressor;
+
+    // The compression algorithms of the two files, and the Compressors for
+    // decompressing their entries (created on demand)
+    int m_file_compressor[2];
+    std::auto_ptr<Compressor> m_decompressor[2];
+
+    // Temporary buffers for a compressed key and for the ranges of a
+    // changeset page
+    ByteArray m_compressed_key;
+    ByteArray m_page_ranges;
+
+    // Counting the bytes which were compressed, and the resulting bytes
+    // (for ham_env_get_metrics)
+    ham_u64_t m_count_bytes_before_compression;
+    ham_u64_t m_count_bytes_after_compression;
+
+    // Protects the following members, which are used for group commit
+    Mutex m_sync_mutex;
+
+    // Signalled when the leader finished an fsync
+    Condition m_sync_cond;
+
+    // The sequence number (see JournalWriter) of the last commit entry
+    ham_u64_t m_write_seq;
+
+    // The highest |m_write_seq| which is durable
+    ham_u64_t m_sync_seq;
+
+    // True while a leader performs an fsync
+    bool m_sync_in_progress;
+
+    // Counting the fsyncs of the group commit (for ham_env_get_metrics)
+    ham_u64_t m_count_group_syncs;
+
+    // Writes the buffers in the background
+    JournalWriter m_writer;
 };
 
 #include "packstop.h"
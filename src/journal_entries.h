@@ -78,13 +78,13 @@ HAM_PACK_0 struct HAM_PACK_1 PJournalEntryInsert {
   // key size
   ham_u16_t key_size;
 
-  // PRO: compressed key size
+  // compressed key size; 0 if the key is not compressed
   ham_u16_t compressed_key_size;
 
   // record size
   ham_u32_t record_size;
 
-  // PRO: compressed record size
+  // compressed record size; 0 if the record is not compressed
   ham_u32_t compressed_record_size;
 
   // record partial size
@@ -99,7 +99,8 @@ HAM_PACK_0 struct HAM_PACK_1 PJournalEntryInsert {
   // data follows here - first |key_size| bytes for the key, then
   // |record_size| bytes for the record (and maybe some padding)
   //
-  // PRO: this data can be compressed
+  // the key and the record can be compressed; then the compressed sizes
+  // are used instead
   ham_u8_t data[1];
 
   // Returns a pointer to the key data
@@ -109,7 +110,7 @@ HAM_PACK_0 struct HAM_PACK_1 PJournalEntryInsert {
 
   // Returns a pointer to the record data
   ham_u8_t *get_record_data() {
-    return (&data[key_size]);
+    return (&data[compressed_key_size ? compressed_key_size : key_size]);
   }
 } HAM_PACK_2;
 
@@ -131,7 +132,7 @@ HAM_PACK_0 struct HAM_PACK_1 PJournalEntryErase {
   // key size
   ham_u16_t key_size;
 
-  // PRO: compressed key size
+  // compressed key size; 0 if the key is not compressed
   ham_u16_t compressed_key_size;
 
   // flags of ham_erase(), ham_cursor_erase()
@@ -140,9 +141,7 @@ HAM_PACK_0 struct HAM_PACK_1 PJournalEntryErase {
   // which duplicate to erase
   ham_u32_t duplicate;
 
-  // the key data
-  //
-  // PRO: this data can be compressed
+  // the key data; compressed if |compressed_key_size| is not 0
   ham_u8_t data[1];
 
   // Returns a pointer to the key data
@@ -186,13 +185,58 @@ HAM_PACK_0 struct HAM_PACK_1 PJournalEntryPageHeader {
   // the page address
   ham_u64_t address;
 
-  // PRO: the compressed size, if compression is enabled
+  // the compressed size of the modified ranges (or the page image); 0 if
+  // the data is not compressed
   ham_u32_t compressed_size;
 } HAM_PACK_2;
 
 #include "packstop.h"
 
 
+#include "packstart.h"
+
+//
+// The modifications of a single page in a changeset of type
+// Journal::kEntryTypeChangesetDelta; follows the PJournalEntryPageHeader
+//
+HAM_PACK_0 struct HAM_PACK_1 PJournalEntryPageDelta {
+  // Constructor - sets all fields to 0
+  PJournalEntryPageDelta(ham_u32_t _num_ranges = 0, ham_u32_t _size = 0)
+    : num_ranges(_num_ranges), size(_size) {
+  }
+
+  // number of modified ranges; each range is a PJournalEntryPageRange,
+  // followed by the modified bytes
+  ham_u32_t num_ranges;
+
+  // the (uncompressed) size of the ranges, incl. their headers
+  ham_u32_t size;
+} HAM_PACK_2;
+
+#include "packstop.h"
+
+
+#include "packstart.h"
+
+//
+// A range of modified bytes in a page
+//
+HAM_PACK_0 struct HAM_PACK_1 PJournalEntryPageRange {
+  // Constructor - sets all fields to 0
+  PJournalEntryPageRange(ham_u32_t _offset = 0, ham_u32_t _length = 0)
+    : offset(_offset), length(_length) {
+  }
+
+  // the offset of the range, relative to the start of the page
+  ham_u32_t offset;
+
+  // the length of the range
+  ham_u32_t length;
+} HAM_PACK_2;
+
+#include "packstop.h"
+
+
 } // namespace hamsterdb
 
 #endif /* HAM_JOURNAL_ENTRIES_H__ */
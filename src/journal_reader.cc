@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2005-2014 Christoph Rupp (chris@crupp.de).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <boost/bind.hpp>
+
+#include "os.h"
+#include "error.h"
+#include "journal_reader.h"
+
+namespace hamsterdb {
+
+JournalReader::JournalReader(Journal *journal)
+  : m_journal(journal), m_read(0), m_released(0), m_pending(false),
+    m_queued_bytes(0), m_stop(false), m_done(false), m_status(0),
+    m_thread(boost::bind(&JournalReader::run, this))
+{
+}
+
+JournalReader::~JournalReader()
+{
+  {
+    ScopedLock lock(m_mutex);
+    m_stop = true;
+  }
+  m_free_cond.notify_one();
+  m_thread.join();
+}
+
+JournalReader::Slot *
+JournalReader::get_next()
+{
+  ScopedLock lock(m_mutex);
+
+  // release the previous slot
+  if (m_pending) {
+    m_queued_bytes -= m_slots[m_released % kMaxEntries].buffer.get_size();
+    m_released++;
+    m_pending = false;
+    m_free_cond.notify_one();
+  }
+
+  while (m_read == m_released && !m_done)
+    m_read_cond.wait(lock);
+
+  // the thread terminated without reading another entry
+  if (m_read == m_released)
+    throw Exception(m_status ? m_status : HAM_INTERNAL_ERROR);
+
+  m_pending = true;
+  return (&m_slots[m_released % kMaxEntries]);
+}
+
+void
+JournalReader::run()
+{
+  ham_status_t st = 0;
+
+  try {
+    // both files are read sequentially from start to end
+    for (int i = 0; i < 2; i++) {
+      ham_fd_t fd = m_journal->m_fd[i];
+      if (fd != HAM_INVALID_FD)
+        os_readahead(fd, 0, os_get_file_size(fd));
+    }
+
+    Journal::Iterator it;
+    while (true) {
+      Slot *slot;
+      {
+        ScopedLock lock(m_mutex);
+        while (!m_stop
+              && (m_read - m_released == kMaxEntries
+                || (m_queued_bytes > kMaxBytes && m_read > m_released)))
+          m_free_cond.wait(lock);
+        if (m_stop)
+          break;
+        slot = &m_slots[m_read % kMaxEntries];
+      }
+
+      // the slot is not used by get_next(), therefore it can be filled
+      // without holding the lock
+      m_journal->get_entry(&it, &slot->entry, &slot->buffer);
+      bool eof = (slot->entry.lsn == 0);
+
+      {
+        ScopedLock lock(m_mutex);
+        m_read++;
+        m_queued_bytes += slot->buffer.get_size();
+      }
+      m_read_cond.notify_one();
+
+      // reached the end of the journal?
+      if (eof)
+        break;
+    }
+  }
+  catch (Exception &ex) {
+    st = ex.code;
+  }
+
+  {
+    ScopedLock lock(m_mutex);
+    m_status = st;
+    m_done = true;
+  }
+  m_read_cond.notify_one();
+}
+
+} // namespace hamsterdb
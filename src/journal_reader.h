@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2005-2014 Christoph Rupp (chris@crupp.de).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * The journal reader
+ *
+ * A thread which reads the journal entries ahead of the recovery. The
+ * recovery re-applies the entries in their original order, but it no longer
+ * waits for the I/O: while an entry is replayed, the thread already reads
+ * the following ones into a ring of slots.
+ *
+ * The number of queued entries is limited by |kMaxEntries| and their
+ * (auxiliary) size by |kMaxBytes|. Errors of the thread are rethrown by
+ * get_next().
+ */
+
+#ifndef HAM_JOURNAL_READER_H__
+#define HAM_JOURNAL_READER_H__
+
+#include "mutex.h"
+#include "util.h"
+#include "journal.h"
+
+namespace hamsterdb {
+
+class JournalReader
+{
+  public:
+    enum {
+      // the maximum number of queued entries
+      kMaxEntries = 256,
+
+      // the maximum size of the queued auxiliary data (key and record)
+      kMaxBytes = 4 * 1024 * 1024
+    };
+
+    // A single entry, with its auxiliary data
+    struct Slot {
+      PJournalEntry entry;
+      ByteArray buffer;
+    };
+
+    // Constructor; starts the thread
+    JournalReader(Journal *journal);
+
+    // Destructor; stops the thread and waits till it terminated
+    ~JournalReader();
+
+    // Returns the next entry; the lsn of the entry is zero after the last
+    // entry. The slot is valid till the next call. Blocks till the entry
+    // was read; throws if the thread failed to read it.
+    Slot *get_next();
+
+  private:
+    // The thread's main function
+    void run();
+
+    // the Journal
+    Journal *m_journal;
+
+    // protects the following members
+    Mutex m_mutex;
+
+    // signalled when the thread queued an entry or terminated
+    Condition m_read_cond;
+
+    // signalled when get_next() released a slot, or the reader was stopped
+    Condition m_free_cond;
+
+    // the queued entries
+    Slot m_slots[kMaxEntries];
+
+    // the number of entries which were read by the thread
+    ham_u64_t m_read;
+
+    // the number of entries which were released by get_next()
+    ham_u64_t m_released;
+
+    // true if get_next() returned a slot which is not yet released
+    bool m_pending;
+
+    // the size of the queued auxiliary data
+    ham_u64_t m_queued_bytes;
+
+    // true if the thread should terminate
+    bool m_stop;
+
+    // true if the thread terminated
+    bool m_done;
+
+    // the error of the thread, if it failed
+    ham_status_t m_status;
+
+    // the thread; must be initialized last
+    Thread m_thread;
+};
+
+} // namespace hamsterdb
+
+#endif /* HAM_JOURNAL_READER_H__ */
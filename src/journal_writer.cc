@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2005-2014 Christoph Rupp (chris@crupp.de).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <boost/bind.hpp>
+
+#include "error.h"
+#include "journal_writer.h"
+
+namespace hamsterdb {
+
+JournalWriter::JournalWriter()
+  : m_queued(0), m_written(0), m_stop(false), m_status(0),
+    m_thread(boost::bind(&JournalWriter::run, this))
+{
+  for (int i = 0; i < kMaxBuffers; i++)
+    m_slots[i].fd = HAM_INVALID_FD;
+}
+
+JournalWriter::~JournalWriter()
+{
+  {
+    ScopedLock lock(m_mutex);
+    m_stop = true;
+  }
+  m_queued_cond.notify_one();
+  m_thread.join();
+}
+
+ham_u64_t
+JournalWriter::write(ham_fd_t fd, ByteArray *buffer)
+{
+  ScopedLock lock(m_mutex);
+
+  // wait till a slot is available
+  while (m_queued - m_written == kMaxBuffers && !m_status)
+    m_written_cond.wait(lock);
+  if (m_status)
+    throw Exception(m_status);
+
+  Slot &slot = m_slots[m_queued % kMaxBuffers];
+  slot.fd = fd;
+  slot.buffer.swap(*buffer);
+  m_queued++;
+
+  m_queued_cond.notify_one();
+  return (m_queued);
+}
+
+void
+JournalWriter::wait(ham_u64_t seq)
+{
+  ScopedLock lock(m_mutex);
+
+  while (m_written < seq)
+    m_written_cond.wait(lock);
+  if (m_status)
+    throw Exception(m_status);
+}
+
+void
+JournalWriter::flush()
+{
+  ham_u64_t seq;
+  {
+    ScopedLock lock(m_mutex);
+    seq = m_queued;
+  }
+  wait(seq);
+}
+
+void
+JournalWriter::run()
+{
+  ScopedLock lock(m_mutex);
+
+  while (true) {
+    while (m_written == m_queued && !m_stop)
+      m_queued_cond.wait(lock);
+
+    // the queued buffers are written before the thread terminates
+    if (m_written == m_queued)
+      break;
+
+    Slot &slot = m_slots[m_written % kMaxBuffers];
+
+    // write the buffer without holding the lock; write() does not
+    // modify this slot till it was written
+    ham_status_t st = 0;
+    lock.unlock();
+    try {
+      os_write(slot.fd, slot.buffer.get_ptr(), slot.buffer.get_size());
+    }
+    catch (Exception &ex) {
+      st = ex.code;
+    }
+    slot.buffer.clear();
+    lock.lock();
+
+    if (st && !m_status)
+      m_status = st;
+    m_written++;
+    m_written_cond.notify_all();
+  }
+}
+
+} // namespace hamsterdb
@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2005-2014 Christoph Rupp (chris@crupp.de).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * The journal writer
+ *
+ * A thread which writes the buffers of the Journal. The Journal hands over
+ * a full buffer (the memory is swapped, not copied) and continues to append
+ * to an empty buffer while the previous one is written. Up to |kMaxBuffers|
+ * buffers can be queued; afterwards write() blocks till a buffer was
+ * written.
+ *
+ * The buffers are written in the order in which they were queued. Every
+ * write has a sequence number; wait() blocks till a write (and all writes
+ * before) completed. Errors of the thread are rethrown by write() and
+ * wait().
+ */
+
+#ifndef HAM_JOURNAL_WRITER_H__
+#define HAM_JOURNAL_WRITER_H__
+
+#include "ham/types.h"
+
+#include "os.h"
+#include "mutex.h"
+#include "util.h"
+
+namespace hamsterdb {
+
+class JournalWriter
+{
+  public:
+    enum {
+      // the maximum number of queued buffers
+      kMaxBuffers = 2
+    };
+
+    // Constructor; starts the thread
+    JournalWriter();
+
+    // Destructor; writes the queued buffers, then stops the thread
+    ~JournalWriter();
+
+    // Queues |buffer| for writing to |fd|; |buffer| is empty afterwards.
+    // Returns the sequence number of this write
+    ham_u64_t write(ham_fd_t fd, ByteArray *buffer);
+
+    // Blocks till the write |seq| and all previous writes completed
+    void wait(ham_u64_t seq);
+
+    // Blocks till all queued writes completed
+    void flush();
+
+  private:
+    // A queued buffer
+    struct Slot {
+      ham_fd_t fd;
+      ByteArray buffer;
+    };
+
+    // The thread's main function
+    void run();
+
+    // protects the following members
+    Mutex m_mutex;
+
+    // signalled when a buffer was queued, or the thread should terminate
+    Condition m_queued_cond;
+
+    // signalled when a buffer was written
+    Condition m_written_cond;
+
+    // the queued buffers
+    Slot m_slots[kMaxBuffers];
+
+    // the sequence number of the last queued buffer
+    ham_u64_t m_queued;
+
+    // the sequence number of the last written buffer
+    ham_u64_t m_written;
+
+    // true if the thread should terminate
+    bool m_stop;
+
+    // the error of the thread, if a write failed
+    ham_status_t m_status;
+
+    // the thread; must be initialized last
+    Thread m_thread;
+};
+
+} // namespace hamsterdb
+
+#endif /* HAM_JOURNAL_WRITER_H__ */
@@ -20,6 +20,7 @@
 #define BOOST_ALL_NO_LIB // disable MSVC auto-linking
 #include <boost/version.hpp>
 #include <boost/thread/mutex.hpp>
+#include <boost/thread/shared_mutex.hpp>
 #include <boost/thread/thread.hpp>
 #include <boost/thread/tss.hpp>
 #include <boost/thread/condition.hpp>
@@ -27,6 +28,8 @@
 namespace hamsterdb {
 
 typedef boost::mutex::scoped_lock ScopedLock;
+typedef boost::unique_lock<boost::shared_mutex> ExclusiveLock;
+typedef boost::shared_lock<boost::shared_mutex> SharedLock;
 typedef boost::thread Thread;
 typedef boost::condition Condition;
 
@@ -45,6 +48,10 @@ class Mutex : public boost::mutex {
 #endif
 };
 
+// A reader/writer mutex; readers acquire a SharedLock, writers an
+// ExclusiveLock
+class RwMutex : public boost::shared_mutex {
+};
 
 } // namespace hamsterdb
 
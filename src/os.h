@@ -44,6 +44,11 @@ extern void
 os_pread(ham_fd_t fd, ham_u64_t addr, void *buffer,
             ham_u64_t bufferlen);
 
+// advises the kernel to read a range of a file in the background; this
+// is only a hint, errors are ignored
+extern void
+os_readahead(ham_fd_t fd, ham_u64_t addr, ham_u64_t size);
+
 // positional write to a file
 extern void
 os_pwrite(ham_fd_t fd, ham_u64_t addr, const void *buffer,
@@ -85,6 +90,11 @@ os_get_file_size(ham_fd_t fd);
 extern void
 os_truncate(ham_fd_t fd, ham_u64_t newsize);
 
+// grows the file by |size| bytes, starting at |offset| (the current file
+// size), and reserves the disk space if the file system supports it
+extern void
+os_allocate(ham_fd_t fd, ham_u64_t offset, ham_u64_t size);
+
 // create a new file
 extern ham_fd_t
 os_create(const char *filename, ham_u32_t flags, ham_u32_t mode);
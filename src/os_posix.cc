@@ -159,6 +159,20 @@ os_read(ham_fd_t fd, ham_u8_t *buffer, ham_u64_t bufferlen)
   }
 }
 
+void
+os_readahead(ham_fd_t fd, ham_u64_t addr, ham_u64_t size)
+{
+#if HAVE_POSIX_FADVISE
+  os_log(("os_readahead: fd=%d, address=%lld, size=%lld", fd, addr, size));
+
+  (void)::posix_fadvise(fd, addr, size, POSIX_FADV_WILLNEED);
+#else
+  (void)fd;
+  (void)addr;
+  (void)size;
+#endif
+}
+
 void
 os_pread(ham_fd_t fd, ham_u64_t addr, void *buffer,
             ham_u64_t bufferlen)
@@ -283,6 +297,24 @@ os_truncate(ham_fd_t fd, ham_u64_t newsize)
     throw Exception(HAM_IO_ERROR);
 }
 
+void
+os_allocate(ham_fd_t fd, ham_u64_t offset, ham_u64_t size)
+{
+  os_log(("os_allocate: fd=%d, offset=%lld, size=%lld", fd, offset, size));
+
+#if HAVE_POSIX_FALLOCATE
+  int r = ::posix_fallocate(fd, offset, size);
+  if (r == 0)
+    return;
+  if (r == ENOSPC) {
+    ham_log(("posix_fallocate failed with status %d (%s)", r, strerror(r)));
+    throw Exception(HAM_IO_ERROR);
+  }
+  // not supported by the file system: fall back to ftruncate
+#endif
+  os_truncate(fd, offset + size);
+}
+
 ham_fd_t
 os_create(const char *filename, ham_u32_t flags, ham_u32_t mode)
 {
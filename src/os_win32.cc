@@ -152,6 +152,15 @@ os_munmap(ham_fd_t *mmaph, void *buffer, ham_u64_t size)
   *mmaph = 0;
 }
 
+void
+os_readahead(ham_fd_t fd, ham_u64_t addr, ham_u64_t size)
+{
+  // not supported; Windows performs its own read-ahead
+  (void)fd;
+  (void)addr;
+  (void)size;
+}
+
 void
 os_pread(ham_fd_t fd, ham_u64_t addr, void *buffer, ham_u64_t bufferlen)
 {
@@ -307,6 +316,13 @@ os_truncate(ham_fd_t fd, ham_u64_t newsize)
   }
 }
 
+void
+os_allocate(ham_fd_t fd, ham_u64_t offset, ham_u64_t size)
+{
+  // SetEndOfFile() allocates the disk space
+  os_truncate(fd, offset + size);
+}
+
 ham_fd_t
 os_create(const char *filename, ham_u32_t flags, ham_u32_t mode)
 {
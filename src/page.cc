@@ -33,7 +33,8 @@ namespace hamsterdb {
 
 Page::Page(LocalEnvironment *env, LocalDatabase *db)
   : m_env(env), m_db(db), m_address(0), m_flags(0), m_dirty(false),
-    m_cursor_list(0), m_node_proxy(0), m_data(0)
+    m_cache_hot(false), m_pin_count(0), m_cursor_list(0), m_node_proxy(0),
+    m_data(0)
 {
   memset(&m_prev[0], 0, sizeof(m_prev));
   memset(&m_next[0], 0, sizeof(m_next));
@@ -41,6 +42,8 @@ Page::Page(LocalEnvironment *env, LocalDatabase *db)
 
 Page::~Page()
 {
+  ham_assert(m_pin_count == 0);
+
   if (m_env && m_env->get_device() && m_data != 0)
     m_env->get_device()->free_page(this);
 
@@ -81,7 +81,7 @@ typedef HAM_PACK_0 union HAM_PACK_1 PPageData {
  * Each Page instance is a node in several linked lists.
  * In order to avoid multiple memory allocations, the previous/next pointers
  * are part of the Page class (m_prev and m_next). Both fields are arrays
- * of pointers and can be used i.e. with m_prev[Page::kListBucket] etc.
+ * of pointers and can be used i.e. with m_prev[Page::kListCache] etc.
  * (or with the methods defined below).
  */
 class Page {
@@ -103,11 +103,8 @@ class Page {
       // list of all pages in a changeset
       kListChangeset          = 1,
 
-      // a bucket in the hash table of the cache
-      kListBucket             = 2,
-
       // array limit
-      kListMax                = 3
+      kListMax                = 2
     };
 
     // non-persistent page flags
@@ -203,6 +200,34 @@ class Page {
       m_dirty = dirty;
     }
 
+    // Returns true if this page is pinned, i.e. currently used by a thread;
+    // pinned pages are not purged from the cache
+    bool is_pinned() const {
+      return (m_pin_count > 0);
+    }
+
+    // Pins the page; the pin count is protected by the Cache
+    void pin() {
+      m_pin_count++;
+    }
+
+    // Unpins the page
+    void unpin() {
+      ham_assert(m_pin_count > 0);
+      m_pin_count--;
+    }
+
+    // Returns true if the page is in the "hot" list of the Cache (only
+    // used by the 2Q policy)
+    bool is_cache_hot() const {
+      return (m_cache_hot);
+    }
+
+    // Moves the page to the "hot" list or back; protected by the Cache
+    void set_cache_hot(bool hot) {
+      m_cache_hot = hot;
+    }
+
     // Returns the linked list of coupled cursors (can be NULL)
     BtreeCursor *get_cursor_list() {
       return (m_cursor_list);
@@ -368,6 +393,14 @@ class Page {
     // is this page dirty and needs to be flushed to disk?
     bool m_dirty;
 
+    // is this page in the "hot" list of the Cache? This is not part of
+    // |m_flags| because the flags are modified without holding the
+    // Cache's locks
+    bool m_cache_hot;
+
+    // number of threads which pinned this page
+    ham_u32_t m_pin_count;
+
     // linked list of all cursors which point to that page
     BtreeCursor *m_cursor_list;
 
@@ -27,16 +27,18 @@
 namespace hamsterdb {
 
 PageManager::PageManager(LocalEnvironment *env, ham_u64_t cache_size)
-  : m_env(env), m_cache(env, cache_size), m_needs_flush(false),
-    m_state_page(0), m_last_blob_page(0), m_last_blob_page_id(0),
-    m_page_count_fetched(0), m_page_count_flushed(0), m_page_count_index(0),
-    m_page_count_blob(0), m_page_count_page_manager(0), m_cache_hits(0),
-    m_cache_misses(0), m_freelist_hits(0), m_freelist_misses(0)
+  : m_env(env), m_cache(env, cache_size, env->get_cache_policy()),
+    m_flusher(0), m_needs_flush(false), m_state_page(0), m_last_blob_page(0),
+    m_last_blob_page_id(0), m_page_count_fetched(0), m_page_count_flushed(0),
+    m_page_count_prefetched(0), m_page_count_index(0), m_page_count_blob(0), m_page_count_page_manager(0),
+    m_cache_hits(0), m_cache_misses(0), m_freelist_hits(0),
+    m_freelist_misses(0)
 {
 }
 
 PageManager::~PageManager()
 {
+  stop_flusher();
 }
 
 void
@@ -220,12 +222,15 @@ PageManager::get_metrics(ham_env_metrics_t *metrics) const
 {
   metrics->page_count_fetched = m_page_count_fetched;
   metrics->page_count_flushed = m_page_count_flushed;
+  metrics->page_count_prefetched = m_page_count_prefetched;
   metrics->page_count_type_index = m_page_count_index;
   metrics->page_count_type_blob = m_page_count_blob;
   metrics->page_count_type_page_manager = m_page_count_page_manager;
   metrics->freelist_hits = m_freelist_hits;
   metrics->freelist_misses = m_freelist_misses;
   m_cache.get_metrics(metrics);
+  if (m_flusher)
+    m_flusher->get_metrics(metrics);
 }
 
 Page *
@@ -234,11 +239,16 @@ PageManager::fetch_page(LocalDatabase *db, ham_u64_t address,
 {
   Page *page = 0;
 
+  ham_u32_t cache_flags = (flags & kPinPage) ? Cache::kPin : 0;
+
   /* fetch the page from the cache */
-  page = m_cache.get_page(address);
+  page = m_cache.get_page(address, cache_flags);
   if (page) {
     ham_assert(page->get_data());
-    if (flags & kNoHeader)
+    // avoid the write if possible; the page can be shared by concurrent
+    // readers
+    if ((flags & kNoHeader)
+        && !(page->get_flags() & Page::kNpersNoHeader))
       page->set_flags(page->get_flags() | Page::kNpersNoHeader);
     /* store the page in the changeset if recovery is enabled */
     if (!(flags & kReadOnly) && m_env->get_flags() & HAM_ENABLE_RECOVERY)
@@ -260,21 +270,43 @@ PageManager::fetch_page(LocalDatabase *db, ham_u64_t address,
 
   ham_assert(page->get_data());
 
-  /* store the page in the list */
-  store_page(page);
-
   if (flags & kNoHeader)
     page->set_flags(page->get_flags() | Page::kNpersNoHeader);
 
+  /* store the page in the list; if another thread was faster then use
+   * its page instead */
+  Page *cached = m_cache.put_page_if_absent(page, cache_flags);
+  if (cached != page) {
+    delete page;
+    page = cached;
+    if ((flags & kNoHeader)
+        && !(page->get_flags() & Page::kNpersNoHeader))
+      page->set_flags(page->get_flags() | Page::kNpersNoHeader);
+  }
+  else {
+    maybe_store_state();
+    m_page_count_fetched++;
+  }
+
   /* store the page in the changeset */
   if (!(flags & kReadOnly) && m_env->get_flags() & HAM_ENABLE_RECOVERY)
     m_env->get_changeset().add_page(page);
 
-  m_page_count_fetched++;
-
   return (page);
 }
 
+void
+PageManager::prefetch_page(ham_u64_t address)
+{
+  if (m_env->get_flags() & HAM_IN_MEMORY)
+    return;
+  if (m_cache.has_page(address))
+    return;
+
+  m_env->get_device()->prefetch(address, m_env->get_page_size());
+  m_page_count_prefetched++;
+}
+
 Page *
 PageManager::alloc_page(LocalDatabase *db, ham_u32_t page_type, ham_u32_t flags)
 {
@@ -430,6 +462,9 @@ flush_all_pages_callback(Page *page, Database *db, ham_u32_t flags)
 void
 PageManager::flush_all_pages(bool nodelete)
 {
+  if (m_flusher)
+    m_flusher->wait_for_io();
+
   if (nodelete == false && m_last_blob_page) {
     m_last_blob_page_id = m_last_blob_page->get_address();
     m_last_blob_page = 0;
@@ -469,12 +504,38 @@ PageManager::purge_cache()
   ham_u32_t max_pages = m_cache.get_capacity() / m_env->get_page_size();
   if (max_pages == 0)
     max_pages = 1;
-  ham_u32_t limit = m_cache.get_current_elements() - max_pages;
+  ham_u64_t elements = m_cache.get_current_elements();
+  ham_u32_t limit = elements - max_pages;
   if (limit < kPurgeAtLeast)
     limit = kPurgeAtLeast;
+
+  // With a background flusher only the clean pages are purged; the
+  // flusher is woken up to write the dirty ones. Dirty pages are only
+  // written here if the flusher cannot keep up.
+  if (m_flusher && elements < (ham_u64_t)max_pages * kPurgeDirtyFactor) {
+    m_flusher->wakeup();
+    m_cache.purge(purge_callback, this, limit, Cache::kSkipDirty);
+    return;
+  }
+
   m_cache.purge(purge_callback, this, limit);
 }
 
+void
+PageManager::start_flusher(ham_u32_t high_watermark, ham_u32_t low_watermark)
+{
+  ham_assert(m_flusher == 0);
+  ham_assert(!(m_env->get_flags() & HAM_IN_MEMORY));
+  m_flusher = new Flusher(m_env, &m_cache, high_watermark, low_watermark);
+}
+
+void
+PageManager::stop_flusher()
+{
+  delete m_flusher;
+  m_flusher = 0;
+}
+
 static bool
 db_close_callback(Page *page, Database *db, ham_u32_t flags)
 {
@@ -500,6 +561,9 @@ db_close_callback(Page *page, Database *db, ham_u32_t flags)
 void
 PageManager::close_database(Database *db)
 {
+  if (m_flusher)
+    m_flusher->wait_for_io();
+
   if (m_last_blob_page) {
     m_last_blob_page_id = m_last_blob_page->get_address();
     m_last_blob_page = 0;
@@ -511,6 +575,9 @@ PageManager::close_database(Database *db)
 void
 PageManager::reclaim_space()
 {
+  if (m_flusher)
+    m_flusher->wait_for_io();
+
   if (m_last_blob_page) {
     m_last_blob_page_id = m_last_blob_page->get_address();
     m_last_blob_page = 0;
@@ -541,6 +608,9 @@ PageManager::reclaim_space()
     maybe_store_state(true);
     m_env->get_device()->truncate(file_size);
   }
+  // release the space which was reserved for growing the file
+  else if (m_env->get_file_growth_size())
+    m_env->get_device()->truncate(file_size);
 }
 
 void
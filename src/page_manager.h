@@ -25,6 +25,7 @@
 #include "env_local.h"
 #include "db_local.h"
 #include "cache.h"
+#include "flusher.h"
 
 namespace hamsterdb {
 
@@ -55,6 +56,10 @@ class PageManager {
       // Only pages above this age are purged
       kPurgeThreshold = 100,
 
+      // With a background flusher, dirty pages are only purged if the
+      // cache exceeds its capacity by this factor
+      kPurgeDirtyFactor = 2,
+
       // Flag for fetch_page(): only fetches from cache, not from disk
       kOnlyFromCache = 1,
 
@@ -62,7 +67,11 @@ class PageManager {
       kReadOnly = 2,
 
       // Flag for fetch_page(): page is part of a multi-page blob, has no header
-      kNoHeader = 4
+      kNoHeader = 4,
+
+      // Flag for fetch_page(): pins the page; it is not purged from the
+      // cache till unpin_page() is called
+      kPinPage = 8
     };
 
     // Default constructor
@@ -87,9 +96,19 @@ class PageManager {
     //
     // @param db The Database which fetches this page
     // @param address The page's address
-    // @param flags bitwise OR'd: kOnlyFromCache, kReadOnly
+    // @param flags bitwise OR'd: kOnlyFromCache, kReadOnly, kNoHeader,
+    //          kPinPage
     Page *fetch_page(LocalDatabase *db, ham_u64_t address, ham_u32_t flags = 0);
 
+    // Read-ahead: advises the device to load a page in the background,
+    // unless it is already cached
+    void prefetch_page(ham_u64_t address);
+
+    // Releases a page which was pinned with fetch_page(..., kPinPage)
+    void unpin_page(Page *page) {
+      m_cache.unpin_page(page);
+    }
+
     // Allocates a new page
     //
     // @param db The Database which allocates this page
@@ -107,6 +126,9 @@ class PageManager {
     // Flushes a Page to disk
     void flush_page(Page *page) {
       if (page->is_dirty()) {
+        // the flusher must not overwrite this page with an older copy
+        if (m_flusher)
+          m_flusher->wait_for_io();
         m_page_count_flushed++;
         page->flush();
       }
@@ -120,6 +142,23 @@ class PageManager {
     // Purges the cache if the cache limits are exceeded
     void purge_cache();
 
+    // Returns true if the cache is full; thread-safe
+    bool cache_is_full() const {
+      return (m_cache.is_full());
+    }
+
+    // Starts the background flusher; the watermarks are in percent of
+    // the cache capacity
+    void start_flusher(ham_u32_t high_watermark, ham_u32_t low_watermark);
+
+    // Stops the background flusher (if it is running)
+    void stop_flusher();
+
+    // Returns the background flusher, or null if it is not running
+    Flusher *get_flusher() {
+      return (m_flusher);
+    }
+
     // Reclaim file space; truncates unused file space at the end of the file.
     void reclaim_space();
 
@@ -183,11 +222,6 @@ class PageManager {
         maybe_store_state();
     }
 
-    /* returns true if the cache is full */
-    bool cache_is_full() const {
-      return (m_cache.is_full());
-    }
-
     /* if recovery is enabled then immediately write the modified blob */
     void maybe_store_state(bool force = false) {
       if (force || (m_env->get_flags() & HAM_ENABLE_RECOVERY)) {
@@ -218,6 +252,9 @@ class PageManager {
     // The cache
     Cache m_cache;
 
+    // The background flusher; null if it is disabled
+    Flusher *m_flusher;
+
     // The map with free pages
     FreeMap m_free_pages;
 
@@ -240,6 +277,9 @@ class PageManager {
     // tracks number of flushed pages
     ham_u64_t m_page_count_flushed;
 
+    // tracks number of pages which were prefetched
+    ham_u64_t m_page_count_prefetched;
+
     // tracks number of index pages
     ham_u64_t m_page_count_index;
 
@@ -27,7 +27,8 @@
  * When a Database is created, it contains a BtreeIndex for persistent
  * (committed and flushed) data, and a TransactionIndex for active Transactions
  * and those Transactions which were committed but not yet flushed to disk.
- * This TransactionTree is implemented as a binary search tree (see rb.h).
+ * This TransactionTree is implemented as an in-memory B+tree (see
+ * inmem_btree.h).
  *
  * Each node in the TransactionTree is implemented by TransactionNode. Each
  * node is identified by its database key, and groups all modifications of this
@@ -234,6 +235,11 @@ class TransactionManager
     // Flushes committed (queued) transactions
     virtual void flush_committed_txns() = 0;
 
+    // Makes the committed transactions durable; called by ham_txn_commit
+    // after the Environment lock was released (see Journal::sync())
+    virtual void sync_journal() {
+    }
+
     // Returns the oldest transaction which not yet flushed to disk
     Transaction *get_oldest_txn() {
       return (m_oldest_txn);
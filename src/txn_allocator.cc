@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2005-2014 Christoph Rupp (chris@crupp.de).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "config.h"
+
+#include <ham/hamsterdb_int.h>
+
+#include "mem.h"
+#include "txn_allocator.h"
+
+namespace hamsterdb {
+
+ham_u64_t g_txn_allocator_hits = 0;
+ham_u64_t g_txn_allocator_misses = 0;
+
+static inline size_t
+align8(size_t size)
+{
+  return ((size + 7) & ~(size_t)7);
+}
+
+void *
+TransactionArena::allocate(size_t size)
+{
+  size = align8(size);
+
+  if (size > m_left) {
+    // the first 8 bytes of a chunk link to the next chunk
+    size_t chunk_size = sizeof(ham_u64_t) + size;
+    if (chunk_size < m_chunk_size)
+      chunk_size = m_chunk_size;
+    if (m_chunk_size < kMaxChunkSize)
+      m_chunk_size *= 2;
+    char *chunk = Memory::allocate<char>(chunk_size);
+    *(char **)chunk = m_chunks;
+    m_chunks = chunk;
+    m_ptr = chunk + sizeof(ham_u64_t);
+    m_left = chunk_size - sizeof(ham_u64_t);
+    g_txn_allocator_misses++;
+  }
+  else
+    g_txn_allocator_hits++;
+
+  void *p = m_ptr;
+  m_ptr += size;
+  m_left -= size;
+  return (p);
+}
+
+void
+TransactionArena::clear()
+{
+  while (m_chunks) {
+    char *next = *(char **)m_chunks;
+    Memory::release(m_chunks);
+    m_chunks = next;
+  }
+  m_ptr = (char *)&m_inline[0];
+  m_left = kInlineSize;
+  m_chunk_size = kMinChunkSize;
+}
+
+void
+TransactionArena::get_metrics(ham_env_metrics_t *metrics)
+{
+  metrics->txn_allocator_hits = g_txn_allocator_hits;
+  metrics->txn_allocator_misses = g_txn_allocator_misses;
+}
+
+TransactionNodeSlab::~TransactionNodeSlab()
+{
+  ham_assert(m_live == 0);
+
+  while (m_slabs) {
+    char *next = *(char **)m_slabs;
+    Memory::release(m_slabs);
+    m_slabs = next;
+  }
+}
+
+void *
+TransactionNodeSlab::allocate(size_t size)
+{
+  size_t slot_size = align8(sizeof(TransactionNodeSlab *) + size);
+  ham_assert(m_slot_size == 0 || m_slot_size == slot_size);
+  m_slot_size = slot_size;
+
+  if (!m_freelist) {
+    char *slab = Memory::allocate<char>(sizeof(ham_u64_t)
+                    + m_slot_size * kObjectsPerSlab);
+    *(char **)slab = m_slabs;
+    m_slabs = slab;
+    add_to_freelist(slab);
+    g_txn_allocator_misses++;
+  }
+  else
+    g_txn_allocator_hits++;
+
+  char *slot = m_freelist;
+  m_freelist = *(char **)slot;
+  *(TransactionNodeSlab **)slot = this;
+  m_live++;
+  return (slot + sizeof(TransactionNodeSlab *));
+}
+
+void *
+TransactionNodeSlab::allocate_unpooled(size_t size)
+{
+  char *slot = Memory::allocate<char>(sizeof(TransactionNodeSlab *) + size);
+  *(TransactionNodeSlab **)slot = 0;
+  return (slot + sizeof(TransactionNodeSlab *));
+}
+
+void
+TransactionNodeSlab::release(void *p)
+{
+  if (!p)
+    return;
+
+  char *slot = (char *)p - sizeof(TransactionNodeSlab *);
+  TransactionNodeSlab *slab = *(TransactionNodeSlab **)slot;
+  if (slab)
+    slab->release_slot(slot);
+  else
+    Memory::release(slot);
+}
+
+void
+TransactionNodeSlab::release_slot(char *slot)
+{
+  ham_assert(m_live > 0);
+
+  *(char **)slot = m_freelist;
+  m_freelist = slot;
+
+  // all objects were released (i.e. because the Transactions were
+  // flushed)? then return the memory of the older slabs
+  if (--m_live == 0)
+    shrink();
+}
+
+void
+TransactionNodeSlab::shrink()
+{
+  ham_assert(m_live == 0);
+  if (!m_slabs || *(char **)m_slabs == 0)
+    return;
+
+  char *slab = *(char **)m_slabs;
+  while (slab) {
+    char *next = *(char **)slab;
+    Memory::release(slab);
+    slab = next;
+  }
+  *(char **)m_slabs = 0;
+
+  m_freelist = 0;
+  add_to_freelist(m_slabs);
+}
+
+void
+TransactionNodeSlab::add_to_freelist(char *slab)
+{
+  char *p = slab + sizeof(ham_u64_t);
+  for (int i = 0; i < kObjectsPerSlab; i++, p += m_slot_size) {
+    *(char **)p = m_freelist;
+    m_freelist = p;
+  }
+}
+
+} // namespace hamsterdb
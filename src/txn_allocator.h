@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2005-2014 Christoph Rupp (chris@crupp.de).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Allocators for the Transaction structures.
+ *
+ * The TransactionOperations of a Transaction are allocated from a
+ * TransactionArena, which is released in one step when the Transaction
+ * is deleted (after it was flushed or aborted).
+ *
+ * The TransactionNodes are shared by the Transactions of a Database, and
+ * therefore cannot live in a Transaction's arena. They are allocated from
+ * the TransactionNodeSlab of the TransactionIndex, which recycles the
+ * freed nodes.
+ */
+
+#ifndef HAM_TXN_ALLOCATOR_H__
+#define HAM_TXN_ALLOCATOR_H__
+
+#include <stddef.h>
+
+#include <ham/types.h>
+
+struct ham_env_metrics_t;
+
+namespace hamsterdb {
+
+// For counting allocations which were served without calling malloc;
+// for metrics only
+extern ham_u64_t g_txn_allocator_hits;
+
+// For counting the chunks and slabs which were allocated with malloc;
+// for metrics only
+extern ham_u64_t g_txn_allocator_misses;
+
+//
+// A bump-pointer allocator; memory cannot be released individually, only
+// all at once with clear(). The first bytes are stored inline, which
+// avoids any heap allocation for small (i.e. temporary) Transactions.
+//
+class TransactionArena
+{
+  public:
+    enum {
+      // number of bytes which are stored inline
+      kInlineSize = 512,
+
+      // the size of the chunks allocated from the heap; starts small (most
+      // Transactions are short) and doubles with each chunk
+      kMinChunkSize = 1024,
+      kMaxChunkSize = 64 * 1024
+    };
+
+    // Constructor
+    TransactionArena()
+      : m_chunks(0), m_ptr((char *)&m_inline[0]), m_left(kInlineSize),
+        m_chunk_size(kMinChunkSize) {
+    }
+
+    // Destructor; releases all memory
+    ~TransactionArena() {
+      clear();
+    }
+
+    // Allocates |size| bytes, aligned to 8 bytes; throws if out of memory
+    void *allocate(size_t size);
+
+    // Releases all allocated memory
+    void clear();
+
+    // Fills in the metrics of all TransactionArenas and
+    // TransactionNodeSlabs
+    static void get_metrics(ham_env_metrics_t *metrics);
+
+  private:
+    // the linked list of chunks; each chunk starts with a pointer to the
+    // next one
+    char *m_chunks;
+
+    // the next free byte
+    char *m_ptr;
+
+    // the number of free bytes at |m_ptr|
+    size_t m_left;
+
+    // the size of the next chunk
+    size_t m_chunk_size;
+
+    // the inline storage
+    ham_u64_t m_inline[kInlineSize / sizeof(ham_u64_t)];
+};
+
+//
+// Allocates fixed-size objects in slabs. Freed objects are stored in a
+// freelist and recycled. Each object is preceded by a pointer to its slab
+// allocator, therefore release() does not require a reference to the
+// allocator. Objects from allocate_unpooled() are released with the same
+// function.
+//
+class TransactionNodeSlab
+{
+  public:
+    enum {
+      // number of objects per slab
+      kObjectsPerSlab = 64
+    };
+
+    // Constructor
+    TransactionNodeSlab()
+      : m_slot_size(0), m_slabs(0), m_freelist(0), m_live(0) {
+    }
+
+    // Destructor; releases all slabs. All objects have to be released
+    // before.
+    ~TransactionNodeSlab();
+
+    // Allocates an object of |size| bytes; |size| must be the same for
+    // all objects of this allocator
+    void *allocate(size_t size);
+
+    // Allocates an object on the heap, bypassing the slab allocator
+    static void *allocate_unpooled(size_t size);
+
+    // Releases an object which was allocated with allocate() or
+    // allocate_unpooled()
+    static void release(void *p);
+
+  private:
+    // Returns an object to the freelist
+    void release_slot(char *slot);
+
+    // Releases all slabs but the newest one, and rebuilds the freelist;
+    // only allowed if all objects were released
+    void shrink();
+
+    // Adds the objects of |slab| to the freelist
+    void add_to_freelist(char *slab);
+
+    // size of each slot, incl. the pointer to the allocator
+    size_t m_slot_size;
+
+    // the linked list of slabs; each slab starts with a pointer to the
+    // next one
+    char *m_slabs;
+
+    // the linked list of free slots
+    char *m_freelist;
+
+    // number of objects which are currently in use
+    size_t m_live;
+};
+
+} // namespace hamsterdb
+
+#endif /* HAM_TXN_ALLOCATOR_H__ */
@@ -21,8 +21,7 @@
 
 #include <ham/hamsterdb.h>
 
-#include "mem.h"
-#include "txn.h"
+#include "txn_local.h"
 
 namespace hamsterdb {
 
@@ -36,7 +35,7 @@ struct TransactionFactory
             TransactionNode *node, ham_u32_t flags, ham_u32_t orig_flags,
             ham_u64_t lsn, ham_key_t *key, ham_record_t *record) {
     TransactionOperation *op;
-    op = (TransactionOperation *)Memory::allocate<char>(sizeof(*op)
+    op = (TransactionOperation *)txn->get_arena()->allocate(sizeof(*op)
                                             + (record ? record->size : 0)
                                             + (key ? key->size : 0));
     op->initialize(txn, node, flags, orig_flags, lsn, key, record);
@@ -28,21 +28,10 @@
 
 namespace hamsterdb {
 
-/* stuff for rb.h */
-#ifndef __ssize_t_defined
-typedef signed ssize_t;
-#endif
-#ifndef __cplusplus
-typedef int bool;
-#define true 1
-#define false (!true)
-#endif /* __cpluscplus */
-
-static int
-compare(void *vlhs, void *vrhs)
+int
+TransactionIndex::Compare::operator()(TransactionNode *lhs,
+                TransactionNode *rhs) const
 {
-  TransactionNode *lhs = (TransactionNode *)vlhs;
-  TransactionNode *rhs = (TransactionNode *)vrhs;
   LocalDatabase *db = lhs->get_db();
 
   if (lhs == rhs)
@@ -51,8 +40,6 @@ compare(void *vlhs, void *vrhs)
   return (db->get_btree_index()->compare_keys(lhs->get_key(), rhs->get_key()));
 }
 
-rb_wrap(static, rbt_, TransactionIndex, TransactionNode, node, compare)
-
 void
 TransactionOperation::initialize(LocalTransaction *txn, TransactionNode *node,
             ham_u32_t flags, ham_u32_t orig_flags, ham_u64_t lsn,
@@ -117,22 +104,21 @@ TransactionOperation::destroy()
   if (prev)
     prev->set_next_in_txn(next);
 
+  // the memory of this operation is released by the Transaction's arena
   if (delete_node)
     delete node;
-
-  Memory::release(this);
 }
 
 TransactionNode *
 TransactionNode::get_next_sibling()
 {
-  return (rbt_next(get_db()->get_txn_index(), this));
+  return (get_db()->get_txn_index()->get_next(this));
 }
 
 TransactionNode *
 TransactionNode::get_previous_sibling()
 {
-  return (rbt_prev(get_db()->get_txn_index(), this));
+  return (get_db()->get_txn_index()->get_previous(this));
 }
 
 TransactionNode::TransactionNode(LocalDatabase *db, ham_key_t *key)
@@ -148,6 +134,30 @@ TransactionNode::~TransactionNode()
 {
 }
 
+void *
+TransactionNode::operator new(size_t size, TransactionIndex *index)
+{
+  return (index->get_node_slab()->allocate(size));
+}
+
+void *
+TransactionNode::operator new(size_t size)
+{
+  return (TransactionNodeSlab::allocate_unpooled(size));
+}
+
+void
+TransactionNode::operator delete(void *p)
+{
+  TransactionNodeSlab::release(p);
+}
+
+void
+TransactionNode::operator delete(void *p, TransactionIndex *index)
+{
+  TransactionNodeSlab::release(p);
+}
+
 TransactionOperation *
 TransactionNode::append(LocalTransaction *txn, ham_u32_t orig_flags,
             ham_u32_t flags, ham_u64_t lsn, ham_key_t *key,
@@ -193,13 +203,13 @@ TransactionNode::append(LocalTransaction *txn, ham_u32_t orig_flags,
 void
 TransactionIndex::store(TransactionNode *node)
 {
-  rbt_insert(this, node);
+  m_tree.insert(node);
 }
 
 void
 TransactionIndex::remove(TransactionNode *node)
 {
-  rbt_remove(this, node);
+  m_tree.remove(node);
 }
 
 LocalTransactionManager::LocalTransactionManager(Environment *env)
@@ -283,30 +293,24 @@ LocalTransaction::free_operations()
 
   set_oldest_op(0);
   set_newest_op(0);
+
+  // now release the memory of all operations in one step
+  m_arena.clear();
 }
 
 TransactionIndex::TransactionIndex(LocalDatabase *db)
   : m_db(db)
 {
-  rbt_new(this);
-
-  // avoid warning about unused function
-  if (0) {
-    (void) (rbt_ppsearch(this, 0));
-  }
 }
 
 TransactionIndex::~TransactionIndex()
 {
   TransactionNode *node;
 
-  while ((node = rbt_last(this))) {
+  while ((node = m_tree.last())) {
     remove(node);
     delete node;
   }
-
-  // re-initialize the tree
-  rbt_new(this);
 }
 
 TransactionNode *
@@ -314,39 +318,32 @@ TransactionIndex::get(ham_key_t *key, ham_u32_t flags)
 {
   TransactionNode *node = 0;
   int match = 0;
+  Compare compare;
 
   /* create a temporary node that we can search for */
   TransactionNode tmp(m_db, key);
 
   /* search if node already exists - if yes, return it */
   if ((flags & HAM_FIND_GEQ_MATCH) == HAM_FIND_GEQ_MATCH) {
-    node = rbt_nsearch(this, &tmp);
+    node = m_tree.nsearch(&tmp);
     if (node)
       match = compare(&tmp, node);
   }
   else if ((flags & HAM_FIND_LEQ_MATCH) == HAM_FIND_LEQ_MATCH) {
-    node = rbt_psearch(this, &tmp);
+    node = m_tree.psearch(&tmp);
     if (node)
       match = compare(&tmp, node);
   }
   else if (flags & HAM_FIND_GT_MATCH) {
-    node = rbt_search(this, &tmp);
-    if (node)
-      node = node->get_next_sibling();
-    else
-      node = rbt_nsearch(this, &tmp);
+    node = m_tree.next(&tmp);
     match = 1;
   }
   else if (flags & HAM_FIND_LT_MATCH) {
-    node = rbt_search(this, &tmp);
-    if (node)
-      node = node->get_previous_sibling();
-    else
-      node = rbt_psearch(this, &tmp);
+    node = m_tree.previous(&tmp);
     match = -1;
   }
   else
-    return (rbt_search(this, &tmp));
+    return (m_tree.search(&tmp));
 
   /* tree is empty? */
   if (!node)
@@ -366,24 +363,19 @@ TransactionIndex::get(ham_key_t *key, ham_u32_t flags)
 TransactionNode *
 TransactionIndex::get_first()
 {
-  return (rbt_first(this));
+  return (m_tree.first());
 }
 
 TransactionNode *
 TransactionIndex::get_last()
 {
-  return (rbt_last(this));
+  return (m_tree.last());
 }
 
 void
 TransactionIndex::enumerate(TransactionIndex::Visitor *visitor)
 {
-  TransactionNode *node = rbt_first(this);
-
-  while (node) {
-    visitor->visit(node);
-    node = rbt_next(this, node);
-  }
+  m_tree.enumerate(visitor);
 }
 
 struct KeyCounter : public TransactionIndex::Visitor
@@ -506,6 +498,14 @@ LocalTransactionManager::commit(Transaction *htxn, ham_u32_t flags)
   m_queued_ops_for_flush += txn->get_op_counter();
   m_queued_bytes_for_flush += txn->get_accum_data_size();
   maybe_flush_committed_txns();
+
+  /* the journal exceeds its size limit? then flush all committed
+   * transactions, so the older journal file can be cleared */
+  Journal *journal = get_local_env()->get_journal();
+  if (journal && journal->is_checkpoint_required()) {
+    flush_committed_txns();
+    journal->checkpoint_performed();
+  }
 }
 
 void 
@@ -534,6 +534,14 @@ LocalTransactionManager::abort(Transaction *htxn, ham_u32_t flags)
   maybe_flush_committed_txns();
 }
 
+void
+LocalTransactionManager::sync_journal()
+{
+  Journal *journal = get_local_env()->get_journal();
+  if (journal)
+    journal->sync();
+}
+
 void
 LocalTransactionManager::maybe_flush_committed_txns()
 {
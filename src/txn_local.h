@@ -18,7 +18,8 @@
 #define HAM_TXN_LOCAL_H__
 
 #include "txn.h"
-#include "rb.h"
+#include "txn_allocator.h"
+#include "inmem_btree.h"
 
 namespace hamsterdb {
 
@@ -222,7 +223,7 @@ class TransactionOperation
 
 
 //
-// A node in the Transaction Index, used as the node structure in rb.h.
+// A node in the Transaction Index.
 // Manages a group of TransactionOperation objects which all modify the
 // same key.
 //
@@ -237,7 +238,6 @@ class TransactionNode
 {
   public:
     // Constructor;
-    // The default parameters are required for the compilation of rb.h.
     // |key| is just a temporary pointer which allows to create a
     // TransactionNode without further memory allocations/copying. The actual
     // key is then fetched from |m_oldest_op| as soon as this node is fully
@@ -248,6 +248,18 @@ class TransactionNode
     // was set to true
     ~TransactionNode();
 
+    // Allocates a node from the slab allocator of |index|
+    static void *operator new(size_t size, TransactionIndex *index);
+
+    // Allocates a node from the heap
+    static void *operator new(size_t size);
+
+    // Releases a node; works for both allocation functions
+    static void operator delete(void *p);
+
+    // Releases a node if the constructor threw an exception
+    static void operator delete(void *p, TransactionIndex *index);
+
     // Returns the database
     LocalDatabase *get_db() {
       return (m_db);
@@ -291,9 +303,6 @@ class TransactionNode
                 ham_u32_t flags, ham_u64_t lsn, ham_key_t *key,
                 ham_record_t *record);
 
-    // red-black tree stub, required for rb.h
-    rb_node(TransactionNode) node;
-
   private:
     friend struct TxnFixture;
 
@@ -307,17 +316,24 @@ class TransactionNode
     TransactionOperation *m_newest_op;
 
     // Pointer to the key data; only used as long as there are no operations
-    // attached. Otherwise we have a chicken-egg problem in rb.h.
+    // attached. Otherwise we have a chicken-egg problem in the
+    // TransactionIndex.
     ham_key_t *m_key;
 };
 
 
 //
-// Each Database has a binary tree which stores the current Transaction
-// operations; this tree is implemented in TransactionIndex
+// Each Database has an (in-memory) B+tree which stores the current
+// Transaction operations; this tree is implemented in TransactionIndex
 //
 class TransactionIndex
 {
+    // Compares two TransactionNodes with the compare function of the
+    // Database
+    struct Compare {
+      int operator()(TransactionNode *lhs, TransactionNode *rhs) const;
+    };
+
   public:
     // Traverses a TransactionIndex; for each node, a callback is executed
     struct Visitor {
@@ -352,16 +368,33 @@ class TransactionIndex
     // tree is empty
     TransactionNode *get_last();
 
+    // Returns the next larger node of |node|, or NULL if there is none
+    TransactionNode *get_next(TransactionNode *node) {
+      return (m_tree.next(node));
+    }
+
+    // Returns the next smaller node of |node|, or NULL if there is none
+    TransactionNode *get_previous(TransactionNode *node) {
+      return (m_tree.previous(node));
+    }
+
     // Returns the key count of this index
     ham_u64_t get_key_count(LocalTransaction *txn, ham_u32_t flags);
 
- // private: //TODO re-enable this; currently disabled because rb.h needs it
+    // Returns the allocator for the TransactionNodes
+    TransactionNodeSlab *get_node_slab() {
+      return (&m_node_slab);
+    }
+
+  private:
     // the Database for all operations in this tree
     LocalDatabase *m_db;
 
-    // stuff for rb.h
-    TransactionNode *rbt_root;
-    TransactionNode rbt_nil;
+    // the allocator for the TransactionNodes
+    TransactionNodeSlab m_node_slab;
+
+    // the sorted TransactionNodes
+    InMemoryBtree<TransactionNode, Compare> m_tree;
 };
 
 
@@ -422,6 +455,11 @@ class LocalTransaction : public Transaction
       return (m_accum_data_size);
     }
 
+    // Returns the allocator for the TransactionOperations
+    TransactionArena *get_arena() {
+      return (&m_arena);
+    }
+
   private:
     friend class Journal;
     friend struct TxnFixture;
@@ -457,6 +495,10 @@ class LocalTransaction : public Transaction
     // The approximate accumulated memory consumed by this Transaction
     // (sums up key->size and record->size over all operations)
     int m_accum_data_size;
+
+    // The memory of all TransactionOperations; released when the
+    // operations are freed
+    TransactionArena m_arena;
 };
 
 
@@ -494,6 +536,9 @@ class LocalTransactionManager : public TransactionManager
     // Flushes committed (queued) transactions
     virtual void flush_committed_txns();
 
+    // Makes the committed transactions durable
+    virtual void sync_journal();
+
     // Increments the global transaction ID and returns the new value. 
     ham_u64_t get_incremented_txn_id() {
       return (++m_txn_id);
@@ -122,6 +122,19 @@ class ByteArray
       m_own = false;
     }
 
+    // Exchanges the memory with |other|
+    void swap(ByteArray &other) {
+      void *ptr = m_ptr;
+      ham_u32_t size = m_size;
+      bool own = m_own;
+      m_ptr = other.m_ptr;
+      m_size = other.m_size;
+      m_own = other.m_own;
+      other.m_ptr = ptr;
+      other.m_size = size;
+      other.m_own = own;
+    }
+
   private:
     void *m_ptr;
     ham_u32_t m_size;
@@ -35,7 +35,8 @@ struct Configuration
     kKeyUint32,
     kKeyUint64,
     kKeyReal32,
-    kKeyReal64
+    kKeyReal64,
+    kKeyUrl
   };
 
   enum {
@@ -88,7 +89,10 @@ struct Configuration
       extkey_threshold(0), duptable_threshold(0), bulk_erase(false),
       flush_txn_immediately(false), disable_recovery(false),
       journal_compression(0), journal_compression_level(7),
-      record_compression(0), record_compression_level(7) {
+      record_compression(0), record_compression_level(7), key_compression(0),
+      cache_policy(0),
+      flusher_high_watermark(0), flusher_low_watermark(0),
+      file_growth_size(0), journal_size_limit(0) {
   }
 
   void print() const {
@@ -101,6 +105,8 @@ struct Configuration
       printf("--record-compression=%d ", record_compression);
     if (record_compression_level != 7)
       printf("--record-compression-level=%d ", record_compression_level);
+    if (key_compression)
+      printf("--key-compression=%d ", key_compression);
     if (use_encryption)
       printf("--use-encryption ");
     if (use_remote)
@@ -127,6 +133,19 @@ struct Configuration
       printf("--cache=unlimited ");
     if (cachesize)
       printf("--cache=%d ", cachesize);
+    if (cache_policy == HAM_CACHE_POLICY_2Q)
+      printf("--cache-policy=2q ");
+    if (flusher_high_watermark && flusher_low_watermark)
+      printf("--flusher-watermark=%d,%d ", flusher_high_watermark,
+              flusher_low_watermark);
+    else if (flusher_high_watermark)
+      printf("--flusher-watermark=%d ", flusher_high_watermark);
+    if (file_growth_size)
+      printf("--file-growth-size=%lu ", file_growth_size);
+    if (journal_size_limit)
+      printf("--journal-size-limit=%lu ", journal_size_limit);
+    if (!microbench.empty())
+      printf("--microbench=%s ", microbench.c_str());
     if (pagesize)
       printf("--pagesize=%d ", pagesize);
     if (num_threads > 1)
@@ -181,6 +200,8 @@ struct Configuration
         printf("--key=real32 ");
       else if (key_type == kKeyReal64)
         printf("--key=real64 ");
+      else if (key_type == kKeyUrl)
+        printf("--key=url ");
       if (key_size != kDefaultKeysize)
         printf("--keysize=%d ", key_size);
       if (key_is_fixed_size)
@@ -267,6 +288,13 @@ struct Configuration
   int journal_compression_level;
   int record_compression;
   int record_compression_level;
+  int key_compression;
+  int cache_policy;
+  int flusher_high_watermark;
+  int flusher_low_watermark;
+  unsigned long file_growth_size;
+  unsigned long journal_size_limit;
+  std::string microbench;
 };
 
 #endif /* CONFIGURATION_H__ */
@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2005-2014 Christoph Rupp (chris@crupp.de).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DATASOURCE_URL_H__
+#define DATASOURCE_URL_H__
+
+#include <stdio.h>
+#include <boost/limits.hpp>
+#include <boost/random.hpp>
+
+#include "datasource_numeric.h"
+
+//
+// Generates URL-like keys with long shared prefixes, i.e.
+//   http://www.example.com/catalog/books/fiction/item-0000000042.html
+// The keys are generated from a number; keys of neighbouring numbers share
+// their directories. The key size is not configurable.
+//
+class UrlDatasource : public Datasource
+{
+  public:
+    // formats the url for the number |n|
+    static void format(uint64_t n, std::vector<uint8_t> &vec) {
+      static const char *sections[] = {
+        "books", "electronics", "garden", "music", "sports", "toys"
+      };
+      static const char *categories[] = {
+        "accessories", "bestsellers", "classics", "fiction", "new-releases",
+        "offers", "reference", "used"
+      };
+
+      char buffer[128];
+      int len = ::snprintf(buffer, sizeof(buffer),
+                      "http://www.example.com/catalog/%s/%s/item-%010llu.html",
+                      sections[(n / 1000000) % 6],
+                      categories[(n / 10000) % 8],
+                      (unsigned long long)n);
+      vec.resize(len);
+      memcpy(&vec[0], buffer, len);
+    }
+};
+
+class UrlRandomDatasource : public UrlDatasource
+{
+  public:
+    UrlRandomDatasource(unsigned int seed = 0)
+      : m_seed(seed) {
+      reset();
+    }
+
+    // resets the input and restarts delivering the same sequence
+    // from scratch
+    virtual void reset() {
+      if (m_seed)
+        m_rng.seed(m_seed);
+    }
+
+    // returns the next piece of data
+    virtual void get_next(std::vector<uint8_t> &vec) {
+      format(m_rng() % 6000000, vec);
+    }
+
+  private:
+    boost::mt19937 m_rng;
+    unsigned int m_seed;
+};
+
+class UrlAscendingDatasource : public UrlDatasource
+{
+  public:
+    UrlAscendingDatasource()
+      : m_next(0) {
+    }
+
+    // resets the input and restarts delivering the same sequence
+    // from scratch
+    virtual void reset() {
+      m_next = 0;
+    }
+
+    // returns the next piece of data
+    virtual void get_next(std::vector<uint8_t> &vec) {
+      format(m_next++, vec);
+    }
+
+  private:
+    uint64_t m_next;
+};
+
+class UrlDescendingDatasource : public UrlDatasource
+{
+  public:
+    UrlDescendingDatasource()
+      : m_next(std::numeric_limits<uint32_t>::max()) {
+    }
+
+    // resets the input and restarts delivering the same sequence
+    // from scratch
+    virtual void reset() {
+      m_next = std::numeric_limits<uint32_t>::max();
+    }
+
+    // returns the next piece of data
+    virtual void get_next(std::vector<uint8_t> &vec) {
+      format(m_next--, vec);
+    }
+
+  private:
+    uint64_t m_next;
+};
+
+class UrlZipfianDatasource : public UrlDatasource
+{
+  public:
+    UrlZipfianDatasource(uint64_t n, long seed = 0, double alpha = 0.8)
+      : m_zipf(n, seed, alpha) {
+    }
+
+    // resets the input and restarts delivering the same sequence
+    // from scratch
+    virtual void reset() {
+      m_zipf.reset();
+    }
+
+    // returns the next piece of data
+    virtual void get_next(std::vector<uint8_t> &vec) {
+      format(m_zipf.get_next_number(), vec);
+    }
+
+  private:
+    NumericZipfianDatasource<uint64_t> m_zipf;
+};
+
+#endif /* DATASOURCE_URL_H__ */
@@ -20,6 +20,7 @@
 #include "datasource_numeric.h"
 #include "datasource_binary.h"
 #include "datasource_string.h"
+#include "datasource_url.h"
 #include "generator_runtime.h"
 
 #define kZipfianLimit       (1024 * 1024)
@@ -167,6 +168,24 @@ RuntimeGenerator::RuntimeGenerator(int id, Configuration *conf, Database *db,
           break;
       }
       break;
+    case Configuration::kKeyUrl:
+      switch (conf->distribution) {
+        case Configuration::kDistributionRandom:
+          m_datasource = new UrlRandomDatasource(conf->seed);
+          break;
+        case Configuration::kDistributionAscending:
+          m_datasource = new UrlAscendingDatasource();
+          break;
+        case Configuration::kDistributionDescending:
+          m_datasource = new UrlDescendingDatasource();
+          break;
+        case Configuration::kDistributionZipfian:
+          m_datasource = new UrlZipfianDatasource(
+                          conf->limit_ops ? conf->limit_ops : kZipfianLimit,
+                          conf->seed);
+          break;
+      }
+      break;
     case Configuration::kKeyReal32:
       switch (conf->distribution) {
         case Configuration::kDistributionRandom:
@@ -702,6 +721,7 @@ RuntimeGenerator::tee(const char *foo, const ham_key_t *key,
           ss << " (0, \"" << *(double *)key->data << '"';
           break;
         case Configuration::kKeyString:
+        case Configuration::kKeyUrl:
           ss << " (0, \"" << (const char *)key->data << '"';
           break;
         default:
@@ -75,7 +75,7 @@ HamsterDatabase::do_create_env()
 {
   ham_status_t st = 0;
   ham_u32_t flags = 0;
-  ham_parameter_t params[6] = {{0, 0}};
+  ham_parameter_t params[12] = {{0, 0}};
 
   ScopedLock lock(ms_mutex);
 
@@ -102,6 +102,31 @@ HamsterDatabase::do_create_env()
       params[p].value = m_config->journal_compression;
       p++;
     }
+    if (m_config->cache_policy) {
+      params[p].name = HAM_PARAM_CACHE_POLICY;
+      params[p].value = m_config->cache_policy;
+      p++;
+    }
+    if (m_config->flusher_high_watermark) {
+      params[p].name = HAM_PARAM_FLUSHER_HIGH_WATERMARK;
+      params[p].value = m_config->flusher_high_watermark;
+      p++;
+    }
+    if (m_config->flusher_low_watermark) {
+      params[p].name = HAM_PARAM_FLUSHER_LOW_WATERMARK;
+      params[p].value = m_config->flusher_low_watermark;
+      p++;
+    }
+    if (m_config->file_growth_size) {
+      params[p].name = HAM_PARAM_FILE_GROWTH_SIZE;
+      params[p].value = m_config->file_growth_size;
+      p++;
+    }
+    if (m_config->journal_size_limit) {
+      params[p].name = HAM_PARAM_JOURNAL_SIZE_LIMIT;
+      params[p].value = m_config->journal_size_limit;
+      p++;
+    }
 
     flags |= m_config->inmemory ? HAM_IN_MEMORY : 0; 
     flags |= m_config->no_mmap ? HAM_DISABLE_MMAP : 0; 
@@ -155,7 +180,7 @@ HamsterDatabase::do_open_env()
 {
   ham_status_t st = 0;
   ham_u32_t flags = 0;
-  ham_parameter_t params[6] = {{0, 0}};
+  ham_parameter_t params[12] = {{0, 0}};
 
   ScopedLock lock(ms_mutex);
 
@@ -180,6 +205,31 @@ HamsterDatabase::do_open_env()
       params[p].value = m_config->journal_compression;
       p++;
     }
+    if (m_config->cache_policy) {
+      params[p].name = HAM_PARAM_CACHE_POLICY;
+      params[p].value = m_config->cache_policy;
+      p++;
+    }
+    if (m_config->flusher_high_watermark) {
+      params[p].name = HAM_PARAM_FLUSHER_HIGH_WATERMARK;
+      params[p].value = m_config->flusher_high_watermark;
+      p++;
+    }
+    if (m_config->flusher_low_watermark) {
+      params[p].name = HAM_PARAM_FLUSHER_LOW_WATERMARK;
+      params[p].value = m_config->flusher_low_watermark;
+      p++;
+    }
+    if (m_config->file_growth_size) {
+      params[p].name = HAM_PARAM_FILE_GROWTH_SIZE;
+      params[p].value = m_config->file_growth_size;
+      p++;
+    }
+    if (m_config->journal_size_limit) {
+      params[p].name = HAM_PARAM_JOURNAL_SIZE_LIMIT;
+      params[p].value = m_config->journal_size_limit;
+      p++;
+    }
 
     flags |= m_config->no_mmap ? HAM_DISABLE_MMAP : 0; 
     flags |= m_config->cacheunlimited ? HAM_CACHE_UNLIMITED : 0;
@@ -285,6 +335,9 @@ HamsterDatabase::do_create_db(int id)
                             ? m_config->key_size
                             : HAM_KEY_SIZE_UNLIMITED;
       break;
+    case Configuration::kKeyUrl:
+      params[0].value = HAM_KEY_SIZE_UNLIMITED;
+      break;
     case Configuration::kKeyUint8:
       params[n].name = HAM_PARAM_KEY_TYPE;
       params[n].value = HAM_TYPE_UINT8;
@@ -321,6 +374,16 @@ HamsterDatabase::do_create_db(int id)
   params[n].name = HAM_PARAM_RECORD_SIZE;
   params[n].value = m_config->rec_size_fixed;
   n++;
+  if (m_config->record_compression) {
+    params[n].name = HAM_PARAM_RECORD_COMPRESSION;
+    params[n].value = m_config->record_compression;
+    n++;
+  }
+  if (m_config->key_compression) {
+    params[n].name = HAM_PARAM_KEY_COMPRESSION;
+    params[n].value = m_config->key_compression;
+    n++;
+  }
 
   ham_u32_t flags = 0;
 
@@ -37,6 +37,7 @@
 #endif
 #include "metrics.h"
 #include "misc.h"
+#include "microbench.h"
 
 #define ARG_HELP                                1
 #define ARG_VERBOSE                             2
@@ -88,6 +89,12 @@
 #define ARG_JOURNAL_COMPRESSION_LEVEL           63
 #define ARG_RECORD_COMPRESSION                  64
 #define ARG_RECORD_COMPRESSION_LEVEL            65
+#define ARG_CACHE_POLICY                        66
+#define ARG_MICROBENCH                          67
+#define ARG_FLUSHER_WATERMARK                   68
+#define ARG_FILE_GROWTH_SIZE                    69
+#define ARG_JOURNAL_SIZE_LIMIT                  70
+#define ARG_KEY_COMPRESSION                     71
 
 /*
  * command line parameters
@@ -189,7 +196,7 @@ static option_t opts[] = {
     ARG_KEY,
     0,
     "key",
-    "Describes the key type ('uint16', 'uint32', 'uint64', 'custom', 'string', 'binary' (default))",
+    "Describes the key type ('uint16', 'uint32', 'uint64', 'custom', 'string', 'url', 'binary' (default))",
     GETOPTS_NEED_ARGUMENT },
   {
     ARG_DISABLE_MMAP,
@@ -381,7 +388,7 @@ static option_t opts[] = {
     ARG_JOURNAL_COMPRESSION,
     0,
     "journal-compression",
-    "PRO: Enables journal compression (0: none, 1: zlib, 2: snappy, 3: lzf, 4: lzo)",
+    "Enables journal compression (0: none, 1: zlib, 5: lz4)",
     GETOPTS_NEED_ARGUMENT },
   {
     ARG_JOURNAL_COMPRESSION_LEVEL,
@@ -393,7 +400,7 @@ static option_t opts[] = {
     ARG_RECORD_COMPRESSION,
     0,
     "record-compression",
-    "PRO: Enables record compression (0: none, 1: zlib, 2: snappy, 3: lzf, 4: lzo)",
+    "Enables record compression (0: none, 1: zlib, 5: lz4)",
     GETOPTS_NEED_ARGUMENT },
   {
     ARG_RECORD_COMPRESSION_LEVEL,
@@ -401,6 +408,54 @@ static option_t opts[] = {
     "record-compression-level",
     "PRO: Sets the record compression (0 .. 9, default: 7); only for zlib",
     GETOPTS_NEED_ARGUMENT },
+  {
+    ARG_CACHE_POLICY,
+    0,
+    "cache-policy",
+    "Sets the cache replacement policy (lru, 2q; default: lru)",
+    GETOPTS_NEED_ARGUMENT },
+  {
+    ARG_MICROBENCH,
+    0,
+    "microbench",
+    "Runs a micro-benchmark of internal routines instead of the regular\n"
+    "\ttest; one of:\n"
+    "\tfetch-page: latency of cache hits in the PageManager\n"
+    "\tread-scaling: throughput of ham_db_find with 1, 2, 4 ...\n"
+    "\t\t--num-threads threads\n"
+    "\tnode-search: latency of the key search in a full node with\n"
+    "\t\tuint32/uint64 keys, for page sizes from 1kb to 64kb\n"
+    "\tgroup-commit: commits per second with HAM_ENABLE_FSYNC and 1, 2,\n"
+    "\t\t4 ... --num-threads committing threads\n"
+    "\tcompression: throughput and ratio of each available compressor\n"
+    "\t\tfor --keysize keys, --recsize records and --pagesize pages",
+    GETOPTS_NEED_ARGUMENT },
+  {
+    ARG_FLUSHER_WATERMARK,
+    0,
+    "flusher-watermark",
+    "Enables the background flusher; <high>[,<low>] are the percentages of\n"
+    "\tdirty pages in the cache which start and stop the flusher",
+    GETOPTS_NEED_ARGUMENT },
+  {
+    ARG_FILE_GROWTH_SIZE,
+    0,
+    "file-growth-size",
+    "Grows the file in extents of this size (in bytes)",
+    GETOPTS_NEED_ARGUMENT },
+  {
+    ARG_JOURNAL_SIZE_LIMIT,
+    0,
+    "journal-size-limit",
+    "Flushes committed Transactions when the journal grows larger than\n"
+    "\tthis size (in bytes)",
+    GETOPTS_NEED_ARGUMENT },
+  {
+    ARG_KEY_COMPRESSION,
+    0,
+    "key-compression",
+    "Enables key compression (0: none, 6: prefix)",
+    GETOPTS_NEED_ARGUMENT },
   {0, 0}
 };
 
@@ -487,6 +542,8 @@ parse_config(int argc, char **argv, Configuration *c)
         c->key_type = Configuration::kKeyReal64;
       else if (param && !strcmp(param, "string"))
         c->key_type = Configuration::kKeyString;
+      else if (param && !strcmp(param, "url"))
+        c->key_type = Configuration::kKeyUrl;
       else if (param && strcmp(param, "binary")) {
         printf("invalid parameter for --key\n");
         exit(-1);
@@ -718,6 +775,52 @@ parse_config(int argc, char **argv, Configuration *c)
     else if (opt == ARG_RECORD_COMPRESSION_LEVEL) {
       c->record_compression_level = strtoul(param, 0, 0);
     }
+    else if (opt == ARG_KEY_COMPRESSION) {
+      c->key_compression = strtoul(param, 0, 0);
+    }
+    else if (opt == ARG_CACHE_POLICY) {
+      if (param && !strcmp(param, "lru"))
+        c->cache_policy = HAM_CACHE_POLICY_LRU;
+      else if (param && !strcmp(param, "2q"))
+        c->cache_policy = HAM_CACHE_POLICY_2Q;
+      else {
+        printf("[FAIL] invalid parameter for '--cache-policy'\n");
+        exit(-1);
+      }
+    }
+    else if (opt == ARG_MICROBENCH) {
+      if (!param) {
+        printf("[FAIL] missing parameter for '--microbench'\n");
+        exit(-1);
+      }
+      c->microbench = param;
+    }
+    else if (opt == ARG_FLUSHER_WATERMARK) {
+      char *end = 0;
+      c->flusher_high_watermark = param ? strtoul(param, &end, 0) : 0;
+      if (end && *end == ',')
+        c->flusher_low_watermark = strtoul(end + 1, &end, 0);
+      if (!c->flusher_high_watermark || !end || *end
+          || c->flusher_high_watermark > 100
+          || c->flusher_low_watermark >= c->flusher_high_watermark) {
+        printf("[FAIL] invalid parameter for '--flusher-watermark'\n");
+        exit(-1);
+      }
+    }
+    else if (opt == ARG_FILE_GROWTH_SIZE) {
+      c->file_growth_size = param ? strtoul(param, 0, 0) : 0;
+      if (!c->file_growth_size) {
+        printf("[FAIL] invalid parameter for '--file-growth-size'\n");
+        exit(-1);
+      }
+    }
+    else if (opt == ARG_JOURNAL_SIZE_LIMIT) {
+      c->journal_size_limit = param ? strtoul(param, 0, 0) : 0;
+      if (!c->journal_size_limit) {
+        printf("[FAIL] invalid parameter for '--journal-size-limit'\n");
+        exit(-1);
+      }
+    }
     else if (opt == GETOPTS_PARAMETER) {
       c->filename = param;
     }
@@ -742,6 +845,21 @@ parse_config(int argc, char **argv, Configuration *c)
     printf("[FAIL] '--duplicate=first' needs 'use-cursors'\n");
     exit(-1);
   }
+
+  if (c->flusher_high_watermark && c->inmemory) {
+    printf("[FAIL] '--flusher-watermark' not supported with '--inmemorydb'\n");
+    exit(-1);
+  }
+
+  if (c->file_growth_size && c->inmemory) {
+    printf("[FAIL] '--file-growth-size' not supported with '--inmemorydb'\n");
+    exit(-1);
+  }
+
+  if (c->journal_size_limit && c->inmemory) {
+    printf("[FAIL] '--journal-size-limit' not supported with '--inmemorydb'\n");
+    exit(-1);
+  }
 }
 
 static void
@@ -840,6 +958,50 @@ print_metrics(Metrics *metrics, Configuration *conf)
           metrics->hamster_metrics.extended_duptables);
   printf("\thamsterdb journal_bytes_flushed       %lu\n",
           metrics->hamster_metrics.journal_bytes_flushed);
+  printf("\thamsterdb flusher_runs                %lu\n",
+          metrics->hamster_metrics.flusher_runs);
+  printf("\thamsterdb flusher_pages_flushed       %lu\n",
+          metrics->hamster_metrics.flusher_pages_flushed);
+  printf("\thamsterdb page_count_prefetched       %lu\n",
+          metrics->hamster_metrics.page_count_prefetched);
+  printf("\thamsterdb page_count_mapped           %lu\n",
+          metrics->hamster_metrics.page_count_mapped);
+  printf("\thamsterdb page_count_malloced         %lu\n",
+          metrics->hamster_metrics.page_count_malloced);
+  printf("\thamsterdb journal_group_syncs         %lu\n",
+          metrics->hamster_metrics.journal_group_syncs);
+  printf("\thamsterdb journal_recovered_entries   %lu\n",
+          metrics->hamster_metrics.journal_recovered_entries);
+  printf("\thamsterdb journal_recovered_bytes     %lu\n",
+          metrics->hamster_metrics.journal_recovered_bytes);
+  printf("\thamsterdb journal_recovery_usec       %lu\n",
+          metrics->hamster_metrics.journal_recovery_usec);
+  printf("\thamsterdb journal_checkpoints         %lu\n",
+          metrics->hamster_metrics.journal_checkpoints);
+  printf("\thamsterdb journal_changeset_bytes_saved %lu\n",
+          metrics->hamster_metrics.journal_changeset_bytes_saved);
+  printf("\thamsterdb journal_bytes_before_compression %lu\n",
+          metrics->hamster_metrics.journal_bytes_before_compression);
+  printf("\thamsterdb journal_bytes_after_compression %lu\n",
+          metrics->hamster_metrics.journal_bytes_after_compression);
+  if (metrics->hamster_metrics.journal_bytes_before_compression)
+    printf("\thamsterdb journal_compression_ratio   %.3f\n",
+          (double)metrics->hamster_metrics.journal_bytes_after_compression
+              / metrics->hamster_metrics.journal_bytes_before_compression);
+  printf("\thamsterdb record_bytes_before_compression %lu\n",
+          metrics->hamster_metrics.record_bytes_before_compression);
+  printf("\thamsterdb record_bytes_after_compression %lu\n",
+          metrics->hamster_metrics.record_bytes_after_compression);
+  if (metrics->hamster_metrics.record_bytes_before_compression)
+    printf("\thamsterdb record_compression_ratio    %.3f\n",
+          (double)metrics->hamster_metrics.record_bytes_after_compression
+              / metrics->hamster_metrics.record_bytes_before_compression);
+  printf("\thamsterdb txn_allocator_hits          %lu\n",
+          metrics->hamster_metrics.txn_allocator_hits);
+  printf("\thamsterdb txn_allocator_misses        %lu\n",
+          metrics->hamster_metrics.txn_allocator_misses);
+  printf("\thamsterdb btree_batch_leaf_hits      %lu\n",
+          metrics->hamster_metrics.btree_batch_leaf_hits);
 }
 
 struct Callable
@@ -1248,6 +1410,9 @@ main(int argc, char **argv)
   if (c.verbose && c.metrics == Configuration::kMetricsDefault)
     c.metrics = Configuration::kMetricsAll;
 
+  if (!c.microbench.empty())
+    return (run_microbench(&c) ? 0 : 1);
+
   bool ok = true;
 
   // if berkeleydb is disabled, and hamsterdb runs in only one thread:
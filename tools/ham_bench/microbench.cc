@@ -0,0 +1,592 @@
+/*
+ * Copyright (C) 2005-2014 Christoph Rupp (chris@crupp.de).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <memory>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <boost/random.hpp>
+#include <boost/ref.hpp>
+#include <boost/thread.hpp>
+
+#include "../../src/config.h"
+#include "../../src/env_local.h"
+#include "../../src/page_manager.h"
+#include "../../src/btree_search.h"
+#include "../../src/compressor_factory.h"
+
+#include "timer.h"
+#include "microbench.h"
+
+using namespace hamsterdb;
+
+//
+// Measures the latency of PageManager::fetch_page() for cache hits,
+// with a growing number of cached pages
+//
+static bool
+bench_fetch_page(Configuration *conf)
+{
+  static const ham_u32_t kPageSize = 1024;
+  static const ham_u32_t kMaxPages = 128 * 1024;
+
+  boost::mt19937 rng((boost::uint32_t)conf->seed);
+  ham_u64_t num_ops = conf->limit_ops;
+
+  for (ham_u32_t num_pages = 1024; num_pages <= kMaxPages; num_pages *= 4) {
+    ham_env_t *env;
+    ham_parameter_t params[] = {
+      {HAM_PARAM_PAGESIZE, kPageSize},
+      {0, 0}
+    };
+    ham_status_t st = ham_env_create(&env, 0, HAM_IN_MEMORY, 0, &params[0]);
+    if (st) {
+      printf("[FAIL] ham_env_create failed: %s\n", ham_strerror(st));
+      return (false);
+    }
+
+    PageManager *pm = ((LocalEnvironment *)env)->get_page_manager();
+    std::vector<ham_u64_t> addresses;
+    for (ham_u32_t i = 0; i < num_pages; i++)
+      addresses.push_back(pm->alloc_page(0, Page::kTypeBlob)->get_address());
+
+    // pick the pages in advance; the random generator is not measured
+    std::vector<ham_u32_t> lookups;
+    boost::uniform_int<ham_u32_t> dist(0, num_pages - 1);
+    for (ham_u64_t i = 0; i < num_ops; i++)
+      lookups.push_back(dist(rng));
+
+    ham_u64_t misses = 0;
+    Timer<boost::chrono::high_resolution_clock> t;
+    for (ham_u64_t i = 0; i < num_ops; i++) {
+      if (!pm->fetch_page(0, addresses[lookups[i]], PageManager::kReadOnly))
+        misses++;
+    }
+    double elapsed = t.seconds();
+
+    printf("\tfetch_page: %7u pages, %10.2f ns/lookup\n", num_pages,
+            num_ops ? elapsed * 1e9 / num_ops : 0.0);
+
+    ham_env_close(env, HAM_AUTO_CLEANUP);
+
+    if (misses) {
+      printf("[FAIL] fetch_page: %lu unexpected cache misses\n",
+              (unsigned long)misses);
+      return (false);
+    }
+  }
+
+  return (true);
+}
+
+//
+// A reader thread for bench_read_scaling(); looks up random keys and
+// verifies the records
+//
+struct ReadScalingWorker {
+  ReadScalingWorker(ham_db_t *db, ham_u64_t num_keys, ham_u64_t num_ops,
+                  boost::uint32_t seed)
+    : db(db), num_keys(num_keys), num_ops(num_ops), seed(seed), failures(0) {
+  }
+
+  void operator()() {
+    boost::mt19937 rng(seed);
+    boost::uniform_int<ham_u64_t> dist(0, num_keys - 1);
+
+    for (ham_u64_t i = 0; i < num_ops; i++) {
+      ham_u64_t k = dist(rng);
+      ham_u64_t r = 0;
+      ham_key_t key = {0};
+      key.data = &k;
+      key.size = sizeof(k);
+      // without HAM_ENABLE_CONCURRENT_READS all threads would share the
+      // same record buffer
+      ham_record_t record = {0};
+      record.data = &r;
+      record.flags = HAM_RECORD_USER_ALLOC;
+      if (ham_db_find(db, 0, &key, &record, 0) != 0
+          || record.size != sizeof(k)
+          || r != k)
+        failures++;
+    }
+  }
+
+  ham_db_t *db;
+  ham_u64_t num_keys;
+  ham_u64_t num_ops;
+  boost::uint32_t seed;
+  ham_u64_t failures;
+};
+
+//
+// Measures the throughput of ham_db_find() with 1, 2, 4 ... --num-threads
+// reader threads, with and without HAM_ENABLE_CONCURRENT_READS
+//
+static bool
+bench_read_scaling(Configuration *conf)
+{
+  static const ham_u64_t kNumKeys = 200 * 1000;
+  static const char *kFilename = "test-ham.db";
+
+  // fill the database
+  ham_env_t *env;
+  ham_db_t *db;
+  ham_parameter_t params[] = {
+    {HAM_PARAM_KEY_TYPE, HAM_TYPE_UINT64},
+    {HAM_PARAM_RECORD_SIZE, sizeof(ham_u64_t)},
+    {0, 0}
+  };
+  ham_status_t st = ham_env_create(&env, kFilename, 0, 0664, 0);
+  if (st == 0)
+    st = ham_env_create_db(env, &db, 1, 0, &params[0]);
+  if (st) {
+    printf("[FAIL] failed to create the database: %s\n", ham_strerror(st));
+    return (false);
+  }
+  for (ham_u64_t k = 0; k < kNumKeys && st == 0; k++) {
+    ham_key_t key = {0};
+    key.data = &k;
+    key.size = sizeof(k);
+    ham_record_t record = {0};
+    record.data = &k;
+    record.size = sizeof(k);
+    st = ham_db_insert(db, 0, &key, &record, 0);
+  }
+  ham_env_close(env, HAM_AUTO_CLEANUP);
+  if (st) {
+    printf("[FAIL] ham_db_insert failed: %s\n", ham_strerror(st));
+    return (false);
+  }
+
+  int max_threads = conf->num_threads > 1 ? conf->num_threads : 1;
+  ham_u32_t modes[] = {0, HAM_ENABLE_CONCURRENT_READS};
+
+  for (int m = 0; m < 2; m++) {
+    for (int num_threads = 1; ; num_threads *= 2) {
+      if (num_threads > max_threads)
+        num_threads = max_threads;
+
+      ham_parameter_t open_params[] = {
+        {HAM_PARAM_CACHESIZE, (ham_u64_t)conf->cachesize},
+        {0, 0}
+      };
+      st = ham_env_open(&env, kFilename, modes[m] | HAM_READ_ONLY,
+                      conf->cachesize ? &open_params[0] : 0);
+      if (st == 0)
+        st = ham_env_open_db(env, &db, 1, 0, 0);
+      if (st) {
+        printf("[FAIL] failed to open the database: %s\n", ham_strerror(st));
+        return (false);
+      }
+
+      // every thread performs its share of the lookups
+      std::vector<ReadScalingWorker *> workers;
+      for (int i = 0; i < num_threads; i++)
+        workers.push_back(new ReadScalingWorker(db, kNumKeys,
+                                conf->limit_ops / num_threads,
+                                (boost::uint32_t)conf->seed + i));
+
+      Timer<boost::chrono::high_resolution_clock> t;
+      std::vector<boost::thread *> threads;
+      for (int i = 0; i < num_threads; i++)
+        threads.push_back(new boost::thread(boost::ref(*workers[i])));
+      for (int i = 0; i < num_threads; i++) {
+        threads[i]->join();
+        delete threads[i];
+      }
+      double elapsed = t.seconds();
+
+      ham_u64_t ops = 0;
+      ham_u64_t failures = 0;
+      for (int i = 0; i < num_threads; i++) {
+        ops += workers[i]->num_ops;
+        failures += workers[i]->failures;
+        delete workers[i];
+      }
+
+      printf("\tread-scaling: %-10s %3d threads, %12.0f ops/sec\n",
+              modes[m] ? "concurrent" : "exclusive", num_threads,
+              elapsed > 0 ? ops / elapsed : 0.0);
+
+      ham_env_close(env, HAM_AUTO_CLEANUP);
+
+      if (failures) {
+        printf("[FAIL] read-scaling: %lu lookups failed\n",
+                (unsigned long)failures);
+        return (false);
+      }
+
+      if (num_threads == max_threads)
+        break;
+    }
+  }
+
+  return (true);
+}
+
+//
+// The binary search which was used for numeric keys before the vectorized
+// search was introduced; it is the baseline for bench_node_search()
+//
+template<typename T>
+static int
+binary_search(const T *data, int count, T key, int *pcmp)
+{
+  int l = 0;
+  int r = count;
+  while (l < r) {
+    int m = (l + r) / 2;
+    if (data[m] <= key)
+      l = m + 1;
+    else
+      r = m;
+  }
+  if (l == 0)
+    *pcmp = -1;
+  else
+    *pcmp = (data[l - 1] == key) ? 0 : +1;
+  return (l - 1);
+}
+
+//
+// Measures the key search in a (full) node of a given |page_size|, for
+// keys of type T: the old binary search, the vectorized search (used in
+// leaf nodes) and the EytzingerIndex (used in internal nodes)
+//
+template<typename T>
+static bool
+bench_node_search_type(Configuration *conf, const char *name)
+{
+  boost::mt19937 rng((boost::uint32_t)conf->seed);
+  ham_u64_t num_ops = conf->limit_ops;
+
+  for (ham_u32_t page_size = 1024; page_size <= 64 * 1024; page_size *= 2) {
+    // a leaf stores the keys and 8-byte record IDs (plus a flag byte)
+    int count = (int)(page_size / (sizeof(T) + sizeof(ham_u64_t) + 1));
+
+    // the keys are even numbers; odd lookups are misses
+    std::vector<T> keys;
+    for (int i = 0; i < count; i++)
+      keys.push_back((T)(i * 2 + 2));
+
+    std::vector<T> lookups;
+    boost::uniform_int<ham_u32_t> dist(0, (ham_u32_t)count * 2 + 2);
+    for (ham_u64_t i = 0; i < num_ops; i++)
+      lookups.push_back((T)dist(rng));
+
+    // the results are summed up to verify the searches, and to keep
+    // the compiler from optimizing the loops away
+    ham_u64_t sum1 = 0, sum2 = 0;
+    int cmp;
+
+    Timer<boost::chrono::high_resolution_clock> t1;
+    for (ham_u64_t i = 0; i < num_ops; i++)
+      sum1 += binary_search<T>(&keys[0], count, lookups[i], &cmp) + cmp;
+    double elapsed1 = t1.seconds();
+
+    Timer<boost::chrono::high_resolution_clock> t2;
+    for (ham_u64_t i = 0; i < num_ops; i++)
+      sum2 += find_numeric_key<T>(&keys[0], count, lookups[i], &cmp) + cmp;
+    double elapsed2 = t2.seconds();
+
+    // the search index which is used for internal nodes
+    EytzingerIndex<T> index;
+    index.build(&keys[0], count);
+    ham_u64_t sum3 = 0;
+    Timer<boost::chrono::high_resolution_clock> t3;
+    for (ham_u64_t i = 0; i < num_ops; i++)
+      sum3 += index.find(&keys[0], lookups[i], &cmp) + cmp;
+    double elapsed3 = t3.seconds();
+
+    printf("\tnode-search: %-6s %5u bytes, %5d keys, binary %7.2f ns, "
+            "vectorized %7.2f ns, eytzinger %7.2f ns/lookup\n", name,
+            page_size, count,
+            num_ops ? elapsed1 * 1e9 / num_ops : 0.0,
+            num_ops ? elapsed2 * 1e9 / num_ops : 0.0,
+            num_ops ? elapsed3 * 1e9 / num_ops : 0.0);
+
+    if (sum1 != sum2 || sum1 != sum3) {
+      printf("[FAIL] node-search: results do not match\n");
+      return (false);
+    }
+  }
+
+  return (true);
+}
+
+static bool
+bench_node_search(Configuration *conf)
+{
+  return (bench_node_search_type<ham_u32_t>(conf, "uint32")
+          && bench_node_search_type<ham_u64_t>(conf, "uint64"));
+}
+
+//
+// A committing thread for bench_group_commit(); each Transaction
+// inserts a single key
+//
+struct GroupCommitWorker {
+  GroupCommitWorker(ham_env_t *env, ham_db_t *db, ham_u64_t first_key,
+                  ham_u64_t num_txns)
+    : env(env), db(db), first_key(first_key), num_txns(num_txns),
+      failures(0) {
+  }
+
+  void operator()() {
+    for (ham_u64_t i = 0; i < num_txns; i++) {
+      ham_u64_t k = first_key + i;
+      ham_key_t key = {0};
+      key.data = &k;
+      key.size = sizeof(k);
+      ham_record_t record = {0};
+      record.data = &k;
+      record.size = sizeof(k);
+      ham_txn_t *txn;
+      if (ham_txn_begin(&txn, env, 0, 0, 0) != 0) {
+        failures++;
+        continue;
+      }
+      if (ham_db_insert(db, txn, &key, &record, 0) != 0)
+        failures++;
+      if (ham_txn_commit(txn, 0) != 0)
+        failures++;
+    }
+  }
+
+  ham_env_t *env;
+  ham_db_t *db;
+  ham_u64_t first_key;
+  ham_u64_t num_txns;
+  ham_u64_t failures;
+};
+
+//
+// Measures the commits per second with HAM_ENABLE_FSYNC and 1, 2, 4 ...
+// --num-threads committing threads, and the number of commits which
+// shared a single fsync
+//
+static bool
+bench_group_commit(Configuration *conf)
+{
+  static const char *kFilename = "test-ham.db";
+
+  int max_threads = conf->num_threads > 1 ? conf->num_threads : 1;
+
+  for (int num_threads = 1; ; num_threads *= 2) {
+    if (num_threads > max_threads)
+      num_threads = max_threads;
+
+    ham_env_t *env;
+    ham_db_t *db;
+    ham_parameter_t params[] = {
+      {HAM_PARAM_KEY_TYPE, HAM_TYPE_UINT64},
+      {HAM_PARAM_RECORD_SIZE, sizeof(ham_u64_t)},
+      {0, 0}
+    };
+    ham_status_t st = ham_env_create(&env, kFilename,
+                    HAM_ENABLE_TRANSACTIONS | HAM_ENABLE_FSYNC, 0664, 0);
+    if (st == 0)
+      st = ham_env_create_db(env, &db, 1, 0, &params[0]);
+    if (st) {
+      printf("[FAIL] failed to create the database: %s\n", ham_strerror(st));
+      return (false);
+    }
+
+    // every thread commits its share of the Transactions
+    ham_u64_t num_txns = conf->limit_ops / num_threads;
+    std::vector<GroupCommitWorker *> workers;
+    for (int i = 0; i < num_threads; i++)
+      workers.push_back(new GroupCommitWorker(env, db, i * num_txns,
+                              num_txns));
+
+    Timer<boost::chrono::high_resolution_clock> t;
+    std::vector<boost::thread *> threads;
+    for (int i = 0; i < num_threads; i++)
+      threads.push_back(new boost::thread(boost::ref(*workers[i])));
+    for (int i = 0; i < num_threads; i++) {
+      threads[i]->join();
+      delete threads[i];
+    }
+    double elapsed = t.seconds();
+
+    ham_env_metrics_t metrics = {0};
+    ham_env_get_metrics(env, &metrics);
+
+    ham_u64_t commits = 0;
+    ham_u64_t failures = 0;
+    for (int i = 0; i < num_threads; i++) {
+      commits += workers[i]->num_txns;
+      failures += workers[i]->failures;
+      delete workers[i];
+    }
+
+    printf("\tgroup-commit: %3d threads, %10.0f commits/sec, "
+            "%6.2f commits/fsync\n", num_threads,
+            elapsed > 0 ? commits / elapsed : 0.0,
+            metrics.journal_group_syncs
+                ? (double)commits / metrics.journal_group_syncs
+                : 0.0);
+
+    ham_env_close(env, HAM_AUTO_CLEANUP);
+
+    if (failures) {
+      printf("[FAIL] group-commit: %lu commits failed\n",
+              (unsigned long)failures);
+      return (false);
+    }
+
+    if (num_threads == max_threads)
+      break;
+  }
+
+  return (true);
+}
+
+//
+// Compresses and decompresses |blocks| with each available Compressor,
+// |total| bytes in all; prints the throughput and the ratio
+//
+static bool
+bench_compression_blocks(const char *name,
+                std::vector<std::vector<ham_u8_t> > &blocks, ham_u64_t total)
+{
+  static const struct {
+    int type;
+    const char *name;
+  } kCompressors[] = {
+    {HAM_COMPRESSOR_LZ4, "lz4"},
+    {HAM_COMPRESSOR_ZLIB, "zlib"},
+    {0, 0}
+  };
+
+  for (int c = 0; kCompressors[c].name; c++) {
+    if (!CompressorFactory::is_available(kCompressors[c].type))
+      continue;
+    std::auto_ptr<Compressor> compressor(
+                    CompressorFactory::create(kCompressors[c].type));
+
+    // the compressed blocks are stored for the decompression
+    std::vector<std::vector<ham_u8_t> > compressed(blocks.size());
+    ham_u64_t bytes = 0, compressed_bytes = 0;
+
+    Timer<boost::chrono::high_resolution_clock> t1;
+    for (size_t i = 0; bytes < total; i = (i + 1) % blocks.size()) {
+      ham_u32_t len = compressor->compress(&blocks[i][0],
+                      (ham_u32_t)blocks[i].size());
+      if (compressed[i].empty())
+        compressed[i].assign(compressor->get_output_data(),
+                        compressor->get_output_data() + len);
+      bytes += blocks[i].size();
+      compressed_bytes += len;
+    }
+    double elapsed1 = t1.seconds();
+
+    std::vector<ham_u8_t> output;
+    bool ok = true;
+    bytes = 0;
+    Timer<boost::chrono::high_resolution_clock> t2;
+    for (size_t i = 0; bytes < total; i = (i + 1) % blocks.size()) {
+      output.resize(blocks[i].size());
+      compressor->decompress(&compressed[i][0],
+                      (ham_u32_t)compressed[i].size(), &output[0],
+                      (ham_u32_t)output.size());
+      ok = ok && output == blocks[i];
+      bytes += blocks[i].size();
+    }
+    double elapsed2 = t2.seconds();
+
+    printf("	compression: %-4s %-8s compress %8.2f MB/s, "
+            "decompress %8.2f MB/s, ratio %.3f\n", kCompressors[c].name, name,
+            elapsed1 > 0 ? bytes / elapsed1 / (1024 * 1024) : 0.0,
+            elapsed2 > 0 ? bytes / elapsed2 / (1024 * 1024) : 0.0,
+            bytes ? (double)compressed_bytes / bytes : 0.0);
+
+    if (!ok) {
+      printf("[FAIL] compression: %s data does not match\n",
+              kCompressors[c].name);
+      return (false);
+    }
+  }
+
+  return (true);
+}
+
+//
+// Measures the throughput and the ratio of each available Compressor
+// for keys (--keysize), records (--recsize) and btree pages (--pagesize)
+//
+static bool
+bench_compression(Configuration *conf)
+{
+  static const ham_u64_t kTotal = 64 * 1024 * 1024;
+  static const int kMaxBlocks = 256;
+
+  boost::mt19937 rng((boost::uint32_t)conf->seed);
+  ham_u32_t page_size = conf->pagesize ? conf->pagesize : 16 * 1024;
+
+  // keys and records are random alphanumeric data, like the default
+  // binary data source
+  static const char kAlphabet[] = "0123456789"
+          "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+          "abcdefghijklmnopqrstuvwxyz";
+  std::vector<std::vector<ham_u8_t> > keys(kMaxBlocks);
+  std::vector<std::vector<ham_u8_t> > records(kMaxBlocks);
+  for (int i = 0; i < kMaxBlocks; i++) {
+    for (int j = 0; j < conf->key_size; j++)
+      keys[i].push_back(kAlphabet[rng() % (sizeof(kAlphabet) - 1)]);
+    for (int j = 0; j < conf->rec_size; j++)
+      records[i].push_back(kAlphabet[rng() % (sizeof(kAlphabet) - 1)]);
+  }
+
+  // the pages are leaf nodes with ascending 64bit keys and 8-byte records
+  std::vector<std::vector<ham_u8_t> > pages(kMaxBlocks);
+  ham_u64_t key = 0;
+  for (int i = 0; i < kMaxBlocks; i++) {
+    pages[i].resize(page_size);
+    ham_u32_t count = page_size / (2 * sizeof(ham_u64_t));
+    ham_u64_t *p = (ham_u64_t *)&pages[i][0];
+    for (ham_u32_t j = 0; j < count; j++) {
+      key += 1 + rng() % 16;
+      p[j] = key;
+      p[count + j] = rng() % 100000;
+    }
+  }
+
+  bool ok = true;
+  if (conf->key_size > 0)
+    ok = ok && bench_compression_blocks("keys", keys, kTotal);
+  if (conf->rec_size > 0)
+    ok = ok && bench_compression_blocks("records", records, kTotal);
+  return (ok && bench_compression_blocks("pages", pages, kTotal));
+}
+
+bool
+run_microbench(Configuration *conf)
+{
+  if (conf->microbench == "fetch-page")
+    return (bench_fetch_page(conf));
+  if (conf->microbench == "read-scaling")
+    return (bench_read_scaling(conf));
+  if (conf->microbench == "node-search")
+    return (bench_node_search(conf));
+  if (conf->microbench == "group-commit")
+    return (bench_group_commit(conf));
+  if (conf->microbench == "compression")
+    return (bench_compression(conf));
+
+  printf("[FAIL] unknown micro-benchmark '%s'\n", conf->microbench.c_str());
+  return (false);
+}
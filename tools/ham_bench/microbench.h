@@ -0,0 +1,33 @@
+/*
+ * Copyright (C) 2005-2014 Christoph Rupp (chris@crupp.de).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MICROBENCH_H__
+#define MICROBENCH_H__
+
+#include "configuration.h"
+
+//
+// Micro-benchmarks for internal hamsterdb routines; most of them directly
+// call into the library (bypassing the public API). All of them print their
+// results to stdout.
+//
+// |conf->microbench| is the name of the benchmark. Returns false if the
+// name is unknown or the benchmark failed.
+//
+extern bool
+run_microbench(Configuration *conf);
+
+#endif /* MICROBENCH_H__ */
@@ -19,6 +19,9 @@
 #include <stdlib.h>
 #include <errno.h>
 
+#include <string>
+#include <vector>
+
 #include <ham/hamsterdb.h>
 
 #include "getopts.h"
@@ -29,6 +32,8 @@
 #define ARG_STDIN         2
 #define ARG_MERGE         3
 
+// the items are inserted in batches of this size
+#define BATCH_SIZE        100000
 
 /*
  * command line parameters
@@ -81,7 +86,7 @@ class BinaryImporter : public Importer {
   public:
     BinaryImporter(FILE *f, ham_env_t *env, const char *outfilename)
       : Importer(f, env, outfilename), m_db(0), m_insert_flags(0),
-        m_db_counter(0), m_item_counter(0) {
+        m_db_counter(0), m_item_counter(0), m_batch_bytes(0) {
       m_buffer = (char *)malloc(1024 * 1024);
     }
 
@@ -98,7 +103,7 @@ class BinaryImporter : public Importer {
         // read the next message from the stream
         ham_u32_t size = read_size();
         if (!size)
-          return;
+          break;
 
         m_buffer = (char *)realloc(0, size);
         if (size != fread(m_buffer, 1, size, m_f)) {
@@ -128,6 +133,8 @@ class BinaryImporter : public Importer {
             exit(-1);
         }
       }
+
+      flush_batch();
     }
 
   private:
@@ -168,6 +175,7 @@ class BinaryImporter : public Importer {
       };
 
       if (m_db) {
+        flush_batch();
         ham_db_close(m_db, 0);
         m_db = 0;
       }
@@ -194,19 +202,40 @@ class BinaryImporter : public Importer {
     void read_item(HamsterTool::Datum &datum) {
       const HamsterTool::Item &item = datum.item();
 
-      const std::string &skey(item.key());
-      const std::string &srec(item.record());
+      m_batch_keys.push_back(item.key());
+      m_batch_records.push_back(item.record());
+      m_batch_bytes += item.key().size() + item.record().size();
+
+      if (m_batch_keys.size() >= BATCH_SIZE
+          || m_batch_bytes >= 64 * 1024 * 1024)
+        flush_batch();
+    }
+
+    // Inserts the buffered items with ham_db_bulk_insert; if the Database
+    // is empty (or if the keys are appended) then the Btree is built
+    // bottom-up instead of inserting the keys one by one
+    void flush_batch() {
+      if (m_batch_keys.empty())
+        return;
 
-      ham_key_t k = {};
-      k.data = (void *)skey.data();
-      k.size = skey.size();
-      ham_record_t r = {};
-      r.data = (void *)srec.data();
-      r.size = srec.size();
+      std::vector<ham_key_t> keys(m_batch_keys.size());
+      std::vector<ham_record_t> records(m_batch_keys.size());
+      for (size_t i = 0; i < m_batch_keys.size(); i++) {
+        keys[i].data = (void *)m_batch_keys[i].data();
+        keys[i].size = m_batch_keys[i].size();
+        records[i].data = (void *)m_batch_records[i].data();
+        records[i].size = m_batch_records[i].size();
+      }
 
-      ham_status_t st = ham_db_insert(m_db, 0, &k, &r, m_insert_flags);
+      ham_status_t st = ham_db_bulk_insert(m_db, 0, &keys[0], &records[0],
+                            (ham_u32_t)keys.size(), 0,
+                            m_insert_flags | HAM_BULK_BYPASS_TRANSACTIONS);
       if (st)
-        error("ham_db_insert", st);
+        error("ham_db_bulk_insert", st);
+
+      m_batch_keys.clear();
+      m_batch_records.clear();
+      m_batch_bytes = 0;
     }
 
     ham_u32_t read_size() {
@@ -228,6 +257,9 @@ class BinaryImporter : public Importer {
     ham_u32_t m_insert_flags;
     size_t m_db_counter;
     size_t m_item_counter;
+    std::vector<std::string> m_batch_keys;
+    std::vector<std::string> m_batch_records;
+    size_t m_batch_bytes;
 };
 
 int
@@ -79,6 +79,8 @@ get_compressor_name(int library) {
       return ("lzf");
     case HAM_COMPRESSOR_LZO:
       return ("lzo");
+    case HAM_COMPRESSOR_LZ4:
+      return ("lz4");
     default:
       return ("???");
   }
@@ -178,7 +180,7 @@ print_database(ham_db_t *db, ham_u16_t dbname, int full) {
     printf("    flags:                0x%04x\n", (unsigned)params[4].value);
     if (params[5].value)
       printf("    record compression:   %s\n",
-                      get_compressor_name((int)params[4].value));
+                      get_compressor_name((int)params[5].value));
     if (params[2].value == HAM_RECORD_SIZE_UNLIMITED)
       printf("    record size:          unlimited\n");
     else
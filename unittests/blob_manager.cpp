@@ -38,12 +38,15 @@ struct BlobManagerFixture {
   bool m_use_txn;
   ham_u32_t m_cache_size;
   ham_u32_t m_page_size;
+  int m_record_compression;
   BlobManager *m_blob_manager;
 
   BlobManagerFixture(bool inmemory = false, bool use_txn = false,
-        ham_u32_t cache_size = 0, ham_u32_t page_size = 0)
+        ham_u32_t cache_size = 0, ham_u32_t page_size = 0,
+        int record_compression = 0)
     : m_db(0), m_inmemory(inmemory), m_use_txn(use_txn),
-      m_cache_size(cache_size), m_page_size(page_size) {
+      m_cache_size(cache_size), m_page_size(page_size),
+      m_record_compression(record_compression) {
     ham_parameter_t params[3] = {
       { HAM_PARAM_CACHESIZE, m_cache_size },
       // set page_size, otherwise 16-bit limit bugs in freelist
@@ -51,6 +54,10 @@ struct BlobManagerFixture {
       { HAM_PARAM_PAGESIZE, (m_page_size ? m_page_size : 4096) },
       { 0, 0 }
     };
+    ham_parameter_t db_params[] = {
+      { HAM_PARAM_RECORD_COMPRESSION, (ham_u64_t)m_record_compression },
+      { 0, 0 }
+    };
 
     os::unlink(Globals::opath(".test"));
 
@@ -63,7 +70,8 @@ struct BlobManagerFixture {
               : 0)),
             0644, &params[0]));
     REQUIRE(0 ==
-        ham_env_create_db(m_env, &m_db, 1, 0, 0));
+        ham_env_create_db(m_env, &m_db, 1, 0,
+            m_record_compression ? &db_params[0] : 0));
     m_blob_manager = ((LocalEnvironment *)m_env)->get_blob_manager();
   }
 
@@ -367,6 +375,203 @@ struct BlobManagerFixture {
   void smallBlobTest() {
     loopInsert(20, 64);
   }
+
+  // fills |buffer| with a (compressible) JSON document
+  void fillDocument(ByteArray *buffer, ham_u32_t size) {
+    std::string s;
+    for (int i = 0; s.size() < size; i++) {
+      char tmp[128];
+      ::sprintf(tmp, "{\"id\": %d, \"name\": \"customer\", "
+                      "\"active\": true, \"tags\": [\"a\", \"b\"]},", i);
+      s += tmp;
+    }
+    buffer->copy(s.data(), size);
+  }
+
+  void compressionTest() {
+    LocalDatabase *ldb = (LocalDatabase *)m_db;
+    ham_env_metrics_t metrics = {0};
+    ByteArray buffer;
+    fillDocument(&buffer, 4096);
+
+    ham_record_t record = {0};
+    record.data = buffer.get_ptr();
+    record.size = buffer.get_size();
+    ham_u64_t blobid = m_blob_manager->allocate(ldb, &record, 0);
+    REQUIRE(blobid != 0ull);
+
+    REQUIRE(0 == ham_env_get_metrics(m_env, &metrics));
+    REQUIRE(metrics.record_bytes_before_compression == 4096ull);
+    REQUIRE(metrics.record_bytes_after_compression
+                    < metrics.record_bytes_before_compression / 4);
+
+    // the size is the uncompressed size
+    REQUIRE(m_blob_manager->get_blob_size(ldb, blobid) == 4096ull);
+
+    ByteArray *arena = &ldb->get_record_arena();
+    ham_record_t rec = {0};
+    m_blob_manager->read(ldb, blobid, &rec, 0, arena);
+    REQUIRE(rec.size == 4096u);
+    REQUIRE(0 == ::memcmp(buffer.get_ptr(), rec.data, rec.size));
+
+    // read into user-allocated memory
+    ByteArray user(4096);
+    rec.data = user.get_ptr();
+    rec.flags = HAM_RECORD_USER_ALLOC;
+    m_blob_manager->read(ldb, blobid, &rec, 0, arena);
+    REQUIRE(rec.size == 4096u);
+    REQUIRE(0 == ::memcmp(buffer.get_ptr(), user.get_ptr(), rec.size));
+
+    // partial read
+    rec.data = 0;
+    rec.flags = 0;
+    rec.partial_offset = 1000;
+    rec.partial_size = 100;
+    m_blob_manager->read(ldb, blobid, &rec, HAM_PARTIAL, arena);
+    REQUIRE(rec.partial_size == 100u);
+    REQUIRE(0 == ::memcmp((char *)buffer.get_ptr() + 1000, rec.data, 100));
+
+    // overwrite with a smaller document, then with a bigger one
+    fillDocument(&buffer, 2048);
+    record.size = 2048;
+    ham_u64_t blobid2 = m_blob_manager->overwrite(ldb, blobid, &record, 0);
+    REQUIRE(blobid2 == blobid);
+    ::memset(&rec, 0, sizeof(rec));
+    m_blob_manager->read(ldb, blobid2, &rec, 0, arena);
+    REQUIRE(rec.size == 2048u);
+    REQUIRE(0 == ::memcmp(buffer.get_ptr(), rec.data, rec.size));
+
+    fillDocument(&buffer, 64 * 1024);
+    record.data = buffer.get_ptr();
+    record.size = 64 * 1024;
+    blobid2 = m_blob_manager->overwrite(ldb, blobid, &record, 0);
+    m_blob_manager->read(ldb, blobid2, &rec, 0, arena);
+    REQUIRE(rec.size == 64u * 1024);
+    REQUIRE(0 == ::memcmp(buffer.get_ptr(), rec.data, rec.size));
+
+    m_blob_manager->erase(ldb, blobid2, 0);
+  }
+
+  void partialOverwriteCompressedTest() {
+    LocalDatabase *ldb = (LocalDatabase *)m_db;
+    ByteArray buffer;
+    fillDocument(&buffer, 4096);
+
+    ham_record_t record = {0};
+    record.data = buffer.get_ptr();
+    record.size = buffer.get_size();
+    ham_u64_t blobid = m_blob_manager->allocate(ldb, &record, 0);
+
+    // overwrite 10 bytes in the middle; the rest of the record is kept
+    char patch[10];
+    ::memset(patch, 'x', sizeof(patch));
+    record.data = patch;
+    record.partial_offset = 2000;
+    record.partial_size = sizeof(patch);
+    blobid = m_blob_manager->overwrite(ldb, blobid, &record, HAM_PARTIAL);
+    buffer.overwrite(2000, patch, sizeof(patch));
+
+    ByteArray *arena = &ldb->get_record_arena();
+    ham_record_t rec = {0};
+    m_blob_manager->read(ldb, blobid, &rec, 0, arena);
+    REQUIRE(rec.size == 4096u);
+    REQUIRE(0 == ::memcmp(buffer.get_ptr(), rec.data, rec.size));
+
+    // and grow the record with a partial write at the end
+    record.partial_offset = 4096;
+    record.size = 4096 + sizeof(patch);
+    blobid = m_blob_manager->overwrite(ldb, blobid, &record, HAM_PARTIAL);
+    buffer.append(patch, sizeof(patch));
+
+    m_blob_manager->read(ldb, blobid, &rec, 0, arena);
+    REQUIRE(rec.size == 4096u + sizeof(patch));
+    REQUIRE(0 == ::memcmp(buffer.get_ptr(), rec.data, rec.size));
+
+    m_blob_manager->erase(ldb, blobid, 0);
+  }
+
+  void incompressibleTest() {
+    LocalDatabase *ldb = (LocalDatabase *)m_db;
+    ham_env_metrics_t metrics = {0};
+    ByteArray buffer(1024);
+    ham_u8_t *p = (ham_u8_t *)buffer.get_ptr();
+    ham_u32_t seed = 12345;
+    for (int i = 0; i < 1024; i++) {
+      seed = seed * 1103515245 + 12345;
+      p[i] = (ham_u8_t)(seed >> 16);
+    }
+
+    // random data is stored uncompressed
+    ham_record_t record = {0};
+    record.data = buffer.get_ptr();
+    record.size = buffer.get_size();
+    ham_u64_t blobid = m_blob_manager->allocate(ldb, &record, 0);
+    REQUIRE(0 == ham_env_get_metrics(m_env, &metrics));
+    REQUIRE(metrics.record_bytes_before_compression == 1024ull);
+    REQUIRE(metrics.record_bytes_after_compression == 1024ull);
+
+    ByteArray *arena = &ldb->get_record_arena();
+    ham_record_t rec = {0};
+    m_blob_manager->read(ldb, blobid, &rec, 0, arena);
+    REQUIRE(rec.size == 1024u);
+    REQUIRE(0 == ::memcmp(buffer.get_ptr(), rec.data, rec.size));
+    m_blob_manager->erase(ldb, blobid, 0);
+
+    // extended keys and duplicate tables are never compressed
+    fillDocument(&buffer, 1024);
+    blobid = m_blob_manager->allocate(ldb, &record,
+                    BlobManager::kDisableCompression);
+    REQUIRE(0 == ham_env_get_metrics(m_env, &metrics));
+    REQUIRE(metrics.record_bytes_before_compression == 1024ull);
+    m_blob_manager->read(ldb, blobid, &rec, 0, arena);
+    REQUIRE(0 == ::memcmp(buffer.get_ptr(), rec.data, rec.size));
+    m_blob_manager->erase(ldb, blobid, 0);
+  }
+
+  void compressionParameterTest() {
+    ham_db_t *db;
+    ham_parameter_t params[] = {
+      { HAM_PARAM_RECORD_COMPRESSION, HAM_COMPRESSOR_SNAPPY },
+      { 0, 0 }
+    };
+    REQUIRE(HAM_NOT_IMPLEMENTED ==
+        ham_env_create_db(m_env, &db, 2, 0, &params[0]));
+
+    params[0].value = HAM_COMPRESSOR_LZ4;
+    REQUIRE(0 == ham_env_create_db(m_env, &db, 2, 0, &params[0]));
+
+    ByteArray buffer;
+    fillDocument(&buffer, 4096);
+    ham_key_t key = {0};
+    ham_record_t record = {0};
+    record.data = buffer.get_ptr();
+    record.size = buffer.get_size();
+    REQUIRE(0 == ham_db_insert(db, 0, &key, &record, 0));
+
+    // the setting is persistent
+    REQUIRE(0 == ham_env_close(m_env, HAM_AUTO_CLEANUP));
+    REQUIRE(0 == ham_env_open(&m_env, Globals::opath(".test"), 0, 0));
+    REQUIRE(HAM_INV_PARAMETER ==
+        ham_env_open_db(m_env, &db, 2, 0, &params[0]));
+    REQUIRE(0 == ham_env_open_db(m_env, &db, 2, 0, 0));
+
+    params[0].value = 0;
+    REQUIRE(0 == ham_db_get_parameters(db, &params[0]));
+    REQUIRE(params[0].value == (ham_u64_t)HAM_COMPRESSOR_LZ4);
+
+    ham_record_t rec = {0};
+    REQUIRE(0 == ham_db_find(db, 0, &key, &rec, 0));
+    REQUIRE(rec.size == 4096u);
+    REQUIRE(0 == ::memcmp(buffer.get_ptr(), rec.data, rec.size));
+
+    // not allowed for In-Memory Environments
+    ham_env_t *env;
+    REQUIRE(0 == ham_env_create(&env, 0, HAM_IN_MEMORY, 0, 0));
+    params[0].value = HAM_COMPRESSOR_LZ4;
+    REQUIRE(HAM_INV_PARAMETER ==
+        ham_env_create_db(env, &db, 1, 0, &params[0]));
+    REQUIRE(0 == ham_env_close(env, 0));
+  }
 };
 
 
@@ -815,4 +1020,71 @@ TEST_CASE("BlobManager-inmem-64k/smallBlobTest", "")
   f.smallBlobTest();
 }
 
+
+TEST_CASE("BlobManager-lz4/allocReadFreeTest", "")
+{
+  BlobManagerFixture f(false, true, 0, 0, HAM_COMPRESSOR_LZ4);
+  f.allocReadFreeTest();
+}
+
+TEST_CASE("BlobManager-lz4/replaceTest", "")
+{
+  BlobManagerFixture f(false, true, 0, 0, HAM_COMPRESSOR_LZ4);
+  f.replaceTest();
+}
+
+TEST_CASE("BlobManager-lz4/replaceWithBigTest", "")
+{
+  BlobManagerFixture f(false, true, 0, 0, HAM_COMPRESSOR_LZ4);
+  f.replaceWithBigTest();
+}
+
+TEST_CASE("BlobManager-lz4/replaceBiggerAndBiggerTest", "")
+{
+  BlobManagerFixture f(false, true, 0, 0, HAM_COMPRESSOR_LZ4);
+  f.replaceBiggerAndBiggerTest();
+}
+
+TEST_CASE("BlobManager-lz4/multipleAllocReadFreeTest", "")
+{
+  BlobManagerFixture f(false, true, 0, 0, HAM_COMPRESSOR_LZ4);
+  f.multipleAllocReadFreeTest();
+}
+
+TEST_CASE("BlobManager-lz4/hugeBlobTest", "")
+{
+  BlobManagerFixture f(false, true, 0, 0, HAM_COMPRESSOR_LZ4);
+  f.hugeBlobTest();
+}
+
+TEST_CASE("BlobManager-lz4/smallBlobTest", "")
+{
+  BlobManagerFixture f(false, true, 0, 0, HAM_COMPRESSOR_LZ4);
+  f.smallBlobTest();
+}
+
+TEST_CASE("BlobManager-lz4/compressionTest", "")
+{
+  BlobManagerFixture f(false, false, 0, 0, HAM_COMPRESSOR_LZ4);
+  f.compressionTest();
+}
+
+TEST_CASE("BlobManager-lz4/partialOverwriteCompressedTest", "")
+{
+  BlobManagerFixture f(false, false, 0, 0, HAM_COMPRESSOR_LZ4);
+  f.partialOverwriteCompressedTest();
+}
+
+TEST_CASE("BlobManager-lz4/incompressibleTest", "")
+{
+  BlobManagerFixture f(false, false, 0, 0, HAM_COMPRESSOR_LZ4);
+  f.incompressibleTest();
+}
+
+TEST_CASE("BlobManager-lz4/compressionParameterTest", "")
+{
+  BlobManagerFixture f(false, false, 0, 0);
+  f.compressionParameterTest();
+}
+
 } // namespace hamsterdb
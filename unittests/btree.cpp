@@ -21,11 +21,14 @@
 #include "globals.h"
 #include "os.hpp"
 
+#include <vector>
+
 #include "../src/env_local.h"
 #include "../src/page_manager.h"
 #include "../src/btree_index.h"
 #include "../src/btree_node_proxy.h"
 #include "../src/btree_impl_default.h"
+#include "../src/btree_search.h"
 
 namespace hamsterdb {
 
@@ -382,8 +385,151 @@ struct BtreeFixture {
 
     REQUIRE(0 == ham_env_close(env, HAM_AUTO_CLEANUP));
   }
+
+  template<typename T>
+  void numericSearchTest(T base) {
+    // the keys are base, base + 2, base + 4 ...; the keys in between
+    // are misses
+    for (int count = 1; count < 100; count++) {
+      std::vector<T> keys;
+      for (int i = 0; i < count; i++)
+        keys.push_back(base + (T)i * 2);
+
+      EytzingerIndex<T> index;
+      index.build(&keys[0], count);
+      REQUIRE(index.get_count() == count);
+
+      for (int i = -1; i < count * 2; i++) {
+        int cmp1, cmp2;
+        T key = base + (T)i;
+        int slot = find_numeric_key<T>(&keys[0], count, key, &cmp1);
+        REQUIRE(slot == index.find(&keys[0], key, &cmp2));
+        REQUIRE(cmp1 == cmp2);
+        if (i < 0) {
+          REQUIRE(slot == -1);
+          REQUIRE(cmp1 == -1);
+        }
+        else {
+          REQUIRE(slot == i / 2);
+          REQUIRE(cmp1 == (i % 2 ? +1 : 0));
+        }
+      }
+    }
+  }
+
+  void numericSearchDbTest() {
+    ham_db_t *db;
+    ham_env_t *env;
+    ham_parameter_t ps[] = {
+        { HAM_PARAM_KEY_TYPE, HAM_TYPE_UINT32 },
+        { 0, 0 }
+    };
+
+    REQUIRE(0 == ham_env_create(&env, Globals::opath("test.db"), 0, 0, 0));
+    REQUIRE(0 == ham_env_create_db(env, &db, 1, 0, &ps[0]));
+
+    // the keys have the upper bit set; they must not be compared as
+    // signed integers
+    ham_key_t key = {0};
+    ham_record_t rec = {0};
+    for (ham_u32_t i = 0; i < 5000; i++) {
+      ham_u32_t k = 0x7ffff000 + i * 2;
+      key.data = &k;
+      key.size = sizeof(k);
+      REQUIRE(0 == ham_db_insert(db, 0, &key, &rec, 0));
+    }
+
+    for (ham_u32_t i = 0; i < 5000; i++) {
+      ham_u32_t k = 0x7ffff000 + i * 2;
+      key.data = &k;
+      key.size = sizeof(k);
+      REQUIRE(0 == ham_db_find(db, 0, &key, &rec, 0));
+      k++;
+      REQUIRE(HAM_KEY_NOT_FOUND == ham_db_find(db, 0, &key, &rec, 0));
+      REQUIRE(0 == ham_db_find(db, 0, &key, &rec, HAM_FIND_LT_MATCH));
+      REQUIRE(*(ham_u32_t *)key.data == k - 1);
+    }
+
+    REQUIRE(0 == ham_env_close(env, HAM_AUTO_CLEANUP));
+  }
+
+  void internalSearchIndexTest() {
+    ham_db_t *db;
+    ham_env_t *env;
+    ham_parameter_t ps[] = {
+        { HAM_PARAM_KEY_TYPE, HAM_TYPE_UINT32 },
+        { 0, 0 }
+    };
+    ham_parameter_t params[] = {
+        { HAM_PARAM_PAGESIZE, 4096 },
+        { 0, 0 }
+    };
+
+    // small pages: the internal nodes (with more than 128 keys) are split
+    // and merged frequently
+    REQUIRE(0 == ham_env_create(&env, Globals::opath("test.db"), 0, 0,
+                            &params[0]));
+    REQUIRE(0 == ham_env_create_db(env, &db, 1, 0, &ps[0]));
+
+    ham_key_t key = {0};
+    ham_record_t rec = {0};
+    for (ham_u32_t i = 0; i < 50000; i++) {
+      ham_u32_t k = i * 2;
+      key.data = &k;
+      key.size = sizeof(k);
+      REQUIRE(0 == ham_db_insert(db, 0, &key, &rec, 0));
+    }
+
+    for (ham_u32_t i = 0; i < 50000; i += 3) {
+      ham_u32_t k = i * 2;
+      key.data = &k;
+      key.size = sizeof(k);
+      REQUIRE(0 == ham_db_erase(db, 0, &key, 0));
+    }
+    REQUIRE(0 == ham_db_check_integrity(db, 0));
+
+    for (ham_u32_t i = 0; i < 50000; i++) {
+      ham_u32_t k = i * 2;
+      key.data = &k;
+      key.size = sizeof(k);
+      REQUIRE((i % 3 ? 0 : HAM_KEY_NOT_FOUND)
+                      == ham_db_find(db, 0, &key, &rec, 0));
+      if (i == 0)
+        continue;
+      k++;
+      REQUIRE(0 == ham_db_find(db, 0, &key, &rec, HAM_FIND_LT_MATCH));
+      REQUIRE(*(ham_u32_t *)key.data == (i % 3 ? k - 1 : k - 3));
+    }
+
+    REQUIRE(0 == ham_env_close(env, HAM_AUTO_CLEANUP));
+  }
 };
 
+TEST_CASE("Btree/numericSearchTest", "")
+{
+  BtreeFixture f;
+  f.numericSearchTest<ham_u32_t>(1u);
+  f.numericSearchTest<ham_u32_t>(0x7fffff00u);
+  f.numericSearchTest<ham_u32_t>(0xfffffe00u);
+  f.numericSearchTest<ham_u64_t>(1ull);
+  f.numericSearchTest<ham_u64_t>(0x7fffffffffffff00ull);
+  f.numericSearchTest<ham_u64_t>(0xfffffffffffffe00ull);
+  f.numericSearchTest<float>(0.0f);
+  f.numericSearchTest<double>(-100.0);
+}
+
+TEST_CASE("Btree/numericSearchDbTest", "")
+{
+  BtreeFixture f;
+  f.numericSearchDbTest();
+}
+
+TEST_CASE("Btree/internalSearchIndexTest", "")
+{
+  BtreeFixture f;
+  f.internalSearchIndexTest();
+}
+
 TEST_CASE("Btree/binaryTypeTest", "")
 {
   BtreeFixture f;
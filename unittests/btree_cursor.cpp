@@ -343,6 +343,52 @@ struct BtreeCursorFixture {
     REQUIRE(0 == ham_cursor_close(c));
   }
 
+  void readAheadTest() {
+    ham_cursor_t *c;
+    ham_key_t key = {0};
+    ham_record_t rec = {0};
+    ham_env_metrics_t metrics;
+    const int kMax = 20000;
+
+    char buffer[16];
+
+    // the keys are compared with memcmp; format them accordingly
+    for (int i = 0; i < kMax; i++) {
+      ::sprintf(buffer, "%08d", i);
+      key.size = 9;
+      key.data = buffer;
+      REQUIRE(0 == ham_db_insert(m_db, 0, &key, &rec, 0));
+    }
+
+    // reopen the file; none of the leaves is cached
+    teardown();
+    REQUIRE(0 == ham_env_open(&m_env, Globals::opath(".test"), 0, 0));
+    REQUIRE(0 == ham_env_open_db(m_env, &m_db, 1, 0, 0));
+
+    REQUIRE(0 == ham_cursor_create(&c, m_db, 0, 0));
+    for (int i = 0; i < kMax; i++) {
+      REQUIRE(0 == ham_cursor_move(c, &key, 0, HAM_CURSOR_NEXT));
+      ::sprintf(buffer, "%08d", i);
+      REQUIRE(key.size == 9);
+      REQUIRE(0 == ::strcmp((const char *)key.data, buffer));
+    }
+    REQUIRE(HAM_KEY_NOT_FOUND == ham_cursor_move(c, &key, 0, HAM_CURSOR_NEXT));
+
+    REQUIRE(0 == ham_env_get_metrics(m_env, &metrics));
+    ham_u64_t prefetched = metrics.page_count_prefetched;
+    REQUIRE(prefetched > 0);
+    REQUIRE(prefetched < metrics.page_count_fetched);
+
+    // the second scan does not prefetch the cached pages
+    REQUIRE(0 == ham_cursor_move(c, &key, 0, HAM_CURSOR_FIRST));
+    for (int i = 1; i < kMax; i++)
+      REQUIRE(0 == ham_cursor_move(c, &key, 0, HAM_CURSOR_NEXT));
+    REQUIRE(0 == ham_env_get_metrics(m_env, &metrics));
+    REQUIRE(prefetched == metrics.page_count_prefetched);
+
+    REQUIRE(0 == ham_cursor_close(c));
+  }
+
 };
 
 TEST_CASE("BtreeCursor/createCloseTest", "")
@@ -399,6 +445,12 @@ TEST_CASE("BtreeCursor/couplingTest", "")
   f.couplingTest();
 }
 
+TEST_CASE("BtreeCursor/readAheadTest", "")
+{
+  BtreeCursorFixture f;
+  f.readAheadTest();
+}
+
 
 TEST_CASE("BtreeCursor-64k/createCloseTest", "")
 {
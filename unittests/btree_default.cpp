@@ -33,6 +33,7 @@ namespace hamsterdb {
 
 static int g_split_count = 0;
 extern void (*g_BTREE_INSERT_SPLIT_HOOK)(void);
+extern ham_u32_t g_extended_threshold;
 
 static void
 split_hook()
@@ -54,7 +55,8 @@ struct BtreeDefaultFixture {
   BtreeDefaultFixture(bool duplicates = false,
                   ham_u16_t key_size = HAM_KEY_SIZE_UNLIMITED,
                   ham_u32_t rec_size = HAM_RECORD_SIZE_UNLIMITED,
-                  ham_u32_t page_size = 1024 * 16)
+                  ham_u32_t page_size = 1024 * 16,
+                  int key_compression = 0)
     : m_db(0), m_env(0), m_key_size(key_size), m_rec_size(rec_size),
       m_duplicates(duplicates) {
     os::unlink(Globals::opath(".test"));
@@ -68,6 +70,7 @@ struct BtreeDefaultFixture {
       { HAM_PARAM_KEY_SIZE, key_size },
       { HAM_PARAM_KEY_TYPE, type },
       { HAM_PARAM_RECORD_SIZE, rec_size },
+      { HAM_PARAM_KEY_COMPRESSION, (ham_u64_t)key_compression },
       { 0, 0 }
     };
     REQUIRE(0 ==
@@ -603,4 +606,211 @@ TEST_CASE("BtreeDefault/fixedRecordsWithDuplicatesTest", "")
   f.eraseCursorTest(ivec);
 }
 
+TEST_CASE("BtreeDefault/prefixInsertSplitTest", "")
+{
+  BtreeDefaultFixture::IntVector ivec;
+  for (int i = 0; i < 10000; i++)
+    ivec.push_back(i);
+
+  BtreeDefaultFixture f(false, HAM_KEY_SIZE_UNLIMITED,
+                  HAM_RECORD_SIZE_UNLIMITED, 1024 * 16, HAM_COMPRESSOR_PREFIX);
+  f.insertSplitTest(ivec, true, true);
+  REQUIRE(0 == ham_db_check_integrity(f.m_db, 0));
+}
+
+TEST_CASE("BtreeDefault/prefixRandomEraseMergeTest", "")
+{
+  BtreeDefaultFixture::IntVector ivec;
+  for (int i = 0; i < 10000; i++)
+    ivec.push_back(i);
+  std::srand(0); // make this reproducable
+  std::random_shuffle(ivec.begin(), ivec.end());
+
+  BtreeDefaultFixture f(false, HAM_KEY_SIZE_UNLIMITED,
+                  HAM_RECORD_SIZE_UNLIMITED, 1024, HAM_COMPRESSOR_PREFIX);
+  f.insertSplitTest(ivec, true, false);
+  REQUIRE(0 == ham_db_check_integrity(f.m_db, 0));
+  f.eraseCursorTest(ivec);
+}
+
+TEST_CASE("BtreeDefault/prefixRandomEraseMergeDuplicateTest", "")
+{
+  BtreeDefaultFixture::IntVector ivec;
+  for (int i = 0; i < 10000; i++) {
+    ivec.push_back(i);
+    ivec.push_back(i);
+    ivec.push_back(i);
+  }
+  std::srand(0); // make this reproducable
+  std::random_shuffle(ivec.begin(), ivec.end());
+
+  BtreeDefaultFixture f(true, HAM_KEY_SIZE_UNLIMITED,
+                  HAM_RECORD_SIZE_UNLIMITED, 1024 * 16, HAM_COMPRESSOR_PREFIX);
+  f.insertSplitTest(ivec, true, false);
+  REQUIRE(0 == ham_db_check_integrity(f.m_db, 0));
+  f.eraseCursorTest(ivec);
+}
+
+static ham_key_t
+make_url_key(int i, char *buffer)
+{
+  // a long shared prefix, followed by a few "directories" with shorter
+  // prefixes
+  ham_key_t key = {0};
+  sprintf(buffer, "http://www.example.com/%0100d/section-%d/item-%08d.html",
+                  0, i % 7, i);
+  key.data = buffer;
+  key.size = (ham_u16_t)strlen(buffer) + 1;
+  return (key);
+}
+
+static void
+fill_url_database(ham_env_t *env, ham_db_t *db, const std::vector<int> &ivec)
+{
+  char buffer[512];
+  for (std::vector<int>::const_iterator it = ivec.begin();
+          it != ivec.end(); it++) {
+    ham_key_t key = make_url_key(*it, buffer);
+    ham_record_t rec = {0};
+    rec.data = (void *)&*it;
+    rec.size = sizeof(*it);
+    REQUIRE(0 == ham_db_insert(db, 0, &key, &rec, 0));
+  }
+}
+
+TEST_CASE("BtreeDefault/prefixUrlKeysTest", "")
+{
+  std::vector<int> ivec;
+  for (int i = 0; i < 5000; i++)
+    ivec.push_back(i);
+  std::srand(0); // make this reproducable
+  std::random_shuffle(ivec.begin(), ivec.end());
+
+  // the threshold is cached globally, and other tests might have set it
+  // for a different page size
+  ham_u32_t old_threshold = g_extended_threshold;
+  g_extended_threshold = 256;
+
+  // first fill an uncompressed database for comparison
+  ham_env_metrics_t metrics1, metrics2;
+  {
+    BtreeDefaultFixture f;
+    fill_url_database(f.m_env, f.m_db, ivec);
+    REQUIRE(0 == ham_env_get_metrics(f.m_env, &metrics1));
+  }
+
+  BtreeDefaultFixture f(false, HAM_KEY_SIZE_UNLIMITED,
+                  HAM_RECORD_SIZE_UNLIMITED, 1024 * 16, HAM_COMPRESSOR_PREFIX);
+  ham_u64_t extended_keys = g_extended_keys;
+  fill_url_database(f.m_env, f.m_db, ivec);
+  REQUIRE(0 == ham_env_get_metrics(f.m_env, &metrics2));
+  REQUIRE(0 == ham_db_check_integrity(f.m_db, 0));
+
+  // the compressed keys require far less space in the leaf nodes
+  REQUIRE(g_extended_keys == extended_keys);
+  ham_u64_t index_pages = metrics2.page_count_type_index * 2;
+  REQUIRE(index_pages < metrics1.page_count_type_index);
+
+  // reopen the database, then verify all keys with lookups and with a
+  // cursor
+  f.teardown();
+  REQUIRE(0 == ham_env_open(&f.m_env, Globals::opath(".test"), 0, 0));
+  REQUIRE(0 == ham_env_open_db(f.m_env, &f.m_db, 1, 0, 0));
+
+  char buffer[512];
+  for (int i = 0; i < 5000; i++) {
+    ham_key_t key = make_url_key(i, buffer);
+    ham_record_t rec = {0};
+    REQUIRE(0 == ham_db_find(f.m_db, 0, &key, &rec, 0));
+    REQUIRE(rec.size == sizeof(int));
+    REQUIRE(*(int *)rec.data == i);
+  }
+
+  std::vector<std::string> keys;
+  for (int i = 0; i < 5000; i++) {
+    make_url_key(i, buffer);
+    keys.push_back(buffer);
+  }
+  std::sort(keys.begin(), keys.end());
+
+  ham_cursor_t *cursor;
+  REQUIRE(0 == ham_cursor_create(&cursor, f.m_db, 0, 0));
+  for (int i = 0; i < 5000; i++) {
+    ham_key_t key = {0};
+    REQUIRE(0 == ham_cursor_move(cursor, &key, 0, HAM_CURSOR_NEXT));
+    REQUIRE(key.size == keys[i].size() + 1);
+    REQUIRE(0 == strcmp((const char *)key.data, keys[i].c_str()));
+  }
+  ham_key_t key = {0};
+  REQUIRE(HAM_KEY_NOT_FOUND == ham_cursor_move(cursor, &key, 0,
+                          HAM_CURSOR_NEXT));
+  REQUIRE(0 == ham_cursor_close(cursor));
+
+  // erase every other key
+  for (int i = 0; i < 5000; i += 2) {
+    ham_key_t key = make_url_key(i, buffer);
+    REQUIRE(0 == ham_db_erase(f.m_db, 0, &key, 0));
+  }
+  REQUIRE(0 == ham_db_check_integrity(f.m_db, 0));
+  for (int i = 0; i < 5000; i++) {
+    ham_key_t key = make_url_key(i, buffer);
+    ham_record_t rec = {0};
+    REQUIRE((i & 1 ? 0 : HAM_KEY_NOT_FOUND)
+                    == ham_db_find(f.m_db, 0, &key, &rec, 0));
+  }
+
+  g_extended_threshold = old_threshold;
+}
+
+TEST_CASE("BtreeDefault/prefixParameterTest", "")
+{
+  ham_env_t *env;
+  ham_db_t *db;
+  REQUIRE(0 == ham_env_create(&env, Globals::opath(".test"), 0, 0644, 0));
+
+  ham_parameter_t ps1[] = {
+    { HAM_PARAM_KEY_COMPRESSION, HAM_COMPRESSOR_LZ4 },
+    { 0, 0 }
+  };
+  REQUIRE(HAM_NOT_IMPLEMENTED == ham_env_create_db(env, &db, 1, 0, &ps1[0]));
+
+  ham_parameter_t ps2[] = {
+    { HAM_PARAM_KEY_COMPRESSION, HAM_COMPRESSOR_PREFIX },
+    { HAM_PARAM_KEY_TYPE, HAM_TYPE_UINT32 },
+    { 0, 0 }
+  };
+  REQUIRE(HAM_INV_PARAMETER == ham_env_create_db(env, &db, 1, 0, &ps2[0]));
+
+  ham_parameter_t ps3[] = {
+    { HAM_PARAM_KEY_COMPRESSION, HAM_COMPRESSOR_PREFIX },
+    { HAM_PARAM_KEY_SIZE, 16 },
+    { 0, 0 }
+  };
+  REQUIRE(HAM_INV_PARAMETER == ham_env_create_db(env, &db, 1, 0, &ps3[0]));
+
+  ham_parameter_t ps4[] = {
+    { HAM_PARAM_KEY_COMPRESSION, HAM_COMPRESSOR_PREFIX },
+    { 0, 0 }
+  };
+  REQUIRE(0 == ham_env_create_db(env, &db, 1, 0, &ps4[0]));
+
+  ham_parameter_t query[] = {
+    { HAM_PARAM_KEY_COMPRESSION, 0 },
+    { 0, 0 }
+  };
+  REQUIRE(0 == ham_db_get_parameters(db, &query[0]));
+  REQUIRE(HAM_COMPRESSOR_PREFIX == query[0].value);
+  REQUIRE(0 == ham_env_close(env, HAM_AUTO_CLEANUP));
+
+  // the setting is persistent, and cannot be specified when opening
+  // the database
+  REQUIRE(0 == ham_env_open(&env, Globals::opath(".test"), 0, 0));
+  REQUIRE(HAM_INV_PARAMETER == ham_env_open_db(env, &db, 1, 0, &ps4[0]));
+  REQUIRE(0 == ham_env_open_db(env, &db, 1, 0, 0));
+  query[0].value = 0;
+  REQUIRE(0 == ham_db_get_parameters(db, &query[0]));
+  REQUIRE(HAM_COMPRESSOR_PREFIX == query[0].value);
+  REQUIRE(0 == ham_env_close(env, HAM_AUTO_CLEANUP));
+}
+
 } // namespace hamsterdb
@@ -16,12 +16,18 @@
 
 #include "../src/config.h"
 
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+
 #include "3rdparty/catch/catch.hpp"
 
 #include "globals.h"
 #include "os.hpp"
 
 #include "../src/db.h"
+#include "../src/db_local.h"
 #include "../src/version.h"
 #include "../src/page.h"
 #include "../src/env.h"
@@ -196,3 +202,378 @@ TEST_CASE("BtreeInsert/sequentialInsertPivotTest", "")
   f.sequentialInsertPivotTest();
 }
 
+
+struct BtreeBulkFixture {
+  ham_db_t *m_db;
+  ham_env_t *m_env;
+  ham_u32_t m_env_flags;
+  ham_u16_t m_key_type;
+  std::vector<std::string> m_key_data;
+  std::vector<std::string> m_record_data;
+  std::vector<ham_key_t> m_keys;
+  std::vector<ham_record_t> m_records;
+
+  BtreeBulkFixture(ham_u32_t env_flags = 0, ham_u32_t db_flags = 0,
+                  ham_u16_t key_type = HAM_TYPE_BINARY)
+    : m_db(0), m_env(0), m_env_flags(env_flags), m_key_type(key_type) {
+    ham_parameter_t p1[] = {
+      { HAM_PARAM_PAGESIZE, 1024 },
+      { 0, 0 }
+    };
+    ham_parameter_t p2[] = {
+      { HAM_PARAM_KEY_TYPE, key_type },
+      { 0, 0 }
+    };
+
+    os::unlink(Globals::opath(".test"));
+    REQUIRE(0 ==
+        ham_env_create(&m_env, Globals::opath(".test"), env_flags, 0644,
+                &p1[0]));
+    REQUIRE(0 ==
+        ham_env_create_db(m_env, &m_db, 1, db_flags, &p2[0]));
+  }
+
+  ~BtreeBulkFixture() {
+    if (m_env)
+	  REQUIRE(0 == ham_env_close(m_env, HAM_AUTO_CLEANUP));
+  }
+
+  // Returns the key data of key |i|; binary keys have a variable size,
+  // and sort in the same order as the numbers
+  std::string make_key(int i) {
+    if (m_key_type == HAM_TYPE_UINT32)
+      return (std::string((const char *)&i, sizeof(i)));
+    char buffer[64];
+    int size = sprintf(buffer, "key%08d", i);
+    // every 10th key is (much) longer
+    if (i % 10 == 0) {
+      memset(&buffer[size], 'x', sizeof(buffer) - size);
+      size = sizeof(buffer);
+    }
+    return (std::string(buffer, size));
+  }
+
+  // Returns the record data of key |i|; every 7th record is not stored
+  // inline
+  std::string make_record(int i, int duplicate = 0) {
+    char buffer[32];
+    sprintf(buffer, "%d/%d", i, duplicate);
+    std::string s(buffer);
+    if (i % 7 == 0)
+      s.resize(200, 'r');
+    return (s);
+  }
+
+  // Prepares every |step|th key of |start| ... |end - 1| with |duplicates|
+  // records each, in random order unless |shuffle| is false
+  void prepare(int start, int end, int duplicates = 1, int step = 1,
+                  bool shuffle = true) {
+    m_key_data.clear();
+    m_record_data.clear();
+    for (int i = start; i < end; i += step) {
+      for (int d = 0; d < duplicates; d++) {
+        m_key_data.push_back(make_key(i));
+        m_record_data.push_back(make_record(i, d));
+      }
+    }
+
+    // shuffle the keys, but keep the duplicates in their order
+    std::vector<size_t> order(m_key_data.size() / duplicates);
+    for (size_t i = 0; i < order.size(); i++)
+      order[i] = i;
+    if (shuffle)
+      std::random_shuffle(order.begin(), order.end());
+
+    m_keys.clear();
+    m_records.clear();
+    for (size_t i = 0; i < order.size(); i++) {
+      for (int d = 0; d < duplicates; d++) {
+        size_t j = order[i] * duplicates + d;
+        ham_key_t key = {0};
+        key.data = (void *)m_key_data[j].data();
+        key.size = (ham_u16_t)m_key_data[j].size();
+        m_keys.push_back(key);
+        ham_record_t record = {0};
+        record.data = (void *)m_record_data[j].data();
+        record.size = (ham_u32_t)m_record_data[j].size();
+        m_records.push_back(record);
+      }
+    }
+  }
+
+  ham_status_t bulk_insert(ham_txn_t *txn, ham_u32_t fill_factor,
+                  ham_u32_t flags) {
+    return (ham_db_bulk_insert(m_db, txn, &m_keys[0], &m_records[0],
+                            (ham_u32_t)m_keys.size(), fill_factor, flags));
+  }
+
+  // Verifies that the database stores every |step|th key of |start| ...
+  // |end - 1| with |duplicates| records each
+  void verify(int start, int end, int duplicates = 1, int step = 1) {
+    REQUIRE(0 == ham_db_check_integrity(m_db, 0));
+
+    ham_cursor_t *cursor;
+    REQUIRE(0 == ham_cursor_create(&cursor, m_db, 0, 0));
+    ham_key_t key = {0};
+    ham_record_t record = {0};
+    for (int i = start; i < end; i += step) {
+      for (int d = 0; d < duplicates; d++) {
+        REQUIRE(0 == ham_cursor_move(cursor, &key, &record, HAM_CURSOR_NEXT));
+        std::string k = make_key(i);
+        std::string r = make_record(i, d);
+        REQUIRE(k.size() == key.size);
+        REQUIRE(0 == memcmp(k.data(), key.data, key.size));
+        REQUIRE(r.size() == record.size);
+        REQUIRE(0 == memcmp(r.data(), record.data, record.size));
+      }
+    }
+    REQUIRE(HAM_KEY_NOT_FOUND ==
+                ham_cursor_move(cursor, &key, &record, HAM_CURSOR_NEXT));
+    REQUIRE(0 == ham_cursor_close(cursor));
+
+    ham_u64_t keys = (end - start + step - 1) / step;
+    ham_u64_t records = keys * duplicates;
+    ham_u64_t count;
+    REQUIRE(0 == ham_db_get_key_count(m_db, 0, HAM_SKIP_DUPLICATES, &count));
+    REQUIRE(keys == count);
+    REQUIRE(0 == ham_db_get_key_count(m_db, 0, 0, &count));
+    REQUIRE(records == count);
+    REQUIRE(0 == ham_db_get_key_count(m_db, 0, HAM_KEY_COUNT_FULL_SCAN,
+                            &count));
+    REQUIRE(records == count);
+  }
+
+  // Returns the number of allocated index pages
+  ham_u64_t get_index_pages() {
+    ham_env_metrics_t metrics;
+    REQUIRE(0 == ham_env_get_metrics(m_env, &metrics));
+    return (metrics.page_count_type_index);
+  }
+
+  // Returns the number of page splits
+  ham_u64_t get_splits() {
+    ham_env_metrics_t metrics;
+    REQUIRE(0 == ham_env_get_metrics(m_env, &metrics));
+    return (metrics.btree_smo_split);
+  }
+
+  void reopen() {
+    REQUIRE(0 == ham_env_close(m_env, HAM_AUTO_CLEANUP));
+    REQUIRE(0 == ham_env_open(&m_env, Globals::opath(".test"),
+                            m_env_flags, 0));
+    REQUIRE(0 == ham_env_open_db(m_env, &m_db, 1, 0, 0));
+  }
+
+  void bulkLoadTest(const char *classname) {
+    std::string name = ((LocalDatabase *)m_db)->get_btree_index()
+                            ->test_get_classname();
+    REQUIRE(std::string::npos != name.find(classname));
+
+    ham_u64_t splits = get_splits();
+    prepare(0, 5000);
+    REQUIRE(0 == bulk_insert(0, 0, 0));
+    verify(0, 5000);
+
+    // the keys were appended bottom-up, and no page was split
+    REQUIRE(splits == get_splits());
+
+    if (!(m_env_flags & HAM_IN_MEMORY)) {
+      reopen();
+      verify(0, 5000);
+    }
+  }
+
+  void fillFactorTest() {
+    prepare(0, 10000, 1, 2);
+    ham_u64_t before = get_index_pages();
+    REQUIRE(0 == bulk_insert(0, 100, 0));
+    ham_u64_t full = get_index_pages() - before;
+    verify(0, 10000, 1, 2);
+
+    REQUIRE(0 == ham_db_close(m_db, 0));
+    REQUIRE(0 == ham_env_erase_db(m_env, 1, 0));
+    ham_parameter_t p[] = {
+      { HAM_PARAM_KEY_TYPE, m_key_type },
+      { 0, 0 }
+    };
+    REQUIRE(0 == ham_env_create_db(m_env, &m_db, 1, 0, &p[0]));
+
+    before = get_index_pages();
+    REQUIRE(0 == bulk_insert(0, 50, 0));
+    ham_u64_t half = get_index_pages() - before;
+    verify(0, 10000, 1, 2);
+
+    // half-filled nodes need (about) twice as many pages; the limit is a
+    // number of keys, therefore nodes with many long keys can fill up
+    // earlier
+    REQUIRE(half > full * 18 / 10);
+    REQUIRE(half < full * 25 / 10);
+
+    // there's space left in the leafs; inserting keys in between does
+    // not split the pages
+    ham_u64_t splits = get_splits();
+    prepare(1, 10000, 1, 200);
+    for (size_t i = 0; i < m_keys.size(); i++)
+      REQUIRE(0 == ham_db_insert(m_db, 0, &m_keys[i], &m_records[i], 0));
+    REQUIRE(splits == get_splits());
+    REQUIRE(0 == ham_db_check_integrity(m_db, 0));
+  }
+
+  void appendTest() {
+    ham_u64_t splits = get_splits();
+    prepare(0, 3000);
+    REQUIRE(0 == bulk_insert(0, 80, 0));
+    prepare(3000, 6000);
+    REQUIRE(HAM_INV_PARAMETER == bulk_insert(0, 80, HAM_BULK_SORTED));
+    prepare(3000, 6000, 1, 1, false);
+    REQUIRE(0 == bulk_insert(0, 80, HAM_BULK_SORTED));
+    verify(0, 6000);
+
+    // the fill factor moves keys to new nodes, but that's not a split
+    REQUIRE(splits == get_splits());
+
+    // these keys overlap with the existing keys and are inserted one by one
+    prepare(5000, 7000);
+    REQUIRE(HAM_DUPLICATE_KEY == bulk_insert(0, 0, 0));
+    REQUIRE(0 == bulk_insert(0, 0, HAM_OVERWRITE));
+    verify(0, 7000);
+  }
+
+  void duplicateTest() {
+    prepare(0, 1000, 3);
+    REQUIRE(HAM_INV_PARAMETER == bulk_insert(0, 0, HAM_BULK_SORTED));
+    REQUIRE(HAM_DUPLICATE_KEY == bulk_insert(0, 0, 0));
+    REQUIRE(0 == bulk_insert(0, 0, HAM_DUPLICATE));
+    verify(0, 1000, 3);
+
+    // with HAM_OVERWRITE the last record of a key is stored
+    prepare(1000, 2000, 3);
+    REQUIRE(0 == bulk_insert(0, 0, HAM_OVERWRITE));
+    REQUIRE(0 == ham_db_check_integrity(m_db, 0));
+    for (int i = 1000; i < 2000; i++) {
+      std::string k = make_key(i);
+      ham_key_t key = {0};
+      key.data = (void *)k.data();
+      key.size = (ham_u16_t)k.size();
+      ham_record_t record = {0};
+      REQUIRE(0 == ham_db_find(m_db, 0, &key, &record, 0));
+      std::string r = make_record(i, 2);
+      REQUIRE(r.size() == record.size);
+      REQUIRE(0 == memcmp(r.data(), record.data, record.size));
+    }
+  }
+
+  void transactionTest() {
+    ham_txn_t *txn;
+    prepare(0, 2000);
+
+    // bypassing is not possible with a Transaction, or if an active
+    // Transaction modified the Database
+    REQUIRE(0 == ham_txn_begin(&txn, m_env, 0, 0, 0));
+    REQUIRE(HAM_INV_PARAMETER ==
+                bulk_insert(txn, 0, HAM_BULK_BYPASS_TRANSACTIONS));
+    REQUIRE(0 == ham_db_insert(m_db, txn, &m_keys[0], &m_records[0], 0));
+    REQUIRE(HAM_TXN_STILL_OPEN ==
+                bulk_insert(0, 0, HAM_BULK_BYPASS_TRANSACTIONS));
+
+    // the items are inserted in the Transaction; if it's aborted then
+    // nothing is inserted
+    REQUIRE(HAM_DUPLICATE_KEY == bulk_insert(txn, 0, 0));
+    REQUIRE(0 == bulk_insert(txn, 0, HAM_OVERWRITE));
+    REQUIRE(0 == ham_txn_abort(txn, 0));
+    ham_u64_t count;
+    REQUIRE(0 == ham_db_get_key_count(m_db, 0, 0, &count));
+    REQUIRE(0u == count);
+
+    // without a Transaction a temporary one is used
+    REQUIRE(0 == bulk_insert(0, 0, 0));
+    verify(0, 2000);
+
+    // the committed Transactions are flushed before the Btree is modified
+    prepare(2000, 4000);
+    REQUIRE(0 == bulk_insert(0, 0, HAM_BULK_BYPASS_TRANSACTIONS));
+    verify(0, 4000);
+    reopen();
+    verify(0, 4000);
+  }
+
+  void invalidParameterTest() {
+    prepare(0, 10);
+    ham_key_t key = {0};
+    ham_record_t record = {0};
+    REQUIRE(HAM_INV_PARAMETER ==
+                ham_db_bulk_insert(0, 0, &key, &record, 1, 0, 0));
+    REQUIRE(HAM_INV_PARAMETER ==
+                ham_db_bulk_insert(m_db, 0, 0, &record, 1, 0, 0));
+    REQUIRE(HAM_INV_PARAMETER ==
+                ham_db_bulk_insert(m_db, 0, &key, 0, 1, 0, 0));
+    REQUIRE(0 == ham_db_bulk_insert(m_db, 0, 0, 0, 0, 0, 0));
+    REQUIRE(HAM_INV_PARAMETER == bulk_insert(0, 101, 0));
+    REQUIRE(HAM_INV_PARAMETER ==
+                bulk_insert(0, 0, HAM_OVERWRITE | HAM_DUPLICATE));
+    REQUIRE(HAM_INV_PARAMETER == bulk_insert(0, 0, HAM_DUPLICATE));
+    REQUIRE(HAM_INV_PARAMETER == bulk_insert(0, 0, HAM_PARTIAL));
+    REQUIRE(HAM_INV_PARAMETER ==
+                bulk_insert(0, 0, HAM_DUPLICATE_INSERT_FIRST));
+  }
+};
+
+TEST_CASE("BtreeBulk/bulkLoadDefaultTest", "")
+{
+  BtreeBulkFixture f;
+  f.bulkLoadTest("DefaultNodeImpl");
+}
+
+TEST_CASE("BtreeBulk/bulkLoadPaxTest", "")
+{
+  BtreeBulkFixture f(0, 0, HAM_TYPE_UINT32);
+  f.bulkLoadTest("PaxNodeImpl");
+}
+
+TEST_CASE("BtreeBulk/bulkLoadRecoveryTest", "")
+{
+  BtreeBulkFixture f(HAM_ENABLE_RECOVERY);
+  f.bulkLoadTest("DefaultNodeImpl");
+}
+
+TEST_CASE("BtreeBulk/bulkLoadInMemoryTest", "")
+{
+  BtreeBulkFixture f(HAM_IN_MEMORY, 0, HAM_TYPE_UINT32);
+  f.bulkLoadTest("PaxNodeImpl");
+}
+
+TEST_CASE("BtreeBulk/fillFactorDefaultTest", "")
+{
+  BtreeBulkFixture f;
+  f.fillFactorTest();
+}
+
+TEST_CASE("BtreeBulk/fillFactorPaxTest", "")
+{
+  BtreeBulkFixture f(0, 0, HAM_TYPE_UINT32);
+  f.fillFactorTest();
+}
+
+TEST_CASE("BtreeBulk/appendTest", "")
+{
+  BtreeBulkFixture f;
+  f.appendTest();
+}
+
+TEST_CASE("BtreeBulk/duplicateTest", "")
+{
+  BtreeBulkFixture f(0, HAM_ENABLE_DUPLICATE_KEYS);
+  f.duplicateTest();
+}
+
+TEST_CASE("BtreeBulk/transactionTest", "")
+{
+  BtreeBulkFixture f(HAM_ENABLE_TRANSACTIONS);
+  f.transactionTest();
+}
+
+TEST_CASE("BtreeBulk/invalidParameterTest", "")
+{
+  BtreeBulkFixture f;
+  f.invalidParameterTest();
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2005-2014 Christoph Rupp (chris@crupp.de).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "3rdparty/catch/catch.hpp"
+
+#include "globals.h"
+
+#include <memory>
+#include <vector>
+
+#include "../src/compressor_factory.h"
+
+using namespace hamsterdb;
+
+// compresses and decompresses |data| (not empty) with the algorithm |type|
+static void
+roundtrip(int type, const std::vector<ham_u8_t> &data)
+{
+  std::auto_ptr<Compressor> c(CompressorFactory::create(type));
+
+  ham_u32_t len = c->compress(&data[0], (ham_u32_t)data.size());
+  std::vector<ham_u8_t> compressed(c->get_output_data(),
+                  c->get_output_data() + len);
+
+  // decompress into a buffer...
+  std::vector<ham_u8_t> output(data.size() + 1);
+  c->decompress(&compressed[0], len, &output[0], (ham_u32_t)data.size());
+  output.resize(data.size());
+  REQUIRE(output == data);
+
+  // ... and into the arena
+  c->decompress(&compressed[0], len, (ham_u32_t)data.size());
+  REQUIRE(0 == ::memcmp(c->get_output_data(), &data[0], data.size()));
+}
+
+static void
+roundtripTest(int type)
+{
+  std::vector<ham_u8_t> data;
+
+  // small inputs are stored as literals
+  for (int i = 0; i < 20; i++) {
+    data.push_back((ham_u8_t)i);
+    roundtrip(type, data);
+  }
+
+  // zeroes, repeated patterns and pseudo-random bytes
+  data.assign(64 * 1024, 0);
+  roundtrip(type, data);
+  for (size_t i = 0; i < data.size(); i++)
+    data[i] = (ham_u8_t)(i % 7);
+  roundtrip(type, data);
+  ham_u32_t seed = 12345;
+  for (size_t i = 0; i < data.size(); i++) {
+    seed = seed * 1103515245 + 12345;
+    data[i] = (ham_u8_t)(seed >> 16);
+  }
+  roundtrip(type, data);
+}
+
+TEST_CASE("Compressor/factory", "")
+{
+  REQUIRE(CompressorFactory::is_available(HAM_COMPRESSOR_LZ4));
+  REQUIRE(false == CompressorFactory::is_available(HAM_COMPRESSOR_NONE));
+  REQUIRE(false == CompressorFactory::is_available(HAM_COMPRESSOR_SNAPPY));
+  REQUIRE_THROWS_AS(CompressorFactory::create(HAM_COMPRESSOR_SNAPPY),
+                  Exception);
+}
+
+TEST_CASE("Compressor/lz4Roundtrip", "")
+{
+  roundtripTest(HAM_COMPRESSOR_LZ4);
+}
+
+TEST_CASE("Compressor/lz4Ratio", "")
+{
+  std::auto_ptr<Compressor> c(CompressorFactory::create(HAM_COMPRESSOR_LZ4));
+  std::vector<ham_u8_t> data(16 * 1024, 'a');
+  REQUIRE(c->compress(&data[0], (ham_u32_t)data.size()) < 100u);
+}
+
+TEST_CASE("Compressor/lz4Corrupt", "")
+{
+  std::auto_ptr<Compressor> c(CompressorFactory::create(HAM_COMPRESSOR_LZ4));
+  std::vector<ham_u8_t> data(1024);
+  for (size_t i = 0; i < data.size(); i++)
+    data[i] = (ham_u8_t)(i % 13);
+
+  ham_u32_t len = c->compress(&data[0], (ham_u32_t)data.size());
+  std::vector<ham_u8_t> compressed(c->get_output_data(),
+                  c->get_output_data() + len);
+  std::vector<ham_u8_t> output(data.size());
+
+  // a truncated input, or a wrong size, are detected
+  REQUIRE_THROWS_AS(c->decompress(&compressed[0], len - 1, &output[0],
+                          (ham_u32_t)output.size()), Exception);
+  REQUIRE_THROWS_AS(c->decompress(&compressed[0], len, &output[0],
+                          (ham_u32_t)output.size() - 1), Exception);
+}
+
+TEST_CASE("Compressor/zlibRoundtrip", "")
+{
+  if (CompressorFactory::is_available(HAM_COMPRESSOR_ZLIB))
+    roundtripTest(HAM_COMPRESSOR_ZLIB);
+}
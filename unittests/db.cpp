@@ -152,7 +152,7 @@ struct DbFixture {
     REQUIRE(sizeof(PBlobHeader) == 28);
     REQUIRE(sizeof(PBtreeNode) == 33);
     REQUIRE(sizeof(PEnvironmentHeader) == 28);
-    REQUIRE(sizeof(PBtreeHeader) == 24);
+    REQUIRE(sizeof(PBtreeHeader) == 40);
     REQUIRE(sizeof(PPageData) == 13);
     PPageData p;
     REQUIRE(sizeof(p._s) == 13);
@@ -185,6 +185,74 @@ struct DbFixture {
     hdrpage.set_data(0);
   }
 
+  // compares the persistent key counters with a full scan
+  void checkKeyCount(ham_u64_t keys, ham_u64_t records) {
+    ham_u64_t count;
+    REQUIRE(0 == ham_db_get_key_count(m_db, 0, HAM_SKIP_DUPLICATES, &count));
+    REQUIRE(keys == count);
+    REQUIRE(0 == ham_db_get_key_count(m_db, 0,
+                HAM_SKIP_DUPLICATES | HAM_KEY_COUNT_FULL_SCAN, &count));
+    REQUIRE(keys == count);
+    REQUIRE(0 == ham_db_get_key_count(m_db, 0, 0, &count));
+    REQUIRE(records == count);
+    REQUIRE(0 == ham_db_get_key_count(m_db, 0, HAM_KEY_COUNT_FULL_SCAN,
+                &count));
+    REQUIRE(records == count);
+  }
+
+  void keyCounterTest() {
+    ham_key_t key = {0};
+    ham_record_t rec = {0};
+    int i;
+    key.data = &i;
+    key.size = sizeof(i);
+
+    // enough keys for a few page splits
+    for (i = 0; i < 5000; i++)
+      REQUIRE(0 == ham_db_insert(m_db, 0, &key, &rec, 0));
+    checkKeyCount(5000, 5000);
+
+    // overwrites do not change the counters; duplicates only increment
+    // the number of records
+    for (i = 0; i < 100; i++) {
+      REQUIRE(0 == ham_db_insert(m_db, 0, &key, &rec, HAM_OVERWRITE));
+      REQUIRE(0 == ham_db_insert(m_db, 0, &key, &rec, HAM_DUPLICATE));
+      REQUIRE(0 == ham_db_insert(m_db, 0, &key, &rec, HAM_DUPLICATE));
+    }
+    REQUIRE(HAM_DUPLICATE_KEY == ham_db_insert(m_db, 0, &key, &rec, 0));
+    checkKeyCount(5000, 5200);
+
+    // erase a single duplicate with a cursor
+    ham_cursor_t *cursor;
+    REQUIRE(0 == ham_cursor_create(&cursor, m_db, 0, 0));
+    i = 7;
+    REQUIRE(0 == ham_cursor_find(cursor, &key, 0, 0));
+    REQUIRE(0 == ham_cursor_erase(cursor, 0));
+    REQUIRE(0 == ham_cursor_close(cursor));
+    checkKeyCount(5000, 5199);
+
+    // erase keys with all their duplicates
+    for (i = 0; i < 50; i++)
+      REQUIRE(0 == ham_db_erase(m_db, 0, &key, 0));
+    for (i = 4000; i < 5000; i++)
+      REQUIRE(0 == ham_db_erase(m_db, 0, &key, 0));
+    REQUIRE(HAM_KEY_NOT_FOUND == ham_db_erase(m_db, 0, &key, 0));
+    checkKeyCount(3950, 4050);
+
+    // the counters are persistent
+    if (!m_inmemory) {
+      REQUIRE(0 == ham_env_close(m_env, HAM_AUTO_CLEANUP));
+      REQUIRE(0 == ham_env_open(&m_env, Globals::opath(".test"), 0, 0));
+      REQUIRE(0 == ham_env_open_db(m_env, &m_db, 13, 0, 0));
+      m_dbp = (LocalDatabase *)m_db;
+      checkKeyCount(3950, 4050);
+    }
+
+    // invalid flags are rejected
+    ham_u64_t count;
+    REQUIRE(HAM_INV_PARAMETER == ham_db_get_key_count(m_db, 0, 0x80,
+                &count));
+  }
 };
 
 TEST_CASE("Db/checkStructurePackingTest", "")
@@ -199,6 +267,12 @@ TEST_CASE("Db/headerTest", "")
   f.headerTest();
 }
 
+TEST_CASE("Db/keyCounterTest", "")
+{
+  DbFixture f;
+  f.keyCounterTest();
+}
+
 TEST_CASE("Db/structureTest", "")
 {
   DbFixture f;
@@ -230,6 +304,12 @@ TEST_CASE("Db-inmem/headerTest", "")
   f.headerTest();
 }
 
+TEST_CASE("Db-inmem/keyCounterTest", "")
+{
+  DbFixture f(true);
+  f.keyCounterTest();
+}
+
 TEST_CASE("Db-inmem/structureTest", "")
 {
   DbFixture f(true);
@@ -21,7 +21,10 @@
 #include "globals.h"
 #include "os.hpp"
 
+#include <vector>
+
 #include "../src/device.h"
+#include "../src/device_disk.h"
 #include "../src/env_local.h"
 
 using namespace hamsterdb;
@@ -191,6 +194,45 @@ struct DeviceFixture
       delete pages[i];
     }
   }
+
+  void growMmapTest() {
+    ham_u32_t ps = ((LocalEnvironment *)m_env)->get_page_size();
+    int max_pages = 2 * DiskDevice::kMinMapChunk / ps + 1;
+    std::vector<Page *> pages;
+    ham_env_metrics_t metrics;
+
+    REQUIRE(true == m_dev->is_open());
+    m_dev->get_metrics(&metrics);
+    ham_u64_t malloced = metrics.page_count_malloced;
+
+    // grow the file till the new pages are mapped
+    int i;
+    for (i = 0; i < max_pages; i++) {
+      Page *page = new Page((LocalEnvironment *)m_env);
+      m_dev->alloc_page(page, ps);
+      pages.push_back(page);
+      if ((page->get_flags() & Page::kNpersMalloc) == 0)
+        break;
+    }
+    REQUIRE(i < max_pages);
+
+    // a mapped page can be written and read again
+    Page *page = pages.back();
+    memset(page->get_payload(), 0x13, ps - Page::kSizeofPersistentHeader);
+    m_dev->write_page(page);
+    std::vector<ham_u8_t> buffer(ps);
+    m_dev->read(page->get_address(), &buffer[0], ps);
+    REQUIRE(0 == memcmp(&buffer[0], page->get_data(), ps));
+
+    m_dev->get_metrics(&metrics);
+    REQUIRE(metrics.page_count_mapped == 1);
+    REQUIRE(metrics.page_count_malloced == malloced + i);
+
+    for (i = 0; i < (int)pages.size(); i++) {
+      m_dev->free_page(pages[i]);
+      delete pages[i];
+    }
+  }
 };
 
 TEST_CASE("Device/newDelete", "")
@@ -235,6 +277,12 @@ TEST_CASE("Device/mmapUnmap", "")
   f. mmapUnmapTest();
 }
 
+TEST_CASE("Device/growMmap", "")
+{
+  DeviceFixture f(false);
+  f. growMmapTest();
+}
+
 TEST_CASE("Device/readWrite", "")
 {
   DeviceFixture f(false);
@@ -16,6 +16,9 @@
 
 #include "../src/config.h"
 
+#include <boost/ref.hpp>
+#include <boost/thread.hpp>
+
 #include "3rdparty/catch/catch.hpp"
 
 #include "globals.h"
@@ -23,6 +26,7 @@
 
 #include "../src/env.h"
 #include "../src/page.h"
+#include "../src/device.h"
 #include "../src/db_local.h"
 #include "../src/env.h"
 #include "../src/env_header.h"
@@ -30,6 +34,59 @@
 
 using namespace hamsterdb;
 
+// A reader thread for EnvFixture::concurrentReadsTest
+struct ConcurrentReader {
+  static const int kNumKeys = 2000;
+
+  ConcurrentReader(ham_db_t *db, int seed)
+    : db(db), seed(seed), failures(0) {
+  }
+
+  // Builds the key for |i|; every 10th key is an extended key
+  static void make_key(int i, char *buffer, ham_key_t *key) {
+    memset(buffer, 'x', 300);
+    sprintf(buffer, "%08d", i);
+    key->data = buffer;
+    key->size = (i % 10 == 0) ? 300 : 9;
+  }
+
+  void operator()() {
+    char buffer[300];
+    for (int j = 0; j < kNumKeys; j++) {
+      int i = (j * 7 + seed * 13) % kNumKeys;
+      ham_key_t key = {0};
+      make_key(i, buffer, &key);
+      ham_record_t rec = {0};
+      if (ham_db_find(db, 0, &key, &rec, 0) != 0
+          || rec.size != sizeof(i)
+          || *(int *)rec.data != i)
+        failures++;
+    }
+
+    ham_cursor_t *cursor;
+    if (ham_cursor_create(&cursor, db, 0, 0) != 0) {
+      failures++;
+      return;
+    }
+    int count = 0;
+    ham_key_t key = {0};
+    ham_record_t rec = {0};
+    while (ham_cursor_move(cursor, &key, &rec, HAM_CURSOR_NEXT) == 0) {
+      int i = atoi((const char *)key.data);
+      if (rec.size != sizeof(i) || *(int *)rec.data != i)
+        failures++;
+      count++;
+    }
+    if (count != kNumKeys)
+      failures++;
+    ham_cursor_close(cursor);
+  }
+
+  ham_db_t *db;
+  int seed;
+  int failures;
+};
+
 struct EnvFixture {
   ham_u32_t m_flags;
 
@@ -127,7 +184,7 @@ struct EnvFixture {
     REQUIRE(0 == ham_env_get_parameters(env, ps));
     REQUIRE((ham_u64_t)(128 * 1024u) == ps[0].value);
     REQUIRE((ham_u64_t)(64 * 1024u) == ps[1].value);
-    REQUIRE((ham_u64_t)2724u == ps[2].value);
+    REQUIRE((ham_u64_t)1634u == ps[2].value);
 
     /* close and re-open the ENV */
     if (!(m_flags & HAM_IN_MEMORY)) {
@@ -140,7 +197,7 @@ struct EnvFixture {
     REQUIRE(0 == ham_env_get_parameters(env, ps));
     REQUIRE((ham_u64_t)(128 * 1024u) == ps[0].value);
     REQUIRE((ham_u64_t)(1024 * 64u) == ps[1].value);
-    REQUIRE(2724ull == ps[2].value);
+    REQUIRE(1634ull == ps[2].value);
 
     /* now create 128 DBs; we said we would, anyway, when creating the
      * ENV ! */
@@ -1075,7 +1132,7 @@ struct EnvFixture {
 
   void limitsReachedTest() {
     int i;
-    const int MAX_DB = 676 + 1;
+    const int MAX_DB = 405 + 1;
     ham_env_t *env;
     ham_db_t *db[MAX_DB];
 
@@ -1159,6 +1216,79 @@ struct EnvFixture {
     REQUIRE(0 == ham_env_close(env, 0));
   }
 
+  void concurrentReadsFlagsTest() {
+    ham_env_t *env;
+    ham_parameter_t params[] = {
+      {HAM_PARAM_FLAGS, 0},
+      {0, 0}
+    };
+
+    REQUIRE(HAM_INV_PARAMETER ==
+        ham_env_create(&env, Globals::opath(".test"),
+            m_flags | HAM_ENABLE_CONCURRENT_READS | HAM_ENABLE_TRANSACTIONS,
+            0664, 0));
+    REQUIRE(0 ==
+        ham_env_create(&env, Globals::opath(".test"),
+            m_flags | HAM_ENABLE_CONCURRENT_READS, 0664, 0));
+    REQUIRE(0 == ham_env_get_parameters(env, &params[0]));
+    REQUIRE((params[0].value & HAM_ENABLE_CONCURRENT_READS) != 0);
+    REQUIRE(0 == ham_env_close(env, 0));
+
+    if (!(m_flags & HAM_IN_MEMORY)) {
+      REQUIRE(HAM_INV_PARAMETER ==
+          ham_env_open(&env, Globals::opath(".test"),
+              HAM_ENABLE_CONCURRENT_READS | HAM_ENABLE_RECOVERY, 0));
+      REQUIRE(0 ==
+          ham_env_open(&env, Globals::opath(".test"),
+              HAM_ENABLE_CONCURRENT_READS, 0));
+      REQUIRE(0 == ham_env_close(env, 0));
+    }
+  }
+
+  void concurrentReadsTest() {
+    static const int kNumThreads = 4;
+    ham_env_t *env;
+    ham_db_t *db;
+    char buffer[300];
+
+    // use a tiny cache to make sure that the cache is purged while
+    // the readers are active
+    ham_parameter_t params[] = {
+      {HAM_PARAM_PAGESIZE, 1024},
+      {HAM_PARAM_CACHESIZE, (m_flags & HAM_IN_MEMORY) ? 0 : 16 * 1024},
+      {0, 0}
+    };
+
+    REQUIRE(0 ==
+        ham_env_create(&env, Globals::opath(".test"),
+            m_flags | HAM_ENABLE_CONCURRENT_READS, 0664, &params[0]));
+    REQUIRE(0 == ham_env_create_db(env, &db, 1, 0, 0));
+
+    for (int i = 0; i < ConcurrentReader::kNumKeys; i++) {
+      ham_key_t key = {0};
+      ConcurrentReader::make_key(i, buffer, &key);
+      ham_record_t rec = {0};
+      rec.data = &i;
+      rec.size = sizeof(i);
+      REQUIRE(0 == ham_db_insert(db, 0, &key, &rec, 0));
+    }
+
+    std::vector<ConcurrentReader *> readers;
+    std::vector<boost::thread *> threads;
+    for (int i = 0; i < kNumThreads; i++) {
+      readers.push_back(new ConcurrentReader(db, i));
+      threads.push_back(new boost::thread(boost::ref(*readers[i])));
+    }
+    for (int i = 0; i < kNumThreads; i++) {
+      threads[i]->join();
+      delete threads[i];
+      REQUIRE(0 == readers[i]->failures);
+      delete readers[i];
+    }
+
+    REQUIRE(0 == ham_env_close(env, HAM_AUTO_CLEANUP));
+  }
+
   void createOpenEmptyTest() {
     ham_env_t *env;
     ham_db_t *db[10];
@@ -1198,6 +1328,71 @@ struct EnvFixture {
 
     REQUIRE(0 == ham_env_close(env, 0));
   }
+
+  // returns the physical size of the file
+  ham_u64_t get_physical_file_size() {
+    struct stat st;
+    REQUIRE(0 == ::stat(Globals::opath(".test"), &st));
+    return ((ham_u64_t)st.st_size);
+  }
+
+  void fileGrowthTest() {
+    ham_env_t *env;
+    ham_db_t *db;
+    const ham_u64_t kGrowth = 1024 * 1024;
+    ham_parameter_t params[] = {
+      {HAM_PARAM_FILE_GROWTH_SIZE, kGrowth},
+      {0, 0}
+    };
+    ham_parameter_t query[] = {
+      {HAM_PARAM_FILE_GROWTH_SIZE, 0},
+      {0, 0}
+    };
+
+    REQUIRE(HAM_INV_PARAMETER ==
+        ham_env_create(&env, Globals::opath(".test"), HAM_IN_MEMORY,
+            0664, &params[0]));
+
+    REQUIRE(0 ==
+        ham_env_create(&env, Globals::opath(".test"), 0, 0664, &params[0]));
+    REQUIRE(0 == ham_env_get_parameters(env, &query[0]));
+    REQUIRE(kGrowth == query[0].value);
+    REQUIRE(0 == ham_env_create_db(env, &db, 1, 0, 0));
+
+    // the file grew by a full extent, but only a few pages are in use
+    Device *device = ((LocalEnvironment *)env)->get_device();
+    REQUIRE(kGrowth == get_physical_file_size());
+    REQUIRE(device->get_file_size() < kGrowth);
+
+    int i;
+    char buffer[256] = {0};
+    ham_key_t key = {0};
+    ham_record_t rec = {0};
+    rec.data = buffer;
+    rec.size = sizeof(buffer);
+    for (i = 0; i < 5000; i++) {
+      key.data = &i;
+      key.size = sizeof(i);
+      REQUIRE(0 == ham_db_insert(db, 0, &key, &rec, 0));
+    }
+    ham_u64_t file_size = device->get_file_size();
+    REQUIRE(file_size > kGrowth);
+    REQUIRE(get_physical_file_size() == 2 * kGrowth);
+
+    // the unused space is released when the Environment is closed
+    REQUIRE(0 == ham_env_close(env, HAM_AUTO_CLEANUP));
+    REQUIRE(get_physical_file_size() <= file_size);
+
+    REQUIRE(0 ==
+        ham_env_open(&env, Globals::opath(".test"), 0, &params[0]));
+    REQUIRE(0 == ham_env_open_db(env, &db, 1, 0, 0));
+    for (i = 0; i < 5000; i++) {
+      key.data = &i;
+      key.size = sizeof(i);
+      REQUIRE(0 == ham_db_find(db, 0, &key, &rec, 0));
+    }
+    REQUIRE(0 == ham_env_close(env, HAM_AUTO_CLEANUP));
+  }
 };
 
 TEST_CASE("Env/createCloseTest", "")
@@ -1369,6 +1564,24 @@ TEST_CASE("Env/createOpenEmptyTest", "")
 }
 
 
+TEST_CASE("Env/concurrentReadsFlagsTest", "")
+{
+  EnvFixture f;
+  f.concurrentReadsFlagsTest();
+}
+
+TEST_CASE("Env/concurrentReadsTest", "")
+{
+  EnvFixture f;
+  f.concurrentReadsTest();
+}
+
+TEST_CASE("Env/fileGrowthTest", "")
+{
+  EnvFixture f;
+  f.fileGrowthTest();
+}
+
 TEST_CASE("Env-inmem/createCloseTest", "")
 {
   EnvFixture f(HAM_IN_MEMORY);
@@ -1495,3 +1708,9 @@ TEST_CASE("Env-inmem/createOpenEmptyTest", "")
   f.createOpenEmptyTest();
 }
 
+
+TEST_CASE("Env-inmem/concurrentReadsTest", "")
+{
+  EnvFixture f(HAM_IN_MEMORY);
+  f.concurrentReadsTest();
+}
@@ -20,12 +20,18 @@
 
 #include "globals.h"
 
+#include <vector>
+#include <boost/thread.hpp>
+
 #include "../src/endianswap.h"
 
+#include "../src/device.h"
+#include "../src/page.h"
 #include "../src/journal.h"
 #include "../src/txn.h"
 #include "../src/env_local.h"
 #include "../src/txn_local.h"
+#include "../src/btree_index.h"
 #include "os.hpp"
 
 using namespace hamsterdb;
@@ -71,6 +77,42 @@ struct EraseLogEntry : public LogEntry {
   ham_key_t *key;
 };
 
+// A thread which commits |kNumTxns| Transactions with one insert each;
+// used to test the group commit
+struct GroupCommitter {
+  static const int kNumTxns = 100;
+
+  GroupCommitter(ham_env_t *env, ham_db_t *db, int id)
+    : env(env), db(db), id(id), failures(0) {
+  }
+
+  void operator()() {
+    for (int i = 0; i < kNumTxns; i++) {
+      int k = id * kNumTxns + i;
+      ham_key_t key = {0};
+      key.data = &k;
+      key.size = sizeof(k);
+      ham_record_t rec = {0};
+      rec.data = &k;
+      rec.size = sizeof(k);
+      ham_txn_t *txn;
+      if (ham_txn_begin(&txn, env, 0, 0, 0) != 0) {
+        failures++;
+        continue;
+      }
+      if (ham_db_insert(db, txn, &key, &rec, 0) != 0)
+        failures++;
+      if (ham_txn_commit(txn, 0) != 0)
+        failures++;
+    }
+  }
+
+  ham_env_t *env;
+  ham_db_t *db;
+  int id;
+  int failures;
+};
+
 struct JournalFixture {
   ham_db_t *m_db;
   ham_env_t *m_env;
@@ -451,7 +493,8 @@ struct JournalFixture {
         break;
 
       // skip Changesets
-      if (entry.type == Journal::kEntryTypeChangeset)
+      if (entry.type == Journal::kEntryTypeChangeset
+          || entry.type == Journal::kEntryTypeChangesetDelta)
         continue;
 
       if (s == size) {
@@ -1049,6 +1092,417 @@ struct JournalFixture {
     REQUIRE(0 == ham_db_get_key_count(m_db, 0, 0, &keycount));
     REQUIRE(0ull == keycount);
   }
+
+  void recoverManyEntriesTest() {
+    // enough entries and data to fill the queue of the JournalReader
+    static const int kNumKeys = 2000;
+    ham_txn_t *txn;
+    ham_key_t key = {0};
+    ham_record_t rec = {0};
+    std::vector<char> data(4096, 'x');
+
+    REQUIRE(0 == ham_txn_begin(&txn, m_env, 0, 0, 0));
+    for (int i = 0; i < kNumKeys; i++) {
+      key.data = &i;
+      key.size = sizeof(i);
+      rec.data = &data[0];
+      rec.size = (ham_u32_t)data.size();
+      REQUIRE(0 == ham_db_insert(m_db, txn, &key, &rec, 0));
+    }
+    REQUIRE(0 == ham_txn_commit(txn, 0));
+
+    /* re-create the Environment from the journal */
+    REQUIRE(0 == ham_env_close(m_env,
+                HAM_AUTO_CLEANUP | HAM_DONT_CLEAR_LOG));
+    REQUIRE(0 ==
+        ham_env_open(&m_env, Globals::opath(".test"),
+            HAM_ENABLE_TRANSACTIONS
+            | HAM_AUTO_RECOVERY, 0));
+    REQUIRE(0 == ham_env_open_db(m_env, &m_db, 1, 0, 0));
+
+    /* the begin, the inserts and the commit were read */
+    ham_env_metrics_t metrics = {0};
+    REQUIRE(0 == ham_env_get_metrics(m_env, &metrics));
+    REQUIRE(metrics.journal_recovered_entries >= (ham_u64_t)kNumKeys + 2);
+    REQUIRE(metrics.journal_recovered_bytes
+                    > (ham_u64_t)kNumKeys * data.size());
+
+    verifyJournalIsEmpty();
+
+    for (int i = 0; i < kNumKeys; i++) {
+      key.data = &i;
+      key.size = sizeof(i);
+      REQUIRE(0 == ham_db_find(m_db, 0, &key, &rec, 0));
+      REQUIRE(rec.size == data.size());
+    }
+  }
+
+  // Commits |kNumTxns| Transactions with a single insert each; returns the
+  // largest combined size of both journal files
+  ham_u64_t runJournalSizeLimit(ham_u64_t limit, ham_u64_t *checkpoints) {
+    static const int kNumTxns = 2000;
+    ham_parameter_t params[] = {
+      {HAM_PARAM_PAGE_SIZE, 1024},
+      {HAM_PARAM_JOURNAL_SIZE_LIMIT, limit},
+      {0, 0}
+    };
+    teardown();
+
+    REQUIRE(0 ==
+        ham_env_create(&m_env, Globals::opath(".test"),
+                HAM_ENABLE_TRANSACTIONS | HAM_ENABLE_RECOVERY, 0644,
+                &params[0]));
+    REQUIRE(0 == ham_env_create_db(m_env, &m_db, 1, 0, 0));
+
+    ham_parameter_t query[] = {
+      {HAM_PARAM_JOURNAL_SIZE_LIMIT, 0},
+      {0, 0}
+    };
+    REQUIRE(0 == ham_env_get_parameters(m_env, &query[0]));
+    REQUIRE(limit == query[0].value);
+
+    Journal *j = ((LocalEnvironment *)m_env)->get_journal();
+    ham_u64_t max_size = 0;
+    char buffer[1000] = {0};
+    for (int i = 0; i < kNumTxns; i++) {
+      ham_txn_t *txn;
+      ham_key_t key = {0};
+      key.data = &i;
+      key.size = sizeof(i);
+      ham_record_t rec = {0};
+      rec.data = buffer;
+      rec.size = sizeof(buffer);
+      REQUIRE(0 == ham_txn_begin(&txn, m_env, 0, 0, 0));
+      REQUIRE(0 == ham_db_insert(m_db, txn, &key, &rec, 0));
+      REQUIRE(0 == ham_txn_commit(txn, 0));
+
+      ham_u64_t size = os_get_file_size(j->m_fd[0])
+              + os_get_file_size(j->m_fd[1]);
+      if (size > max_size)
+        max_size = size;
+    }
+
+    ham_env_metrics_t metrics = {0};
+    REQUIRE(0 == ham_env_get_metrics(m_env, &metrics));
+    *checkpoints = metrics.journal_checkpoints;
+
+    /* the recovery still works */
+    REQUIRE(0 == ham_env_close(m_env,
+                HAM_AUTO_CLEANUP | HAM_DONT_CLEAR_LOG));
+    REQUIRE(0 ==
+        ham_env_open(&m_env, Globals::opath(".test"),
+            HAM_ENABLE_TRANSACTIONS | HAM_AUTO_RECOVERY, 0));
+    REQUIRE(0 == ham_env_open_db(m_env, &m_db, 1, 0, 0));
+    for (int i = 0; i < kNumTxns; i++) {
+      ham_key_t key = {0};
+      key.data = &i;
+      key.size = sizeof(i);
+      ham_record_t rec = {0};
+      REQUIRE(0 == ham_db_find(m_db, 0, &key, &rec, 0));
+    }
+    return (max_size);
+  }
+
+  void journalSizeLimitTest() {
+    ham_u64_t checkpoints;
+    ham_u64_t unlimited = runJournalSizeLimit(0, &checkpoints);
+    REQUIRE(checkpoints == 0ull);
+
+    ham_u64_t limited = runJournalSizeLimit(32 * 1024, &checkpoints);
+    REQUIRE(checkpoints > 0ull);
+    REQUIRE(limited < unlimited);
+  }
+
+  void diffPageTest() {
+    static const ham_u32_t kPageSize = 1024;
+    std::vector<ham_u8_t> before(kPageSize, 0);
+    std::vector<ham_u8_t> after(before);
+    std::vector<PJournalEntryPageRange> ranges;
+
+    /* identical pages have no ranges */
+    REQUIRE(0u == Journal::diff_page(&before[0], &after[0], kPageSize,
+                            &ranges));
+    REQUIRE(ranges.empty());
+
+    /* a single modified byte is logged as a word */
+    after[100] = 1;
+    REQUIRE(Journal::diff_page(&before[0], &after[0], kPageSize, &ranges)
+            == sizeof(PJournalEntryPageRange) + 8);
+    REQUIRE(1u == ranges.size());
+    REQUIRE(96u == ranges[0].offset);
+    REQUIRE(8u == ranges[0].length);
+
+    /* small gaps are merged */
+    ranges.clear();
+    after[112] = 1;
+    Journal::diff_page(&before[0], &after[0], kPageSize, &ranges);
+    REQUIRE(1u == ranges.size());
+    REQUIRE(96u == ranges[0].offset);
+    REQUIRE(24u == ranges[0].length);
+
+    /* larger gaps start a new range; the last word is included */
+    ranges.clear();
+    after[kPageSize - 1] = 1;
+    REQUIRE(Journal::diff_page(&before[0], &after[0], kPageSize, &ranges)
+            == 2 * sizeof(PJournalEntryPageRange) + 32);
+    REQUIRE(2u == ranges.size());
+    REQUIRE(ranges[1].offset == kPageSize - 8);
+    REQUIRE(8u == ranges[1].length);
+  }
+
+  void recoverChangesetDeltaTest() {
+    ham_u32_t page_size = m_lenv->get_page_size();
+    Device *device = m_lenv->get_device();
+    Journal *j = m_lenv->get_journal();
+
+    /* the old version of a page; the lsn in the header is 0 */
+    std::vector<ham_u8_t> before(page_size, 0x11);
+    memset(&before[0], 0, sizeof(PPageHeader));
+    ham_u64_t address = device->alloc(page_size);
+    device->write(address, &before[0], page_size);
+
+    /* modify a few bytes, then log the page */
+    std::vector<ham_u8_t> after(before);
+    after[100] = 0x22;
+    after[page_size - 1] = 0x33;
+    Page *page = new Page(m_lenv);
+    page->fetch(address);
+    memcpy(page->get_raw_payload(), &after[0], page_size);
+    j->append_changeset(&page, 1, 0, 0, 0, 0, 0, 0,
+                    (ham_u32_t)j->get_incremented_lsn());
+    delete page;
+
+    /* only the modified ranges were logged */
+    ham_env_metrics_t metrics = {0};
+    REQUIRE(0 == ham_env_get_metrics(m_env, &metrics));
+    REQUIRE(metrics.journal_changeset_bytes_saved > 0ull);
+
+    /* the write of the page was interrupted; only the first half is new */
+    device->write(address, &after[0], page_size / 2);
+
+    /* the recovery applies the ranges to the page in the file */
+    j->recover_changeset();
+    std::vector<ham_u8_t> result(page_size);
+    device->read(address, &result[0], page_size);
+    REQUIRE(0 == memcmp(&after[0], &result[0], page_size));
+  }
+
+  void compressionParameterTest() {
+    ham_env_t *env;
+    ham_parameter_t params[] = {
+      {HAM_PARAM_JOURNAL_COMPRESSION, HAM_COMPRESSOR_SNAPPY},
+      {0, 0}
+    };
+    REQUIRE(HAM_NOT_IMPLEMENTED ==
+        ham_env_create(&env, Globals::opath(".test2"),
+                HAM_ENABLE_TRANSACTIONS, 0644, &params[0]));
+    params[0].value = HAM_COMPRESSOR_LZ4;
+    REQUIRE(HAM_INV_PARAMETER ==
+        ham_env_create(&env, 0, HAM_IN_MEMORY | HAM_ENABLE_TRANSACTIONS,
+                0644, &params[0]));
+
+    REQUIRE(0 ==
+        ham_env_create(&env, Globals::opath(".test2"),
+                HAM_ENABLE_TRANSACTIONS, 0644, &params[0]));
+    params[0].value = 0;
+    REQUIRE(0 == ham_env_get_parameters(env, &params[0]));
+    REQUIRE((ham_u64_t)HAM_COMPRESSOR_LZ4 == params[0].value);
+    REQUIRE(0 == ham_env_close(env, 0));
+  }
+
+  void recoverCompressedTest() {
+    ham_parameter_t params[] = {
+      {HAM_PARAM_JOURNAL_COMPRESSION, HAM_COMPRESSOR_LZ4},
+      {0, 0}
+    };
+    REQUIRE(0 == ham_env_close(m_env, HAM_AUTO_CLEANUP));
+    REQUIRE(0 ==
+        ham_env_create(&m_env, Globals::opath(".test"),
+                HAM_FLUSH_WHEN_COMMITTED
+                | HAM_ENABLE_TRANSACTIONS
+                | HAM_ENABLE_RECOVERY, 0644, &params[0]));
+    REQUIRE(0 ==
+            ham_env_create_db(m_env, &m_db, 1, HAM_ENABLE_DUPLICATE_KEYS, 0));
+
+    /* compressible keys and records; the odd keys are erased again */
+    ham_txn_t *txn;
+    char keybuf[64];
+    char recbuf[1024];
+    ham_key_t key = {0};
+    ham_record_t rec = {0};
+    REQUIRE(0 == ham_txn_begin(&txn, m_env, 0, 0, 0));
+    for (int i = 0; i < 100; i++) {
+      memset(keybuf, 'k', sizeof(keybuf));
+      memset(recbuf, i, sizeof(recbuf));
+      *(int *)&keybuf[0] = i;
+      key.data = keybuf;
+      key.size = sizeof(keybuf);
+      rec.data = recbuf;
+      rec.size = sizeof(recbuf);
+      REQUIRE(0 == ham_db_insert(m_db, txn, &key, &rec, 0));
+    }
+    for (int i = 1; i < 100; i += 2) {
+      *(int *)&keybuf[0] = i;
+      REQUIRE(0 == ham_db_erase(m_db, txn, &key, 0));
+    }
+    REQUIRE(0 == ham_txn_commit(txn, 0));
+
+    ham_env_metrics_t metrics = {0};
+    REQUIRE(0 == ham_env_get_metrics(m_env, &metrics));
+    REQUIRE(metrics.journal_bytes_before_compression
+            > 150 * (sizeof(keybuf) + 0ull));
+    REQUIRE(metrics.journal_bytes_after_compression
+            < metrics.journal_bytes_before_compression / 4);
+
+    /* re-create the Environment from the journal; the journal is
+     * decompressed although compression is not enabled anymore */
+    REQUIRE(0 == ham_env_close(m_env,
+                HAM_AUTO_CLEANUP | HAM_DONT_CLEAR_LOG));
+    REQUIRE(0 ==
+        ham_env_open(&m_env, Globals::opath(".test"),
+            HAM_ENABLE_TRANSACTIONS
+            | HAM_AUTO_RECOVERY, 0));
+    REQUIRE(0 == ham_env_open_db(m_env, &m_db, 1, 0, 0));
+    verifyJournalIsEmpty();
+
+    for (int i = 0; i < 100; i++) {
+      memset(keybuf, 'k', sizeof(keybuf));
+      *(int *)&keybuf[0] = i;
+      key.data = keybuf;
+      key.size = sizeof(keybuf);
+      memset(&rec, 0, sizeof(rec));
+      if (i & 1)
+        REQUIRE(HAM_KEY_NOT_FOUND == ham_db_find(m_db, 0, &key, &rec, 0));
+      else {
+        REQUIRE(0 == ham_db_find(m_db, 0, &key, &rec, 0));
+        REQUIRE(sizeof(recbuf) == rec.size);
+        memset(recbuf, i, sizeof(recbuf));
+        REQUIRE(0 == memcmp(recbuf, rec.data, rec.size));
+      }
+    }
+
+    /* the cleared journal files are no longer compressed */
+    Journal::PJournalHeader header;
+    os_pread(m_lenv->get_journal()->m_fd[0], 0, &header, sizeof(header));
+    REQUIRE(0u == header.compressor);
+  }
+
+  void asyncWriterTest() {
+    static const int kNumBuffers = 100;
+    ham_fd_t fd = os_create(Globals::opath(".test.async"), 0, 0644);
+
+    {
+      JournalWriter writer;
+      ham_u64_t seq = 0;
+      for (int i = 0; i < kNumBuffers; i++) {
+        ByteArray buffer;
+        buffer.resize(1000 + i, (ham_u8_t)i);
+        seq = writer.write(fd, &buffer);
+        REQUIRE((ham_u64_t)(i + 1) == seq);
+        // the memory was handed over to the writer
+        REQUIRE(0u == buffer.get_size());
+      }
+      writer.wait(seq);
+    }
+
+    // the buffers were written in their original order
+    ham_u64_t offset = 0;
+    for (int i = 0; i < kNumBuffers; i++) {
+      ByteArray buffer(1000 + i);
+      os_pread(fd, offset, buffer.get_ptr(), buffer.get_size());
+      for (int j = 0; j < 1000 + i; j++)
+        REQUIRE((ham_u8_t)i == ((ham_u8_t *)buffer.get_ptr())[j]);
+      offset += buffer.get_size();
+    }
+    REQUIRE(offset == os_get_file_size(fd));
+    os_close(fd);
+    (void)os::unlink(Globals::opath(".test.async"));
+  }
+
+  void recoverKeyCountersTest() {
+    ham_txn_t *txn;
+    ham_key_t key = {0};
+    ham_record_t rec = {0};
+    int i;
+    key.data = &i;
+    key.size = sizeof(i);
+
+    REQUIRE(0 == ham_txn_begin(&txn, m_env, 0, 0, 0));
+    for (i = 0; i < 100; i++)
+      REQUIRE(0 == ham_db_insert(m_db, txn, &key, &rec, 0));
+    for (i = 0; i < 10; i++)
+      REQUIRE(0 == ham_db_erase(m_db, txn, &key, 0));
+    REQUIRE(0 == ham_txn_commit(txn, 0));
+
+    /* keep the journal, and destroy the counters in the header */
+    REQUIRE(0 == ham_env_close(m_env,
+                HAM_AUTO_CLEANUP | HAM_DONT_CLEAR_LOG));
+    REQUIRE(0 == ham_env_open(&m_env, Globals::opath(".test"), 0, 0));
+    m_lenv = (LocalEnvironment *)m_env;
+    PBtreeHeader *desc = m_lenv->get_btree_descriptor(0);
+    desc->set_key_count(12345);
+    desc->set_record_count(12345);
+    m_lenv->mark_header_page_dirty();
+    REQUIRE(0 == ham_env_close(m_env, 0));
+
+    /* the recovery rebuilds the counters */
+    REQUIRE(0 ==
+        ham_env_open(&m_env, Globals::opath(".test"),
+            HAM_ENABLE_TRANSACTIONS | HAM_AUTO_RECOVERY, 0));
+    m_lenv = (LocalEnvironment *)m_env;
+    REQUIRE(0 == ham_env_open_db(m_env, &m_db, 1, 0, 0));
+
+    ham_u64_t keycount;
+    REQUIRE(0 == ham_db_get_key_count(m_db, 0, HAM_SKIP_DUPLICATES,
+                &keycount));
+    REQUIRE(90ull == keycount);
+    REQUIRE(0 == ham_db_get_key_count(m_db, 0, 0, &keycount));
+    REQUIRE(90ull == keycount);
+  }
+
+  void groupCommitTest() {
+    static const int kNumThreads = 4;
+    teardown();
+
+    REQUIRE(0 ==
+        ham_env_create(&m_env, Globals::opath(".test"),
+                HAM_ENABLE_TRANSACTIONS | HAM_ENABLE_FSYNC, 0644, 0));
+    REQUIRE(0 == ham_env_create_db(m_env, &m_db, 1, 0, 0));
+
+    std::vector<GroupCommitter *> committers;
+    std::vector<boost::thread *> threads;
+    for (int i = 0; i < kNumThreads; i++) {
+      committers.push_back(new GroupCommitter(m_env, m_db, i));
+      threads.push_back(new boost::thread(boost::ref(*committers[i])));
+    }
+    for (int i = 0; i < kNumThreads; i++) {
+      threads[i]->join();
+      delete threads[i];
+      REQUIRE(0 == committers[i]->failures);
+      delete committers[i];
+    }
+
+    // every commit was synced, but concurrent commits can share an fsync
+    ham_env_metrics_t metrics = {0};
+    REQUIRE(0 == ham_env_get_metrics(m_env, &metrics));
+    REQUIRE(metrics.journal_group_syncs > 0);
+    REQUIRE(metrics.journal_group_syncs
+                    <= (ham_u64_t)(kNumThreads * GroupCommitter::kNumTxns));
+
+    REQUIRE(0 == ham_env_close(m_env, HAM_AUTO_CLEANUP));
+    REQUIRE(0 ==
+        ham_env_open(&m_env, Globals::opath(".test"),
+                HAM_ENABLE_TRANSACTIONS, 0));
+    REQUIRE(0 == ham_env_open_db(m_env, &m_db, 1, 0, 0));
+    for (int k = 0; k < kNumThreads * GroupCommitter::kNumTxns; k++) {
+      ham_key_t key = {0};
+      key.data = &k;
+      key.size = sizeof(k);
+      ham_record_t rec = {0};
+      REQUIRE(0 == ham_db_find(m_db, 0, &key, &rec, 0));
+      REQUIRE(*(int *)rec.data == k);
+    }
+  }
 };
 
 TEST_CASE("Journal/createCloseTest", "")
@@ -1183,5 +1637,58 @@ TEST_CASE("Journal/recoverEraseTest", "")
   f.recoverEraseTest();
 }
 
-} // namespace hamsterdb
+TEST_CASE("Journal/recoverManyEntriesTest", "")
+{
+  JournalFixture f;
+  f.recoverManyEntriesTest();
+}
+
+TEST_CASE("Journal/journalSizeLimit", "")
+{
+  JournalFixture f;
+  f.journalSizeLimitTest();
+}
+
+TEST_CASE("Journal/diffPage", "")
+{
+  JournalFixture f;
+  f.diffPageTest();
+}
 
+TEST_CASE("Journal/recoverChangesetDelta", "")
+{
+  JournalFixture f;
+  f.recoverChangesetDeltaTest();
+}
+
+TEST_CASE("Journal/compressionParameter", "")
+{
+  JournalFixture f;
+  f.compressionParameterTest();
+}
+
+TEST_CASE("Journal/recoverCompressed", "")
+{
+  JournalFixture f;
+  f.recoverCompressedTest();
+}
+
+TEST_CASE("Journal/asyncWriter", "")
+{
+  JournalFixture f;
+  f.asyncWriterTest();
+}
+
+TEST_CASE("Journal/recoverKeyCounters", "")
+{
+  JournalFixture f;
+  f.recoverKeyCountersTest();
+}
+
+TEST_CASE("Journal/groupCommit", "")
+{
+  JournalFixture f;
+  f.groupCommitTest();
+}
+
+} // namespace hamsterdb
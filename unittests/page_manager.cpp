@@ -243,6 +243,357 @@ struct PageManagerFixture {
     REQUIRE(false == lenv->get_page_manager()->cache_is_full());
   }
 
+  static std::vector<Page *> ms_purged;
+
+  static void purge_callback(Page *page, PageManager *pm) {
+    ms_purged.push_back(page);
+  }
+
+  static bool contains_purged(ham_u64_t address) {
+    for (std::vector<Page *>::iterator it = ms_purged.begin();
+            it != ms_purged.end(); it++)
+      if ((*it)->get_address() == address)
+        return (true);
+    return (false);
+  }
+
+  // Fills the cache, purges, re-loads a purged page and then simulates a
+  // scan. Returns true if the re-loaded page survived the scan.
+  bool cacheScanTest(ham_u32_t policy) {
+    LocalEnvironment *lenv = (LocalEnvironment *)m_env;
+    ham_u32_t page_size = lenv->get_page_size();
+    Cache cache(lenv, 16 * page_size, policy);
+    REQUIRE(cache.get_policy() == policy);
+
+    PPageData pers;
+    memset(&pers, 0, sizeof(pers));
+    std::vector<Page *> v;
+    ms_purged.clear();
+
+    for (unsigned int i = 0; i < 17; i++) {
+      Page *p = new Page(lenv);
+      p->set_flags(Page::kNpersNoHeader | Page::kNpersMalloc);
+      p->set_address((i + 1) * page_size);
+      p->set_data(&pers);
+      v.push_back(p);
+      cache.put_page(p);
+    }
+
+    REQUIRE(true == cache.is_full());
+    cache.purge(purge_callback, 0, 5);
+    REQUIRE(false == cache.is_full());
+    REQUIRE(5u == ms_purged.size());
+    // the oldest page was purged first
+    REQUIRE(true == contains_purged(page_size));
+
+    // the first page is loaded again
+    Page *first = v[0];
+    cache.put_page(first);
+    REQUIRE(cache.get_page(page_size) == first);
+    ms_purged.clear();
+
+    // now "scan" lots of new pages
+    for (unsigned int i = 0; i < 40; i++) {
+      Page *p = new Page(lenv);
+      p->set_flags(Page::kNpersNoHeader | Page::kNpersMalloc);
+      p->set_address((i + 100) * page_size);
+      p->set_data(&pers);
+      v.push_back(p);
+      cache.put_page(p);
+      while (cache.is_full())
+        cache.purge(purge_callback, 0, 1);
+    }
+
+    bool survived = cache.get_page(page_size) == first;
+    REQUIRE(survived != contains_purged(page_size));
+
+    for (std::vector<Page *>::iterator it = v.begin(); it != v.end(); it++) {
+      cache.remove_page(*it);
+      (*it)->set_data(0);
+      delete *it;
+    }
+    REQUIRE(0u == cache.get_current_elements());
+    return (survived);
+  }
+
+  void cacheHashTableTest() {
+    LocalEnvironment *lenv = (LocalEnvironment *)m_env;
+    ham_u32_t page_size = lenv->get_page_size();
+    Cache cache(lenv, 16 * page_size);
+    const unsigned int kMax = 5000;
+
+    PPageData pers;
+    memset(&pers, 0, sizeof(pers));
+    std::vector<Page *> v;
+
+    // insert more pages than the hash table initially can store
+    for (unsigned int i = 0; i < kMax; i++) {
+      Page *p = new Page(lenv);
+      p->set_flags(Page::kNpersNoHeader | Page::kNpersMalloc);
+      p->set_address((i + 1) * page_size);
+      p->set_data(&pers);
+      v.push_back(p);
+      cache.put_page(p);
+    }
+    REQUIRE(kMax == cache.get_current_elements());
+
+    // remove every third page; the others must still be found
+    for (unsigned int i = 0; i < kMax; i += 3)
+      cache.remove_page(v[i]);
+    for (unsigned int i = 0; i < kMax; i++) {
+      if (i % 3 == 0)
+        REQUIRE((Page *)0 == cache.get_page((i + 1) * page_size));
+      else
+        REQUIRE(v[i] == cache.get_page((i + 1) * page_size));
+    }
+
+    // re-insert them
+    for (unsigned int i = 0; i < kMax; i += 3)
+      cache.put_page(v[i]);
+    for (unsigned int i = 0; i < kMax; i++)
+      REQUIRE(v[i] == cache.get_page((i + 1) * page_size));
+    REQUIRE(kMax == cache.get_current_elements());
+
+    for (unsigned int i = 0; i < kMax; i++) {
+      cache.remove_page(v[i]);
+      v[i]->set_data(0);
+      delete v[i];
+    }
+    REQUIRE(0u == cache.get_current_elements());
+    REQUIRE((Page *)0 == cache.get_page(page_size));
+  }
+
+  void cachePinTest() {
+    LocalEnvironment *lenv = (LocalEnvironment *)m_env;
+    ham_u32_t page_size = lenv->get_page_size();
+    Cache cache(lenv, 16 * page_size);
+    REQUIRE(1u == cache.get_num_shards());
+
+    PPageData pers;
+    memset(&pers, 0, sizeof(pers));
+    std::vector<Page *> v;
+    ms_purged.clear();
+
+    for (unsigned int i = 0; i < 17; i++) {
+      Page *p = new Page(lenv);
+      p->set_flags(Page::kNpersNoHeader | Page::kNpersMalloc);
+      p->set_address((i + 1) * page_size);
+      p->set_data(&pers);
+      v.push_back(p);
+      cache.put_page(p);
+    }
+
+    // a pinned page is not purged
+    REQUIRE(v[0] == cache.get_page(page_size, Cache::kPin));
+    REQUIRE(true == v[0]->is_pinned());
+    cache.purge(purge_callback, 0, 100);
+    REQUIRE(16u == ms_purged.size());
+    REQUIRE(false == contains_purged(page_size));
+    REQUIRE(1u == cache.get_current_elements());
+
+    // ... but it is purged when it was unpinned
+    cache.unpin_page(v[0]);
+    REQUIRE(false == v[0]->is_pinned());
+    cache.purge(purge_callback, 0, 100);
+    REQUIRE(true == contains_purged(page_size));
+    REQUIRE(0u == cache.get_current_elements());
+
+    // put_page_if_absent() does not replace a cached page
+    Page *p = new Page(lenv);
+    p->set_flags(Page::kNpersNoHeader | Page::kNpersMalloc);
+    p->set_address(page_size);
+    p->set_data(&pers);
+    cache.put_page(v[0]);
+    REQUIRE(v[0] == cache.put_page_if_absent(p, Cache::kPin));
+    REQUIRE(true == v[0]->is_pinned());
+    cache.unpin_page(v[0]);
+    p->set_data(0);
+    delete p;
+
+    for (std::vector<Page *>::iterator it = v.begin(); it != v.end(); it++) {
+      cache.remove_page(*it);
+      (*it)->set_data(0);
+      delete *it;
+    }
+  }
+
+  void cacheShardTest() {
+    LocalEnvironment *lenv = (LocalEnvironment *)m_env;
+    ham_u32_t page_size = lenv->get_page_size();
+    Cache cache(lenv, 1024 * page_size);
+    REQUIRE(16u == cache.get_num_shards());
+    const unsigned int kMax = 1000;
+
+    PPageData pers;
+    memset(&pers, 0, sizeof(pers));
+    std::vector<Page *> v;
+    ms_purged.clear();
+
+    for (unsigned int i = 0; i < kMax; i++) {
+      Page *p = new Page(lenv);
+      p->set_flags(Page::kNpersNoHeader | Page::kNpersMalloc);
+      p->set_address((i + 1) * page_size);
+      p->set_data(&pers);
+      v.push_back(p);
+      cache.put_page(p);
+    }
+    REQUIRE(kMax == cache.get_current_elements());
+    for (unsigned int i = 0; i < kMax; i++)
+      REQUIRE(v[i] == cache.get_page((i + 1) * page_size));
+
+    ham_env_metrics_t metrics;
+    cache.get_metrics(&metrics);
+    REQUIRE(kMax == metrics.cache_hits);
+    REQUIRE(0u == metrics.cache_misses);
+
+    // all shards are purged
+    cache.purge(purge_callback, 0, 160);
+    REQUIRE(160u == ms_purged.size());
+    REQUIRE((ham_u64_t)(kMax - 160) == cache.get_current_elements());
+
+    for (std::vector<Page *>::iterator it = v.begin(); it != v.end(); it++) {
+      cache.remove_page(*it);
+      (*it)->set_data(0);
+      delete *it;
+    }
+    REQUIRE(0u == cache.get_current_elements());
+  }
+
+  void cachePolicyTest() {
+    ham_parameter_t params[] = {
+        {HAM_PARAM_CACHE_POLICY, 0},
+        {0, 0}
+    };
+    REQUIRE(0 == ham_env_get_parameters(m_env, &params[0]));
+    REQUIRE((ham_u64_t)HAM_CACHE_POLICY_LRU == params[0].value);
+    REQUIRE(0 == ham_env_close(m_env, HAM_AUTO_CLEANUP));
+
+    params[0].value = 99;
+    REQUIRE(HAM_INV_PARAMETER ==
+        ham_env_open(&m_env, Globals::opath(".test"), 0, &params[0]));
+
+    params[0].value = HAM_CACHE_POLICY_2Q;
+    REQUIRE(0 ==
+        ham_env_open(&m_env, Globals::opath(".test"), 0, &params[0]));
+    REQUIRE(HAM_CACHE_POLICY_2Q == ((LocalEnvironment *)m_env)
+                    ->get_page_manager()->m_cache.get_policy());
+    params[0].value = 0;
+    REQUIRE(0 == ham_env_get_parameters(m_env, &params[0]));
+    REQUIRE((ham_u64_t)HAM_CACHE_POLICY_2Q == params[0].value);
+  }
+
+  void flusherParamsTest() {
+    ham_parameter_t params[] = {
+        {HAM_PARAM_FLUSHER_HIGH_WATERMARK, 0},
+        {HAM_PARAM_FLUSHER_LOW_WATERMARK, 0},
+        {0, 0}
+    };
+    REQUIRE(0 == ham_env_get_parameters(m_env, &params[0]));
+    REQUIRE(0u == params[0].value);
+    REQUIRE(0u == params[1].value);
+    REQUIRE((Flusher *)0 == ((LocalEnvironment *)m_env)
+                    ->get_page_manager()->get_flusher());
+    REQUIRE(0 == ham_env_close(m_env, HAM_AUTO_CLEANUP));
+
+    // not a percentage
+    params[0].value = 101;
+    REQUIRE(HAM_INV_PARAMETER ==
+        ham_env_open(&m_env, Globals::opath(".test"), 0, &params[0]));
+    // low watermark >= high watermark
+    params[0].value = 40;
+    params[1].value = 40;
+    REQUIRE(HAM_INV_PARAMETER ==
+        ham_env_open(&m_env, Globals::opath(".test"), 0, &params[0]));
+    // low watermark without high watermark
+    params[0].value = 0;
+    params[1].value = 10;
+    REQUIRE(HAM_INV_PARAMETER ==
+        ham_env_open(&m_env, Globals::opath(".test"), 0, &params[0]));
+    // not allowed for in-memory Environments
+    params[0].value = 40;
+    params[1].value = 0;
+    REQUIRE(HAM_INV_PARAMETER ==
+        ham_env_create(&m_env, 0, HAM_IN_MEMORY, 0, &params[0]));
+
+    // the low watermark defaults to half of the high watermark
+    REQUIRE(0 ==
+        ham_env_open(&m_env, Globals::opath(".test"), 0, &params[0]));
+    REQUIRE((Flusher *)0 != ((LocalEnvironment *)m_env)
+                    ->get_page_manager()->get_flusher());
+    REQUIRE(0 == ham_env_get_parameters(m_env, &params[0]));
+    REQUIRE(40u == params[0].value);
+    REQUIRE(20u == params[1].value);
+  }
+
+  void flusherTest() {
+    REQUIRE(0 == ham_env_close(m_env, HAM_AUTO_CLEANUP));
+
+    ham_parameter_t params[] = {
+        {HAM_PARAM_CACHE_SIZE, 16 * HAM_DEFAULT_PAGESIZE},
+        {HAM_PARAM_FLUSHER_HIGH_WATERMARK, 50},
+        {HAM_PARAM_FLUSHER_LOW_WATERMARK, 25},
+        {0, 0}
+    };
+    REQUIRE(0 ==
+        ham_env_open(&m_env, Globals::opath(".test"), 0, &params[0]));
+
+    LocalEnvironment *lenv = (LocalEnvironment *)m_env;
+    PageManager *pm = lenv->get_page_manager();
+    ham_u32_t page_size = lenv->get_page_size();
+    std::vector<Page *> pages;
+
+    // the flusher thread is running; therefore lock the Environment
+    // while the PageManager is used
+    {
+      ExclusiveLock lock(lenv->get_mutex());
+      for (int i = 0; i < 12; i++) {
+        Page *page = pm->alloc_page(0, Page::kTypeBlob);
+        memset(page->get_payload(), i + 1, 64);
+        pages.push_back(page);
+      }
+
+      // the cache is not full; purge_cache() does not write dirty pages
+      for (int i = 0; i < 12; i++)
+        pages.push_back(pm->alloc_page(0, Page::kTypeBlob));
+      ham_u64_t elements = pm->m_cache.get_current_elements();
+      REQUIRE(elements > 16u);
+      pm->purge_cache();
+      REQUIRE(elements == pm->m_cache.get_current_elements());
+      pages.resize(12);
+    }
+
+    // the flusher thread may have been faster
+    (void)pm->get_flusher()->run_once();
+
+    {
+      ExclusiveLock lock(lenv->get_mutex());
+      pm->get_flusher()->wait_for_io();
+      std::vector<Page *> dirty;
+      pm->m_cache.get_dirty_pages(dirty);
+      REQUIRE(dirty.size() <= 4u);
+
+      // the flushed pages were written to disk
+      ByteArray buffer(page_size);
+      int flushed = 0;
+      for (int i = 0; i < 12; i++) {
+        if (pages[i]->is_dirty())
+          continue;
+        lenv->get_device()->read(pages[i]->get_address(), buffer.get_ptr(),
+                        page_size);
+        REQUIRE(0 == memcmp(buffer.get_ptr(), pages[i]->get_data(),
+                        page_size));
+        flushed++;
+      }
+      REQUIRE(flushed > 0);
+      REQUIRE(false == pages[0]->is_pinned());
+    }
+
+    ham_env_metrics_t metrics;
+    REQUIRE(0 == ham_env_get_metrics(m_env, &metrics));
+    REQUIRE(metrics.flusher_runs > 0u);
+    REQUIRE(metrics.flusher_pages_flushed >= 20u);
+  }
+
   void storeStateTest() {
     LocalEnvironment *lenv = (LocalEnvironment *)m_env;
     PageManager *pm = lenv->get_page_manager();
@@ -398,6 +749,8 @@ struct PageManagerFixture {
   }
 };
 
+std::vector<Page *> PageManagerFixture::ms_purged;
+
 TEST_CASE("PageManager/fetchPage", "")
 {
   PageManagerFixture f;
@@ -458,6 +811,54 @@ TEST_CASE("PageManager/cacheFullTest", "")
   f.cacheFullTest();
 }
 
+TEST_CASE("PageManager/cacheScanLruTest", "")
+{
+  PageManagerFixture f(false, 16 * HAM_DEFAULT_PAGESIZE);
+  REQUIRE(false == f.cacheScanTest(HAM_CACHE_POLICY_LRU));
+}
+
+TEST_CASE("PageManager/cacheScan2QTest", "")
+{
+  PageManagerFixture f(false, 16 * HAM_DEFAULT_PAGESIZE);
+  REQUIRE(true == f.cacheScanTest(HAM_CACHE_POLICY_2Q));
+}
+
+TEST_CASE("PageManager/cacheHashTableTest", "")
+{
+  PageManagerFixture f(false, 16 * HAM_DEFAULT_PAGESIZE);
+  f.cacheHashTableTest();
+}
+
+TEST_CASE("PageManager/cachePinTest", "")
+{
+  PageManagerFixture f(false, 16 * HAM_DEFAULT_PAGESIZE);
+  f.cachePinTest();
+}
+
+TEST_CASE("PageManager/cacheShardTest", "")
+{
+  PageManagerFixture f(false, 16 * HAM_DEFAULT_PAGESIZE);
+  f.cacheShardTest();
+}
+
+TEST_CASE("PageManager/cachePolicyTest", "")
+{
+  PageManagerFixture f;
+  f.cachePolicyTest();
+}
+
+TEST_CASE("PageManager/flusherParamsTest", "")
+{
+  PageManagerFixture f;
+  f.flusherParamsTest();
+}
+
+TEST_CASE("PageManager/flusherTest", "")
+{
+  PageManagerFixture f;
+  f.flusherTest();
+}
+
 TEST_CASE("PageManager/storeStateTest", "")
 {
   PageManagerFixture f(false, 16 * HAM_DEFAULT_PAGESIZE);
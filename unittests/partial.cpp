@@ -31,11 +31,14 @@ using namespace hamsterdb;
 struct PartialWriteFixture {
   ham_u32_t m_page_size;
   bool m_inmemory;
+  int m_record_compression;
   ham_db_t *m_db;
   ham_env_t *m_env;
 
-  PartialWriteFixture(ham_u32_t page_size = 0, bool inmemory = false)
-    : m_page_size(page_size), m_inmemory(inmemory) {
+  PartialWriteFixture(ham_u32_t page_size = 0, bool inmemory = false,
+                  int record_compression = 0)
+    : m_page_size(page_size), m_inmemory(inmemory),
+      m_record_compression(record_compression) {
     setup();
   }
 
@@ -54,11 +57,17 @@ struct PartialWriteFixture {
       params[0].value = m_page_size;
     }
 
+    ham_parameter_t db_params[] = {
+      { HAM_PARAM_RECORD_COMPRESSION, (ham_u64_t)m_record_compression },
+      { 0, 0 }
+    };
+
     REQUIRE(0 ==
         ham_env_create(&m_env, Globals::opath(".test"),
             m_inmemory ? HAM_IN_MEMORY : 0, 0644, &params[0]));
     REQUIRE(0 ==
-        ham_env_create_db(m_env, &m_db, 1, 0, 0));
+        ham_env_create_db(m_env, &m_db, 1, 0,
+            m_record_compression ? &db_params[0] : 0));
   }
 
   void teardown() {
@@ -245,10 +254,13 @@ struct PartialWriteFixture {
 #include "partial-write-inmem-ps16.h"
 #include "partial-write-inmem-ps64.h"
 
+#include "partial-write-lz4-ps16.h"
+
 
 struct OverwritePartialWriteFixture : public PartialWriteFixture {
-  OverwritePartialWriteFixture(ham_u32_t page_size, bool inmemory = false)
-    : PartialWriteFixture(page_size, inmemory) {
+  OverwritePartialWriteFixture(ham_u32_t page_size, bool inmemory = false,
+                  int record_compression = 0)
+    : PartialWriteFixture(page_size, inmemory, record_compression) {
   }
 
   void fillBufferReverse(ham_u8_t *ptr, ham_u32_t size) {
@@ -305,6 +317,8 @@ struct OverwritePartialWriteFixture : public PartialWriteFixture {
 #include "partial-overwrite-inmem-ps16.h"
 #include "partial-overwrite-inmem-ps64.h"
 
+#include "partial-overwrite-lz4-ps16.h"
+
 struct ShrinkPartialWriteFixture : public PartialWriteFixture {
   ShrinkPartialWriteFixture() {
   }
@@ -822,7 +836,7 @@ struct PartialReadFixture {
   ham_env_t *m_env;
 
   PartialReadFixture(ham_u32_t page_size = 0, bool inmemory = false,
-                  ham_u32_t find_flags = 0)
+                  ham_u32_t find_flags = 0, int record_compression = 0)
     : m_page_size(page_size), m_inmemory(inmemory), m_find_flags(find_flags) {
     ham_parameter_t params[] = {
       { 0, 0 },
@@ -834,11 +848,17 @@ struct PartialReadFixture {
       params[0].value = m_page_size;
     }
 
+    ham_parameter_t db_params[] = {
+      { HAM_PARAM_RECORD_COMPRESSION, (ham_u64_t)record_compression },
+      { 0, 0 }
+    };
+
     REQUIRE(0 ==
         ham_env_create(&m_env, Globals::opath(".test"),
             m_inmemory ? HAM_IN_MEMORY : 0, 0644, &params[0]));
     REQUIRE(0 ==
-        ham_env_create_db(m_env, &m_db, 1, 0, 0));
+        ham_env_create_db(m_env, &m_db, 1, 0,
+            record_compression ? &db_params[0] : 0));
   }
 
   ~PartialReadFixture() {
@@ -983,6 +1003,8 @@ struct PartialReadFixture {
 #include "partial-read-direct-ps16.h"
 #include "partial-read-direct-ps64.h"
 
+#include "partial-read-lz4-ps16.h"
+
 struct MiscPartialFixture {
   ham_db_t *m_db;
   ham_env_t *m_env;
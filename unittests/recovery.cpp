@@ -32,11 +32,7 @@ using namespace hamsterdb;
 
 int
 default_compressor() {
-#ifdef HAM_COMPRESSOR_SNAPPY
-  return (HAM_COMPRESSOR_SNAPPY);
-#else
-  return (2);
-#endif
+  return (HAM_COMPRESSOR_LZ4);
 }
 
 ham_parameter_t *
@@ -137,5 +137,8 @@ duplicate_test(0);
 print "----------------------------\nextended_duplicate_test\n";
 extended_duplicate_test(0);
 
+print "----------------------------\nextended_test (compressed)\n";
+extended_test(1);
+
 print "\nsuccess!\n";
 exit(0);
@@ -16,6 +16,9 @@
 
 #include "../src/config.h"
 
+#include <set>
+#include <vector>
+
 #include "3rdparty/catch/catch.hpp"
 
 #include "globals.h"
@@ -1519,4 +1522,190 @@ TEST_CASE("Txn-inmem/cursorOverwriteTest", "")
   f.cursorOverwriteTest();
 }
 
+TEST_CASE("TxnAllocator/arenaTest", "")
+{
+  TransactionArena arena;
+  ham_u64_t misses = g_txn_allocator_misses;
+
+  // the first allocations are served from the inline storage
+  char *p1 = (char *)arena.allocate(13);
+  char *p2 = (char *)arena.allocate(100);
+  REQUIRE(p2 == p1 + 16);
+  REQUIRE(misses == g_txn_allocator_misses);
+
+  // now fill the first chunk
+  std::vector<char *> ptrs;
+  for (int i = 0; i < 1000; i++) {
+    char *p = (char *)arena.allocate(i);
+    REQUIRE(0u == ((size_t)p & 7));
+    memset(p, i & 0xff, i);
+    ptrs.push_back(p);
+  }
+  REQUIRE(misses < g_txn_allocator_misses);
+  for (int i = 0; i < 1000; i++) {
+    for (int j = 0; j < i; j++)
+      REQUIRE((char)(i & 0xff) == ptrs[i][j]);
+  }
+
+  // a huge allocation gets its own chunk
+  char *p3 = (char *)arena.allocate(1024 * 1024);
+  memset(p3, 0, 1024 * 1024);
+
+  arena.clear();
+  REQUIRE(p1 == (char *)arena.allocate(8));
+}
+
+TEST_CASE("TxnAllocator/slabTest", "")
+{
+  TransactionNodeSlab slab;
+  std::vector<void *> ptrs;
+
+  ham_u64_t misses = g_txn_allocator_misses;
+  for (int i = 0; i < 200; i++)
+    ptrs.push_back(slab.allocate(24));
+  // 200 objects require 4 slabs
+  REQUIRE(g_txn_allocator_misses == misses + 4);
+
+  // recycle an object
+  void *p = ptrs[17];
+  TransactionNodeSlab::release(p);
+  REQUIRE(p == slab.allocate(24));
+  REQUIRE(g_txn_allocator_misses == misses + 4);
+
+  for (int i = 0; i < 200; i++)
+    TransactionNodeSlab::release(ptrs[i]);
+
+  // the older slabs were released, but the newest one is still available
+  ham_u64_t hits = g_txn_allocator_hits;
+  for (int i = 0; i < 64; i++)
+    ptrs[i] = slab.allocate(24);
+  REQUIRE(g_txn_allocator_hits == hits + 64);
+  REQUIRE(g_txn_allocator_misses == misses + 4);
+  for (int i = 0; i < 64; i++)
+    TransactionNodeSlab::release(ptrs[i]);
+
+  // unpooled objects are released with the same function
+  p = TransactionNodeSlab::allocate_unpooled(24);
+  TransactionNodeSlab::release(p);
+}
+
+TEST_CASE("TxnAllocator/metricsTest", "")
+{
+  TxnFixture f;
+  ham_env_metrics_t metrics1, metrics2;
+  REQUIRE(0 == ham_env_get_metrics(f.m_env, &metrics1));
+
+  ham_txn_t *txn;
+  REQUIRE(0 == ham_txn_begin(&txn, f.m_env, 0, 0, 0));
+  for (int i = 0; i < 100; i++) {
+    ham_key_t key = {0};
+    key.data = &i;
+    key.size = sizeof(i);
+    ham_record_t rec = {0};
+    REQUIRE(0 == ham_db_insert(f.m_db, txn, &key, &rec, 0));
+  }
+  REQUIRE(0 == ham_txn_commit(txn, 0));
+
+  // 100 operations and 100 nodes; only a few chunks and slabs are
+  // allocated from the heap (1k, 2k, 4k, 8k, 16k and 2 slabs)
+  REQUIRE(0 == ham_env_get_metrics(f.m_env, &metrics2));
+  ham_u64_t allocations = metrics2.txn_allocator_hits
+                  + metrics2.txn_allocator_misses;
+  REQUIRE(allocations == metrics1.txn_allocator_hits
+                  + metrics1.txn_allocator_misses + 200);
+  REQUIRE(metrics2.txn_allocator_misses <= metrics1.txn_allocator_misses + 7);
+}
+
+struct IntCompare {
+  int operator()(int *lhs, int *rhs) const {
+    return (*lhs < *rhs ? -1 : (*lhs > *rhs ? +1 : 0));
+  }
+};
+
+struct IntCollector {
+  void visit(int *i) {
+    values.push_back(*i);
+  }
+
+  std::vector<int> values;
+};
+
+TEST_CASE("TxnIndex/inmemBtreeTest", "")
+{
+  InMemoryBtree<int, IntCompare> tree;
+  std::set<int> set;
+  std::vector<int> values(5000);
+  for (int i = 0; i < 5000; i++)
+    values[i] = i * 2;
+
+  // insert in pseudo-random order; enough elements for three levels
+  for (int i = 0; i < 5000; i++) {
+    int *p = &values[(i * 7919) % 5000];
+    tree.insert(p);
+    set.insert(*p);
+  }
+  REQUIRE(tree.size() == set.size());
+
+  // remove two thirds of the elements, also in pseudo-random order
+  for (int i = 0; i < 5000; i++) {
+    int *p = &values[(i * 104729) % 5000];
+    if (*p % 3 == 0)
+      continue;
+    REQUIRE(true == tree.remove(p));
+    REQUIRE(false == tree.remove(p));
+    set.erase(*p);
+  }
+  REQUIRE(tree.size() == set.size());
+  REQUIRE(*tree.first() == *set.begin());
+  REQUIRE(*tree.last() == *set.rbegin());
+
+  IntCollector collector;
+  tree.enumerate(&collector);
+  REQUIRE(collector.values == std::vector<int>(set.begin(), set.end()));
+
+  // compare the searches with std::set; odd keys do not exist
+  for (int key = -1; key <= 10001; key++) {
+    int *p;
+    std::set<int>::iterator it = set.find(key);
+    p = tree.search(&key);
+    if (it == set.end())
+      REQUIRE(p == (int *)0);
+    else
+      REQUIRE(*p == key);
+
+    it = set.lower_bound(key);
+    p = tree.nsearch(&key);
+    if (it == set.end())
+      REQUIRE(p == (int *)0);
+    else
+      REQUIRE(*p == *it);
+
+    it = set.upper_bound(key);
+    p = tree.next(&key);
+    if (it == set.end())
+      REQUIRE(p == (int *)0);
+    else
+      REQUIRE(*p == *it);
+
+    p = tree.psearch(&key);
+    if (it == set.begin())
+      REQUIRE(p == (int *)0);
+    else
+      REQUIRE(*p == *(--it));
+
+    it = set.lower_bound(key);
+    p = tree.previous(&key);
+    if (it == set.begin())
+      REQUIRE(p == (int *)0);
+    else
+      REQUIRE(*p == *(--it));
+  }
+
+  // now remove everything
+  while (tree.first())
+    REQUIRE(true == tree.remove(tree.first()));
+  REQUIRE(tree.size() == 0u);
+  REQUIRE(tree.last() == (int *)0);
+}
+
 } // namespace hamsterdb